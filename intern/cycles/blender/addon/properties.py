@@ -391,6 +391,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         min=0.0, max=1.0,
         default=0.01,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights by their estimated contribution to the shading point instead of uniformly, "
+        "reducing noise in scenes with many lights. Not used when sampling all lights",
+        default=False,
+    )
 
     use_adaptive_sampling: BoolProperty(
         name="Use Adaptive Sampling",
@@ -794,6 +800,26 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_auto_limit: BoolProperty(
+        name="Automatic Texture Limit",
+        description="Reduce the resolution of image textures on objects that are small in the frame, "
+        "based on their projected size in the camera view",
+        default=False,
+    )
+
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read image textures on demand in tiles while rendering on the CPU, instead of loading them fully. "
+        "Tiled and mipmapped files (.tx) are read most efficiently",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Texture Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        min=64, max=1048576,
+        default=4096,
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
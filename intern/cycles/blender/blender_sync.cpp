@@ -307,6 +307,11 @@ void BlenderSync::sync_integrator()
   integrator->sample_all_lights_direct = get_boolean(cscene, "sample_all_lights_direct");
   integrator->sample_all_lights_indirect = get_boolean(cscene, "sample_all_lights_indirect");
   integrator->light_sampling_threshold = get_float(cscene, "light_sampling_threshold");
+  integrator->use_light_tree = get_boolean(cscene, "use_light_tree");
+
+  if (integrator->use_light_tree_sampling() != previntegrator.use_light_tree_sampling()) {
+    scene->light_manager->tag_update(scene);
+  }
 
   if (RNA_boolean_get(&cscene, "use_adaptive_sampling")) {
     integrator->sampling_pattern = SAMPLING_PATTERN_PMJ;
@@ -767,6 +772,17 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  /* Only for final renders, to avoid reloading images while navigating the viewport. */
+  params.use_texture_auto_limit = background && b_scene.render().use_simplify() &&
+                                  get_boolean(cscene, "use_texture_auto_limit");
+
+  if (get_boolean(cscene, "use_texture_cache")) {
+    params.texture_cache_size = get_int(cscene, "texture_cache_size");
+  }
+  else {
+    params.texture_cache_size = 0;
+  }
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
@@ -92,7 +92,11 @@ int BVHStackEntry::encodeIdx() const
 BVH::BVH(const BVHParams &params_,
          const vector<Geometry *> &geometry_,
          const vector<Object *> &objects_)
-    : params(params_), geometry(geometry_), objects(objects_)
+    : params(params_),
+      geometry(geometry_),
+      objects(objects_),
+      build_sah_cost(0.0f),
+      refit_sah_cost(0.0f)
 {
 }
 
@@ -169,6 +173,14 @@ void BVH::build(Progress &progress, Stats *)
     return;
   }
 
+  /* Reference for the quality of the tree once it gets refitted. */
+  if (!params.top_level) {
+    build_sah_cost = root->computeSubtreeSAHCost(params);
+    if (!isfinite_safe(build_sah_cost)) {
+      build_sah_cost = 0.0f;
+    }
+  }
+
   /* pack nodes */
   progress.set_substatus("Packing BVH nodes");
   pack_nodes(root);
@@ -179,16 +191,26 @@ void BVH::build(Progress &progress, Stats *)
 
 /* Refitting */
 
-void BVH::refit(Progress &progress)
+bool BVH::refit(Progress &progress)
 {
   progress.set_substatus("Packing BVH primitives");
   pack_primitives();
 
   if (progress.get_cancel())
-    return;
+    return true;
 
   progress.set_substatus("Refitting BVH nodes");
   refit_nodes();
+
+  /* The tree topology stays the same, which fits worse the further primitives move away from
+   * where they were when building. */
+  if (build_sah_cost > 0.0f && refit_sah_cost > build_sah_cost * params.refit_sah_threshold) {
+    VLOG(1) << "Refitted BVH SAH cost " << refit_sah_cost << " exceeds built cost "
+            << build_sah_cost << ", building again.";
+    return false;
+  }
+
+  return true;
 }
 
 void BVH::refit_primitives(int start, int end, BoundBox &bbox, uint &visibility)
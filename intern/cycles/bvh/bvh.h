@@ -99,13 +99,18 @@ class BVH {
   {
   }
 
-  void refit(Progress &progress);
+  /* Returns false when the refitted tree degraded too much, and should be built again. */
+  bool refit(Progress &progress);
 
  protected:
   BVH(const BVHParams &params,
       const vector<Geometry *> &geometry,
       const vector<Object *> &objects);
 
+  /* SAH cost of the tree when built and after the last refit, zero if unknown. */
+  float build_sah_cost;
+  float refit_sah_cost;
+
   /* Refit range of primitives. */
   void refit_primitives(int start, int end, BoundBox &bbox, uint &visibility);
 
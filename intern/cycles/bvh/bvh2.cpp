@@ -241,10 +241,15 @@ void BVH2::refit_nodes()
 
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
-  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+  float sah_cost = 0.0f;
+  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility, sah_cost);
+
+  /* Normalize by the root area, same as BVHNode::computeSubtreeSAHCost(). */
+  const float area = bbox.safe_area();
+  refit_sah_cost = (area > 0.0f) ? sah_cost / area : 0.0f;
 }
 
-void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility, float &sah_cost)
 {
   if (leaf) {
     /* refit leaf node */
@@ -262,6 +267,8 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     leaf_data[0].z = __uint_as_float(visibility);
     leaf_data[0].w = __uint_as_float(data[0].w);
     memcpy(&pack.leaf_nodes[idx], leaf_data, sizeof(float4) * BVH_NODE_LEAF_SIZE);
+
+    sah_cost += bbox.safe_area() * params.primitive_cost(c1 - c0);
   }
   else {
     assert(idx + BVH_NODE_SIZE <= pack.nodes.size());
@@ -274,8 +281,8 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     BoundBox bbox0 = BoundBox::empty, bbox1 = BoundBox::empty;
     uint visibility0 = 0, visibility1 = 0;
 
-    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0);
-    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1);
+    refit_node((c0 < 0) ? -c0 - 1 : c0, (c0 < 0), bbox0, visibility0, sah_cost);
+    refit_node((c1 < 0) ? -c1 - 1 : c1, (c1 < 0), bbox1, visibility1, sah_cost);
 
     if (is_unaligned) {
       Transform aligned_space = transform_identity();
@@ -289,6 +296,8 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     bbox.grow(bbox0);
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
+
+    sah_cost += bbox.safe_area() * params.node_cost(2);
   }
 }
 
@@ -85,7 +85,7 @@ class BVH2 : public BVH {
 
   /* refit */
   void refit_nodes() override;
-  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
+  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility, float &sah_cost);
 };
 
 CCL_NAMESPACE_END
@@ -56,6 +56,10 @@ class BVHParams {
   float sah_node_cost;
   float sah_primitive_cost;
 
+  /* Build again instead of refitting, once refitting made the SAH cost grow by more than
+   * this factor compared to the built tree. */
+  float refit_sah_threshold;
+
   /* number of primitives in leaf */
   int min_leaf_size;
   int max_triangle_leaf_size;
@@ -106,6 +110,8 @@ class BVHParams {
     sah_node_cost = 1.0f;
     sah_primitive_cost = 1.0f;
 
+    refit_sah_threshold = 1.5f;
+
     min_leaf_size = 1;
     max_triangle_leaf_size = 8;
     max_motion_triangle_leaf_size = 8;
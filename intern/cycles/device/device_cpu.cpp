@@ -57,6 +57,7 @@
 #include "util/util_progress.h"
 #include "util/util_system.h"
 #include "util/util_task.h"
+#include "util/util_texture_cache.h"
 #include "util/util_thread.h"
 
 CCL_NAMESPACE_BEGIN
@@ -1432,6 +1433,7 @@ class CPUDevice : public Device {
     }
     kg.decoupled_volume_steps_index = 0;
     kg.coverage_asset = kg.coverage_object = kg.coverage_material = NULL;
+    kg.texture_cache_tdata = NULL;
 #ifdef WITH_OSL
     OSLShader::thread_init(&kg, &kernel_globals, &osl_globals);
 #endif
@@ -1454,6 +1456,9 @@ class CPUDevice : public Device {
         free(kg->decoupled_volume_steps[i]);
       }
     }
+    if (kg->texture_cache_tdata != NULL) {
+      texture_cache_thread_free(kg->texture_cache_tdata);
+    }
 #ifdef WITH_OSL
     OSLShader::thread_free(kg);
 #endif
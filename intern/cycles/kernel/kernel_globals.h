@@ -49,6 +49,7 @@ typedef unordered_map<float, float> CoverageMap;
 
 struct Intersection;
 struct VolumeStep;
+struct TextureCacheThreadData;
 
 typedef struct KernelGlobals {
 #  define KERNEL_TEX(type, name) texture<type> name;
@@ -78,6 +79,9 @@ typedef struct KernelGlobals {
   CoverageMap *coverage_material;
   CoverageMap *coverage_asset;
 
+  /* Texture cache state of the thread, created on its first lookup. */
+  TextureCacheThreadData *texture_cache_tdata;
+
   /* split kernel */
   SplitData split_data;
   SplitParams split_param_data;
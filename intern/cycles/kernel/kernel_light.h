@@ -35,6 +35,126 @@ typedef struct LightSample {
   LightType type; /* type of light */
 } LightSample;
 
+/* Light Tree
+ *
+ * Point, spot and area lights are organized in a tree, which is traversed stochastically
+ * with probabilities proportional to an importance estimate of each child for the shading
+ * point. Only the position is used, so the probability of any light can be recomputed for
+ * MIS from the ray origin alone. */
+
+ccl_device_inline bool light_tree_use_type(LightType type)
+{
+  return (type == LIGHT_POINT || type == LIGHT_SPOT || type == LIGHT_AREA);
+}
+
+ccl_device float light_tree_node_importance(KernelGlobals *kg, int index, float3 P)
+{
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, index);
+  const float3 bbox_min = make_float3(knode->bbox_min[0], knode->bbox_min[1], knode->bbox_min[2]);
+  const float3 bbox_max = make_float3(knode->bbox_max[0], knode->bbox_max[1], knode->bbox_max[2]);
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius = 0.5f * len(bbox_max - bbox_min);
+  float distance;
+  const float3 D = normalize_len(P - centroid, &distance);
+
+  /* Angle from the cone axis to the shading point, reduced by the normal spread and by the
+   * angle under which the bounds are seen. Inside the bounds any direction is possible. */
+  const float theta_b = (distance > radius) ? asinf(radius / distance) : M_PI_F;
+  const float theta_w = safe_acosf(dot(axis, D));
+  const float theta = max(theta_w - knode->theta_o - theta_b, 0.0f);
+  if (theta >= knode->theta_e) {
+    return 0.0f;
+  }
+
+  /* Clamp the distance to the bounds size, to avoid singularities close to the lights. */
+  const float distance_sq = max(distance * distance, radius * radius);
+  return knode->energy * cosf(theta) / max(distance_sq, 1e-8f);
+}
+
+ccl_device_inline float light_tree_left_probability(KernelGlobals *kg, int index, float3 P)
+{
+  const float importance_left = light_tree_node_importance(kg, index + 1, P);
+  const float importance_right = light_tree_node_importance(
+      kg, kernel_tex_fetch(__light_tree_nodes, index).child_index, P);
+  const float importance = importance_left + importance_right;
+
+  return (importance > 0.0f) ? importance_left / importance : -1.0f;
+}
+
+/* Pick a light from the tree, rescaling randu to be reused for sampling the light. */
+ccl_device int light_tree_sample(KernelGlobals *kg, float3 P, float *randu)
+{
+  int index = 0;
+
+  while (true) {
+    const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, index);
+    if (knode->light >= 0) {
+      return knode->light;
+    }
+
+    const float prob_left = light_tree_left_probability(kg, index, P);
+    if (prob_left < 0.0f) {
+      return -1;
+    }
+
+    if (*randu < prob_left) {
+      *randu = *randu / prob_left;
+      index = index + 1;
+    }
+    else {
+      *randu = (*randu - prob_left) / (1.0f - prob_left);
+      index = knode->child_index;
+    }
+  }
+}
+
+/* Probability of light_tree_sample picking the given light, following its bit trail. */
+ccl_device float light_tree_pdf(KernelGlobals *kg, int lamp, float3 P)
+{
+  uint bit_trail = kernel_tex_fetch(__lights, lamp).tree_bit_trail;
+  float pdf = 1.0f;
+  int index = 0;
+
+  while (true) {
+    const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, index);
+    if (knode->light >= 0) {
+      return pdf;
+    }
+
+    const float prob_left = light_tree_left_probability(kg, index, P);
+    if (prob_left < 0.0f) {
+      return 0.0f;
+    }
+
+    if (bit_trail & 1) {
+      pdf *= 1.0f - prob_left;
+      index = knode->child_index;
+    }
+    else {
+      pdf *= prob_left;
+      index = index + 1;
+    }
+    bit_trail >>= 1;
+  }
+}
+
+/* Probability of picking a lamp, as a fraction of all lights and emissive triangles. */
+ccl_device_inline float lamp_light_select_pdf(KernelGlobals *kg,
+                                              int lamp,
+                                              LightType type,
+                                              float3 P)
+{
+  if (kernel_data.integrator.use_light_tree && light_tree_use_type(type)) {
+    /* The lamps in the tree are first picked as a group, then by the tree. */
+    return kernel_data.integrator.pdf_lights * kernel_data.integrator.num_light_tree_lights *
+           light_tree_pdf(kg, lamp, P);
+  }
+
+  return kernel_data.integrator.pdf_lights;
+}
+
 /* Regular Light */
 
 ccl_device_inline bool lamp_light_sample(
@@ -153,7 +273,7 @@ ccl_device_inline bool lamp_light_sample(
     }
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= lamp_light_select_pdf(kg, lamp, type, P);
 
   return (ls->pdf > 0.0f);
 }
@@ -291,7 +411,7 @@ ccl_device bool lamp_light_eval(
     return false;
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
+  ls->pdf *= lamp_light_select_pdf(kg, lamp, type, P);
 
   return true;
 }
@@ -651,6 +771,15 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
     }
 
     lamp = -prim - 1;
+
+    if (kernel_data.integrator.use_light_tree &&
+        light_tree_use_type((LightType)kernel_tex_fetch(__lights, lamp).type)) {
+      /* Replace the uniformly picked lamp by one picked by importance from the tree. */
+      lamp = light_tree_sample(kg, P, &randu);
+      if (lamp < 0) {
+        return false;
+      }
+    }
   }
 
   if (UNLIKELY(light_select_reached_max_bounces(kg, lamp, bounce))) {
@@ -1389,7 +1389,9 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
-  int pad1, pad2;
+  /* light tree */
+  int use_light_tree;
+  int num_light_tree_lights;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1521,7 +1523,7 @@ typedef struct KernelLight {
   float max_bounces;
   float random;
   float strength[3];
-  float pad1;
+  uint tree_bit_trail;
   Transform tfm;
   Transform itfm;
   union {
@@ -1548,6 +1550,24 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+/* Node of the light tree used for importance sampling of point, spot and area lights.
+ * Interior nodes are directly followed by their first child, the second child is at
+ * child_index. Leaves reference a single light. */
+typedef struct KernelLightTreeNode {
+  float bbox_min[3];
+  float energy;
+  float bbox_max[3];
+  /* Spread of emitter normals around the axis. */
+  float theta_o;
+  float axis[3];
+  /* Angle beyond theta_o up to which the emitters still emit. */
+  float theta_e;
+  int child_index;
+  int light;
+  int pad1, pad2;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
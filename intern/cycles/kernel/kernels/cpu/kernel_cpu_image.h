@@ -17,6 +17,8 @@
 #ifndef __KERNEL_CPU_IMAGE_H__
 #define __KERNEL_CPU_IMAGE_H__
 
+#include "util/util_texture_cache.h"
+
 CCL_NAMESPACE_BEGIN
 
 /* Make template functions private so symbols don't conflict between kernels with different
@@ -474,6 +476,15 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
+  if (info.texture_cache) {
+    return texture_cache_lookup(&kg->texture_cache_tdata,
+                                (const TextureCacheImage *)info.texture_cache,
+                                x,
+                                y,
+                                make_float2(0.0f, 0.0f),
+                                make_float2(0.0f, 0.0f));
+  }
+
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF:
       return TextureInterpolator<half>::interp(info, x, y);
@@ -498,6 +509,26 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Same as kernel_tex_image_interp(), with the derivatives of the coordinates along the screen
+ * axes. They select the MIP level of images sampled through the texture cache, other images
+ * have no MIP levels. */
+ccl_device float4 kernel_tex_image_interp_filtered(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+
+  if (info.texture_cache) {
+    return texture_cache_lookup(&kg->texture_cache_tdata,
+                                (const TextureCacheImage *)info.texture_cache,
+                                x,
+                                y,
+                                dx,
+                                dy);
+  }
+
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
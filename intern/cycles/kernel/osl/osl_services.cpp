@@ -1118,8 +1118,13 @@ bool OSLRenderServices::texture(ustring filename,
       break;
     }
     case OSLTextureHandle::SVM: {
-      /* Packed texture. */
-      float4 rgba = kernel_tex_image_interp(kernel_globals, handle->svm_slot, s, 1.0f - t);
+      /* Packed texture, with the V axis flipped like the coordinate. */
+      float4 rgba = kernel_tex_image_interp_filtered(kernel_globals,
+                                                     handle->svm_slot,
+                                                     s,
+                                                     1.0f - t,
+                                                     make_float2(dsdx, -dtdx),
+                                                     make_float2(dsdy, -dtdy));
 
       result[0] = rgba[0];
       if (nchannels > 1)
@@ -16,14 +16,21 @@
 
 CCL_NAMESPACE_BEGIN
 
-ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+/* The derivatives of the coordinates along the screen axes are only used on the CPU, for images
+ * sampled through the texture cache. */
+ccl_device float4 svm_image_texture_filtered(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy, uint flags)
 {
   if (id == -1) {
     return make_float4(
         TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
   }
 
+#ifdef __KERNEL_CPU__
+  float4 r = kernel_tex_image_interp_filtered(kg, id, x, y, dx, dy);
+#else
   float4 r = kernel_tex_image_interp(kg, id, x, y);
+#endif
   const float alpha = r.w;
 
   if ((flags & NODE_IMAGE_ALPHA_UNASSOCIATE) && alpha != 1.0f && alpha != 0.0f) {
@@ -38,6 +45,32 @@ ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y,
   return r;
 }
 
+ccl_device float4 svm_image_texture(KernelGlobals *kg, int id, float x, float y, uint flags)
+{
+  return svm_image_texture_filtered(
+      kg, id, x, y, make_float2(0.0f, 0.0f), make_float2(0.0f, 0.0f), flags);
+}
+
+#ifdef __KERNEL_CPU__
+/* Derivatives of the default UV map along the screen axes, from the ray differentials. SVM does
+ * not track derivatives of texture coordinates, these stand in for them since image textures
+ * are usually mapped by UV. */
+ccl_device_inline void svm_image_uv_derivatives(KernelGlobals *kg,
+                                                ShaderData *sd,
+                                                float2 *dx,
+                                                float2 *dy)
+{
+  *dx = make_float2(0.0f, 0.0f);
+  *dy = make_float2(0.0f, 0.0f);
+#  ifdef __RAY_DIFFERENTIALS__
+  const AttributeDescriptor desc = find_attribute(kg, sd, ATTR_STD_UV);
+  if (desc.offset != ATTR_STD_NOT_FOUND) {
+    primitive_surface_attribute_float2(kg, sd, desc, dx, dy);
+  }
+#  endif
+}
+#endif
+
 /* Remap coordnate from 0..1 box to -1..-1 */
 ccl_device_inline float3 texco_remap_square(float3 co)
 {
@@ -108,7 +141,16 @@ ccl_device void svm_node_tex_image(
     id = -num_nodes;
   }
 
-  float4 f = svm_image_texture(kg, id, tex_co.x, tex_co.y, flags);
+  float2 tex_co_dx = make_float2(0.0f, 0.0f);
+  float2 tex_co_dy = make_float2(0.0f, 0.0f);
+#ifdef __KERNEL_CPU__
+  if (id != -1 && node.w == NODE_IMAGE_PROJ_FLAT &&
+      kernel_tex_fetch(__texture_info, id).texture_cache) {
+    svm_image_uv_derivatives(kg, sd, &tex_co_dx, &tex_co_dy);
+  }
+#endif
+
+  float4 f = svm_image_texture_filtered(kg, id, tex_co.x, tex_co.y, tex_co_dx, tex_co_dy, flags);
 
   if (stack_valid(out_offset))
     stack_store_float3(stack, out_offset, make_float3(f.x, f.y, f.z));
@@ -231,6 +231,11 @@ void Camera::update(Scene *scene)
   if (!need_update)
     return;
 
+  /* Image resolution limits depend on the size of objects on screen. */
+  if (scene->params.use_texture_auto_limit) {
+    scene->image_manager->need_update = true;
+  }
+
   /* Full viewport to camera border in the viewport. */
   Transform fulltoborder = transform_from_viewplane(viewport_camera_border);
   Transform bordertofull = transform_inverse(fulltoborder);
@@ -40,6 +40,7 @@
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
+#include "util/util_tbb.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -60,6 +61,7 @@ Geometry::Geometry(const NodeType *node_type, const Type type)
 {
   need_update = true;
   need_update_rebuild = false;
+  need_update_pack = true;
 
   transform_applied = false;
   transform_negative_scaled = false;
@@ -192,15 +194,17 @@ void Geometry::compute_bvh(
     vector<Object *> objects;
     objects.push_back(&object);
 
+    bool refitted = false;
     if (bvh && !need_update_rebuild) {
       progress->set_status(msg, "Refitting BVH");
 
       bvh->geometry = geometry;
       bvh->objects = objects;
 
-      bvh->refit(*progress);
+      refitted = bvh->refit(*progress);
     }
-    else {
+
+    if (!refitted) {
       progress->set_status(msg, "Building BVH");
 
       BVHParams bparams;
@@ -255,6 +259,11 @@ void Geometry::tag_update(Scene *scene, bool rebuild)
 
   scene->geometry_manager->need_update = true;
   scene->object_manager->need_update = true;
+
+  /* Image resolution limits depend on the size of objects on screen. */
+  if (scene->params.use_texture_auto_limit) {
+    scene->image_manager->need_update = true;
+  }
 }
 
 /* Geometry Manager */
@@ -799,6 +808,13 @@ void GeometryManager::mesh_calc_offset(Scene *scene)
     if (geom->type == Geometry::MESH) {
       Mesh *mesh = static_cast<Mesh *>(geom);
 
+      /* Packed indices include the offsets, so geometry that moved has to be packed again. */
+      if (mesh->vert_offset != vert_size || mesh->prim_offset != tri_size ||
+          mesh->patch_offset != patch_size || mesh->face_offset != face_size ||
+          mesh->corner_offset != corner_size) {
+        mesh->need_update_pack = true;
+      }
+
       mesh->vert_offset = vert_size;
       mesh->prim_offset = tri_size;
 
@@ -815,6 +831,9 @@ void GeometryManager::mesh_calc_offset(Scene *scene)
 
         /* patch tables are stored in same array so include them in patch_size */
         if (mesh->patch_table) {
+          if (mesh->patch_table_offset != patch_size) {
+            mesh->need_update_pack = true;
+          }
           mesh->patch_table_offset = patch_size;
           patch_size += mesh->patch_table->total_size();
         }
@@ -829,6 +848,10 @@ void GeometryManager::mesh_calc_offset(Scene *scene)
     else if (geom->type == Geometry::HAIR) {
       Hair *hair = static_cast<Hair *>(geom);
 
+      if (hair->curvekey_offset != curve_key_size || hair->prim_offset != curve_size) {
+        hair->need_update_pack = true;
+      }
+
       hair->curvekey_offset = curve_key_size;
       hair->prim_offset = curve_size;
 
@@ -904,6 +927,14 @@ void GeometryManager::device_update_mesh(
     }
   }
 
+  /* The arrays are kept from the previous update, so only geometry that changed or moved needs
+   * to be packed again. That no longer holds once an array is reallocated with a new size. */
+  const bool pack_all_meshes = for_displacement || dscene->tri_vindex.size() != tri_size ||
+                               dscene->tri_vnormal.size() != vert_size;
+  const bool pack_all_curves = dscene->curve_keys.size() != curve_key_size ||
+                               dscene->curves.size() != curve_size;
+  const bool pack_all_patches = dscene->patches.size() != patch_size;
+
   /* Fill in all the arrays. */
   if (tri_size != 0) {
     /* normals */
@@ -915,21 +946,36 @@ void GeometryManager::device_update_mesh(
     uint *tri_patch = dscene->tri_patch.alloc(tri_size);
     float2 *tri_patch_uv = dscene->tri_patch_uv.alloc(vert_size);
 
-    foreach (Geometry *geom, scene->geometry) {
-      if (geom->type == Geometry::MESH) {
-        Mesh *mesh = static_cast<Mesh *>(geom);
-        mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
-        mesh->pack_normals(&vnormal[mesh->vert_offset]);
-        mesh->pack_verts(tri_prim_index,
-                         &tri_vindex[mesh->prim_offset],
-                         &tri_patch[mesh->prim_offset],
-                         &tri_patch_uv[mesh->vert_offset],
-                         mesh->vert_offset,
-                         mesh->prim_offset);
-        if (progress.get_cancel())
-          return;
-      }
-    }
+    /* Geometry writes to its own range of the arrays, so it can be packed in parallel. */
+    parallel_for(blocked_range<size_t>(0, scene->geometry.size()),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     Geometry *geom = scene->geometry[i];
+                     if (geom->type != Geometry::MESH) {
+                       continue;
+                     }
+
+                     Mesh *mesh = static_cast<Mesh *>(geom);
+                     if (pack_all_meshes || mesh->need_update_pack) {
+                       mesh->pack_shaders(scene, &tri_shader[mesh->prim_offset]);
+                       mesh->pack_normals(&vnormal[mesh->vert_offset]);
+                       mesh->pack_verts(tri_prim_index,
+                                        &tri_vindex[mesh->prim_offset],
+                                        &tri_patch[mesh->prim_offset],
+                                        &tri_patch_uv[mesh->vert_offset],
+                                        mesh->vert_offset,
+                                        mesh->prim_offset);
+                     }
+                     else {
+                       /* The BVH is built again, which may reorder the primitives. */
+                       mesh->pack_prim_index(
+                           tri_prim_index, &tri_vindex[mesh->prim_offset], mesh->prim_offset);
+                     }
+                   }
+                 });
+
+    if (progress.get_cancel())
+      return;
 
     /* vertex coordinates */
     progress.set_status("Updating Mesh", "Copying Mesh to device");
@@ -940,6 +986,13 @@ void GeometryManager::device_update_mesh(
     dscene->tri_patch.copy_to_device();
     dscene->tri_patch_uv.copy_to_device();
   }
+  else {
+    dscene->tri_shader.free();
+    dscene->tri_vnormal.free();
+    dscene->tri_vindex.free();
+    dscene->tri_patch.free();
+    dscene->tri_patch_uv.free();
+  }
 
   if (curve_size != 0) {
     progress.set_status("Updating Mesh", "Copying Strands to device");
@@ -947,21 +1000,34 @@ void GeometryManager::device_update_mesh(
     float4 *curve_keys = dscene->curve_keys.alloc(curve_key_size);
     float4 *curves = dscene->curves.alloc(curve_size);
 
-    foreach (Geometry *geom, scene->geometry) {
-      if (geom->type == Geometry::HAIR) {
-        Hair *hair = static_cast<Hair *>(geom);
-        hair->pack_curves(scene,
-                          &curve_keys[hair->curvekey_offset],
-                          &curves[hair->prim_offset],
-                          hair->curvekey_offset);
-        if (progress.get_cancel())
-          return;
-      }
-    }
+    parallel_for(blocked_range<size_t>(0, scene->geometry.size()),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     Geometry *geom = scene->geometry[i];
+                     if (geom->type != Geometry::HAIR) {
+                       continue;
+                     }
+
+                     Hair *hair = static_cast<Hair *>(geom);
+                     if (pack_all_curves || hair->need_update_pack) {
+                       hair->pack_curves(scene,
+                                         &curve_keys[hair->curvekey_offset],
+                                         &curves[hair->prim_offset],
+                                         hair->curvekey_offset);
+                     }
+                   }
+                 });
+
+    if (progress.get_cancel())
+      return;
 
     dscene->curve_keys.copy_to_device();
     dscene->curves.copy_to_device();
   }
+  else {
+    dscene->curve_keys.free();
+    dscene->curves.free();
+  }
 
   if (patch_size != 0) {
     progress.set_status("Updating Mesh", "Copying Patches to device");
@@ -971,6 +1037,10 @@ void GeometryManager::device_update_mesh(
     foreach (Geometry *geom, scene->geometry) {
       if (geom->type == Geometry::MESH) {
         Mesh *mesh = static_cast<Mesh *>(geom);
+        if (!(pack_all_patches || mesh->need_update_pack)) {
+          continue;
+        }
+
         mesh->pack_patches(&patch_data[mesh->patch_offset],
                            mesh->vert_offset,
                            mesh->face_offset,
@@ -988,6 +1058,9 @@ void GeometryManager::device_update_mesh(
 
     dscene->patches.copy_to_device();
   }
+  else {
+    dscene->patches.free();
+  }
 
   if (for_displacement) {
     float4 *prim_tri_verts = dscene->prim_tri_verts.alloc(tri_size * 3);
@@ -1005,6 +1078,12 @@ void GeometryManager::device_update_mesh(
     }
     dscene->prim_tri_verts.copy_to_device();
   }
+  else {
+    /* Everything is packed for rendering now. */
+    foreach (Geometry *geom, scene->geometry) {
+      geom->need_update_pack = false;
+    }
+  }
 }
 
 void GeometryManager::device_update_bvh(Device *device,
@@ -1234,6 +1313,10 @@ void GeometryManager::device_update(Device *device,
         geom->need_update = true;
     }
 
+    if (geom->need_update) {
+      geom->need_update_pack = true;
+    }
+
     if (geom->need_update && geom->type == Geometry::MESH) {
       Mesh *mesh = static_cast<Mesh *>(geom);
 
@@ -1306,7 +1389,7 @@ void GeometryManager::device_update(Device *device,
   }
 
   /* Device update. */
-  device_free(device, dscene);
+  device_free(device, dscene, false);
 
   mesh_calc_offset(scene);
   if (true_displacement_used) {
@@ -1345,7 +1428,7 @@ void GeometryManager::device_update(Device *device,
 
   /* Device re-update after displacement. */
   if (displacement_done) {
-    device_free(device, dscene);
+    device_free(device, dscene, false);
 
     device_update_attributes(device, dscene, scene, progress);
     if (progress.get_cancel())
@@ -1406,7 +1489,7 @@ void GeometryManager::device_update(Device *device,
   }
 }
 
-void GeometryManager::device_free(Device *device, DeviceScene *dscene)
+void GeometryManager::device_free(Device *device, DeviceScene *dscene, bool force_free)
 {
 #ifdef WITH_EMBREE
   if (dscene->data.bvh.scene) {
@@ -1426,20 +1509,25 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene)
   dscene->prim_index.free();
   dscene->prim_object.free();
   dscene->prim_time.free();
-  dscene->tri_shader.free();
-  dscene->tri_vnormal.free();
-  dscene->tri_vindex.free();
-  dscene->tri_patch.free();
-  dscene->tri_patch_uv.free();
-  dscene->curves.free();
-  dscene->curve_keys.free();
-  dscene->patches.free();
   dscene->attributes_map.free();
   dscene->attributes_float.free();
   dscene->attributes_float2.free();
   dscene->attributes_float3.free();
   dscene->attributes_uchar4.free();
 
+  /* Packed geometry is kept for the next update, so geometry that did not change does not
+   * have to be packed again. */
+  if (force_free) {
+    dscene->tri_shader.free();
+    dscene->tri_vnormal.free();
+    dscene->tri_vindex.free();
+    dscene->tri_patch.free();
+    dscene->tri_patch_uv.free();
+    dscene->curves.free();
+    dscene->curve_keys.free();
+    dscene->patches.free();
+  }
+
   /* Signal for shaders like displacement not to do ray tracing. */
   dscene->data.bvh.bvh_layout = BVH_LAYOUT_NONE;
 
@@ -88,6 +88,8 @@ class Geometry : public Node {
   /* Update Flags */
   bool need_update;
   bool need_update_rebuild;
+  /* Data packed into the global arrays is out of date, cleared by device_update_mesh(). */
+  bool need_update_pack;
 
   /* Constructor/Destructor */
   explicit Geometry(const NodeType *node_type, const Type type);
@@ -155,7 +157,7 @@ class GeometryManager {
   /* Device Updates */
   void device_update_preprocess(Device *device, Scene *scene, Progress &progress);
   void device_update(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
-  void device_free(Device *device, DeviceScene *dscene);
+  void device_free(Device *device, DeviceScene *dscene, bool force_free);
 
   /* Updates */
   void tag_update(Scene *scene);
@@ -177,7 +179,8 @@ class GeometryManager {
                              Scene *scene,
                              vector<AttributeRequestSet> &geom_attributes);
 
-  /* Compute verts/triangles/curves offsets in global arrays. */
+  /* Compute verts/triangles/curves offsets in global arrays, tagging geometry that moved
+   * for repacking. */
   void mesh_calc_offset(Scene *scene);
 
   void device_update_object(Device *device, DeviceScene *dscene, Scene *scene, Progress &progress);
@@ -16,19 +16,28 @@
 
 #include "render/image.h"
 #include "device/device.h"
+#include "render/background.h"
+#include "render/camera.h"
 #include "render/colorspace.h"
+#include "render/geometry.h"
 #include "render/image_oiio.h"
+#include "render/light.h"
+#include "render/nodes.h"
+#include "render/object.h"
 #include "render/scene.h"
+#include "render/shader.h"
 #include "render/stats.h"
 
 #include "util/util_foreach.h"
 #include "util/util_image.h"
 #include "util/util_image_impl.h"
 #include "util/util_logging.h"
+#include "util/util_map.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
 #include "util/util_task.h"
 #include "util/util_texture.h"
+#include "util/util_texture_cache.h"
 #include "util/util_unique_ptr.h"
 
 #ifdef WITH_OSL
@@ -265,15 +274,19 @@ ImageManager::ImageManager(const DeviceInfo &info)
   need_update = true;
   osl_texture_system = NULL;
   animation_frame = 0;
+  texture_cache = NULL;
 
   /* Set image limits */
   has_half_images = info.has_half_images;
+  has_texture_cache = (info.type == DEVICE_CPU);
 }
 
 ImageManager::~ImageManager()
 {
   for (size_t slot = 0; slot < images.size(); slot++)
     assert(!images[slot]);
+
+  delete texture_cache;
 }
 
 void ImageManager::set_osl_texture_system(void *texture_system)
@@ -410,6 +423,8 @@ int ImageManager::add_image_slot(ImageLoader *loader,
   img->builtin = builtin;
   img->users = 1;
   img->mem = NULL;
+  img->cache_image = NULL;
+  img->footprint_limit = 0;
 
   images[slot] = img;
 
@@ -443,7 +458,7 @@ void ImageManager::remove_image_user(int slot)
     need_update = true;
 }
 
-static bool image_associate_alpha(ImageManager::Image *img)
+static bool image_associate_alpha(const ImageManager::Image *img)
 {
   /* For typical RGBA images we let OIIO convert to associated alpha,
    * but some types we want to leave the RGB channels untouched. */
@@ -608,6 +623,57 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
   return true;
 }
 
+bool ImageManager::texture_cache_supports_image(const Image *img, int texture_limit)
+{
+  /* Only files that need no conversion on load can be sampled through the cache as is. Their
+   * sRGB to linear conversion is done after the lookup, like for 8 bit images. The cache
+   * associates alpha, so images with an alpha channel that must stay untouched are skipped. */
+  const ImageMetaData &metadata = img->metadata;
+  if (img->loader->osl_filepath().empty() || metadata.depth > 1 || metadata.channels < 1 ||
+      metadata.channels > 4) {
+    return false;
+  }
+  const bool has_alpha = (metadata.channels == 2 || metadata.channels == 4);
+  if (has_alpha && !image_associate_alpha(img)) {
+    return false;
+  }
+  if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+    return false;
+  }
+  if (texture_limit > 0 && max(metadata.width, metadata.height) > texture_limit) {
+    return false;
+  }
+  return true;
+}
+
+bool ImageManager::texture_cache_load_image(Image *img, int texture_limit)
+{
+  if (texture_cache == NULL || !texture_cache_supports_image(img, texture_limit)) {
+    return false;
+  }
+
+  const ImageMetaData &metadata = img->metadata;
+  TextureCacheImage *cache_image = texture_cache->add_image(img->loader->osl_filepath().string(),
+                                                            metadata.channels,
+                                                            img->params.interpolation,
+                                                            img->params.extension);
+  if (cache_image == NULL) {
+    return false;
+  }
+
+  VLOG(1) << "Reading image " << img->loader->name() << " through the texture cache.";
+
+  /* Placeholder pixel, lookups go to the texture cache instead. */
+  thread_scoped_lock device_lock(device_mutex);
+  void *pixels = img->mem->alloc(1, 1);
+  memset(pixels, 0, img->mem->memory_size());
+
+  img->mem->info.texture_cache = (uint64_t)cache_image;
+  img->cache_image = cache_image;
+
+  return true;
+}
+
 void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Progress *progress)
 {
   if (progress->get_cancel()) {
@@ -618,7 +684,11 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
 
   progress->set_status("Updating Images", "Loading " + img->loader->name());
 
-  const int texture_limit = scene->params.texture_limit;
+  int texture_limit = scene->params.texture_limit;
+  if (img->footprint_limit > 0) {
+    texture_limit = (texture_limit > 0) ? min(texture_limit, img->footprint_limit) :
+                                          img->footprint_limit;
+  }
 
   load_image_metadata(img);
   ImageDataType type = img->metadata.type;
@@ -632,6 +702,10 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
     delete img->mem;
     img->mem = NULL;
   }
+  if (img->cache_image) {
+    texture_cache->remove_image(img->cache_image);
+    img->cache_image = NULL;
+  }
 
   img->mem = new device_texture(
       device, img->mem_name.c_str(), slot, type, img->params.interpolation, img->params.extension);
@@ -639,7 +713,10 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  if (texture_cache_load_image(img, texture_limit)) {
+    /* Pixels are read on demand while rendering. */
+  }
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -755,17 +832,156 @@ void ImageManager::device_free_image(Device *, int slot)
     delete img->mem;
   }
 
+  if (img->cache_image) {
+    texture_cache->remove_image(img->cache_image);
+  }
+
   delete img->loader;
   delete img;
   images[slot] = NULL;
 }
 
+/* Estimate the image resolution needed for an object, from the size of its bounds in raster
+ * space. Returns zero when the bounds can not be projected, and no limit should be used. */
+static int image_footprint_resolution(const Camera *cam, const BoundBox &bounds)
+{
+  if (!bounds.valid()) {
+    return 0;
+  }
+
+  BoundBox ndc_bounds = BoundBox::empty;
+  for (int i = 0; i < 8; i++) {
+    const float3 P = make_float3((i & 1) ? bounds.max.x : bounds.min.x,
+                                 (i & 2) ? bounds.max.y : bounds.min.y,
+                                 (i & 4) ? bounds.max.z : bounds.min.z);
+
+    /* Objects crossing the near plane can cover the full frame. */
+    if (cam->type == CAMERA_PERSPECTIVE &&
+        transform_point(&cam->worldtocamera, P).z < cam->nearclip) {
+      return 0;
+    }
+
+    ndc_bounds.grow(transform_perspective(&cam->worldtondc, P));
+  }
+
+  /* Leave a factor two margin for textures mapped to only part of the object. */
+  const float3 ndc_size = ndc_bounds.size();
+  const float size = 2.0f * max(ndc_size.x * cam->full_width, ndc_size.y * cam->full_height);
+
+  if (!isfinite_safe(size) || size >= (float)(1 << 24)) {
+    return 0;
+  }
+
+  int resolution = 128;
+  while (resolution < size) {
+    resolution *= 2;
+  }
+  return resolution;
+}
+
+void ImageManager::update_footprint_limits(Scene *scene)
+{
+  const Camera *cam = scene->camera;
+  const bool use_footprint = scene->params.use_texture_auto_limit &&
+                             cam->type != CAMERA_PANORAMA;
+
+  /* Resolution needed by each shader, with zero meaning no limit. */
+  map<Shader *, int> shader_limits;
+
+  if (use_footprint) {
+    foreach (Object *object, scene->objects) {
+      if (object->geometry == NULL) {
+        continue;
+      }
+
+      /* Objects hidden from the camera may still be seen up close in reflections. */
+      const int resolution = (object->visibility & PATH_RAY_CAMERA) ?
+                                 image_footprint_resolution(cam, object->bounds) :
+                                 0;
+
+      foreach (Shader *shader, object->geometry->used_shaders) {
+        map<Shader *, int>::iterator it = shader_limits.find(shader);
+        if (it == shader_limits.end()) {
+          shader_limits[shader] = resolution;
+        }
+        else if (it->second != 0) {
+          it->second = (resolution == 0) ? 0 : max(it->second, resolution);
+        }
+      }
+    }
+
+    /* Lights and the world are not bounded by an object on screen. */
+    foreach (Light *light, scene->lights) {
+      shader_limits[light->shader] = 0;
+    }
+    shader_limits[scene->background->get_shader(scene)] = 0;
+  }
+
+  /* Resolution needed by each image slot, with -1 for images not used by any shader. */
+  vector<int> slot_limits(images.size(), -1);
+
+  foreach (Shader *shader, scene->shaders) {
+    /* Displacement needs the full resolution, since it changes the shape and not just the
+     * shading. */
+    const bool use_displacement = shader->has_displacement &&
+                                  shader->displacement_method != DISPLACE_BUMP;
+    map<Shader *, int>::iterator it = shader_limits.find(shader);
+    const int shader_limit = (it != shader_limits.end() && !use_displacement) ? it->second : 0;
+
+    foreach (ShaderNode *node, shader->graph->nodes) {
+      if (node->special_type != SHADER_SPECIAL_TYPE_IMAGE_SLOT) {
+        continue;
+      }
+
+      ImageSlotTextureNode *image_node = static_cast<ImageSlotTextureNode *>(node);
+      for (int i = 0; i < image_node->handle.num_tiles(); i++) {
+        const int slot = image_node->handle.svm_slot(i);
+        if (slot == -1 || slot >= (int)slot_limits.size()) {
+          continue;
+        }
+
+        int &slot_limit = slot_limits[slot];
+        if (slot_limit == -1) {
+          slot_limit = shader_limit;
+        }
+        else if (slot_limit != 0) {
+          slot_limit = (shader_limit == 0) ? 0 : max(slot_limit, shader_limit);
+        }
+      }
+    }
+  }
+
+  /* Reload images that were already loaded at a different resolution. */
+  for (size_t slot = 0; slot < images.size(); slot++) {
+    Image *img = images[slot];
+    if (img == NULL) {
+      continue;
+    }
+
+    const int footprint_limit = max(slot_limits[slot], 0);
+    if (img->footprint_limit != footprint_limit) {
+      VLOG(1) << "Image " << img->loader->name() << " footprint limit changed to "
+              << footprint_limit << ".";
+      img->footprint_limit = footprint_limit;
+      if (img->mem) {
+        img->need_load = true;
+      }
+    }
+  }
+}
+
 void ImageManager::device_update(Device *device, Scene *scene, Progress &progress)
 {
   if (!need_update) {
     return;
   }
 
+  update_footprint_limits(scene);
+
+  if (has_texture_cache && scene->params.texture_cache_size > 0 && texture_cache == NULL) {
+    texture_cache = new TextureCache(scene->params.texture_cache_size);
+  }
+
   TaskPool pool;
   for (size_t slot = 0; slot < images.size(); slot++) {
     Image *img = images[slot];
@@ -840,6 +1056,11 @@ void ImageManager::collect_statistics(RenderStats *stats)
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
   }
+
+  if (texture_cache) {
+    stats->image.textures.add_entry(
+        NamedSizeEntry("Texture Cache", texture_cache->memory_used()));
+  }
 }
 
 CCL_NAMESPACE_END
@@ -39,6 +39,8 @@ class Progress;
 class RenderStats;
 class Scene;
 class ColorSpaceProcessor;
+class TextureCache;
+struct TextureCacheImage;
 
 /* Image Parameters */
 class ImageParams {
@@ -197,11 +199,20 @@ class ImageManager {
 
     string mem_name;
     device_texture *mem;
+    TextureCacheImage *cache_image;
+
+    /* Resolution limit from the screen space size of the objects using the image, zero for
+     * no limit. */
+    int footprint_limit;
 
     int users;
     thread_mutex mutex;
   };
 
+  /* Whether the image file can be sampled through the texture cache as is, without loading
+   * it into device memory. */
+  static bool texture_cache_supports_image(const Image *img, int texture_limit);
+
  private:
   bool has_half_images;
 
@@ -212,14 +223,20 @@ class ImageManager {
   vector<Image *> images;
   void *osl_texture_system;
 
+  /* Only the CPU device can read images on demand during rendering. */
+  bool has_texture_cache;
+  TextureCache *texture_cache;
+
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
   void remove_image_user(int slot);
 
   void load_image_metadata(Image *img);
+  void update_footprint_limits(Scene *scene);
 
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
+  bool texture_cache_load_image(Image *img, int texture_limit);
 
   void device_load_image(Device *device, Scene *scene, int slot, Progress *progress);
   void device_free_image(Device *device, int slot);
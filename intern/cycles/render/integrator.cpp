@@ -77,6 +77,7 @@ NODE_DEFINE(Integrator)
   SOCKET_BOOLEAN(sample_all_lights_direct, "Sample All Lights Direct", true);
   SOCKET_BOOLEAN(sample_all_lights_indirect, "Sample All Lights Indirect", true);
   SOCKET_FLOAT(light_sampling_threshold, "Light Sampling Threshold", 0.05f);
+  SOCKET_BOOLEAN(use_light_tree, "Use Light Tree", false);
 
   static NodeEnum method_enum;
   method_enum.insert("path", PATH);
@@ -270,6 +271,14 @@ bool Integrator::modified(const Integrator &integrator)
   return !Node::equals(integrator);
 }
 
+bool Integrator::use_light_tree_sampling() const
+{
+  if (method == BRANCHED_PATH && (sample_all_lights_direct || sample_all_lights_indirect)) {
+    return false;
+  }
+  return use_light_tree;
+}
+
 void Integrator::tag_update(Scene *scene)
 {
   foreach (Shader *shader, scene->shaders) {
@@ -15,6 +15,7 @@
  */
 
 #include "render/light.h"
+#include "render/light_tree.h"
 #include "device/device.h"
 #include "render/background.h"
 #include "render/film.h"
@@ -899,6 +900,7 @@ void LightManager::device_update_points(Device *, DeviceScene *dscene, Scene *sc
 
     klights[light_index].max_bounces = max_bounces;
     klights[light_index].random = random;
+    klights[light_index].tree_bit_trail = 0;
 
     klights[light_index].tfm = light->tfm;
     klights[light_index].itfm = transform_inverse(light->tfm);
@@ -950,9 +952,86 @@ void LightManager::device_update_points(Device *, DeviceScene *dscene, Scene *sc
 
   VLOG(1) << "Number of lights without contribution: " << num_scene_lights - light_index;
 
+  device_update_tree(dscene, scene, klights);
+
   dscene->lights.copy_to_device();
 }
 
+void LightManager::device_update_tree(DeviceScene *dscene, Scene *scene, KernelLight *klights)
+{
+  if (!scene->integrator->use_light_tree_sampling()) {
+    return;
+  }
+
+  /* Distant and background lights are not localized, they keep being picked uniformly. */
+  vector<LightTreePrimitive> prims;
+  int light_index = 0;
+
+  foreach (Light *light, scene->lights) {
+    if (!light->is_enabled) {
+      continue;
+    }
+
+    if (light->type == LIGHT_POINT || light->type == LIGHT_SPOT || light->type == LIGHT_AREA) {
+      LightTreePrimitive prim;
+      prim.light = light_index;
+      prim.bit_trail = 0;
+
+      LightTreeBounds &bounds = prim.bounds;
+      bounds.energy = average(fabs(light->strength));
+      bounds.theta_e = M_PI_2_F;
+
+      if (light->type == LIGHT_AREA) {
+        float3 axisu = light->axisu * (0.5f * light->sizeu * light->size);
+        float3 axisv = light->axisv * (0.5f * light->sizev * light->size);
+
+        bounds.bbox.grow(light->co - axisu - axisv);
+        bounds.bbox.grow(light->co - axisu + axisv);
+        bounds.bbox.grow(light->co + axisu - axisv);
+        bounds.bbox.grow(light->co + axisu + axisv);
+        bounds.axis = safe_normalize(light->dir);
+        bounds.theta_o = 0.0f;
+      }
+      else {
+        bounds.bbox.grow(light->co, light->size);
+        if (light->type == LIGHT_SPOT) {
+          bounds.axis = safe_normalize(light->dir);
+          bounds.theta_o = 0.5f * light->spot_angle;
+        }
+        else {
+          bounds.theta_o = M_PI_F;
+        }
+      }
+
+      prim.centroid = bounds.bbox.center();
+      prims.push_back(prim);
+    }
+
+    light_index++;
+  }
+
+  if (prims.empty()) {
+    return;
+  }
+
+  LightTree tree(prims);
+
+  foreach (const LightTreePrimitive &prim, prims) {
+    klights[prim.light].tree_bit_trail = prim.bit_trail;
+  }
+
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+  KernelLightTreeNode *knodes = dscene->light_tree_nodes.alloc(nodes.size());
+  memcpy(knodes, nodes.data(), sizeof(KernelLightTreeNode) * nodes.size());
+  dscene->light_tree_nodes.copy_to_device();
+
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  kintegrator->use_light_tree = true;
+  kintegrator->num_light_tree_lights = prims.size();
+
+  VLOG(1) << "Light tree with " << nodes.size() << " nodes over " << prims.size() << " lights.";
+}
+
 void LightManager::device_update(Device *device,
                                  DeviceScene *dscene,
                                  Scene *scene,
@@ -970,6 +1049,10 @@ void LightManager::device_update(Device *device,
 
   use_light_visibility = false;
 
+  KernelIntegrator *kintegrator = &dscene->data.integrator;
+  kintegrator->use_light_tree = false;
+  kintegrator->num_light_tree_lights = 0;
+
   device_update_points(device, dscene, scene);
   if (progress.get_cancel())
     return;
@@ -1001,6 +1084,7 @@ void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_ba
 {
   dscene->light_distribution.free();
   dscene->lights.free();
+  dscene->light_tree_nodes.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
     dscene->light_background_conditional_cdf.free();
@@ -115,6 +115,7 @@ class LightManager {
   void test_enabled_lights(Scene *scene);
 
   void device_update_points(Device *device, DeviceScene *dscene, Scene *scene);
+  void device_update_tree(DeviceScene *dscene, Scene *scene, KernelLight *klights);
   void device_update_distribution(Device *device,
                                   DeviceScene *dscene,
                                   Scene *scene,
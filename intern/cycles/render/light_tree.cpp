@@ -0,0 +1,140 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree Bounds */
+
+LightTreeBounds::LightTreeBounds()
+    : bbox(BoundBox::empty),
+      axis(make_float3(0.0f, 0.0f, 1.0f)),
+      theta_o(0.0f),
+      theta_e(0.0f),
+      energy(0.0f)
+{
+}
+
+void LightTreeBounds::grow(const LightTreeBounds &other)
+{
+  if (!bbox.valid()) {
+    *this = other;
+    return;
+  }
+
+  bbox.grow(other.bbox);
+  energy += other.energy;
+  theta_e = max(theta_e, other.theta_e);
+
+  /* Merge the orientation cones, keeping either one if it already contains the other. */
+  const float theta_d = safe_acosf(dot(axis, other.axis));
+  if (min(theta_d + other.theta_o, M_PI_F) <= theta_o) {
+    return;
+  }
+  if (min(theta_d + theta_o, M_PI_F) <= other.theta_o) {
+    axis = other.axis;
+    theta_o = other.theta_o;
+    return;
+  }
+
+  const float theta_new = 0.5f * (theta_o + theta_d + other.theta_o);
+  const float3 rotation_axis = cross(axis, other.axis);
+  if (theta_new >= M_PI_F || len_squared(rotation_axis) < 1e-12f) {
+    theta_o = M_PI_F;
+    return;
+  }
+
+  /* Rotate the axis towards the other one, so the new cone just encloses both. */
+  axis = normalize(rotate_around_axis(axis, normalize(rotation_axis), theta_new - theta_o));
+  theta_o = theta_new;
+}
+
+/* Light Tree */
+
+LightTree::LightTree(vector<LightTreePrimitive> &prims)
+{
+  if (prims.empty()) {
+    return;
+  }
+
+  nodes.reserve(prims.size() * 2 - 1);
+  recursive_build(prims, 0, prims.size(), 0, 0);
+}
+
+int LightTree::recursive_build(
+    vector<LightTreePrimitive> &prims, int begin, int end, uint bit_trail, int depth)
+{
+  const int node_index = nodes.size();
+  nodes.push_back(KernelLightTreeNode());
+
+  LightTreeBounds bounds;
+  BoundBox centroid_bbox = BoundBox::empty;
+  for (int i = begin; i < end; i++) {
+    bounds.grow(prims[i].bounds);
+    centroid_bbox.grow(prims[i].centroid);
+  }
+
+  KernelLightTreeNode &knode = nodes[node_index];
+  knode.bbox_min[0] = bounds.bbox.min.x;
+  knode.bbox_min[1] = bounds.bbox.min.y;
+  knode.bbox_min[2] = bounds.bbox.min.z;
+  knode.bbox_max[0] = bounds.bbox.max.x;
+  knode.bbox_max[1] = bounds.bbox.max.y;
+  knode.bbox_max[2] = bounds.bbox.max.z;
+  knode.axis[0] = bounds.axis.x;
+  knode.axis[1] = bounds.axis.y;
+  knode.axis[2] = bounds.axis.z;
+  knode.theta_o = bounds.theta_o;
+  knode.theta_e = bounds.theta_e;
+  knode.energy = bounds.energy;
+
+  if (end - begin == 1) {
+    knode.child_index = -1;
+    knode.light = prims[begin].light;
+    prims[begin].bit_trail = bit_trail;
+    return node_index;
+  }
+
+  knode.light = -1;
+
+  /* Median split keeps the tree balanced, which bounds the depth by the bit trail size. */
+  assert(depth < 32);
+  const float3 extent = centroid_bbox.size();
+  const int dim = (extent.x >= extent.y && extent.x >= extent.z) ? 0 :
+                  (extent.y >= extent.z)                       ? 1 :
+                                                                   2;
+  const int mid = (begin + end) / 2;
+  std::nth_element(prims.begin() + begin,
+                   prims.begin() + mid,
+                   prims.begin() + end,
+                   [dim](const LightTreePrimitive &a, const LightTreePrimitive &b) {
+                     return a.centroid[dim] < b.centroid[dim];
+                   });
+
+  recursive_build(prims, begin, mid, bit_trail, depth + 1);
+  const int right_index = recursive_build(prims, mid, end, bit_trail | (1u << depth), depth + 1);
+
+  /* The node reference may be invalidated by the recursion. */
+  nodes[node_index].child_index = right_index;
+
+  return node_index;
+}
+
+CCL_NAMESPACE_END
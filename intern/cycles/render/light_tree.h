@@ -0,0 +1,73 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Spatial and directional bounds of one or more lights, together with their combined energy.
+ * The orientation is stored as a cone around axis: theta_o bounds the emitter normals, and
+ * light is emitted up to theta_e beyond that. */
+struct LightTreeBounds {
+  BoundBox bbox;
+  float3 axis;
+  float theta_o;
+  float theta_e;
+  float energy;
+
+  LightTreeBounds();
+
+  void grow(const LightTreeBounds &other);
+};
+
+/* Light in the tree, with the bit trail of the path from the root to its leaf filled in
+ * by the build. */
+struct LightTreePrimitive {
+  int light;
+  LightTreeBounds bounds;
+  float3 centroid;
+  uint bit_trail;
+};
+
+/* Binary tree over the lights, built by splitting at the median centroid along the largest
+ * axis. Leaves hold exactly one light, so the depth stays below 32 and every leaf can be
+ * addressed by a 32 bit trail. */
+class LightTree {
+ public:
+  LightTree(vector<LightTreePrimitive> &prims);
+
+  const vector<KernelLightTreeNode> &get_nodes() const
+  {
+    return nodes;
+  }
+
+ protected:
+  int recursive_build(
+      vector<LightTreePrimitive> &prims, int begin, int end, uint bit_trail, int depth);
+
+  vector<KernelLightTreeNode> nodes;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
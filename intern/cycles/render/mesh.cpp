@@ -636,6 +636,17 @@ void Mesh::pack_verts(const vector<uint> &tri_prim_index,
   }
 }
 
+void Mesh::pack_prim_index(const vector<uint> &tri_prim_index,
+                           uint4 *tri_vindex,
+                           size_t tri_offset)
+{
+  size_t triangles_size = num_triangles();
+
+  for (size_t i = 0; i < triangles_size; i++) {
+    tri_vindex[i].w = tri_prim_index[i + tri_offset];
+  }
+}
+
 void Mesh::pack_patches(uint *patch_data, uint vert_offset, uint face_offset, uint corner_offset)
 {
   size_t num_faces = subd_faces.size();
@@ -200,6 +200,7 @@ class Mesh : public Geometry {
                   float2 *tri_patch_uv,
                   size_t vert_offset,
                   size_t tri_offset);
+  void pack_prim_index(const vector<uint> &tri_prim_index, uint4 *tri_vindex, size_t tri_offset);
   void pack_patches(uint *patch_data, uint vert_offset, uint face_offset, uint corner_offset);
 
   void tessellate(DiagSplit *split);
@@ -221,6 +221,11 @@ void Object::tag_update(Scene *scene)
   scene->camera->need_flags_update = true;
   scene->geometry_manager->need_update = true;
   scene->object_manager->need_update = true;
+
+  /* Image resolution limits depend on the size of objects on screen. */
+  if (scene->params.use_texture_auto_limit) {
+    scene->image_manager->need_update = true;
+  }
 }
 
 bool Object::use_motion() const
@@ -835,6 +840,8 @@ void ObjectManager::apply_static_transforms(DeviceScene *dscene, Scene *scene, P
         if (!geom->transform_applied) {
           object->apply_transform(apply_to_motion);
           geom->transform_applied = true;
+          /* Positions and normals changed, while the geometry may not be tagged for update. */
+          geom->need_update_pack = true;
 
           if (progress.get_cancel())
             return;
@@ -855,6 +862,10 @@ void ObjectManager::tag_update(Scene *scene)
   need_update = true;
   scene->geometry_manager->need_update = true;
   scene->light_manager->need_update = true;
+
+  if (scene->params.use_texture_auto_limit) {
+    scene->image_manager->need_update = true;
+  }
 }
 
 string ObjectManager::get_cryptomatte_objects(Scene *scene)
@@ -106,6 +106,7 @@ class DeviceScene {
   /* lights */
   device_vector<KernelLightDistribution> light_distribution;
   device_vector<KernelLight> lights;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
 
@@ -172,6 +173,10 @@ class SceneParams {
   CurveShapeType hair_shape;
   bool persistent_data;
   int texture_limit;
+  /* Reduce texture_limit per image, based on the screen space size of objects using it. */
+  bool use_texture_auto_limit;
+  /* Memory limit in MB for CPU image textures read on demand, zero loads them fully. */
+  int texture_cache_size;
 
   bool background;
 
@@ -187,6 +192,8 @@ class SceneParams {
     hair_shape = CURVE_RIBBON;
     persistent_data = false;
     texture_limit = 0;
+    use_texture_auto_limit = false;
+    texture_cache_size = 0;
     background = true;
   }
 
@@ -198,7 +205,9 @@ class SceneParams {
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             use_texture_auto_limit == params.use_texture_auto_limit &&
+             texture_cache_size == params.texture_cache_size);
   }
 
   int curve_subdivisions()
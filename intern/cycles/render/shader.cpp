@@ -483,8 +483,10 @@ void ShaderManager::update_shaders_used(Scene *scene)
   /* figure out which shaders are in use, so SVM/OSL can skip compiling them
    * for speed and avoid loading image textures into memory */
   uint id = 0;
+  bool id_changed = false;
   foreach (Shader *shader, scene->shaders) {
     shader->used = false;
+    id_changed |= (shader->id != id);
     shader->id = id++;
   }
 
@@ -503,6 +505,12 @@ void ShaderManager::update_shaders_used(Scene *scene)
   foreach (Light *light, scene->lights)
     if (light->shader)
       light->shader->used = true;
+
+  /* Shader ids are packed along with the geometry. */
+  if (id_changed) {
+    foreach (Geometry *geom, scene->geometry)
+      geom->need_update_pack = true;
+  }
 }
 
 void ShaderManager::device_update_common(Device *device,
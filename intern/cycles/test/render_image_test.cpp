@@ -0,0 +1,124 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/colorspace.h"
+#include "render/image.h"
+#include "render/image_oiio.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* A tiled 8 bit sRGB file with alpha, which the texture cache can sample as is. The file is not
+ * read, only its metadata is checked. */
+class TextureCacheSupportsImageTest : public testing::Test {
+ protected:
+  OIIOImageLoader file_loader;
+  OIIOImageLoader no_file_loader;
+  ImageManager::Image img;
+
+  TextureCacheSupportsImageTest() : file_loader("/textures/image.tx"), no_file_loader("")
+  {
+  }
+
+  void SetUp() override
+  {
+    img.loader = &file_loader;
+    img.metadata.channels = 4;
+    img.metadata.width = 1024;
+    img.metadata.height = 512;
+    img.metadata.depth = 1;
+    img.metadata.type = IMAGE_DATA_TYPE_BYTE4;
+    img.metadata.colorspace = u_colorspace_srgb;
+  }
+
+  bool supported(int texture_limit = 0) const
+  {
+    return ImageManager::texture_cache_supports_image(&img, texture_limit);
+  }
+};
+
+}  // namespace
+
+TEST_F(TextureCacheSupportsImageTest, Supported)
+{
+  EXPECT_TRUE(supported());
+
+  img.metadata.colorspace = u_colorspace_raw;
+  EXPECT_TRUE(supported());
+
+  img.metadata.channels = 1;
+  img.metadata.type = IMAGE_DATA_TYPE_BYTE;
+  EXPECT_TRUE(supported());
+}
+
+/* Packed and generated images have no file the texture system could read. */
+TEST_F(TextureCacheSupportsImageTest, NoFile)
+{
+  img.loader = &no_file_loader;
+  EXPECT_FALSE(supported());
+}
+
+TEST_F(TextureCacheSupportsImageTest, Volume)
+{
+  img.metadata.depth = 16;
+  EXPECT_FALSE(supported());
+}
+
+TEST_F(TextureCacheSupportsImageTest, Channels)
+{
+  img.metadata.channels = 0;
+  EXPECT_FALSE(supported());
+
+  img.metadata.channels = 5;
+  EXPECT_FALSE(supported());
+}
+
+/* The texture system always associates alpha. */
+TEST_F(TextureCacheSupportsImageTest, AlphaUntouched)
+{
+  img.params.alpha_type = IMAGE_ALPHA_CHANNEL_PACKED;
+  EXPECT_FALSE(supported());
+
+  img.params.alpha_type = IMAGE_ALPHA_IGNORE;
+  EXPECT_FALSE(supported());
+
+  img.metadata.channels = 2;
+  EXPECT_FALSE(supported());
+
+  /* Without an alpha channel there is nothing to associate. */
+  img.metadata.channels = 3;
+  EXPECT_TRUE(supported());
+}
+
+/* Other color spaces are converted on load. */
+TEST_F(TextureCacheSupportsImageTest, ColorSpace)
+{
+  img.metadata.colorspace = ustring("ACEScg");
+  EXPECT_FALSE(supported());
+}
+
+/* The largest dimension is compared with the limit, images are not scaled down in the cache. */
+TEST_F(TextureCacheSupportsImageTest, TextureLimit)
+{
+  EXPECT_TRUE(supported(1024));
+  EXPECT_TRUE(supported(2048));
+  EXPECT_FALSE(supported(512));
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,257 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/light_tree.h"
+
+#include "util/util_foreach.h"
+#include "util/util_math.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+LightTreeBounds make_bounds(const float3 co, const float3 axis, float theta_o, float energy)
+{
+  LightTreeBounds bounds;
+  bounds.bbox.grow(co, 0.1f);
+  bounds.axis = axis;
+  bounds.theta_o = theta_o;
+  bounds.theta_e = M_PI_2_F;
+  bounds.energy = energy;
+  return bounds;
+}
+
+LightTreePrimitive make_prim(int light, const float3 co, const float3 axis, float theta_o)
+{
+  LightTreePrimitive prim;
+  prim.light = light;
+  prim.bounds = make_bounds(co, axis, theta_o, 1.0f + light);
+  prim.centroid = prim.bounds.bbox.center();
+  prim.bit_trail = 0;
+  return prim;
+}
+
+float3 node_axis(const KernelLightTreeNode &knode)
+{
+  return make_float3(knode.axis[0], knode.axis[1], knode.axis[2]);
+}
+
+/* Angle between the axes plus the spread of the inner cone has to fit into the outer cone. */
+void expect_cone_contains(const float3 axis,
+                          float theta_o,
+                          const float3 inner_axis,
+                          float inner_theta_o)
+{
+  const float theta_d = safe_acosf(dot(axis, inner_axis));
+  EXPECT_LE(min(theta_d + inner_theta_o, M_PI_F), theta_o + 1e-5f);
+}
+
+/* Lights along a line, with orientations turning around the Y axis. */
+vector<LightTreePrimitive> make_line_prims(int num_lights)
+{
+  vector<LightTreePrimitive> prims;
+  for (int i = 0; i < num_lights; i++) {
+    const float angle = 0.1f * i;
+    const float3 axis = make_float3(sinf(angle), 0.0f, cosf(angle));
+    /* Out of order, so the build has to sort them. */
+    const int position = (i * 5) % num_lights;
+    prims.push_back(make_prim(i, make_float3((float)position, 0.0f, 0.0f), axis, 0.05f));
+  }
+  return prims;
+}
+
+/* Index of the leaf which the bit trail leads to, walking the tree like the kernel does. */
+int follow_bit_trail(const vector<KernelLightTreeNode> &nodes, uint bit_trail)
+{
+  int index = 0;
+  while (nodes[index].child_index != -1) {
+    index = (bit_trail & 1) ? nodes[index].child_index : index + 1;
+    bit_trail >>= 1;
+  }
+  return index;
+}
+
+}  // namespace
+
+TEST(LightTreeBounds, GrowEmpty)
+{
+  LightTreeBounds bounds;
+  const LightTreeBounds other = make_bounds(
+      make_float3(1.0f, 2.0f, 3.0f), make_float3(1.0f, 0.0f, 0.0f), 0.3f, 2.0f);
+  bounds.grow(other);
+
+  EXPECT_EQ(bounds.bbox.min, other.bbox.min);
+  EXPECT_EQ(bounds.bbox.max, other.bbox.max);
+  EXPECT_EQ(bounds.axis, other.axis);
+  EXPECT_EQ(bounds.theta_o, other.theta_o);
+  EXPECT_EQ(bounds.energy, other.energy);
+}
+
+TEST(LightTreeBounds, GrowBoxAndEnergy)
+{
+  const float3 axis = make_float3(0.0f, 0.0f, 1.0f);
+  LightTreeBounds bounds = make_bounds(make_float3(0.0f, 0.0f, 0.0f), axis, 0.0f, 1.0f);
+  LightTreeBounds other = make_bounds(make_float3(2.0f, -1.0f, 3.0f), axis, 0.0f, 2.5f);
+  other.theta_e = M_PI_F;
+  bounds.grow(other);
+
+  EXPECT_EQ(bounds.bbox.min, make_float3(0.0f - 0.1f, -1.0f - 0.1f, 0.0f - 0.1f));
+  EXPECT_EQ(bounds.bbox.max, make_float3(2.0f + 0.1f, 0.0f + 0.1f, 3.0f + 0.1f));
+  EXPECT_EQ(bounds.energy, 3.5f);
+  EXPECT_EQ(bounds.theta_e, M_PI_F);
+  /* Same orientation, nothing to merge. */
+  EXPECT_EQ(bounds.axis, axis);
+  EXPECT_EQ(bounds.theta_o, 0.0f);
+}
+
+/* The narrow cone fits into the wide one, whichever is grown. */
+TEST(LightTreeBounds, GrowConeContained)
+{
+  const float3 wide_axis = make_float3(0.0f, 0.0f, 1.0f);
+  const float3 narrow_axis = normalize(make_float3(0.2f, 0.0f, 1.0f));
+  const float3 co = make_float3(0.0f, 0.0f, 0.0f);
+
+  LightTreeBounds bounds = make_bounds(co, wide_axis, 1.0f, 1.0f);
+  bounds.grow(make_bounds(co, narrow_axis, 0.1f, 1.0f));
+  EXPECT_EQ(bounds.axis, wide_axis);
+  EXPECT_EQ(bounds.theta_o, 1.0f);
+
+  bounds = make_bounds(co, narrow_axis, 0.1f, 1.0f);
+  bounds.grow(make_bounds(co, wide_axis, 1.0f, 1.0f));
+  EXPECT_EQ(bounds.axis, wide_axis);
+  EXPECT_EQ(bounds.theta_o, 1.0f);
+}
+
+/* Two disjoint cones are enclosed by a cone half way between them. */
+TEST(LightTreeBounds, GrowConeMerge)
+{
+  const float3 axis_a = make_float3(0.0f, 0.0f, 1.0f);
+  const float3 axis_b = make_float3(1.0f, 0.0f, 0.0f);
+  const float3 co = make_float3(0.0f, 0.0f, 0.0f);
+
+  LightTreeBounds bounds = make_bounds(co, axis_a, 0.1f, 1.0f);
+  bounds.grow(make_bounds(co, axis_b, 0.2f, 1.0f));
+
+  EXPECT_NEAR(bounds.theta_o, 0.5f * (0.1f + M_PI_2_F + 0.2f), 1e-5f);
+  EXPECT_NEAR(len(bounds.axis), 1.0f, 1e-5f);
+  EXPECT_NEAR(bounds.axis.y, 0.0f, 1e-5f);
+  expect_cone_contains(bounds.axis, bounds.theta_o, axis_a, 0.1f);
+  expect_cone_contains(bounds.axis, bounds.theta_o, axis_b, 0.2f);
+}
+
+/* Opposite cones can only be enclosed by the whole sphere. */
+TEST(LightTreeBounds, GrowConeOpposite)
+{
+  const float3 co = make_float3(0.0f, 0.0f, 0.0f);
+  LightTreeBounds bounds = make_bounds(co, make_float3(0.0f, 0.0f, 1.0f), 0.0f, 1.0f);
+  bounds.grow(make_bounds(co, make_float3(0.0f, 0.0f, -1.0f), 0.0f, 1.0f));
+  EXPECT_EQ(bounds.theta_o, M_PI_F);
+}
+
+TEST(LightTree, SingleLight)
+{
+  vector<LightTreePrimitive> prims;
+  prims.push_back(
+      make_prim(3, make_float3(1.0f, 0.0f, 0.0f), make_float3(0.0f, 0.0f, 1.0f), 0.0f));
+  LightTree tree(prims);
+
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+  ASSERT_EQ(nodes.size(), (size_t)1);
+  EXPECT_EQ(nodes[0].child_index, -1);
+  EXPECT_EQ(nodes[0].light, 3);
+  EXPECT_EQ(prims[0].bit_trail, 0u);
+}
+
+/* Nodes are stored depth first: the left child follows its parent, the right child is referenced
+ * by index. Every light ends up in exactly one leaf. */
+TEST(LightTree, NodeLayout)
+{
+  const int num_lights = 13;
+  vector<LightTreePrimitive> prims = make_line_prims(num_lights);
+  LightTree tree(prims);
+
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+  ASSERT_EQ(nodes.size(), (size_t)(num_lights * 2 - 1));
+
+  vector<int> light_leaf_count(num_lights, 0);
+  for (int i = 0; i < (int)nodes.size(); i++) {
+    const KernelLightTreeNode &knode = nodes[i];
+    if (knode.child_index == -1) {
+      ASSERT_GE(knode.light, 0);
+      ASSERT_LT(knode.light, num_lights);
+      light_leaf_count[knode.light]++;
+      continue;
+    }
+
+    EXPECT_EQ(knode.light, -1);
+    ASSERT_GT(knode.child_index, i + 1);
+    ASSERT_LT(knode.child_index, (int)nodes.size());
+    const KernelLightTreeNode &left = nodes[i + 1];
+    const KernelLightTreeNode &right = nodes[knode.child_index];
+    EXPECT_NEAR(knode.energy, left.energy + right.energy, 1e-4f);
+    for (int axis = 0; axis < 3; axis++) {
+      EXPECT_EQ(knode.bbox_min[axis], min(left.bbox_min[axis], right.bbox_min[axis]));
+      EXPECT_EQ(knode.bbox_max[axis], max(left.bbox_max[axis], right.bbox_max[axis]));
+    }
+    /* The median split along X puts all lights with smaller positions on the left. */
+    EXPECT_LE(left.bbox_max[0], right.bbox_min[0]);
+  }
+  for (int light = 0; light < num_lights; light++) {
+    EXPECT_EQ(light_leaf_count[light], 1);
+  }
+}
+
+/* The bit trail of every light leads from the root to its leaf. */
+TEST(LightTree, BitTrails)
+{
+  const int num_lights = 37;
+  vector<LightTreePrimitive> prims = make_line_prims(num_lights);
+  LightTree tree(prims);
+
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+  foreach (const LightTreePrimitive &prim, prims) {
+    const int leaf_index = follow_bit_trail(nodes, prim.bit_trail);
+    EXPECT_EQ(nodes[leaf_index].light, prim.light);
+  }
+}
+
+/* The orientation cone of every node encloses the cones of its children. */
+TEST(LightTree, ConeMerging)
+{
+  const int num_lights = 16;
+  vector<LightTreePrimitive> prims = make_line_prims(num_lights);
+  LightTree tree(prims);
+
+  const vector<KernelLightTreeNode> &nodes = tree.get_nodes();
+  for (int i = 0; i < (int)nodes.size(); i++) {
+    const KernelLightTreeNode &knode = nodes[i];
+    if (knode.child_index == -1) {
+      EXPECT_EQ(knode.theta_o, 0.05f);
+      continue;
+    }
+    const KernelLightTreeNode &left = nodes[i + 1];
+    const KernelLightTreeNode &right = nodes[knode.child_index];
+    expect_cone_contains(node_axis(knode), knode.theta_o, node_axis(left), left.theta_o);
+    expect_cone_contains(node_axis(knode), knode.theta_o, node_axis(right), right.theta_o);
+  }
+  /* All lights turn by 1.5 radians in total, the root is far from the whole sphere. */
+  EXPECT_LT(nodes[0].theta_o, M_PI_2_F);
+}
+
+CCL_NAMESPACE_END
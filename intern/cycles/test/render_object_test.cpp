@@ -0,0 +1,152 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "device/device.h"
+
+#include "render/hair.h"
+#include "render/mesh.h"
+#include "render/object.h"
+#include "render/scene.h"
+
+#include "util/util_foreach.h"
+#include "util/util_progress.h"
+#include "util/util_stats.h"
+#include "util/util_transform.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Geometry of objects with static transforms gets the transform applied to its positions, so
+ * its packed data has to be updated even when the geometry itself was not changed. */
+class ApplyStaticTransformsTest : public testing::Test {
+ protected:
+  Stats stats;
+  Profiler profiler;
+  DeviceInfo device_info;
+  Device *device_cpu;
+  SceneParams scene_params;
+  Scene *scene;
+  Progress progress;
+
+  virtual void SetUp()
+  {
+    device_cpu = Device::create(device_info, stats, profiler, true);
+    scene = new Scene(scene_params, device_cpu);
+  }
+
+  virtual void TearDown()
+  {
+    delete scene;
+    delete device_cpu;
+  }
+
+  Mesh *add_mesh()
+  {
+    Mesh *mesh = new Mesh();
+    mesh->reserve_mesh(3, 1);
+    mesh->add_vertex(make_float3(0.0f, 0.0f, 0.0f));
+    mesh->add_vertex(make_float3(1.0f, 0.0f, 0.0f));
+    mesh->add_vertex(make_float3(0.0f, 1.0f, 0.0f));
+    mesh->add_triangle(0, 1, 2, 0, false);
+    scene->geometry.push_back(mesh);
+    return mesh;
+  }
+
+  Hair *add_hair()
+  {
+    Hair *hair = new Hair();
+    hair->reserve_curves(1, 2);
+    hair->add_curve_key(make_float3(0.0f, 0.0f, 0.0f), 0.1f);
+    hair->add_curve_key(make_float3(0.0f, 0.0f, 1.0f), 0.1f);
+    hair->add_curve(0, 0);
+    scene->geometry.push_back(hair);
+    return hair;
+  }
+
+  Object *add_object(Geometry *geom, const Transform &tfm)
+  {
+    Object *object = new Object();
+    object->geometry = geom;
+    object->tfm = tfm;
+    scene->objects.push_back(object);
+    return object;
+  }
+
+  /* Geometry that was packed before and did not change since. */
+  void apply_static_transforms()
+  {
+    foreach (Geometry *geom, scene->geometry) {
+      geom->need_update = false;
+      geom->need_update_pack = false;
+    }
+    scene->dscene.object_flag.alloc(scene->objects.size());
+    scene->dscene.object_flag.zero_to_device();
+    scene->object_manager->apply_static_transforms(&scene->dscene, scene, progress);
+  }
+};
+
+}  // namespace
+
+TEST_F(ApplyStaticTransformsTest, Mesh)
+{
+  Mesh *mesh = add_mesh();
+  add_object(mesh, transform_translate(make_float3(0.0f, 0.0f, 2.0f)));
+  apply_static_transforms();
+
+  EXPECT_TRUE(mesh->transform_applied);
+  EXPECT_TRUE(mesh->need_update_pack);
+  EXPECT_EQ(mesh->verts[1], make_float3(1.0f, 0.0f, 2.0f));
+}
+
+TEST_F(ApplyStaticTransformsTest, Hair)
+{
+  Hair *hair = add_hair();
+  add_object(hair, transform_scale(make_float3(2.0f, 2.0f, 2.0f)));
+  apply_static_transforms();
+
+  EXPECT_TRUE(hair->transform_applied);
+  EXPECT_TRUE(hair->need_update_pack);
+  EXPECT_EQ(hair->curve_keys[1], make_float3(0.0f, 0.0f, 2.0f));
+}
+
+/* Instanced geometry keeps its transforms in the objects. */
+TEST_F(ApplyStaticTransformsTest, Instanced)
+{
+  Mesh *mesh = add_mesh();
+  add_object(mesh, transform_translate(make_float3(0.0f, 0.0f, 2.0f)));
+  add_object(mesh, transform_translate(make_float3(0.0f, 0.0f, -2.0f)));
+  apply_static_transforms();
+
+  EXPECT_FALSE(mesh->transform_applied);
+  EXPECT_FALSE(mesh->need_update_pack);
+}
+
+/* The transform was applied in an earlier update and the geometry did not change since. */
+TEST_F(ApplyStaticTransformsTest, AlreadyApplied)
+{
+  Mesh *mesh = add_mesh();
+  add_object(mesh, transform_translate(make_float3(0.0f, 0.0f, 2.0f)));
+  mesh->transform_applied = true;
+  apply_static_transforms();
+
+  EXPECT_FALSE(mesh->need_update_pack);
+  EXPECT_EQ(mesh->verts[1], make_float3(1.0f, 0.0f, 0.0f));
+}
+
+CCL_NAMESPACE_END
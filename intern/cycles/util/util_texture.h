@@ -104,6 +104,8 @@ typedef struct TextureInfo {
   /* Transform for 3D textures. */
   uint use_transform_3d;
   Transform transform_3d;
+  /* Texture cache image on the CPU, if pixels are paged in on demand instead of loaded. */
+  uint64_t texture_cache;
 } TextureInfo;
 
 CCL_NAMESPACE_END
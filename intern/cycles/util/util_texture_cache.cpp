@@ -0,0 +1,191 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/util_texture_cache.h"
+#include "util/util_logging.h"
+#include "util/util_math.h"
+
+#include <OpenImageIO/texture.h>
+
+OIIO_NAMESPACE_USING
+
+CCL_NAMESPACE_BEGIN
+
+void texture_cache_thread_free(TextureCacheThreadData *tdata)
+{
+  TextureSystem *ts = (TextureSystem *)tdata->texture_system;
+  ts->destroy_thread_info((TextureSystem::Perthread *)tdata->thread_info);
+  delete tdata;
+}
+
+float4 texture_cache_lookup(TextureCacheThreadData **tdata,
+                            const TextureCacheImage *image,
+                            float x,
+                            float y,
+                            float2 dx,
+                            float2 dy)
+{
+  TextureSystem *ts = (TextureSystem *)image->texture_system;
+
+  /* Avoids the thread specific storage lookup of the texture system on every lookup. */
+  if (*tdata == NULL) {
+    *tdata = new TextureCacheThreadData();
+    (*tdata)->texture_system = ts;
+    (*tdata)->thread_info = ts->create_thread_info();
+  }
+  assert((*tdata)->texture_system == ts);
+
+  TextureOpt options;
+
+  switch (image->interpolation) {
+    case INTERPOLATION_CLOSEST:
+      options.interpmode = TextureOpt::InterpClosest;
+      break;
+    case INTERPOLATION_CUBIC:
+      options.interpmode = TextureOpt::InterpBicubic;
+      break;
+    case INTERPOLATION_SMART:
+      options.interpmode = TextureOpt::InterpSmartBicubic;
+      break;
+    default:
+      options.interpmode = TextureOpt::InterpBilinear;
+      break;
+  }
+
+  switch (image->extension) {
+    case EXTENSION_REPEAT:
+      options.swrap = options.twrap = TextureOpt::WrapPeriodic;
+      break;
+    case EXTENSION_EXTEND:
+      options.swrap = options.twrap = TextureOpt::WrapClamp;
+      break;
+    default:
+      options.swrap = options.twrap = TextureOpt::WrapBlack;
+      break;
+  }
+
+  /* Image rows are stored bottom to top in Cycles, the texture system reads them top to
+   * bottom. */
+  float result[4];
+  if (!ts->texture((TextureSystem::TextureHandle *)image->handle,
+                   (TextureSystem::Perthread *)(*tdata)->thread_info,
+                   options,
+                   x,
+                   1.0f - y,
+                   dx.x,
+                   -dx.y,
+                   dy.x,
+                   -dy.y,
+                   image->channels,
+                   result)) {
+    /* Prevents error messages from accumulating. */
+    ts->geterror();
+    return make_float4(
+        TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+  }
+
+  float4 r;
+  switch (image->channels) {
+    case 1:
+      r = make_float4(result[0], result[0], result[0], 1.0f);
+      break;
+    case 2:
+      r = make_float4(result[0], result[0], result[0], result[1]);
+      break;
+    case 3:
+      r = make_float4(result[0], result[1], result[2], 1.0f);
+      break;
+    default:
+      r = make_float4(result[0], result[1], result[2], result[3]);
+      break;
+  }
+
+  /* Same as for loaded images, avoid hue shifts from partially invalid pixels. */
+  if (!isfinite3_safe(float4_to_float3(r)) || !isfinite_safe(r.w)) {
+    return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+  }
+
+  return r;
+}
+
+TextureCache::TextureCache(size_t max_memory_mb)
+{
+  TextureSystem *ts = TextureSystem::create(false);
+
+  /* Page untiled files in tiles as well, they are still read in full scanlines. */
+  ts->attribute("autotile", 64);
+  ts->attribute("max_memory_MB", (float)max_memory_mb);
+
+  texture_system = ts;
+
+  VLOG(1) << "Texture cache created with a limit of " << max_memory_mb << " MB.";
+}
+
+TextureCache::~TextureCache()
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+
+  VLOG(1) << "Texture cache statistics:\n" << ts->getstats();
+
+  ts->invalidate_all(true);
+  TextureSystem::destroy(ts);
+}
+
+TextureCacheImage *TextureCache::add_image(const string &filepath,
+                                           int channels,
+                                           InterpolationType interpolation,
+                                           ExtensionType extension)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  TextureSystem::TextureHandle *handle = ts->get_texture_handle(ustring(filepath));
+
+  if (handle == NULL) {
+    ts->geterror();
+    return NULL;
+  }
+
+  TextureCacheImage *image = new TextureCacheImage();
+  image->texture_system = ts;
+  image->handle = handle;
+  image->filepath = filepath;
+  image->channels = clamp(channels, 1, 4);
+  image->interpolation = interpolation;
+  image->extension = extension;
+
+  return image;
+}
+
+void TextureCache::remove_image(TextureCacheImage *image)
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+
+  /* Release the tiles, the file may have changed before it is used again. */
+  ts->invalidate(ustring(image->filepath));
+
+  delete image;
+}
+
+size_t TextureCache::memory_used() const
+{
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  long long memory_used = 0;
+
+  ts->getattribute("stat:cache_memory_used", TypeDesc::INT64, &memory_used);
+
+  return (size_t)memory_used;
+}
+
+CCL_NAMESPACE_END
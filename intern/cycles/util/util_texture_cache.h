@@ -0,0 +1,79 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+#include "util/util_string.h"
+#include "util/util_texture.h"
+#include "util/util_types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Image file sampled through the texture cache by the CPU kernel. */
+struct TextureCacheImage {
+  /* OIIO texture system and texture handle. */
+  void *texture_system;
+  void *handle;
+
+  string filepath;
+  int channels;
+  InterpolationType interpolation;
+  ExtensionType extension;
+};
+
+/* Texture system state of one render thread, created by its first lookup. */
+struct TextureCacheThreadData {
+  void *texture_system;
+  void *thread_info;
+};
+
+void texture_cache_thread_free(TextureCacheThreadData *tdata);
+
+/* Filtered lookup at normalized image coordinates, with the same conventions as the
+ * regular CPU image textures. The derivatives of the coordinates along the screen X and Y
+ * axes select the MIP level, zero derivatives read the finest level. */
+float4 texture_cache_lookup(TextureCacheThreadData **tdata,
+                            const TextureCacheImage *image,
+                            float x,
+                            float y,
+                            float2 dx,
+                            float2 dy);
+
+/* Image storage backed by the OIIO texture system. Files are read in tiles as lookups touch
+ * them, using the tiles and MIP levels stored in the file (.tx) when available, and the
+ * least recently used tiles are evicted once the memory limit is reached. */
+class TextureCache {
+ public:
+  explicit TextureCache(size_t max_memory_mb);
+  ~TextureCache();
+
+  /* Returns NULL when the file can not be read by the texture system. */
+  TextureCacheImage *add_image(const string &filepath,
+                               int channels,
+                               InterpolationType interpolation,
+                               ExtensionType extension);
+  void remove_image(TextureCacheImage *image);
+
+  size_t memory_used() const;
+
+ protected:
+  void *texture_system;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
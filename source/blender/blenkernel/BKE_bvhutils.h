@@ -260,6 +260,10 @@ bool bvhcache_has_tree(const struct BVHCache *bvh_cache, const BVHTree *tree);
 struct BVHCache *bvhcache_init(void);
 void bvhcache_free(struct BVHCache *bvh_cache);
 
+/* Keep trees alive across evaluations of meshes with the same topology. */
+struct BVHCache *bvhcache_release_from_mesh(struct Mesh *mesh);
+void bvhcache_reuse_for_mesh(struct Mesh *mesh, struct BVHCache *bvh_cache);
+
 #ifdef __cplusplus
 }
 #endif
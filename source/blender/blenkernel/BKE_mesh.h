@@ -374,6 +374,12 @@ enum {
   MLNOR_SPACEARR_BMLOOP_PTR = 1,
 };
 
+/**
+ * Smooth fans around vertices, kept to compute split normals of deformed meshes,
+ * see #BKE_mesh_normals_loop_split_ex.
+ */
+typedef struct MLoopFanCache MLoopFanCache;
+
 /* Low-level custom normals functions. */
 void BKE_lnor_spacearr_init(MLoopNorSpaceArray *lnors_spacearr,
                             const int numLoops,
@@ -414,6 +420,23 @@ void BKE_mesh_normals_loop_split(const struct MVert *mverts,
                                  MLoopNorSpaceArray *r_lnors_spacearr,
                                  short (*clnors_data)[2],
                                  int *r_loop_to_poly);
+void BKE_mesh_normals_loop_split_ex(const struct MVert *mverts,
+                                    const int numVerts,
+                                    struct MEdge *medges,
+                                    const int numEdges,
+                                    struct MLoop *mloops,
+                                    float (*r_loopnors)[3],
+                                    const int numLoops,
+                                    struct MPoly *mpolys,
+                                    const float (*polynors)[3],
+                                    const int numPolys,
+                                    const bool use_split_normals,
+                                    const float split_angle,
+                                    MLoopNorSpaceArray *r_lnors_spacearr,
+                                    short (*clnors_data)[2],
+                                    int *r_loop_to_poly,
+                                    struct MLoopFanCache **fan_cache_p);
+void BKE_mesh_loop_fan_cache_free(struct MLoopFanCache *fan_cache);
 
 void BKE_mesh_normals_loop_custom_set(const struct MVert *mverts,
                                       const int numVerts,
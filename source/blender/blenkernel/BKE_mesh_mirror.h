@@ -30,10 +30,13 @@
 extern "C" {
 #endif
 
+struct Mesh;
 struct MirrorModifierData;
 struct ModifierEvalContext;
 struct Object;
 
+typedef struct MeshMirrorCache MeshMirrorCache;
+
 struct Mesh *BKE_mesh_mirror_bisect_on_mirror_plane(struct MirrorModifierData *mmd,
                                                     const struct Mesh *mesh,
                                                     int axis,
@@ -46,6 +49,17 @@ struct Mesh *BKE_mesh_mirror_apply_mirror_on_axis(struct MirrorModifierData *mmd
                                                   const struct Mesh *mesh,
                                                   int axis);
 
+struct Mesh *BKE_mesh_mirror_cache_apply(MeshMirrorCache *mirror_cache,
+                                         const struct MirrorModifierData *mmd,
+                                         const struct Object *ob,
+                                         const struct Mesh *mesh);
+void BKE_mesh_mirror_cache_store(MeshMirrorCache **mirror_cache_p,
+                                 const struct MirrorModifierData *mmd,
+                                 const struct Object *ob,
+                                 const struct Mesh *mesh,
+                                 struct Mesh *result);
+void BKE_mesh_mirror_cache_free(MeshMirrorCache *mirror_cache);
+
 #ifdef __cplusplus
 }
 #endif
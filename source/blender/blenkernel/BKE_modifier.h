@@ -114,6 +114,14 @@ typedef enum {
 
   /** Accepts #BMesh input (without conversion). */
   eModifierTypeFlag_AcceptsBMesh = (1 << 11),
+
+  /**
+   * Deform only modifiers that only read topology and custom data from the mesh passed to
+   * `deformVerts`, so they can share one mesh with the other deform modifiers in the stack
+   * instead of each copying the original mesh. Vertex coordinates of that mesh may lag behind
+   * `vertexCos`, they are only synchronized for modifiers that depend on normals.
+   */
+  eModifierTypeFlag_AcceptsSharedDeformMesh = (1 << 12),
 } ModifierTypeFlag;
 
 /* IMPORTANT! Keep ObjectWalkFunc and IDWalkFunc signatures compatible. */
@@ -143,6 +151,10 @@ typedef enum ModifierApplyFlag {
    * This flag can be checked to ignore rendering display data to the mesh.
    * See `OBJECT_OT_modifier_apply` operator. */
   MOD_APPLY_TO_BASE_MESH = 1 << 4,
+  /** Since the previous evaluation of this modifier, nothing but the vertex positions of its
+   * input mesh changed, unless its topology changed too. Modifiers can reuse the topology of
+   * their previous result after checking the topology of the input still matches. */
+  MOD_APPLY_TOPOLOGY_CACHE = 1 << 5,
 } ModifierApplyFlag;
 
 typedef struct ModifierUpdateDepsgraphContext {
@@ -37,6 +37,7 @@ struct OpenSubdiv_Converter;
 struct OpenSubdiv_Evaluator;
 struct OpenSubdiv_TopologyRefiner;
 struct Subdiv;
+struct SubdivMeshTopology;
 
 typedef enum eSubdivVtxBoundaryInterpolation {
   /* Do not interpolate boundaries. */
@@ -98,6 +99,7 @@ typedef enum eSubdivStatsValue {
   SUBDIV_STATS_SUBDIV_TO_CCG,
   SUBDIV_STATS_SUBDIV_TO_CCG_ELEMENTS,
   SUBDIV_STATS_TOPOLOGY_COMPARE,
+  SUBDIV_STATS_MESH_TOPOLOGY_COMPARE,
 
   NUM_SUBDIV_STATS_VALUES,
 } eSubdivStatsValue;
@@ -123,6 +125,9 @@ typedef struct SubdivStats {
       double subdiv_to_ccg_elements_time;
       /* Time spent on CCG elements evaluation/initialization. */
       double topology_compare_time;
+      /* Time spent on comparing the base mesh with the mesh topology stored in the subdiv, to skip
+       * the topology comparison when it didn't change. */
+      double mesh_topology_compare_time;
     };
     double values_[NUM_SUBDIV_STATS_VALUES];
   };
@@ -186,6 +191,10 @@ typedef struct Subdiv {
   /* Statistics for debugging. */
   SubdivStats stats;
 
+  /* Copy of the mesh data this subdiv was last created or updated from, see
+   * BKE_subdiv_update_from_mesh(). NULL when created from another source. */
+  struct SubdivMeshTopology *mesh_topology;
+
   /* Cached values, are not supposed to be accessed directly. */
   struct {
     /* Indexed by base face index, element indicates total number of ptex
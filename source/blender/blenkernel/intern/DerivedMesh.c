@@ -871,6 +871,43 @@ void BKE_mesh_wrapper_deferred_finalize(Mesh *me_eval,
   BLI_assert(me_eval->runtime.wrapper_type_finalize == 0);
 }
 
+/* Mesh handed to a deform only modifier while no final mesh exists yet. Modifiers which accept a
+ * shared deform mesh all get the same CD-reference copy of the input mesh, instead of each one
+ * copying the original mesh in #MOD_deform_mesh_eval_get. Its vertex coordinates are only
+ * synchronized with the deformed coordinates once it becomes the final mesh. */
+static Mesh *mesh_calc_modifiers_deform_mesh_get(const ModifierTypeInfo *mti,
+                                                 Mesh *mesh_input,
+                                                 Mesh *mesh_final,
+                                                 Mesh **mesh_shared_p)
+{
+  if (mesh_final != NULL) {
+    return mesh_final;
+  }
+  if ((mti->flags & eModifierTypeFlag_AcceptsSharedDeformMesh) == 0) {
+    return NULL;
+  }
+  if (*mesh_shared_p == NULL) {
+    *mesh_shared_p = BKE_mesh_copy_for_eval(mesh_input, true);
+    ASSERT_IS_VALID_MESH(*mesh_shared_p);
+  }
+  return *mesh_shared_p;
+}
+
+/* Create the final mesh, reusing the shared deform mesh when there is one: it is a plain copy of
+ * the input mesh as well, so this saves copying the input mesh again. */
+static Mesh *mesh_calc_modifiers_final_mesh_create(Mesh *mesh_input, Mesh **mesh_shared_p)
+{
+  Mesh *mesh_final = *mesh_shared_p;
+  if (mesh_final != NULL) {
+    *mesh_shared_p = NULL;
+  }
+  else {
+    mesh_final = BKE_mesh_copy_for_eval(mesh_input, true);
+  }
+  ASSERT_IS_VALID_MESH(mesh_final);
+  return mesh_final;
+}
+
 static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
                                 Scene *scene,
                                 Object *ob,
@@ -880,6 +917,7 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
                                 const int index,
                                 const bool use_cache,
                                 const bool allow_shared_mesh,
+                                MLoopFanCache *loop_fan_cache_prev,
                                 /* return args */
                                 Mesh **r_deform,
                                 Mesh **r_final)
@@ -900,6 +938,11 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   int num_deformed_verts = mesh_input->totvert;
   bool isPrevDeform = false;
 
+  /* Copy of the input mesh shared by sequential deform only modifiers while there is no final
+   * mesh yet, see #mesh_calc_modifiers_deform_mesh_get. Becomes the final mesh once one is
+   * needed. */
+  Mesh *mesh_deform_shared = NULL;
+
   /* Mesh with constructive modifiers but no deformation applied. Tracked
    * along with final mesh if undeformed / orco coordinates are requested
    * for texturing. */
@@ -923,6 +966,11 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
   const ModifierEvalContext mectx = {depsgraph, ob, apply_render | apply_cache};
   const ModifierEvalContext mectx_orco = {depsgraph, ob, apply_render | MOD_APPLY_ORCO};
 
+  /* Unless the mesh itself got updated, only deform modifiers change its data between
+   * evaluations, so the first constructive modifier may reuse the topology of its previous
+   * result. */
+  const bool use_topology_cache = use_cache && (mesh_input->id.recalc & ID_RECALC_ALL) == 0;
+
   /* Get effective list of modifiers to execute. Some effects like shape keys
    * are added as virtual modifiers before the user created modifiers. */
   VirtualModifierData virtualModifierData;
@@ -976,13 +1024,14 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
         }
         else if (isPrevDeform && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
           if (mesh_final == NULL) {
-            mesh_final = BKE_mesh_copy_for_eval(mesh_input, true);
-            ASSERT_IS_VALID_MESH(mesh_final);
+            mesh_final = mesh_calc_modifiers_final_mesh_create(mesh_input, &mesh_deform_shared);
           }
           BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
         }
 
-        BKE_modifier_deform_verts(md, &mectx, mesh_final, deformed_verts, num_deformed_verts);
+        Mesh *mesh_deform_md = mesh_calc_modifiers_deform_mesh_get(
+            mti, mesh_input, mesh_final, &mesh_deform_shared);
+        BKE_modifier_deform_verts(md, &mectx, mesh_deform_md, deformed_verts, num_deformed_verts);
 
         isPrevDeform = true;
       }
@@ -1097,14 +1146,21 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
        * to avoid giving bogus normals to the next modifier see: [#23673] */
       else if (isPrevDeform && mti->dependsOnNormals && mti->dependsOnNormals(md)) {
         if (mesh_final == NULL) {
-          mesh_final = BKE_mesh_copy_for_eval(mesh_input, true);
-          ASSERT_IS_VALID_MESH(mesh_final);
+          mesh_final = mesh_calc_modifiers_final_mesh_create(mesh_input, &mesh_deform_shared);
         }
         BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
       }
-      BKE_modifier_deform_verts(md, &mectx, mesh_final, deformed_verts, num_deformed_verts);
+      Mesh *mesh_deform_md = mesh_calc_modifiers_deform_mesh_get(
+          mti, mesh_input, mesh_final, &mesh_deform_shared);
+      BKE_modifier_deform_verts(md, &mectx, mesh_deform_md, deformed_verts, num_deformed_verts);
     }
     else {
+      const ModifierEvalContext mectx_md = {
+          depsgraph,
+          ob,
+          mectx.flag | ((use_topology_cache && !have_non_onlydeform_modifiers_appled) ?
+                            MOD_APPLY_TOPOLOGY_CACHE :
+                            0)};
       have_non_onlydeform_modifiers_appled = true;
 
       /* determine which data layers are needed by following modifiers */
@@ -1123,8 +1179,7 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
         }
       }
       else {
-        mesh_final = BKE_mesh_copy_for_eval(mesh_input, true);
-        ASSERT_IS_VALID_MESH(mesh_final);
+        mesh_final = mesh_calc_modifiers_final_mesh_create(mesh_input, &mesh_deform_shared);
 
         if (deformed_verts) {
           BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
@@ -1184,7 +1239,7 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
         }
       }
 
-      Mesh *mesh_next = BKE_modifier_modify_mesh(md, &mectx, mesh_final);
+      Mesh *mesh_next = BKE_modifier_modify_mesh(md, &mectx_md, mesh_final);
       ASSERT_IS_VALID_MESH(mesh_next);
 
       if (mesh_next) {
@@ -1300,9 +1355,14 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
       mesh_final = mesh_input;
     }
     else {
-      mesh_final = BKE_mesh_copy_for_eval(mesh_input, true);
+      mesh_final = mesh_calc_modifiers_final_mesh_create(mesh_input, &mesh_deform_shared);
     }
   }
+  if (mesh_deform_shared) {
+    /* Only left over when the final mesh did not need to be created from it. */
+    BKE_id_free(NULL, mesh_deform_shared);
+    mesh_deform_shared = NULL;
+  }
   if (deformed_verts) {
     BKE_mesh_vert_coords_apply(mesh_final, deformed_verts);
     MEM_freeN(deformed_verts);
@@ -1335,6 +1395,10 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
 
   /* Compute normals. */
   if (is_own_mesh) {
+    if (mesh_final->runtime.loop_fan_cache == NULL) {
+      mesh_final->runtime.loop_fan_cache = loop_fan_cache_prev;
+      loop_fan_cache_prev = NULL;
+    }
     mesh_calc_modifier_final_normals(mesh_input, &final_datamask, sculpt_dyntopo, mesh_final);
   }
   else {
@@ -1357,6 +1421,10 @@ static void mesh_calc_modifiers(struct Depsgraph *depsgraph,
     mesh_calc_finalize(mesh_input, mesh_final);
   }
 
+  if (loop_fan_cache_prev != NULL) {
+    BKE_mesh_loop_fan_cache_free(loop_fan_cache_prev);
+  }
+
   /* Return final mesh */
   *r_final = mesh_final;
   if (r_deform) {
@@ -1769,6 +1837,19 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * they aren't cleaned up properly on mode switch, causing crashes, e.g T58150. */
   BLI_assert(ob->id.tag & LIB_TAG_COPIED_ON_WRITE);
 
+  /* Keep the BVH trees of the previous result, when only the coordinates changed
+   * (e.g. armature deformation) they're refit instead of being rebuilt. */
+  struct BVHCache *bvh_cache_prev = NULL;
+  /* Same for the smooth fans used by split normals, which are only computed again. */
+  MLoopFanCache *loop_fan_cache_prev = NULL;
+  if ((ob->runtime.data_eval != NULL) && ob->runtime.is_data_eval_owned &&
+      (GS(ob->runtime.data_eval->name) == ID_ME)) {
+    Mesh *mesh_eval_prev = (Mesh *)ob->runtime.data_eval;
+    bvh_cache_prev = bvhcache_release_from_mesh(mesh_eval_prev);
+    loop_fan_cache_prev = mesh_eval_prev->runtime.loop_fan_cache;
+    mesh_eval_prev->runtime.loop_fan_cache = NULL;
+  }
+
   BKE_object_free_derived_caches(ob);
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
@@ -1793,6 +1874,7 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
                       -1,
                       true,
                       true,
+                      loop_fan_cache_prev,
                       &mesh_deform_eval,
                       &mesh_eval);
 
@@ -1806,6 +1888,13 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  if (is_mesh_eval_owned) {
+    bvhcache_reuse_for_mesh(mesh_eval, bvh_cache_prev);
+  }
+  else if (bvh_cache_prev != NULL) {
+    bvhcache_free(bvh_cache_prev);
+  }
+
   ob->runtime.mesh_deform_eval = mesh_deform_eval;
   ob->runtime.last_data_mask = *dataMask;
   ob->runtime.last_need_mapping = need_mapping;
@@ -1994,7 +2083,18 @@ Mesh *mesh_create_eval_final_render(Depsgraph *depsgraph,
 {
   Mesh *final;
 
-  mesh_calc_modifiers(depsgraph, scene, ob, 1, false, dataMask, -1, false, false, NULL, &final);
+  mesh_calc_modifiers(depsgraph,
+                      scene,
+                      ob,
+                      1,
+                      false,
+                      dataMask,
+                      -1,
+                      false,
+                      false,
+                      NULL,
+                      NULL,
+                      &final);
 
   return final;
 }
@@ -2007,7 +2107,18 @@ Mesh *mesh_create_eval_final_index_render(Depsgraph *depsgraph,
 {
   Mesh *final;
 
-  mesh_calc_modifiers(depsgraph, scene, ob, 1, false, dataMask, index, false, false, NULL, &final);
+  mesh_calc_modifiers(depsgraph,
+                      scene,
+                      ob,
+                      1,
+                      false,
+                      dataMask,
+                      index,
+                      false,
+                      false,
+                      NULL,
+                      NULL,
+                      &final);
 
   return final;
 }
@@ -2025,7 +2136,18 @@ Mesh *mesh_create_eval_final_view(Depsgraph *depsgraph,
    */
   ob->transflag |= OB_NO_PSYS_UPDATE;
 
-  mesh_calc_modifiers(depsgraph, scene, ob, 1, false, dataMask, -1, false, false, NULL, &final);
+  mesh_calc_modifiers(depsgraph,
+                      scene,
+                      ob,
+                      1,
+                      false,
+                      dataMask,
+                      -1,
+                      false,
+                      false,
+                      NULL,
+                      NULL,
+                      &final);
 
   ob->transflag &= ~OB_NO_PSYS_UPDATE;
 
@@ -2039,7 +2161,18 @@ Mesh *mesh_create_eval_no_deform(Depsgraph *depsgraph,
 {
   Mesh *final;
 
-  mesh_calc_modifiers(depsgraph, scene, ob, 0, false, dataMask, -1, false, false, NULL, &final);
+  mesh_calc_modifiers(depsgraph,
+                      scene,
+                      ob,
+                      0,
+                      false,
+                      dataMask,
+                      -1,
+                      false,
+                      false,
+                      NULL,
+                      NULL,
+                      &final);
 
   return final;
 }
@@ -2051,7 +2184,18 @@ Mesh *mesh_create_eval_no_deform_render(Depsgraph *depsgraph,
 {
   Mesh *final;
 
-  mesh_calc_modifiers(depsgraph, scene, ob, 0, false, dataMask, -1, false, false, NULL, &final);
+  mesh_calc_modifiers(depsgraph,
+                      scene,
+                      ob,
+                      0,
+                      false,
+                      dataMask,
+                      -1,
+                      false,
+                      false,
+                      NULL,
+                      NULL,
+                      &final);
 
   return final;
 }
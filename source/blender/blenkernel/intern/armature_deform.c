@@ -237,6 +237,31 @@ static void pchan_bone_deform(bPoseChannel *pchan,
  * #BKE_armature_deform_coords and related functions.
  * \{ */
 
+/**
+ * Deformation of a vertex group, calculated once per evaluation so vertices don't need to
+ * look up pose channels or check bone options (see #armature_vert_task_deform_groups).
+ */
+typedef struct ArmatureDeformGroup {
+  /**
+   * Bone deformation in the target object space (`postmat * chan_mat * premat`),
+   * as 4 columns of 3 rows so accumulating weighted matrices is a flat loop.
+   */
+  float mat[4][3];
+  /** Bone deformation in armature space, for dual quaternion skinning. */
+  DualQuat dq;
+  /** #eArmatureDeformGroupType. */
+  int type;
+} ArmatureDeformGroup;
+
+typedef enum eArmatureDeformGroupType {
+  /** No deforming bone. */
+  ARM_DEFORM_GROUP_NONE = 0,
+  /** A bone that deforms all vertices the same way. */
+  ARM_DEFORM_GROUP_SIMPLE = 1,
+  /** B-Bones and bones multiplied by their envelope depend on the vertex position. */
+  ARM_DEFORM_GROUP_COMPLEX = 2,
+} eArmatureDeformGroupType;
+
 typedef struct ArmatureUserdata {
   const Object *ob_arm;
   const Object *ob_target;
@@ -258,6 +283,9 @@ typedef struct ArmatureUserdata {
   bPoseChannel **pchan_from_defbase;
   int defbase_len;
 
+  /** Per vertex group, when set #armature_vert_task_deform_groups is used. */
+  ArmatureDeformGroup *deform_groups;
+
   float premat[4][4];
   float postmat[4][4];
 
@@ -414,34 +442,182 @@ static void armature_vert_task_with_dvert(const ArmatureUserdata *data,
   }
 }
 
-static void armature_vert_task(void *__restrict userdata,
-                               const int i,
-                               const TaskParallelTLS *__restrict UNUSED(tls))
+static const MDeformVert *armature_vert_dvert_get(const ArmatureUserdata *data, const int i)
 {
-  const ArmatureUserdata *data = userdata;
-  const MDeformVert *dvert;
   if (data->use_dverts || data->armature_def_nr != -1) {
     if (data->me_target) {
       BLI_assert(i < data->me_target->totvert);
       if (data->me_target->dvert != NULL) {
-        dvert = data->me_target->dvert + i;
-      }
-      else {
-        dvert = NULL;
+        return data->me_target->dvert + i;
       }
     }
     else if (data->dverts && i < data->dverts_len) {
-      dvert = data->dverts + i;
+      return data->dverts + i;
+    }
+  }
+  return NULL;
+}
+
+static void armature_vert_task(void *__restrict userdata,
+                               const int i,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArmatureUserdata *data = userdata;
+  armature_vert_task_with_dvert(data, i, armature_vert_dvert_get(data, i));
+}
+
+/**
+ * Same result as #armature_vert_task, using the deformation of each vertex group
+ * calculated beforehand. Vertices using bones that need the vertex position to calculate their
+ * deformation (or needing envelopes), are deformed by #armature_vert_task_with_dvert.
+ */
+static void armature_vert_task_deform_groups(void *__restrict userdata,
+                                             const int i,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ArmatureUserdata *data = userdata;
+  const ArmatureDeformGroup *deform_groups = data->deform_groups;
+  const MDeformVert *dvert = armature_vert_dvert_get(data, i);
+
+  if (dvert == NULL || dvert->totweight == 0) {
+    if (data->use_envelope) {
+      armature_vert_task_with_dvert(data, i, dvert);
+    }
+    return;
+  }
+
+  float armature_weight = 1.0f;
+  if (data->armature_def_nr != -1) {
+    armature_weight = BKE_defvert_find_weight(dvert, data->armature_def_nr);
+    if (data->invert_vgroup) {
+      armature_weight = 1.0f - armature_weight;
+    }
+    if (armature_weight == 0.0f) {
+      return;
+    }
+  }
+
+  const MDeformWeight *dw = dvert->dw;
+  const int totweight = dvert->totweight;
+  bool deformed = false;
+  for (int j = 0; j < totweight; j++) {
+    const uint index = dw[j].def_nr;
+    if (index < data->defbase_len) {
+      const int type = deform_groups[index].type;
+      if (type == ARM_DEFORM_GROUP_COMPLEX) {
+        armature_vert_task_with_dvert(data, i, dvert);
+        return;
+      }
+      deformed |= (type == ARM_DEFORM_GROUP_SIMPLE);
+    }
+  }
+  if (!deformed) {
+    if (data->use_envelope) {
+      armature_vert_task_with_dvert(data, i, dvert);
+    }
+    return;
+  }
+
+  float *co = data->vert_coords[i];
+  float contrib = 0.0f;
+
+  if (data->use_quaternion) {
+    DualQuat dq;
+    float co_arm[3], dco[3];
+    memset(&dq, 0, sizeof(dq));
+
+    for (int j = 0; j < totweight; j++) {
+      const uint index = dw[j].def_nr;
+      const float weight = dw[j].weight;
+      if (index < data->defbase_len && weight != 0.0f &&
+          deform_groups[index].type == ARM_DEFORM_GROUP_SIMPLE) {
+        add_weighted_dq_dq(&dq, &deform_groups[index].dq, weight);
+        contrib += weight;
+      }
+    }
+    if (contrib <= 0.0001f) {
+      return;
+    }
+
+    mul_v3_m4v3(co_arm, data->premat, co);
+    normalize_dq(&dq, contrib);
+    if (armature_weight != 1.0f) {
+      copy_v3_v3(dco, co_arm);
+      mul_v3m3_dq(dco, NULL, &dq);
+      sub_v3_v3(dco, co_arm);
+      madd_v3_v3fl(co_arm, dco, armature_weight);
     }
     else {
-      dvert = NULL;
+      mul_v3m3_dq(co_arm, NULL, &dq);
     }
+    mul_v3_m4v3(co, data->postmat, co_arm);
   }
   else {
-    dvert = NULL;
+    /* Blend the matrices, then transform the vertex once. */
+    float mat[4][3] = {{0.0f}};
+    float *mat_flat = &mat[0][0];
+
+    for (int j = 0; j < totweight; j++) {
+      const uint index = dw[j].def_nr;
+      const float weight = dw[j].weight;
+      if (index < data->defbase_len && weight != 0.0f &&
+          deform_groups[index].type == ARM_DEFORM_GROUP_SIMPLE) {
+        const float *group_mat_flat = &deform_groups[index].mat[0][0];
+        for (int k = 0; k < 12; k++) {
+          mat_flat[k] += group_mat_flat[k] * weight;
+        }
+        contrib += weight;
+      }
+    }
+    if (contrib <= 0.0001f) {
+      return;
+    }
+
+    float co_deform[3];
+    for (int k = 0; k < 3; k++) {
+      co_deform[k] = mat[0][k] * co[0] + mat[1][k] * co[1] + mat[2][k] * co[2] + mat[3][k];
+    }
+    const float fac = armature_weight / contrib;
+    for (int k = 0; k < 3; k++) {
+      co[k] += (co_deform[k] - co[k] * contrib) * fac;
+    }
   }
+}
 
-  armature_vert_task_with_dvert(data, i, dvert);
+/**
+ * Calculate the deformation of each vertex group for #armature_vert_task_deform_groups.
+ */
+static ArmatureDeformGroup *armature_deform_groups_create(const ArmatureUserdata *data)
+{
+  ArmatureDeformGroup *deform_groups = MEM_mallocN(
+      sizeof(*deform_groups) * (size_t)data->defbase_len, __func__);
+
+  for (int i = 0; i < data->defbase_len; i++) {
+    ArmatureDeformGroup *group = &deform_groups[i];
+    const bPoseChannel *pchan = data->pchan_from_defbase[i];
+    const Bone *bone = pchan ? pchan->bone : NULL;
+
+    if (bone == NULL) {
+      group->type = ARM_DEFORM_GROUP_NONE;
+      continue;
+    }
+    if ((bone->segments > 1 && pchan->runtime.bbone_segments == bone->segments) ||
+        (bone->flag & BONE_MULT_VG_ENV)) {
+      group->type = ARM_DEFORM_GROUP_COMPLEX;
+      continue;
+    }
+
+    group->type = ARM_DEFORM_GROUP_SIMPLE;
+    group->dq = pchan->runtime.deform_dual_quat;
+
+    float mat[4][4];
+    mul_m4_series(mat, data->postmat, pchan->chan_mat, data->premat);
+    for (int col = 0; col < 4; col++) {
+      copy_v3_v3(group->mat[col], mat[col]);
+    }
+  }
+
+  return deform_groups;
 }
 
 static void armature_vert_task_editmesh(void *__restrict userdata, MempoolIterData *iter)
@@ -602,10 +778,25 @@ static void armature_deform_coords_impl(const Object *ob_arm,
     }
   }
   else {
+    /* Deformation matrices and blending with previous coordinates
+     * are only supported by the generic code. */
+    const bool use_deform_groups = use_dverts && (vert_deform_mats == NULL) &&
+                                   (vert_coords_prev == NULL);
+    if (use_deform_groups) {
+      data.deform_groups = armature_deform_groups_create(&data);
+    }
+
     TaskParallelSettings settings;
     BLI_parallel_range_settings_defaults(&settings);
     settings.min_iter_per_thread = 32;
-    BLI_task_parallel_range(0, vert_coords_len, &data, armature_vert_task, &settings);
+    BLI_task_parallel_range(0,
+                            vert_coords_len,
+                            &data,
+                            use_deform_groups ? armature_vert_task_deform_groups :
+                                                armature_vert_task,
+                            &settings);
+
+    MEM_SAFE_FREE(data.deform_groups);
   }
 
   if (pchan_from_defbase) {
@@ -0,0 +1,212 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "BKE_armature.h"
+
+#include "BLI_listbase.h"
+#include "BLI_math.h"
+#include "BLI_string.h"
+
+#include "DNA_action_types.h"
+#include "DNA_armature_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "testing/testing.h"
+
+namespace blender::bke::tests {
+
+#define NUM_BONES 3
+#define NUM_GROUPS 5
+#define NUM_VERTS 256
+
+/* Index of the vertex group of the bone which multiplies weights by its envelope. The groups after
+ * the ones of bones have no bones. */
+#define GROUP_ENVELOPE 2
+/* Index of the vertex group limiting the influence of the whole armature. */
+#define GROUP_ARMATURE 4
+
+/* Compares deformation using vertex group deformations calculated once per evaluation, which is
+ * used when no deformation matrices are requested, with the generic per vertex deformation. */
+class ArmatureDeformGroupsTest : public testing::Test {
+ protected:
+  Bone bones[NUM_BONES];
+  bPoseChannel pchans[NUM_BONES];
+  bPose pose;
+  bArmature arm;
+  Object ob_arm;
+
+  bDeformGroup defgroups[NUM_GROUPS];
+  MDeformVert dverts[NUM_VERTS];
+  MDeformWeight weights[NUM_VERTS][NUM_GROUPS];
+  Mesh mesh;
+  Object ob_target;
+
+  float vert_coords[NUM_VERTS][3];
+
+  void SetUp() override
+  {
+    memset(bones, 0, sizeof(bones));
+    memset(pchans, 0, sizeof(pchans));
+    memset(&pose, 0, sizeof(pose));
+    memset(&arm, 0, sizeof(arm));
+    memset(&ob_arm, 0, sizeof(ob_arm));
+    memset(defgroups, 0, sizeof(defgroups));
+    memset(dverts, 0, sizeof(dverts));
+    memset(weights, 0, sizeof(weights));
+    memset(&mesh, 0, sizeof(mesh));
+    memset(&ob_target, 0, sizeof(ob_target));
+
+    for (int i = 0; i < NUM_BONES; i++) {
+      Bone *bone = &bones[i];
+      bPoseChannel *pchan = &pchans[i];
+      BLI_snprintf(bone->name, sizeof(bone->name), "Bone%d", i);
+      STRNCPY(pchan->name, bone->name);
+      pchan->bone = bone;
+      bone->segments = 1;
+
+      const float head[3] = {0.0f, (float)i, 0.0f};
+      const float tail[3] = {0.0f, (float)i + 1.0f, 0.0f};
+      copy_v3_v3(bone->arm_head, head);
+      copy_v3_v3(bone->arm_tail, tail);
+      bone->rad_head = bone->rad_tail = 0.5f;
+      bone->dist = 0.5f;
+      unit_m4(bone->arm_mat);
+      copy_v3_v3(bone->arm_mat[3], head);
+
+      const float loc[3] = {0.1f * i, -0.2f, 0.3f};
+      const float eul[3] = {0.3f + 0.2f * i, -0.4f, 0.1f * i};
+      const float size[3] = {1.0f, 1.0f + 0.1f * i, 1.0f};
+      loc_eul_size_to_mat4(pchan->pose_mat, loc, eul, size);
+      float arm_mat_inv[4][4];
+      invert_m4_m4(arm_mat_inv, bone->arm_mat);
+      mul_m4_m4m4(pchan->chan_mat, pchan->pose_mat, arm_mat_inv);
+      mat4_to_dquat(&pchan->runtime.deform_dual_quat, bone->arm_mat, pchan->chan_mat);
+
+      BLI_addtail(&pose.chanbase, pchan);
+    }
+    bones[GROUP_ENVELOPE].flag |= BONE_MULT_VG_ENV;
+
+    ob_arm.type = OB_ARMATURE;
+    ob_arm.data = &arm;
+    ob_arm.pose = &pose;
+    const float arm_loc[3] = {0.5f, 0.0f, -1.0f};
+    unit_m4(ob_arm.obmat);
+    copy_v3_v3(ob_arm.obmat[3], arm_loc);
+
+    for (int i = 0; i < NUM_GROUPS; i++) {
+      if (i < NUM_BONES) {
+        STRNCPY(defgroups[i].name, bones[i].name);
+      }
+      else {
+        BLI_snprintf(defgroups[i].name, sizeof(defgroups[i].name), "Group%d", i);
+      }
+      BLI_addtail(&ob_target.defbase, &defgroups[i]);
+    }
+
+    for (int i = 0; i < NUM_VERTS; i++) {
+      vert_coords[i][0] = (float)(i % 7) * 0.25f - 0.75f;
+      vert_coords[i][1] = (float)(i % 13) * 0.25f;
+      vert_coords[i][2] = (float)(i % 5) * 0.2f - 0.4f;
+
+      /* Every vertex gets a different combination of groups, some get none. */
+      MDeformVert *dvert = &dverts[i];
+      dvert->dw = weights[i];
+      for (int group = 0; group < NUM_GROUPS; group++) {
+        if (i & (1 << group)) {
+          MDeformWeight *dw = &dvert->dw[dvert->totweight++];
+          dw->def_nr = group;
+          dw->weight = (float)((i * (group + 3)) % 11) / 10.0f;
+        }
+      }
+    }
+
+    mesh.totvert = NUM_VERTS;
+    mesh.dvert = dverts;
+
+    ob_target.type = OB_MESH;
+    ob_target.data = &mesh;
+    unit_m4(ob_target.obmat);
+  }
+
+  void expect_deform_groups_match(const int deformflag, const char *defgrp_name)
+  {
+    float coords_groups[NUM_VERTS][3];
+    float coords_generic[NUM_VERTS][3];
+    float deform_mats[NUM_VERTS][3][3];
+    memcpy(coords_groups, vert_coords, sizeof(vert_coords));
+    memcpy(coords_generic, vert_coords, sizeof(vert_coords));
+    for (int i = 0; i < NUM_VERTS; i++) {
+      unit_m3(deform_mats[i]);
+    }
+
+    BKE_armature_deform_coords_with_mesh(&ob_arm,
+                                         &ob_target,
+                                         coords_groups,
+                                         nullptr,
+                                         NUM_VERTS,
+                                         deformflag,
+                                         nullptr,
+                                         defgrp_name,
+                                         &mesh);
+    /* Requesting deformation matrices uses the generic code. */
+    BKE_armature_deform_coords_with_mesh(&ob_arm,
+                                         &ob_target,
+                                         coords_generic,
+                                         deform_mats,
+                                         NUM_VERTS,
+                                         deformflag,
+                                         nullptr,
+                                         defgrp_name,
+                                         &mesh);
+
+    for (int i = 0; i < NUM_VERTS; i++) {
+      EXPECT_V3_NEAR(coords_groups[i], coords_generic[i], 1e-5f);
+    }
+  }
+};
+
+TEST_F(ArmatureDeformGroupsTest, Linear)
+{
+  expect_deform_groups_match(ARM_DEF_VGROUP, nullptr);
+}
+
+TEST_F(ArmatureDeformGroupsTest, LinearArmatureGroup)
+{
+  expect_deform_groups_match(ARM_DEF_VGROUP, defgroups[GROUP_ARMATURE].name);
+}
+
+TEST_F(ArmatureDeformGroupsTest, LinearEnvelope)
+{
+  expect_deform_groups_match(ARM_DEF_VGROUP | ARM_DEF_ENVELOPE, nullptr);
+}
+
+TEST_F(ArmatureDeformGroupsTest, DualQuaternion)
+{
+  expect_deform_groups_match(ARM_DEF_VGROUP | ARM_DEF_QUATERNION, nullptr);
+}
+
+TEST_F(ArmatureDeformGroupsTest, DualQuaternionArmatureGroup)
+{
+  expect_deform_groups_match(ARM_DEF_VGROUP | ARM_DEF_QUATERNION,
+                             defgroups[GROUP_ARMATURE].name);
+}
+
+}  // namespace blender::bke::tests
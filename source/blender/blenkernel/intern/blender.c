@@ -57,6 +57,7 @@
 #include "BKE_studiolight.h"
 
 #include "DEG_depsgraph.h"
+#include "DEG_depsgraph_debug.h"
 
 #include "RE_pipeline.h"
 #include "RE_render_ext.h"
@@ -85,6 +86,8 @@ void BKE_blender_free(void)
     fclose(G.log.file);
   }
 
+  DEG_debug_trace_end();
+
   BKE_spacetypes_free(); /* after free main, it uses space callbacks */
 
   IMB_exit();
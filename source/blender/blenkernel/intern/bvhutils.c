@@ -29,8 +29,10 @@
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -47,12 +49,19 @@
 
 typedef struct BVHCacheItem {
   bool is_filled;
+  /**
+   * The tree was built for a previous evaluation of a mesh with the same topology,
+   * its bounds must be refit before use (see #bvhcache_take_outdated).
+   */
+  bool is_outdated;
   BVHTree *tree;
 } BVHCacheItem;
 
 typedef struct BVHCache {
   BVHCacheItem items[BVHTREE_MAX_ITEM];
   ThreadMutex mutex;
+  /** Topology of the mesh the outdated items were built for, see #bvhcache_release_from_mesh. */
+  uint32_t topology_hash;
 } BVHCache;
 
 /**
@@ -141,11 +150,133 @@ BVHCache *bvhcache_init(void)
 static void bvhcache_insert(BVHCache *bvh_cache, BVHTree *tree, BVHCacheType type)
 {
   BVHCacheItem *item = &bvh_cache->items[type];
-  BLI_assert(!item->is_filled);
+  BLI_assert(!item->is_filled && !item->is_outdated);
   item->tree = tree;
   item->is_filled = true;
 }
 
+/**
+ * Remove the outdated tree of the given type from the cache, so it can be refit and inserted.
+ * Must be called with the cache locked.
+ *
+ * \return NULL when there is no outdated tree or it was built with different parameters.
+ */
+static BVHTree *bvhcache_take_outdated(BVHCache *bvh_cache,
+                                       BVHCacheType type,
+                                       float epsilon,
+                                       int tree_type)
+{
+  BVHCacheItem *item = &bvh_cache->items[type];
+  if (!item->is_outdated) {
+    return NULL;
+  }
+  BVHTree *tree = item->tree;
+  item->tree = NULL;
+  item->is_outdated = false;
+
+  if ((BLI_bvhtree_get_tree_type(tree) != tree_type) ||
+      (BLI_bvhtree_get_epsilon(tree) != epsilon)) {
+    BLI_bvhtree_free(tree);
+    return NULL;
+  }
+  return tree;
+}
+
+static uint32_t mesh_topology_hash(const Mesh *mesh)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+
+  BLI_hash_mm2a_add_int(&mm2, mesh->totvert);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totedge);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totloop);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totpoly);
+
+  /* Only hash what the trees (and their masks) depend on. */
+  const MEdge *med = mesh->medge;
+  for (int i = 0; i < mesh->totedge; i++, med++) {
+    BLI_hash_mm2a_add_int(&mm2, (int)med->v1);
+    BLI_hash_mm2a_add_int(&mm2, (int)med->v2);
+    BLI_hash_mm2a_add_int(&mm2, med->flag & ME_LOOSEEDGE);
+  }
+  const MLoop *ml = mesh->mloop;
+  for (int i = 0; i < mesh->totloop; i++, ml++) {
+    BLI_hash_mm2a_add_int(&mm2, (int)ml->v);
+  }
+  const MPoly *mp = mesh->mpoly;
+  for (int i = 0; i < mesh->totpoly; i++, mp++) {
+    BLI_hash_mm2a_add_int(&mm2, mp->loopstart);
+    BLI_hash_mm2a_add_int(&mm2, mp->totloop);
+    BLI_hash_mm2a_add_int(&mm2, mp->flag & ME_HIDE);
+  }
+
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+/**
+ * Detach the cache from an evaluated mesh which is about to be freed,
+ * so its trees can be refit for the next evaluation instead of being rebuilt.
+ * Only trees which can be refit are kept, they're marked as outdated.
+ *
+ * \return NULL when the mesh has no trees to reuse.
+ */
+BVHCache *bvhcache_release_from_mesh(Mesh *mesh)
+{
+  BVHCache *bvh_cache = mesh->runtime.bvh_cache;
+  if (bvh_cache == NULL) {
+    return NULL;
+  }
+  mesh->runtime.bvh_cache = NULL;
+
+  bool has_tree = false;
+  for (BVHCacheType type = 0; type < BVHTREE_MAX_ITEM; type++) {
+    BVHCacheItem *item = &bvh_cache->items[type];
+    const bool use_refit = ELEM(type,
+                                BVHTREE_FROM_VERTS,
+                                BVHTREE_FROM_LOOSEVERTS,
+                                BVHTREE_FROM_EDGES,
+                                BVHTREE_FROM_LOOSEEDGES,
+                                BVHTREE_FROM_LOOPTRI,
+                                BVHTREE_FROM_LOOPTRI_NO_HIDDEN);
+    if ((item->is_filled || item->is_outdated) && use_refit && item->tree) {
+      item->is_outdated = true;
+      has_tree = true;
+    }
+    else {
+      BLI_bvhtree_free(item->tree);
+      item->tree = NULL;
+      item->is_outdated = false;
+    }
+    item->is_filled = false;
+  }
+
+  if (!has_tree) {
+    bvhcache_free(bvh_cache);
+    return NULL;
+  }
+
+  bvh_cache->topology_hash = mesh_topology_hash(mesh);
+  return bvh_cache;
+}
+
+/**
+ * Give a cache detached by #bvhcache_release_from_mesh to a newly evaluated mesh.
+ * It's only used when the topology matches, otherwise it's freed.
+ */
+void bvhcache_reuse_for_mesh(Mesh *mesh, BVHCache *bvh_cache)
+{
+  if (bvh_cache == NULL) {
+    return;
+  }
+  if ((mesh->runtime.bvh_cache == NULL) &&
+      (bvh_cache->topology_hash == mesh_topology_hash(mesh))) {
+    mesh->runtime.bvh_cache = bvh_cache;
+  }
+  else {
+    bvhcache_free(bvh_cache);
+  }
+}
+
 /**
  * frees a bvhcache
  */
@@ -531,6 +662,114 @@ static void mesh_edges_spherecast(void *userdata,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Refit
+ *
+ * Update the bounds of an outdated cached tree with the coordinates of a newly evaluated mesh
+ * of the same topology, cheaper than building a new tree.
+ * \{ */
+
+typedef struct BVHRefitData {
+  BVHTree *tree;
+  const MVert *vert;
+  const MEdge *edge;
+  const MLoop *loop;
+  const MLoopTri *looptri;
+  /** Element index of each leaf, NULL when all elements are in the tree. */
+  const int *leaf_elem;
+} BVHRefitData;
+
+static void bvhtree_refit_verts_cb(void *__restrict userdata,
+                                   const int leaf,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHRefitData *data = userdata;
+  const int i = data->leaf_elem ? data->leaf_elem[leaf] : leaf;
+
+  BLI_bvhtree_update_node(data->tree, leaf, data->vert[i].co, NULL, 1);
+}
+
+static void bvhtree_refit_edges_cb(void *__restrict userdata,
+                                   const int leaf,
+                                   const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHRefitData *data = userdata;
+  const int i = data->leaf_elem ? data->leaf_elem[leaf] : leaf;
+  float co[2][3];
+
+  copy_v3_v3(co[0], data->vert[data->edge[i].v1].co);
+  copy_v3_v3(co[1], data->vert[data->edge[i].v2].co);
+
+  BLI_bvhtree_update_node(data->tree, leaf, co[0], NULL, 2);
+}
+
+static void bvhtree_refit_looptri_cb(void *__restrict userdata,
+                                     const int leaf,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHRefitData *data = userdata;
+  const int i = data->leaf_elem ? data->leaf_elem[leaf] : leaf;
+  const MLoopTri *lt = &data->looptri[i];
+  float co[3][3];
+
+  copy_v3_v3(co[0], data->vert[data->loop[lt->tri[0]].v].co);
+  copy_v3_v3(co[1], data->vert[data->loop[lt->tri[1]].v].co);
+  copy_v3_v3(co[2], data->vert[data->loop[lt->tri[2]].v].co);
+
+  BLI_bvhtree_update_node(data->tree, leaf, co[0], NULL, 3);
+}
+
+/**
+ * Refit all leafs of \a tree in parallel, leafs were inserted in order for all elements
+ * enabled in \a elem_mask (or all elements when it's NULL).
+ *
+ * \return false when the number of elements doesn't match the tree, it must be rebuilt then.
+ */
+static bool bvhtree_refit(BVHTree *tree,
+                          BVHRefitData *data,
+                          TaskParallelRangeFunc func,
+                          const int elem_num,
+                          const BLI_bitmap *elem_mask)
+{
+  const int leaf_num = BLI_bvhtree_get_len(tree);
+  int *leaf_elem = NULL;
+
+  if (elem_mask) {
+    leaf_elem = MEM_mallocN(sizeof(*leaf_elem) * (size_t)leaf_num, __func__);
+    int leaf = 0;
+    for (int i = 0; i < elem_num; i++) {
+      if (BLI_BITMAP_TEST_BOOL(elem_mask, i)) {
+        if (leaf == leaf_num) {
+          MEM_freeN(leaf_elem);
+          return false;
+        }
+        leaf_elem[leaf++] = i;
+      }
+    }
+    if (leaf != leaf_num) {
+      MEM_freeN(leaf_elem);
+      return false;
+    }
+  }
+  else if (elem_num != leaf_num) {
+    return false;
+  }
+
+  data->tree = tree;
+  data->leaf_elem = leaf_elem;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, leaf_num, data, func, &settings);
+
+  BLI_bvhtree_update_tree(tree);
+
+  MEM_SAFE_FREE(leaf_elem);
+  return true;
+}
+
+/** \} */
+
 /*
  * BVH builders
  */
@@ -709,8 +948,19 @@ BVHTree *bvhtree_from_mesh_verts_ex(BVHTreeFromMesh *data,
   }
 
   if (in_cache == false) {
-    tree = bvhtree_from_mesh_verts_create_tree(
-        epsilon, tree_type, axis, vert, verts_num, verts_mask, verts_num_active);
+    tree = bvh_cache_p ? bvhcache_take_outdated(*bvh_cache_p, bvh_cache_type, epsilon, tree_type) :
+                         NULL;
+    if (tree) {
+      BVHRefitData refit_data = {.vert = vert};
+      if (!bvhtree_refit(tree, &refit_data, bvhtree_refit_verts_cb, verts_num, verts_mask)) {
+        BLI_bvhtree_free(tree);
+        tree = NULL;
+      }
+    }
+    if (tree == NULL) {
+      tree = bvhtree_from_mesh_verts_create_tree(
+          epsilon, tree_type, axis, vert, verts_num, verts_mask, verts_num_active);
+    }
 
     if (bvh_cache_p) {
       /* Save on cache for later use */
@@ -921,8 +1171,19 @@ BVHTree *bvhtree_from_mesh_edges_ex(BVHTreeFromMesh *data,
   }
 
   if (in_cache == false) {
-    tree = bvhtree_from_mesh_edges_create_tree(
-        vert, edge, edges_num, edges_mask, edges_num_active, epsilon, tree_type, axis);
+    tree = bvh_cache_p ? bvhcache_take_outdated(*bvh_cache_p, bvh_cache_type, epsilon, tree_type) :
+                         NULL;
+    if (tree) {
+      BVHRefitData refit_data = {.vert = vert, .edge = edge};
+      if (!bvhtree_refit(tree, &refit_data, bvhtree_refit_edges_cb, edges_num, edges_mask)) {
+        BLI_bvhtree_free(tree);
+        tree = NULL;
+      }
+    }
+    if (tree == NULL) {
+      tree = bvhtree_from_mesh_edges_create_tree(
+          vert, edge, edges_num, edges_mask, edges_num_active, epsilon, tree_type, axis);
+    }
 
     if (bvh_cache_p) {
       BVHCache *bvh_cache = *bvh_cache_p;
@@ -1284,16 +1545,28 @@ BVHTree *bvhtree_from_mesh_looptri_ex(BVHTreeFromMesh *data,
   }
 
   if (in_cache == false) {
-    /* Setup BVHTreeFromMesh */
-    tree = bvhtree_from_mesh_looptri_create_tree(epsilon,
-                                                 tree_type,
-                                                 axis,
-                                                 vert,
-                                                 mloop,
-                                                 looptri,
-                                                 looptri_num,
-                                                 looptri_mask,
-                                                 looptri_num_active);
+    tree = bvh_cache_p ? bvhcache_take_outdated(*bvh_cache_p, bvh_cache_type, epsilon, tree_type) :
+                         NULL;
+    if (tree) {
+      BVHRefitData refit_data = {.vert = vert, .loop = mloop, .looptri = looptri};
+      if (!bvhtree_refit(
+              tree, &refit_data, bvhtree_refit_looptri_cb, looptri_num, looptri_mask)) {
+        BLI_bvhtree_free(tree);
+        tree = NULL;
+      }
+    }
+    if (tree == NULL) {
+      /* Setup BVHTreeFromMesh */
+      tree = bvhtree_from_mesh_looptri_create_tree(epsilon,
+                                                   tree_type,
+                                                   axis,
+                                                   vert,
+                                                   mloop,
+                                                   looptri,
+                                                   looptri_num,
+                                                   looptri_mask,
+                                                   looptri_num_active);
+    }
 
     if (bvh_cache_p) {
       BVHCache *bvh_cache = *bvh_cache_p;
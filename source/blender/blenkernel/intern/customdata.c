@@ -41,6 +41,7 @@
 #include "BLI_path_util.h"
 #include "BLI_string.h"
 #include "BLI_string_utils.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "BLT_translation.h"
@@ -3197,6 +3198,157 @@ void CustomData_interp(const CustomData *source,
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Bulk Copy
+ *
+ * Copying a whole range of elements at once only has to match layers and look up their type info
+ * once, the work is then split over layers and chunks of elements in parallel.
+ * \{ */
+
+/* Number of elements handled by one task. */
+#define CUSTOMDATA_BULK_CHUNK_SIZE 4096
+/* Below this many elements (summed over all layers) the work isn't worth threading. */
+#define CUSTOMDATA_BULK_THREADED_MIN 8192
+
+typedef struct CustomDataBulkLayer {
+  const LayerTypeInfo *typeInfo;
+  const void *src_data;
+  void *dst_data;
+} CustomDataBulkLayer;
+
+typedef struct CustomDataBulkData {
+  const CustomDataBulkLayer *layers;
+  int chunks_num;
+
+  const int *src_indices;
+
+  int dest_index;
+  int count;
+} CustomDataBulkData;
+
+/**
+ * Gather the source & dest layer pairs used by #CustomData_copy_data.
+ *
+ * \return the number of layers written to \a r_layers, which is source->totlayer long.
+ */
+static int customdata_bulk_layers_get(const CustomData *source,
+                                      CustomData *dest,
+                                      CustomDataBulkLayer *r_layers)
+{
+  int layers_num = 0;
+  int dest_i = 0;
+  for (int src_i = 0; src_i < source->totlayer; src_i++) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(source->layers[src_i].type);
+
+    /* find the first dest layer with type >= the source type
+     * (this should work because layers are ordered by type)
+     */
+    while (dest_i < dest->totlayer && dest->layers[dest_i].type < source->layers[src_i].type) {
+      dest_i++;
+    }
+
+    /* if there are no more dest layers, we're done */
+    if (dest_i >= dest->totlayer) {
+      break;
+    }
+
+    if (dest->layers[dest_i].type == source->layers[src_i].type) {
+      const void *src_data = source->layers[src_i].data;
+      void *dst_data = dest->layers[dest_i].data;
+      if (src_data && dst_data) {
+        r_layers[layers_num++] = (CustomDataBulkLayer){typeInfo, src_data, dst_data};
+      }
+      else if (!(src_data == NULL && dst_data == NULL)) {
+        CLOG_WARN(&LOG,
+                  "null data for %s type (%p --> %p), skipping",
+                  layerType_getName(source->layers[src_i].type),
+                  (void *)src_data,
+                  (void *)dst_data);
+      }
+
+      /* if there are multiple source & dest layers of the same type,
+       * we don't want to copy all source layers to the same dest, so
+       * increment dest_i
+       */
+      dest_i++;
+    }
+  }
+  return layers_num;
+}
+
+static void customdata_bulk_do(const CustomDataBulkData *bulk_data,
+                               TaskParallelRangeFunc func,
+                               const int layers_num)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = ((size_t)bulk_data->count * (size_t)layers_num >=
+                            CUSTOMDATA_BULK_THREADED_MIN);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(
+      0, layers_num * bulk_data->chunks_num, (void *)bulk_data, func, &settings);
+}
+
+static void customdata_copy_data_indices_cb(void *__restrict userdata,
+                                            const int iter,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const CustomDataBulkData *bulk_data = userdata;
+  const CustomDataBulkLayer *layer = &bulk_data->layers[iter / bulk_data->chunks_num];
+  const LayerTypeInfo *typeInfo = layer->typeInfo;
+  const size_t size = (size_t)typeInfo->size;
+
+  const int start = (iter % bulk_data->chunks_num) * CUSTOMDATA_BULK_CHUNK_SIZE;
+  const int end = min_ii(start + CUSTOMDATA_BULK_CHUNK_SIZE, bulk_data->count);
+
+  void *dst = POINTER_OFFSET(layer->dst_data, (size_t)(bulk_data->dest_index + start) * size);
+  if (typeInfo->copy) {
+    for (int i = start; i < end; i++, dst = POINTER_OFFSET(dst, size)) {
+      typeInfo->copy(
+          POINTER_OFFSET(layer->src_data, (size_t)bulk_data->src_indices[i] * size), dst, 1);
+    }
+  }
+  else {
+    for (int i = start; i < end; i++, dst = POINTER_OFFSET(dst, size)) {
+      memcpy(dst, POINTER_OFFSET(layer->src_data, (size_t)bulk_data->src_indices[i] * size), size);
+    }
+  }
+}
+
+/**
+ * Bulk version of #CustomData_copy_data, copying element `src_indices[i]` of \a source to element
+ * `dest_index + i` of \a dest for every layer.
+ */
+void CustomData_copy_data_indices(const CustomData *source,
+                                  CustomData *dest,
+                                  const int *src_indices,
+                                  int dest_index,
+                                  int count)
+{
+  if (count <= 0 || source->totlayer == 0) {
+    return;
+  }
+
+  CustomDataBulkLayer *layers = MEM_malloc_arrayN(
+      (size_t)source->totlayer, sizeof(*layers), __func__);
+  const int layers_num = customdata_bulk_layers_get(source, dest, layers);
+
+  if (layers_num != 0) {
+    const CustomDataBulkData bulk_data = {
+        .layers = layers,
+        .chunks_num = (int)divide_ceil_u((uint)count, CUSTOMDATA_BULK_CHUNK_SIZE),
+        .src_indices = src_indices,
+        .dest_index = dest_index,
+        .count = count,
+    };
+    customdata_bulk_do(&bulk_data, customdata_copy_data_indices_cb, layers_num);
+  }
+
+  MEM_freeN(layers);
+}
+
+/** \} */
+
 /**
  * Swap data inside each item, for all layers.
  * This only applies to item types that may store several sub-item data
@@ -0,0 +1,122 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "BKE_customdata.h"
+
+namespace blender::bke::tests {
+
+/* Enough elements for the bulk copy to run on multiple threads. */
+#define NUM_ITEMS 20000
+
+static void customdata_layers_add(CustomData *data,
+                                  const int totelem,
+                                  const eCDAllocType alloctype)
+{
+  CustomData_reset(data);
+  /* Two layers of the same type, to check they're copied pairwise. */
+  CustomData_add_layer_named(data, CD_PROP_FLOAT, alloctype, nullptr, totelem, "a");
+  CustomData_add_layer_named(data, CD_PROP_FLOAT, alloctype, nullptr, totelem, "b");
+  CustomData_add_layer(data, CD_PROP_INT32, alloctype, nullptr, totelem);
+  /* Copied through the type's copy callback. */
+  CustomData_add_layer(data, CD_MDEFORMVERT, alloctype, nullptr, totelem);
+}
+
+TEST(customdata, CopyDataIndices)
+{
+  BLI_threadapi_init();
+
+  CustomData source, dest, dest_expected;
+  customdata_layers_add(&source, NUM_ITEMS, CD_CALLOC);
+  customdata_layers_add(&dest, NUM_ITEMS, CD_CALLOC);
+  customdata_layers_add(&dest_expected, NUM_ITEMS, CD_CALLOC);
+
+  float *src_a = (float *)CustomData_get_layer_n(&source, CD_PROP_FLOAT, 0);
+  float *src_b = (float *)CustomData_get_layer_n(&source, CD_PROP_FLOAT, 1);
+  int *src_int = (int *)CustomData_get_layer(&source, CD_PROP_INT32);
+  MDeformVert *src_dvert = (MDeformVert *)CustomData_get_layer(&source, CD_MDEFORMVERT);
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    src_a[i] = (float)i;
+    src_b[i] = (float)-i;
+    src_int[i] = i * 3;
+    src_dvert[i].totweight = 1 + i % 3;
+    src_dvert[i].dw = (MDeformWeight *)MEM_calloc_arrayN(
+        src_dvert[i].totweight, sizeof(MDeformWeight), __func__);
+    for (int j = 0; j < src_dvert[i].totweight; j++) {
+      src_dvert[i].dw[j].def_nr = (unsigned int)j;
+      src_dvert[i].dw[j].weight = (float)(i % 7) / 7.0f;
+    }
+  }
+
+  /* Reversed, skipping the first element and using the last one twice. */
+  const int count = NUM_ITEMS - 1;
+  int *src_indices = (int *)MEM_malloc_arrayN(count, sizeof(int), __func__);
+  for (int i = 0; i < count; i++) {
+    src_indices[i] = NUM_ITEMS - 1 - i;
+  }
+  src_indices[count - 1] = NUM_ITEMS - 1;
+
+  const int dest_index = 1;
+  CustomData_copy_data_indices(&source, &dest, src_indices, dest_index, count);
+  for (int i = 0; i < count; i++) {
+    CustomData_copy_data(&source, &dest_expected, src_indices[i], dest_index + i, 1);
+  }
+
+  for (int n = 0; n < 2; n++) {
+    const float *r_float = (const float *)CustomData_get_layer_n(&dest, CD_PROP_FLOAT, n);
+    const float *r_float_expected = (const float *)CustomData_get_layer_n(
+        &dest_expected, CD_PROP_FLOAT, n);
+    EXPECT_EQ(memcmp(r_float, r_float_expected, sizeof(float) * NUM_ITEMS), 0);
+  }
+  const int *r_int = (const int *)CustomData_get_layer(&dest, CD_PROP_INT32);
+  const int *r_int_expected = (const int *)CustomData_get_layer(&dest_expected, CD_PROP_INT32);
+  EXPECT_EQ(memcmp(r_int, r_int_expected, sizeof(int) * NUM_ITEMS), 0);
+
+  const MDeformVert *r_dvert = (const MDeformVert *)CustomData_get_layer(&dest, CD_MDEFORMVERT);
+  const MDeformVert *r_dvert_expected = (const MDeformVert *)CustomData_get_layer(&dest_expected,
+                                                                                 CD_MDEFORMVERT);
+  EXPECT_EQ(r_dvert[0].dw, nullptr);
+  for (int i = dest_index; i < dest_index + count; i++) {
+    ASSERT_EQ(r_dvert[i].totweight, r_dvert_expected[i].totweight);
+    /* Each copy owns its weights. */
+    EXPECT_NE(r_dvert[i].dw, src_dvert[src_indices[i - dest_index]].dw);
+    for (int j = 0; j < r_dvert[i].totweight; j++) {
+      EXPECT_EQ(r_dvert[i].dw[j].def_nr, r_dvert_expected[i].dw[j].def_nr);
+      EXPECT_EQ(r_dvert[i].dw[j].weight, r_dvert_expected[i].dw[j].weight);
+    }
+  }
+
+  MEM_freeN(src_indices);
+  CustomData_free(&source, NUM_ITEMS);
+  CustomData_free(&dest, NUM_ITEMS);
+  CustomData_free(&dest_expected, NUM_ITEMS);
+
+  BLI_threadapi_exit();
+}
+
+}  // namespace blender::bke::tests
@@ -1674,21 +1674,26 @@ void BKE_mesh_calc_normals_split_ex(Mesh *mesh, MLoopNorSpaceArray *r_lnors_spac
     free_polynors = true;
   }
 
-  BKE_mesh_normals_loop_split(mesh->mvert,
-                              mesh->totvert,
-                              mesh->medge,
-                              mesh->totedge,
-                              mesh->mloop,
-                              r_loopnors,
-                              mesh->totloop,
-                              mesh->mpoly,
-                              (const float(*)[3])polynors,
-                              mesh->totpoly,
-                              use_split_normals,
-                              split_angle,
-                              r_lnors_spacearr,
-                              clnors,
-                              NULL);
+  /* Keep the smooth fans, in case only the coordinates change in the next evaluation.
+   * Only done for meshes outside of main (evaluated and temporary meshes), original meshes would
+   * hold on to the cache until their geometry is cleared. */
+  const bool use_fan_cache = use_split_normals && (mesh->id.tag & LIB_TAG_NO_MAIN);
+  BKE_mesh_normals_loop_split_ex(mesh->mvert,
+                                 mesh->totvert,
+                                 mesh->medge,
+                                 mesh->totedge,
+                                 mesh->mloop,
+                                 r_loopnors,
+                                 mesh->totloop,
+                                 mesh->mpoly,
+                                 (const float(*)[3])polynors,
+                                 mesh->totpoly,
+                                 use_split_normals,
+                                 split_angle,
+                                 r_lnors_spacearr,
+                                 clnors,
+                                 NULL,
+                                 use_fan_cache ? &mesh->runtime.loop_fan_cache : NULL);
 
   if (free_polynors) {
     MEM_freeN(polynors);
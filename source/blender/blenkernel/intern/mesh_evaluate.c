@@ -36,6 +36,7 @@
 #include "BLI_alloca.h"
 #include "BLI_bitmap.h"
 #include "BLI_edgehash.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_linklist.h"
 #include "BLI_linklist_stack.h"
 #include "BLI_math.h"
@@ -210,6 +211,10 @@ void BKE_mesh_calc_normals_mapping_ex(MVert *mverts,
   fnors = pnors = NULL;
 }
 
+/* Meshes with fewer loops accumulate vertex normals on a single thread,
+ * the vertex to loop map is only worth building for larger meshes. */
+#define MESH_NORMALS_VERT_LOOP_MAP_MIN_LOOPS 65536
+
 typedef struct MeshCalcNormalsData {
   const MPoly *mpolys;
   const MLoop *mloop;
@@ -217,6 +222,11 @@ typedef struct MeshCalcNormalsData {
   float (*pnors)[3];
   float (*lnors_weighted)[3];
   float (*vnors)[3];
+
+  /** Offset of the loops of each vertex in #vert_loops, (numVerts + 1) items.
+   * Before the map is filled, item `v + 1` holds the number of loops of vertex `v`. */
+  int *vert_loop_offsets;
+  int *vert_loops;
 } MeshCalcNormalsData;
 
 static void mesh_calc_normals_poly_cb(void *__restrict userdata,
@@ -291,17 +301,46 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
       prev_edge = cur_edge;
     }
   }
+
+  /* Count the loops of each vertex, to build the vertex to loop map. */
+  if (data->vert_loop_offsets) {
+    for (i = 0; i < nverts; i++) {
+      atomic_fetch_and_add_int32(&data->vert_loop_offsets[ml[i].v + 1], 1);
+    }
+  }
+}
+
+static void mesh_calc_normals_poly_accum_cb(void *__restrict userdata,
+                                            const int vidx,
+                                            const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  MeshCalcNormalsData *data = userdata;
+  const float(*lnors_weighted)[3] = (const float(*)[3])data->lnors_weighted;
+  const int *vert_loops = &data->vert_loops[data->vert_loop_offsets[vidx]];
+  const int vert_loops_num = data->vert_loop_offsets[vidx + 1] - data->vert_loop_offsets[vidx];
+  float *no = data->vnors[vidx];
+
+  /* Loops are in increasing order, the same order as accumulating over all loops on a single
+   * thread, so the result doesn't depend on threading. */
+  zero_v3(no);
+  for (int i = 0; i < vert_loops_num; i++) {
+    add_v3_v3(no, lnors_weighted[vert_loops[i]]);
+  }
 }
 
 static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
                                                const int vidx,
-                                               const TaskParallelTLS *__restrict UNUSED(tls))
+                                               const TaskParallelTLS *__restrict tls)
 {
   MeshCalcNormalsData *data = userdata;
 
   MVert *mv = &data->mverts[vidx];
   float *no = data->vnors[vidx];
 
+  if (data->vert_loops) {
+    mesh_calc_normals_poly_accum_cb(userdata, vidx, tls);
+  }
+
   if (UNLIKELY(normalize_v3(no) == 0.0f)) {
     /* following Mesh convention; we use vertex coordinate itself for normal in this case */
     normalize_v3_v3(no, mv->co);
@@ -346,12 +385,21 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
       (size_t)numLoops, sizeof(*lnors_weighted), __func__);
   bool free_vnors = false;
 
+  /* Accumulating weighted loop normals into vertex ones can't be threaded directly
+   * (not in a reasonable, totally lock- and barrier-free fashion),
+   * since several loops will point to the same vertex.
+   * For large meshes, a vertex to loop map is built so each vertex gathers its own loops,
+   * the map is counted while preparing loop normals. */
+  const bool use_vert_loop_map = (numLoops >= MESH_NORMALS_VERT_LOOP_MAP_MIN_LOOPS) &&
+                                 (numVerts > settings.min_iter_per_thread);
+
   /* first go through and calculate normals for all the polys */
   if (vnors == NULL) {
-    vnors = MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
+    vnors = use_vert_loop_map ? MEM_malloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__) :
+                                MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
     free_vnors = true;
   }
-  else {
+  else if (!use_vert_loop_map) {
     memset(vnors, 0, sizeof(*vnors) * (size_t)numVerts);
   }
 
@@ -364,24 +412,47 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
       .vnors = vnors,
   };
 
+  if (use_vert_loop_map) {
+    data.vert_loop_offsets = MEM_calloc_arrayN(
+        (size_t)numVerts + 1, sizeof(*data.vert_loop_offsets), __func__);
+    data.vert_loops = MEM_malloc_arrayN((size_t)numLoops, sizeof(*data.vert_loops), __func__);
+  }
+
   /* Compute poly normals, and prepare weighted loop normals. */
   BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_prepare_cb, &settings);
 
-  /* Actually accumulate weighted loop normals into vertex ones. */
-  /* Unfortunately, not possible to thread that
-   * (not in a reasonable, totally lock- and barrier-free fashion),
-   * since several loops will point to the same vertex... */
-  for (int lidx = 0; lidx < numLoops; lidx++) {
-    add_v3_v3(vnors[mloop[lidx].v], data.lnors_weighted[lidx]);
+  if (use_vert_loop_map) {
+    /* Turn loop counts into offsets to the start of each vertex loops. */
+    int *vert_loop_offsets = data.vert_loop_offsets;
+    for (int vidx = 1; vidx <= numVerts; vidx++) {
+      vert_loop_offsets[vidx] += vert_loop_offsets[vidx - 1];
+    }
+    /* Fill the map in loop order (a counting sort), using the offsets as write positions.
+     * Each one ends up at the start of the loops of the next vertex, shift them back. */
+    int *vert_loops = data.vert_loops;
+    for (int lidx = 0; lidx < numLoops; lidx++) {
+      vert_loops[vert_loop_offsets[mloop[lidx].v]++] = lidx;
+    }
+    memmove(&vert_loop_offsets[1], vert_loop_offsets, sizeof(*vert_loop_offsets) * (size_t)numVerts);
+    vert_loop_offsets[0] = 0;
+  }
+  else {
+    /* Actually accumulate weighted loop normals into vertex ones. */
+    for (int lidx = 0; lidx < numLoops; lidx++) {
+      add_v3_v3(vnors[mloop[lidx].v], data.lnors_weighted[lidx]);
+    }
   }
 
-  /* Normalize and validate computed vertex normals. */
+  /* Normalize and validate computed vertex normals
+   * (also accumulated here when using the vertex to loop map). */
   BLI_task_parallel_range(0, numVerts, &data, mesh_calc_normals_poly_finalize_cb, &settings);
 
   if (free_vnors) {
     MEM_freeN(vnors);
   }
   MEM_freeN(lnors_weighted);
+  MEM_SAFE_FREE(data.vert_loop_offsets);
+  MEM_SAFE_FREE(data.vert_loops);
 }
 
 void BKE_mesh_ensure_normals(Mesh *mesh)
@@ -1025,12 +1096,210 @@ void BKE_mesh_loop_manifold_fan_around_vert_next(const MLoop *mloops,
   /* And now we are back in sync, mlfan_curr_index is the index of mlfan_curr! Pff! */
 }
 
-static void split_loop_nor_single_do(LoopSplitTaskDataCommon *common_data, LoopSplitTaskData *data)
+/**
+ * Define the lnor space of a loop with two sharp edges, which just takes its poly normal.
+ * Shared by #split_loop_nor_single_do and #loop_fan_cache_fan_do.
+ */
+static void split_loop_nor_single_space_do(const LoopSplitTaskDataCommon *common_data,
+                                           MLoopNorSpace *lnor_space,
+                                           float lnor[3],
+                                           const int ml_curr_index,
+                                           const MEdge *me_curr,
+                                           const MEdge *me_prev)
 {
   MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
-  const short(*clnors_data)[2] = common_data->clnors_data;
+  const short(*clnors_data)[2] = (const short(*)[2])common_data->clnors_data;
+  const MVert *mverts = common_data->mverts;
+
+  float vec_curr[3], vec_prev[3];
+
+  /* The vertex we are "fanning" around! */
+  const unsigned int mv_pivot_index = common_data->mloops[ml_curr_index].v;
+  const MVert *mv_pivot = &mverts[mv_pivot_index];
+  const MVert *mv_2 = (me_curr->v1 == mv_pivot_index) ? &mverts[me_curr->v2] :
+                                                        &mverts[me_curr->v1];
+  const MVert *mv_3 = (me_prev->v1 == mv_pivot_index) ? &mverts[me_prev->v2] :
+                                                        &mverts[me_prev->v1];
+
+  sub_v3_v3v3(vec_curr, mv_2->co, mv_pivot->co);
+  normalize_v3(vec_curr);
+  sub_v3_v3v3(vec_prev, mv_3->co, mv_pivot->co);
+  normalize_v3(vec_prev);
+
+  BKE_lnor_space_define(lnor_space, lnor, vec_curr, vec_prev, NULL);
+  /* We know there is only one loop in this space,
+   * no need to create a linklist in this case... */
+  BKE_lnor_space_add_loop(lnors_spacearr, lnor_space, ml_curr_index, NULL, true);
+
+  if (clnors_data) {
+    BKE_lnor_space_custom_data_to_normal(lnor_space, clnors_data[ml_curr_index], lnor);
+  }
+}
+
+/**
+ * Normal accumulated over the loops of a smooth fan, whether the fan is walked
+ * (#split_loop_nor_fan_do) or read from the fan cache (#loop_fan_cache_fan_do).
+ */
+typedef struct LoopSplitFan {
+  /** The vertex we are "fanning" around! */
+  unsigned int mv_pivot_index;
+  const MVert *mv_pivot;
+  /** Edge of the loop which started the fan. */
+  const MEdge *me_org;
+
+  float vec_org[3], vec_prev[3], vec_curr[3];
+  float lnor[3];
 
+  /* We validate clnors data on the fly - cheapest way to do! */
+  int clnors_avg[2];
+  short (*clnor_ref)[2];
+  int clnors_nbr;
+  bool clnors_invalid;
+} LoopSplitFan;
+
+static void split_loop_nor_fan_begin(const LoopSplitTaskDataCommon *common_data,
+                                     LoopSplitFan *fan,
+                                     const MLoop *ml_curr,
+                                     BLI_Stack *edge_vectors)
+{
+  const MVert *mverts = common_data->mverts;
+
+  memset(fan, 0, sizeof(*fan));
+  fan->mv_pivot_index = ml_curr->v;
+  fan->mv_pivot = &mverts[fan->mv_pivot_index];
+  /* ml_curr would be mlfan_prev if we needed that one. */
+  fan->me_org = &common_data->medges[ml_curr->e];
+
+  /* Only need to compute previous edge's vector once, then we can just reuse old current one! */
+  const MEdge *me_org = fan->me_org;
+  const MVert *mv_2 = (me_org->v1 == fan->mv_pivot_index) ? &mverts[me_org->v2] :
+                                                            &mverts[me_org->v1];
+
+  sub_v3_v3v3(fan->vec_org, mv_2->co, fan->mv_pivot->co);
+  normalize_v3(fan->vec_org);
+  copy_v3_v3(fan->vec_prev, fan->vec_org);
+
+  if (common_data->lnors_spacearr) {
+    BLI_stack_push(edge_vectors, fan->vec_org);
+  }
+}
+
+/* Accumulate the face of \a mlfan_vert_index, \a me_curr being its edge which was crossed last. */
+static void split_loop_nor_fan_step(const LoopSplitTaskDataCommon *common_data,
+                                    LoopSplitFan *fan,
+                                    MLoopNorSpace *lnor_space,
+                                    BLI_Stack *edge_vectors,
+                                    const MEdge *me_curr,
+                                    const int mpfan_curr_index,
+                                    const int mlfan_vert_index)
+{
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  short(*clnors_data)[2] = common_data->clnors_data;
   const MVert *mverts = common_data->mverts;
+
+  /* Compute edge vectors.
+   * NOTE: We could pre-compute those into an array, in the first iteration, instead of computing
+   *       them twice (or more) here. However, time gained is not worth memory and time lost,
+   *       given the fact that this code should not be called that much in real-life meshes...
+   */
+  {
+    const MVert *mv_2 = (me_curr->v1 == fan->mv_pivot_index) ? &mverts[me_curr->v2] :
+                                                               &mverts[me_curr->v1];
+
+    sub_v3_v3v3(fan->vec_curr, mv_2->co, fan->mv_pivot->co);
+    normalize_v3(fan->vec_curr);
+  }
+
+  {
+    /* Code similar to accumulate_vertex_normals_poly_v3. */
+    /* Calculate angle between the two poly edges incident on this vertex. */
+    const float fac = saacos(dot_v3v3(fan->vec_curr, fan->vec_prev));
+    /* Accumulate */
+    madd_v3_v3fl(fan->lnor, common_data->polynors[mpfan_curr_index], fac);
+
+    if (clnors_data) {
+      /* Accumulate all clnors, if they are not all equal we have to fix that! */
+      short(*clnor)[2] = &clnors_data[mlfan_vert_index];
+      if (fan->clnors_nbr) {
+        fan->clnors_invalid |= ((*fan->clnor_ref)[0] != (*clnor)[0] ||
+                                (*fan->clnor_ref)[1] != (*clnor)[1]);
+      }
+      else {
+        fan->clnor_ref = clnor;
+      }
+      fan->clnors_avg[0] += (*clnor)[0];
+      fan->clnors_avg[1] += (*clnor)[1];
+      fan->clnors_nbr++;
+    }
+  }
+
+  if (lnors_spacearr) {
+    /* Assign current lnor space to current 'vertex' loop. */
+    BKE_lnor_space_add_loop(lnors_spacearr, lnor_space, mlfan_vert_index, NULL, false);
+    if (me_curr != fan->me_org) {
+      /* We store here all edges-normalized vectors processed. */
+      BLI_stack_push(edge_vectors, fan->vec_curr);
+    }
+  }
+
+  copy_v3_v3(fan->vec_prev, fan->vec_curr);
+}
+
+/**
+ * Normalize the fan normal in `fan->lnor`, and define the lnor space of the fan.
+ *
+ * \param mlfan_vert_index: The last loop of the fan.
+ * \param r_clnor_fix: Set to the average of the custom normals of the fan when they differ,
+ * the caller has to write it to all of them (returning true).
+ * \return false if the fan normal is zero, loops keep their vertex normal in that case.
+ */
+static bool split_loop_nor_fan_end(const LoopSplitTaskDataCommon *common_data,
+                                   LoopSplitFan *fan,
+                                   MLoopNorSpace *lnor_space,
+                                   BLI_Stack *edge_vectors,
+                                   const int mlfan_vert_index,
+                                   short r_clnor_fix[2],
+                                   bool *r_do_clnor_fix)
+{
+  float lnor_len = normalize_v3(fan->lnor);
+
+  *r_do_clnor_fix = false;
+
+  /* If we are generating lnor spacearr, we can now define the one for this fan,
+   * and optionally compute final lnor from custom data too!
+   */
+  if (common_data->lnors_spacearr) {
+    if (UNLIKELY(lnor_len == 0.0f)) {
+      /* Use vertex normal as fallback! */
+      copy_v3_v3(fan->lnor, common_data->loopnors[mlfan_vert_index]);
+      lnor_len = 1.0f;
+    }
+
+    BKE_lnor_space_define(lnor_space, fan->lnor, fan->vec_org, fan->vec_curr, edge_vectors);
+
+    if (common_data->clnors_data) {
+      const short *clnor = *fan->clnor_ref;
+      if (fan->clnors_invalid) {
+        /* Fix/update all clnors of this fan with computed average value. */
+        if (G.debug & G_DEBUG) {
+          printf("Invalid clnors in this fan!\n");
+        }
+        r_clnor_fix[0] = (short)(fan->clnors_avg[0] / fan->clnors_nbr);
+        r_clnor_fix[1] = (short)(fan->clnors_avg[1] / fan->clnors_nbr);
+        *r_do_clnor_fix = true;
+        clnor = r_clnor_fix;
+      }
+
+      BKE_lnor_space_custom_data_to_normal(lnor_space, clnor, fan->lnor);
+    }
+  }
+
+  /* In case we get a zero normal here, just use vertex normal already set! */
+  return LIKELY(lnor_len != 0.0f);
+}
+
+static void split_loop_nor_single_do(LoopSplitTaskDataCommon *common_data, LoopSplitTaskData *data)
+{
   const MEdge *medges = common_data->medges;
   const float(*polynors)[3] = common_data->polynors;
 
@@ -1059,47 +1328,22 @@ static void split_loop_nor_single_do(LoopSplitTaskDataCommon *common_data, LoopS
 #endif
 
   /* If needed, generate this (simple!) lnor space. */
-  if (lnors_spacearr) {
-    float vec_curr[3], vec_prev[3];
-
-    const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
-    const MVert *mv_pivot = &mverts[mv_pivot_index];
-    const MEdge *me_curr = &medges[ml_curr->e];
-    const MVert *mv_2 = (me_curr->v1 == mv_pivot_index) ? &mverts[me_curr->v2] :
-                                                          &mverts[me_curr->v1];
-    const MEdge *me_prev = &medges[ml_prev->e];
-    const MVert *mv_3 = (me_prev->v1 == mv_pivot_index) ? &mverts[me_prev->v2] :
-                                                          &mverts[me_prev->v1];
-
-    sub_v3_v3v3(vec_curr, mv_2->co, mv_pivot->co);
-    normalize_v3(vec_curr);
-    sub_v3_v3v3(vec_prev, mv_3->co, mv_pivot->co);
-    normalize_v3(vec_prev);
-
-    BKE_lnor_space_define(lnor_space, *lnor, vec_curr, vec_prev, NULL);
-    /* We know there is only one loop in this space,
-     * no need to create a linklist in this case... */
-    BKE_lnor_space_add_loop(lnors_spacearr, lnor_space, ml_curr_index, NULL, true);
-
-    if (clnors_data) {
-      BKE_lnor_space_custom_data_to_normal(lnor_space, clnors_data[ml_curr_index], *lnor);
-    }
+  if (common_data->lnors_spacearr) {
+    split_loop_nor_single_space_do(
+        common_data, lnor_space, *lnor, ml_curr_index, &medges[ml_curr->e], &medges[ml_prev->e]);
   }
 }
 
 static void split_loop_nor_fan_do(LoopSplitTaskDataCommon *common_data, LoopSplitTaskData *data)
 {
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
   float(*loopnors)[3] = common_data->loopnors;
   short(*clnors_data)[2] = common_data->clnors_data;
 
-  const MVert *mverts = common_data->mverts;
   const MEdge *medges = common_data->medges;
   const MLoop *mloops = common_data->mloops;
   const MPoly *mpolys = common_data->mpolys;
   const int(*edge_to_loops)[2] = common_data->edge_to_loops;
   const int *loop_to_poly = common_data->loop_to_poly;
-  const float(*polynors)[3] = common_data->polynors;
 
   MLoopNorSpace *lnor_space = data->lnor_space;
 #if 0 /* Not needed for 'fan' loops. */
@@ -1121,25 +1365,14 @@ static void split_loop_nor_fan_do(LoopSplitTaskDataCommon *common_data, LoopSpli
    * number of sharp edges per vertex, I doubt the additional memory usage would be worth it,
    * especially as it should not be a common case in real-life meshes anyway).
    */
-  const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
-  const MVert *mv_pivot = &mverts[mv_pivot_index];
-
-  /* ml_curr would be mlfan_prev if we needed that one. */
-  const MEdge *me_org = &medges[ml_curr->e];
+  LoopSplitFan fan;
+  split_loop_nor_fan_begin(common_data, &fan, ml_curr, edge_vectors);
 
   const int *e2lfan_curr;
-  float vec_curr[3], vec_prev[3], vec_org[3];
   const MLoop *mlfan_curr;
-  float lnor[3] = {0.0f, 0.0f, 0.0f};
   /* mlfan_vert_index: the loop of our current edge might not be the loop of our current vertex! */
   int mlfan_curr_index, mlfan_vert_index, mpfan_curr_index;
 
-  /* We validate clnors data on the fly - cheapest way to do! */
-  int clnors_avg[2] = {0, 0};
-  short(*clnor_ref)[2] = NULL;
-  int clnors_nbr = 0;
-  bool clnors_invalid = false;
-
   /* Temp loop normal stack. */
   BLI_SMALLSTACK_DECLARE(normal, float *);
   /* Temp clnors stack. */
@@ -1155,75 +1388,24 @@ static void split_loop_nor_fan_do(LoopSplitTaskDataCommon *common_data, LoopSpli
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  /* Only need to compute previous edge's vector once, then we can just reuse old current one! */
-  {
-    const MVert *mv_2 = (me_org->v1 == mv_pivot_index) ? &mverts[me_org->v2] : &mverts[me_org->v1];
-
-    sub_v3_v3v3(vec_org, mv_2->co, mv_pivot->co);
-    normalize_v3(vec_org);
-    copy_v3_v3(vec_prev, vec_org);
-
-    if (lnors_spacearr) {
-      BLI_stack_push(edge_vectors, vec_org);
-    }
-  }
-
   //  printf("FAN: vert %d, start edge %d\n", mv_pivot_index, ml_curr->e);
 
   while (true) {
     const MEdge *me_curr = &medges[mlfan_curr->e];
-    /* Compute edge vectors.
-     * NOTE: We could pre-compute those into an array, in the first iteration, instead of computing
-     *       them twice (or more) here. However, time gained is not worth memory and time lost,
-     *       given the fact that this code should not be called that much in real-life meshes...
-     */
-    {
-      const MVert *mv_2 = (me_curr->v1 == mv_pivot_index) ? &mverts[me_curr->v2] :
-                                                            &mverts[me_curr->v1];
-
-      sub_v3_v3v3(vec_curr, mv_2->co, mv_pivot->co);
-      normalize_v3(vec_curr);
-    }
 
     //      printf("\thandling edge %d / loop %d\n", mlfan_curr->e, mlfan_curr_index);
 
-    {
-      /* Code similar to accumulate_vertex_normals_poly_v3. */
-      /* Calculate angle between the two poly edges incident on this vertex. */
-      const float fac = saacos(dot_v3v3(vec_curr, vec_prev));
-      /* Accumulate */
-      madd_v3_v3fl(lnor, polynors[mpfan_curr_index], fac);
-
-      if (clnors_data) {
-        /* Accumulate all clnors, if they are not all equal we have to fix that! */
-        short(*clnor)[2] = &clnors_data[mlfan_vert_index];
-        if (clnors_nbr) {
-          clnors_invalid |= ((*clnor_ref)[0] != (*clnor)[0] || (*clnor_ref)[1] != (*clnor)[1]);
-        }
-        else {
-          clnor_ref = clnor;
-        }
-        clnors_avg[0] += (*clnor)[0];
-        clnors_avg[1] += (*clnor)[1];
-        clnors_nbr++;
-        /* We store here a pointer to all custom lnors processed. */
-        BLI_SMALLSTACK_PUSH(clnors, (short *)*clnor);
-      }
-    }
+    split_loop_nor_fan_step(
+        common_data, &fan, lnor_space, edge_vectors, me_curr, mpfan_curr_index, mlfan_vert_index);
 
+    if (clnors_data) {
+      /* We store here a pointer to all custom lnors processed. */
+      BLI_SMALLSTACK_PUSH(clnors, (short *)clnors_data[mlfan_vert_index]);
+    }
     /* We store here a pointer to all loop-normals processed. */
     BLI_SMALLSTACK_PUSH(normal, (float *)(loopnors[mlfan_vert_index]));
 
-    if (lnors_spacearr) {
-      /* Assign current lnor space to current 'vertex' loop. */
-      BKE_lnor_space_add_loop(lnors_spacearr, lnor_space, mlfan_vert_index, NULL, false);
-      if (me_curr != me_org) {
-        /* We store here all edges-normalized vectors processed. */
-        BLI_stack_push(edge_vectors, vec_curr);
-      }
-    }
-
-    if (IS_EDGE_SHARP(e2lfan_curr) || (me_curr == me_org)) {
+    if (IS_EDGE_SHARP(e2lfan_curr) || (me_curr == fan.me_org)) {
       /* Current edge is sharp and we have finished with this fan of faces around this vert,
        * or this vert is smooth, and we have completed a full turn around it.
        */
@@ -1231,14 +1413,12 @@ static void split_loop_nor_fan_do(LoopSplitTaskDataCommon *common_data, LoopSpli
       break;
     }
 
-    copy_v3_v3(vec_prev, vec_curr);
-
     /* Find next loop of the smooth fan. */
     BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
                                                 mpolys,
                                                 loop_to_poly,
                                                 e2lfan_curr,
-                                                mv_pivot_index,
+                                                fan.mv_pivot_index,
                                                 &mlfan_curr,
                                                 &mlfan_curr_index,
                                                 &mlfan_vert_index,
@@ -1247,56 +1427,29 @@ static void split_loop_nor_fan_do(LoopSplitTaskDataCommon *common_data, LoopSpli
     e2lfan_curr = edge_to_loops[mlfan_curr->e];
   }
 
-  {
-    float lnor_len = normalize_v3(lnor);
-
-    /* If we are generating lnor spacearr, we can now define the one for this fan,
-     * and optionally compute final lnor from custom data too!
-     */
-    if (lnors_spacearr) {
-      if (UNLIKELY(lnor_len == 0.0f)) {
-        /* Use vertex normal as fallback! */
-        copy_v3_v3(lnor, loopnors[mlfan_vert_index]);
-        lnor_len = 1.0f;
-      }
-
-      BKE_lnor_space_define(lnor_space, lnor, vec_org, vec_curr, edge_vectors);
-
-      if (clnors_data) {
-        if (clnors_invalid) {
-          short *clnor;
-
-          clnors_avg[0] /= clnors_nbr;
-          clnors_avg[1] /= clnors_nbr;
-          /* Fix/update all clnors of this fan with computed average value. */
-          if (G.debug & G_DEBUG) {
-            printf("Invalid clnors in this fan!\n");
-          }
-          while ((clnor = BLI_SMALLSTACK_POP(clnors))) {
-            // print_v2("org clnor", clnor);
-            clnor[0] = (short)clnors_avg[0];
-            clnor[1] = (short)clnors_avg[1];
-          }
-          // print_v2("new clnors", clnors_avg);
-        }
-        /* Extra bonus: since small-stack is local to this function,
-         * no more need to empty it at all cost! */
+  short clnor_fix[2];
+  bool do_clnor_fix;
+  const bool is_valid = split_loop_nor_fan_end(
+      common_data, &fan, lnor_space, edge_vectors, mlfan_vert_index, clnor_fix, &do_clnor_fix);
 
-        BKE_lnor_space_custom_data_to_normal(lnor_space, *clnor_ref, lnor);
-      }
+  if (do_clnor_fix) {
+    short *clnor;
+    while ((clnor = BLI_SMALLSTACK_POP(clnors))) {
+      // print_v2("org clnor", clnor);
+      clnor[0] = clnor_fix[0];
+      clnor[1] = clnor_fix[1];
     }
+  }
+  /* Extra bonus: since small-stack is local to this function,
+   * no more need to empty it at all cost! */
 
-    /* In case we get a zero normal here, just use vertex normal already set! */
-    if (LIKELY(lnor_len != 0.0f)) {
-      /* Copy back the final computed normal into all related loop-normals. */
-      float *nor;
+  if (is_valid) {
+    /* Copy back the final computed normal into all related loop-normals. */
+    float *nor;
 
-      while ((nor = BLI_SMALLSTACK_POP(normal))) {
-        copy_v3_v3(nor, lnor);
-      }
+    while ((nor = BLI_SMALLSTACK_POP(normal))) {
+      copy_v3_v3(nor, fan.lnor);
     }
-    /* Extra bonus: since small-stack is local to this function,
-     * no more need to empty it at all cost! */
   }
 }
 
@@ -1601,13 +1754,620 @@ static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common
 #endif
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Loop Fan Cache
+ *
+ * Walking the smooth fans around vertices only depends on the topology, the sharp and smooth
+ * flags, and the edges made sharp by the split angle. When those did not change (e.g. a mesh
+ * deformed by an armature), the fans found by a previous evaluation are used as is,
+ * and only the normals are computed again.
+ * \{ */
+
+struct MLoopFanCache {
+  uint32_t topology_hash;
+  int numEdges;
+  int numLoops;
+  int numPolys;
+
+  int *loop_to_poly;
+  /** Edges made sharp by the split angle when the fans were found. */
+  bool *angle_sharp_edges;
+
+  /**
+   * Fans in the order they are found by #loop_split_generator, with the lnor spaces
+   * created in the same order. Each fan has (fan_offsets[i + 1] - fan_offsets[i]) steps.
+   * A fan with a single step is a loop with two sharp edges, its step edge is the previous
+   * edge of the loop. Otherwise steps are in walking order, the first step loop is the one
+   * which started the fan.
+   */
+  int fans_num;
+  int *fan_offsets;
+  /** Vertex loop, poly and edge of each step. */
+  int *step_loops;
+  int *step_polys;
+  int *step_edges;
+};
+
+void BKE_mesh_loop_fan_cache_free(MLoopFanCache *fan_cache)
+{
+  MEM_SAFE_FREE(fan_cache->loop_to_poly);
+  MEM_SAFE_FREE(fan_cache->angle_sharp_edges);
+  MEM_SAFE_FREE(fan_cache->fan_offsets);
+  MEM_SAFE_FREE(fan_cache->step_loops);
+  MEM_SAFE_FREE(fan_cache->step_polys);
+  MEM_SAFE_FREE(fan_cache->step_edges);
+  MEM_freeN(fan_cache);
+}
+
+static uint32_t loop_fan_cache_topology_hash(const LoopSplitTaskDataCommon *common_data)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+
+  BLI_hash_mm2a_add_int(&mm2, common_data->numEdges);
+  BLI_hash_mm2a_add_int(&mm2, common_data->numLoops);
+  BLI_hash_mm2a_add_int(&mm2, common_data->numPolys);
+
+  const MEdge *me = common_data->medges;
+  for (int i = 0; i < common_data->numEdges; i++, me++) {
+    BLI_hash_mm2a_add_int(&mm2, (int)me->v1);
+    BLI_hash_mm2a_add_int(&mm2, (int)me->v2);
+    BLI_hash_mm2a_add_int(&mm2, me->flag & ME_SHARP);
+  }
+  const MLoop *ml = common_data->mloops;
+  for (int i = 0; i < common_data->numLoops; i++, ml++) {
+    BLI_hash_mm2a_add_int(&mm2, (int)ml->v);
+    BLI_hash_mm2a_add_int(&mm2, (int)ml->e);
+  }
+  const MPoly *mp = common_data->mpolys;
+  for (int i = 0; i < common_data->numPolys; i++, mp++) {
+    BLI_hash_mm2a_add_int(&mm2, mp->loopstart);
+    BLI_hash_mm2a_add_int(&mm2, mp->totloop);
+    BLI_hash_mm2a_add_int(&mm2, mp->flag & ME_SMOOTH);
+  }
+
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+typedef struct LoopFanCacheTaskData {
+  const LoopSplitTaskDataCommon *common_data;
+  const MLoopFanCache *fan_cache;
+  MLoopNorSpace **lnor_spaces;
+
+  /* Angle sharp edges. */
+  const int (*edge_to_loops)[2];
+  float split_angle_cos;
+  bool *r_angle_sharp_edges;
+} LoopFanCacheTaskData;
+
+static void loop_fan_cache_angle_sharp_cb(void *__restrict userdata,
+                                          const int me_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopFanCacheTaskData *data = userdata;
+  const int *e2l = data->edge_to_loops[me_index];
+  const int *loop_to_poly = data->fan_cache->loop_to_poly;
+  const float(*polynors)[3] = data->common_data->polynors;
+
+  /* Same test as #mesh_edges_sharp_tag, on the edges which are smooth without it.
+   * Loose edges keep their initial `{0, 0}` loops and are skipped. */
+  data->r_angle_sharp_edges[me_index] = (!IS_EDGE_SHARP(e2l) && (e2l[0] != e2l[1]) &&
+                                         dot_v3v3(polynors[loop_to_poly[e2l[0]]],
+                                                  polynors[loop_to_poly[e2l[1]]]) <
+                                             data->split_angle_cos);
+}
+
+/**
+ * Find edges made sharp by the split angle, for the edges smooth from the topology and flags.
+ * \note Edges tagged as sharp by it stay smooth in \a edge_to_loops.
+ */
+static bool *loop_fan_cache_angle_sharp_edges(const LoopSplitTaskDataCommon *common_data,
+                                              const MLoopFanCache *fan_cache,
+                                              const int (*edge_to_loops)[2],
+                                              const bool check_angle,
+                                              const float split_angle)
+{
+  const int numEdges = common_data->numEdges;
+
+  if (!check_angle) {
+    return MEM_calloc_arrayN((size_t)numEdges, sizeof(bool), __func__);
+  }
+
+  LoopFanCacheTaskData data = {
+      .common_data = common_data,
+      .fan_cache = fan_cache,
+      .edge_to_loops = edge_to_loops,
+      .split_angle_cos = cosf(split_angle),
+      .r_angle_sharp_edges = MEM_malloc_arrayN((size_t)numEdges, sizeof(bool), __func__),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numEdges >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  BLI_task_parallel_range(0, numEdges, &data, loop_fan_cache_angle_sharp_cb, &settings);
+
+  return data.r_angle_sharp_edges;
+}
+
+static void loop_fan_cache_add_step(MLoopFanCache *fan_cache,
+                                    int *steps_len_alloc,
+                                    const int ml_index,
+                                    const int mp_index,
+                                    const int me_index)
+{
+  const int step = fan_cache->fan_offsets[fan_cache->fans_num + 1]++;
+  if (UNLIKELY(step == *steps_len_alloc)) {
+    /* Each loop is normally in a single fan, only degenerate topology needs to grow. */
+    *steps_len_alloc *= 2;
+    const size_t size = sizeof(int) * (size_t)*steps_len_alloc;
+    fan_cache->step_loops = MEM_reallocN(fan_cache->step_loops, size);
+    fan_cache->step_polys = MEM_reallocN(fan_cache->step_polys, size);
+    fan_cache->step_edges = MEM_reallocN(fan_cache->step_edges, size);
+  }
+  fan_cache->step_loops[step] = ml_index;
+  fan_cache->step_polys[step] = mp_index;
+  fan_cache->step_edges[step] = me_index;
+}
+
+/* Same walk as #split_loop_nor_fan_do. */
+static void loop_fan_cache_add_fan(const LoopSplitTaskDataCommon *common_data,
+                                   MLoopFanCache *fan_cache,
+                                   int *steps_len_alloc,
+                                   const int *e2l_prev,
+                                   const MLoop *ml_curr,
+                                   const MLoop *ml_prev,
+                                   const int ml_curr_index,
+                                   const int ml_prev_index,
+                                   const int mp_index)
+{
+  const MLoop *mloops = common_data->mloops;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+
+  const unsigned int mv_pivot_index = ml_curr->v;
+  const unsigned int me_org_index = ml_curr->e;
+
+  const int *e2lfan_curr = e2l_prev;
+  const MLoop *mlfan_curr = ml_prev;
+  int mlfan_curr_index = ml_prev_index;
+  int mlfan_vert_index = ml_curr_index;
+  int mpfan_curr_index = mp_index;
+
+  while (true) {
+    loop_fan_cache_add_step(
+        fan_cache, steps_len_alloc, mlfan_vert_index, mpfan_curr_index, (int)mlfan_curr->e);
+
+    if (IS_EDGE_SHARP(e2lfan_curr) || (mlfan_curr->e == me_org_index)) {
+      break;
+    }
+
+    BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
+                                                common_data->mpolys,
+                                                common_data->loop_to_poly,
+                                                e2lfan_curr,
+                                                mv_pivot_index,
+                                                &mlfan_curr,
+                                                &mlfan_curr_index,
+                                                &mlfan_vert_index,
+                                                &mpfan_curr_index);
+
+    e2lfan_curr = edge_to_loops[mlfan_curr->e];
+  }
+}
+
+/* Same loop as #loop_split_generator, storing the fans instead of computing their normals. */
+static void loop_fan_cache_add_fans(const LoopSplitTaskDataCommon *common_data,
+                                    MLoopFanCache *fan_cache)
+{
+  const MLoop *mloops = common_data->mloops;
+  const MPoly *mpolys = common_data->mpolys;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const int *loop_to_poly = common_data->loop_to_poly;
+  const int numLoops = common_data->numLoops;
+  const int numPolys = common_data->numPolys;
+
+  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
+
+  int steps_len_alloc = max_ii(numLoops, 1);
+  fan_cache->fan_offsets = MEM_calloc_arrayN(
+      (size_t)numLoops + 1, sizeof(*fan_cache->fan_offsets), __func__);
+  fan_cache->step_loops = MEM_malloc_arrayN((size_t)steps_len_alloc, sizeof(int), __func__);
+  fan_cache->step_polys = MEM_malloc_arrayN((size_t)steps_len_alloc, sizeof(int), __func__);
+  fan_cache->step_edges = MEM_malloc_arrayN((size_t)steps_len_alloc, sizeof(int), __func__);
+  fan_cache->fans_num = 0;
+
+  const MPoly *mp;
+  int mp_index;
+  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
+    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+    int ml_curr_index = mp->loopstart;
+    int ml_prev_index = ml_last_index;
+
+    const MLoop *ml_curr = &mloops[ml_curr_index];
+    const MLoop *ml_prev = &mloops[ml_prev_index];
+
+    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++) {
+      const int *e2l_curr = edge_to_loops[ml_curr->e];
+      const int *e2l_prev = edge_to_loops[ml_prev->e];
+
+      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
+                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
+                                                                                     mpolys,
+                                                                                     edge_to_loops,
+                                                                                     loop_to_poly,
+                                                                                     e2l_prev,
+                                                                                     skip_loops,
+                                                                                     ml_curr,
+                                                                                     ml_prev,
+                                                                                     ml_curr_index,
+                                                                                     ml_prev_index,
+                                                                                     mp_index))) {
+        /* Skip. */
+      }
+      else {
+        fan_cache->fan_offsets[fan_cache->fans_num + 1] =
+            fan_cache->fan_offsets[fan_cache->fans_num];
+
+        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
+          loop_fan_cache_add_step(
+              fan_cache, &steps_len_alloc, ml_curr_index, mp_index, (int)ml_prev->e);
+        }
+        else {
+          loop_fan_cache_add_fan(common_data,
+                                 fan_cache,
+                                 &steps_len_alloc,
+                                 e2l_prev,
+                                 ml_curr,
+                                 ml_prev,
+                                 ml_curr_index,
+                                 ml_prev_index,
+                                 mp_index);
+          BLI_assert(fan_cache->fan_offsets[fan_cache->fans_num + 1] -
+                         fan_cache->fan_offsets[fan_cache->fans_num] >
+                     1);
+        }
+        fan_cache->fans_num++;
+      }
+
+      ml_prev = ml_curr;
+      ml_prev_index = ml_curr_index;
+    }
+  }
+
+  MEM_freeN(skip_loops);
+}
+
+static MLoopFanCache *loop_fan_cache_create(LoopSplitTaskDataCommon *common_data,
+                                            const uint32_t topology_hash,
+                                            const bool check_angle,
+                                            const float split_angle,
+                                            bool *angle_sharp_edges)
+{
+  const int numEdges = common_data->numEdges;
+  const int numLoops = common_data->numLoops;
+
+  MLoopFanCache *fan_cache = MEM_callocN(sizeof(*fan_cache), __func__);
+  fan_cache->topology_hash = topology_hash;
+  fan_cache->numEdges = numEdges;
+  fan_cache->numLoops = numLoops;
+  fan_cache->numPolys = common_data->numPolys;
+  fan_cache->loop_to_poly = MEM_malloc_arrayN(
+      (size_t)numLoops, sizeof(*fan_cache->loop_to_poly), __func__);
+
+  /* See #BKE_mesh_normals_loop_split for details about this mapping. */
+  int(*edge_to_loops)[2] = MEM_calloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
+  float(*loopnors)[3] = common_data->loopnors;
+
+  common_data->edge_to_loops = edge_to_loops;
+  common_data->loop_to_poly = fan_cache->loop_to_poly;
+  common_data->loopnors = NULL;
+  mesh_edges_sharp_tag(common_data, false, split_angle, false);
+  common_data->loopnors = loopnors;
+
+  if (angle_sharp_edges == NULL) {
+    angle_sharp_edges = loop_fan_cache_angle_sharp_edges(
+        common_data, fan_cache, (const int(*)[2])edge_to_loops, check_angle, split_angle);
+  }
+  fan_cache->angle_sharp_edges = angle_sharp_edges;
+  for (int me_index = 0; me_index < numEdges; me_index++) {
+    if (angle_sharp_edges[me_index]) {
+      edge_to_loops[me_index][1] = INDEX_INVALID;
+    }
+  }
+
+  loop_fan_cache_add_fans(common_data, fan_cache);
+
+  MEM_freeN(edge_to_loops);
+  common_data->edge_to_loops = NULL;
+  common_data->loop_to_poly = NULL;
+
+  return fan_cache;
+}
+
+/**
+ * Return the cache in \a fan_cache_p if it is still valid, otherwise free it and create a new one.
+ */
+static MLoopFanCache *loop_fan_cache_ensure(LoopSplitTaskDataCommon *common_data,
+                                            MLoopFanCache **fan_cache_p,
+                                            const bool check_angle,
+                                            const float split_angle)
+{
+  MLoopFanCache *fan_cache = *fan_cache_p;
+  const uint32_t topology_hash = loop_fan_cache_topology_hash(common_data);
+  bool *angle_sharp_edges = NULL;
+
+  if (fan_cache != NULL) {
+    bool is_valid = (fan_cache->topology_hash == topology_hash) &&
+                    (fan_cache->numEdges == common_data->numEdges) &&
+                    (fan_cache->numLoops == common_data->numLoops) &&
+                    (fan_cache->numPolys == common_data->numPolys);
+
+    if (is_valid) {
+      /* Polygon normals are not part of the topology, edges sharp from the split angle are
+       * found again. This only needs the edge to loops mapping, which is cheap compared to
+       * walking the fans. */
+      int(*edge_to_loops)[2] = NULL;
+      if (check_angle) {
+        float(*loopnors)[3] = common_data->loopnors;
+        edge_to_loops = MEM_calloc_arrayN(
+            (size_t)common_data->numEdges, sizeof(*edge_to_loops), __func__);
+
+        common_data->edge_to_loops = edge_to_loops;
+        /* Same topology, the values written are the same. */
+        common_data->loop_to_poly = fan_cache->loop_to_poly;
+        common_data->loopnors = NULL;
+        mesh_edges_sharp_tag(common_data, false, split_angle, false);
+        common_data->loopnors = loopnors;
+        common_data->edge_to_loops = NULL;
+        common_data->loop_to_poly = NULL;
+      }
+
+      angle_sharp_edges = loop_fan_cache_angle_sharp_edges(
+          common_data, fan_cache, (const int(*)[2])edge_to_loops, check_angle, split_angle);
+      MEM_SAFE_FREE(edge_to_loops);
+
+      is_valid = memcmp(angle_sharp_edges,
+                        fan_cache->angle_sharp_edges,
+                        sizeof(bool) * (size_t)common_data->numEdges) == 0;
+    }
+
+    if (is_valid) {
+      MEM_freeN(angle_sharp_edges);
+      return fan_cache;
+    }
+
+    /* When only the angle sharp edges changed, they're used for the new cache. */
+    BKE_mesh_loop_fan_cache_free(fan_cache);
+  }
+
+  fan_cache = loop_fan_cache_create(
+      common_data, topology_hash, check_angle, split_angle, angle_sharp_edges);
+  *fan_cache_p = fan_cache;
+  return fan_cache;
+}
+
+/* Same as #split_loop_nor_single_do and #split_loop_nor_fan_do, from a stored fan. */
+static void loop_fan_cache_fan_do(const LoopSplitTaskDataCommon *common_data,
+                                  const MLoopFanCache *fan_cache,
+                                  const int fan_index,
+                                  MLoopNorSpace *lnor_space,
+                                  BLI_Stack *edge_vectors)
+{
+  float(*loopnors)[3] = common_data->loopnors;
+  short(*clnors_data)[2] = common_data->clnors_data;
+
+  const MEdge *medges = common_data->medges;
+  const MLoop *mloops = common_data->mloops;
+
+  const int step_start = fan_cache->fan_offsets[fan_index];
+  const int step_end = fan_cache->fan_offsets[fan_index + 1];
+  const int *step_loops = fan_cache->step_loops;
+  const int *step_polys = fan_cache->step_polys;
+  const int *step_edges = fan_cache->step_edges;
+
+  const int ml_curr_index = step_loops[step_start];
+  const MLoop *ml_curr = &mloops[ml_curr_index];
+
+  if (step_end - step_start == 1) {
+    float *lnor = loopnors[ml_curr_index];
+    copy_v3_v3(lnor, common_data->polynors[step_polys[step_start]]);
+
+    if (common_data->lnors_spacearr) {
+      split_loop_nor_single_space_do(common_data,
+                                     lnor_space,
+                                     lnor,
+                                     ml_curr_index,
+                                     &medges[ml_curr->e],
+                                     &medges[step_edges[step_start]]);
+    }
+    return;
+  }
+
+  LoopSplitFan fan;
+  split_loop_nor_fan_begin(common_data, &fan, ml_curr, edge_vectors);
+
+  for (int step = step_start; step < step_end; step++) {
+    split_loop_nor_fan_step(common_data,
+                            &fan,
+                            lnor_space,
+                            edge_vectors,
+                            &medges[step_edges[step]],
+                            step_polys[step],
+                            step_loops[step]);
+  }
+
+  short clnor_fix[2];
+  bool do_clnor_fix;
+  const bool is_valid = split_loop_nor_fan_end(common_data,
+                                               &fan,
+                                               lnor_space,
+                                               edge_vectors,
+                                               step_loops[step_end - 1],
+                                               clnor_fix,
+                                               &do_clnor_fix);
+
+  for (int step = step_start; step < step_end; step++) {
+    if (do_clnor_fix) {
+      short *clnor = clnors_data[step_loops[step]];
+      clnor[0] = clnor_fix[0];
+      clnor[1] = clnor_fix[1];
+    }
+    if (is_valid) {
+      copy_v3_v3(loopnors[step_loops[step]], fan.lnor);
+    }
+  }
+}
+
+typedef struct LoopFanCacheTLS {
+  /** Only used when computing lnor spacearr. */
+  BLI_Stack *edge_vectors;
+} LoopFanCacheTLS;
+
+static void loop_fan_cache_fan_cb(void *__restrict userdata,
+                                  const int fan_index,
+                                  const TaskParallelTLS *__restrict tls)
+{
+  LoopFanCacheTaskData *data = userdata;
+  LoopFanCacheTLS *fan_tls = tls->userdata_chunk;
+  MLoopNorSpace *lnor_space = NULL;
+
+  if (data->lnor_spaces) {
+    lnor_space = data->lnor_spaces[fan_index];
+    if (fan_tls->edge_vectors == NULL) {
+      fan_tls->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+    }
+  }
+
+  loop_fan_cache_fan_do(
+      data->common_data, data->fan_cache, fan_index, lnor_space, fan_tls->edge_vectors);
+}
+
+static void loop_fan_cache_fan_free(const void *__restrict UNUSED(userdata),
+                                    void *__restrict chunk)
+{
+  LoopFanCacheTLS *fan_tls = chunk;
+  if (fan_tls->edge_vectors) {
+    BLI_stack_free(fan_tls->edge_vectors);
+  }
+}
+
+static void loop_fan_cache_vert_normals_cb(void *__restrict userdata,
+                                           const int ml_index,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopFanCacheTaskData *data = userdata;
+  const LoopSplitTaskDataCommon *common_data = data->common_data;
+
+  /* Same as #mesh_edges_sharp_tag. */
+  normal_short_to_float_v3(common_data->loopnors[ml_index],
+                           common_data->mverts[common_data->mloops[ml_index].v].no);
+}
+
+static void loop_split_from_fan_cache(LoopSplitTaskDataCommon *common_data,
+                                      const MLoopFanCache *fan_cache,
+                                      int *r_loop_to_poly)
+{
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  const int numLoops = common_data->numLoops;
+
+  if (r_loop_to_poly) {
+    memcpy(r_loop_to_poly, fan_cache->loop_to_poly, sizeof(*r_loop_to_poly) * (size_t)numLoops);
+  }
+
+  LoopFanCacheTaskData data = {
+      .common_data = common_data,
+      .fan_cache = fan_cache,
+  };
+
+  /* Spaces are allocated from a memarena, which is not thread safe. */
+  if (lnors_spacearr) {
+    data.lnor_spaces = MEM_malloc_arrayN(
+        (size_t)fan_cache->fans_num, sizeof(*data.lnor_spaces), __func__);
+    for (int fan_index = 0; fan_index < fan_cache->fans_num; fan_index++) {
+      data.lnor_spaces[fan_index] = BKE_lnor_space_create(lnors_spacearr);
+    }
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  BLI_task_parallel_range(0, numLoops, &data, loop_fan_cache_vert_normals_cb, &settings);
+
+  LoopFanCacheTLS fan_tls = {NULL};
+  settings.userdata_chunk = &fan_tls;
+  settings.userdata_chunk_size = sizeof(fan_tls);
+  settings.func_free = loop_fan_cache_fan_free;
+  BLI_task_parallel_range(0, fan_cache->fans_num, &data, loop_fan_cache_fan_cb, &settings);
+
+  MEM_SAFE_FREE(data.lnor_spaces);
+}
+
+/** \} */
+
+/* Find the smooth fans and compute their normals, without cache. */
+static void mesh_normals_loop_split_fans(LoopSplitTaskDataCommon *common_data,
+                                         const bool check_angle,
+                                         const float split_angle,
+                                         int *r_loop_to_poly)
+{
+  const int numEdges = common_data->numEdges;
+  const int numLoops = common_data->numLoops;
+
+  /**
+   * Mapping edge -> loops.
+   * If that edge is used by more than two loops (polys),
+   * it is always sharp (and tagged as such, see below).
+   * We also use the second loop index as a kind of flag:
+   *
+   * - smooth edge: > 0.
+   * - sharp edge: < 0 (INDEX_INVALID || INDEX_UNSET).
+   * - unset: INDEX_UNSET.
+   *
+   * Note that currently we only have two values for second loop of sharp edges.
+   * However, if needed, we can store the negated value of loop index instead of INDEX_INVALID
+   * to retrieve the real value later in code).
+   * Note also that lose edges always have both values set to 0! */
+  int(*edge_to_loops)[2] = MEM_calloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
+
+  /* Simple mapping from a loop to its polygon index. */
+  int *loop_to_poly = r_loop_to_poly ?
+                          r_loop_to_poly :
+                          MEM_malloc_arrayN((size_t)numLoops, sizeof(*loop_to_poly), __func__);
+
+  common_data->edge_to_loops = edge_to_loops;
+  common_data->loop_to_poly = loop_to_poly;
+
+  /* This first loop check which edges are actually smooth, and compute edge vectors. */
+  mesh_edges_sharp_tag(common_data, check_angle, split_angle, false);
+
+  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
+    /* Not enough loops to be worth the whole threading overhead... */
+    loop_split_generator(NULL, common_data);
+  }
+  else {
+    TaskPool *task_pool = BLI_task_pool_create(common_data, TASK_PRIORITY_HIGH);
+
+    loop_split_generator(task_pool, common_data);
+
+    BLI_task_pool_work_and_wait(task_pool);
+
+    BLI_task_pool_free(task_pool);
+  }
+
+  MEM_freeN(edge_to_loops);
+  if (!r_loop_to_poly) {
+    MEM_freeN(loop_to_poly);
+  }
+  common_data->edge_to_loops = NULL;
+  common_data->loop_to_poly = NULL;
+}
+
 /**
  * Compute split normals, i.e. vertex normals associated with each poly (hence 'loop normals').
  * Useful to materialize sharp edges (or non-smooth faces) without actually modifying the geometry
  * (splitting edges).
  */
 void BKE_mesh_normals_loop_split(const MVert *mverts,
-                                 const int UNUSED(numVerts),
+                                 const int numVerts,
                                  MEdge *medges,
                                  const int numEdges,
                                  MLoop *mloops,
@@ -1621,6 +2381,49 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
                                  MLoopNorSpaceArray *r_lnors_spacearr,
                                  short (*clnors_data)[2],
                                  int *r_loop_to_poly)
+{
+  BKE_mesh_normals_loop_split_ex(mverts,
+                                 numVerts,
+                                 medges,
+                                 numEdges,
+                                 mloops,
+                                 r_loopnors,
+                                 numLoops,
+                                 mpolys,
+                                 polynors,
+                                 numPolys,
+                                 use_split_normals,
+                                 split_angle,
+                                 r_lnors_spacearr,
+                                 clnors_data,
+                                 r_loop_to_poly,
+                                 NULL);
+}
+
+/**
+ * Same as #BKE_mesh_normals_loop_split, \a fan_cache_p stores the smooth fans around vertices
+ * for the next calls. As long as the topology, sharp and smooth flags, and edges sharp from the
+ * split angle don't change, the fans are not searched again (e.g. for deformed meshes).
+ *
+ * \param fan_cache_p: Pointer to a cache from a previous call or NULL, it is replaced when not
+ * valid anymore. Free with #BKE_mesh_loop_fan_cache_free.
+ */
+void BKE_mesh_normals_loop_split_ex(const MVert *mverts,
+                                    const int UNUSED(numVerts),
+                                    MEdge *medges,
+                                    const int numEdges,
+                                    MLoop *mloops,
+                                    float (*r_loopnors)[3],
+                                    const int numLoops,
+                                    MPoly *mpolys,
+                                    const float (*polynors)[3],
+                                    const int numPolys,
+                                    const bool use_split_normals,
+                                    const float split_angle,
+                                    MLoopNorSpaceArray *r_lnors_spacearr,
+                                    short (*clnors_data)[2],
+                                    int *r_loop_to_poly,
+                                    MLoopFanCache **fan_cache_p)
 {
   /* For now this is not supported.
    * If we do not use split normals, we do not generate anything fancy! */
@@ -1657,27 +2460,6 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
     return;
   }
 
-  /**
-   * Mapping edge -> loops.
-   * If that edge is used by more than two loops (polys),
-   * it is always sharp (and tagged as such, see below).
-   * We also use the second loop index as a kind of flag:
-   *
-   * - smooth edge: > 0.
-   * - sharp edge: < 0 (INDEX_INVALID || INDEX_UNSET).
-   * - unset: INDEX_UNSET.
-   *
-   * Note that currently we only have two values for second loop of sharp edges.
-   * However, if needed, we can store the negated value of loop index instead of INDEX_INVALID
-   * to retrieve the real value later in code).
-   * Note also that lose edges always have both values set to 0! */
-  int(*edge_to_loops)[2] = MEM_calloc_arrayN((size_t)numEdges, sizeof(*edge_to_loops), __func__);
-
-  /* Simple mapping from a loop to its polygon index. */
-  int *loop_to_poly = r_loop_to_poly ?
-                          r_loop_to_poly :
-                          MEM_malloc_arrayN((size_t)numLoops, sizeof(*loop_to_poly), __func__);
-
   /* When using custom loop normals, disable the angle feature! */
   const bool check_angle = (split_angle < (float)M_PI) && (clnors_data == NULL);
 
@@ -1704,34 +2486,19 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
       .medges = medges,
       .mloops = mloops,
       .mpolys = mpolys,
-      .edge_to_loops = edge_to_loops,
-      .loop_to_poly = loop_to_poly,
       .polynors = polynors,
       .numEdges = numEdges,
       .numLoops = numLoops,
       .numPolys = numPolys,
   };
 
-  /* This first loop check which edges are actually smooth, and compute edge vectors. */
-  mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
-
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
+  if (fan_cache_p) {
+    const MLoopFanCache *fan_cache = loop_fan_cache_ensure(
+        &common_data, fan_cache_p, check_angle, split_angle);
+    loop_split_from_fan_cache(&common_data, fan_cache, r_loop_to_poly);
   }
   else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
-
-    loop_split_generator(task_pool, &common_data);
-
-    BLI_task_pool_work_and_wait(task_pool);
-
-    BLI_task_pool_free(task_pool);
-  }
-
-  MEM_freeN(edge_to_loops);
-  if (!r_loop_to_poly) {
-    MEM_freeN(loop_to_poly);
+    mesh_normals_loop_split_fans(&common_data, check_angle, split_angle, r_loop_to_poly);
   }
 
   if (r_lnors_spacearr) {
@@ -21,6 +21,8 @@
  * \ingroup bke
  */
 
+#include "BLI_bitmap.h"
+#include "BLI_hash_mm2a.h"
 #include "BLI_math.h"
 
 #include "DNA_mesh_types.h"
@@ -97,6 +99,46 @@ Mesh *BKE_mesh_mirror_bisect_on_mirror_plane(MirrorModifierData *mmd,
   return result;
 }
 
+/* Calculate the mirror transformation of \a axis and the mirror plane used for bisecting. */
+static void mesh_mirror_transform_calc(const MirrorModifierData *mmd,
+                                       const Object *ob,
+                                       const int axis,
+                                       float r_mtx[4][4],
+                                       float r_plane_co[3],
+                                       float r_plane_no[3])
+{
+  /* mtx is the mirror transformation */
+  unit_m4(r_mtx);
+  r_mtx[axis][axis] = -1.0f;
+
+  Object *mirror_ob = mmd->mirror_ob;
+  if (mirror_ob != NULL) {
+    float tmp[4][4];
+    float itmp[4][4];
+
+    /* tmp is a transform from coords relative to the object's own origin,
+     * to coords relative to the mirror object origin */
+    invert_m4_m4(tmp, mirror_ob->obmat);
+    mul_m4_m4m4(tmp, tmp, ob->obmat);
+
+    /* itmp is the reverse transform back to origin-relative coordinates */
+    invert_m4_m4(itmp, tmp);
+
+    /* combine matrices to get a single matrix that translates coordinates into
+     * mirror-object-relative space, does the mirror, and translates back to
+     * origin-relative space */
+    mul_m4_series(r_mtx, itmp, r_mtx, tmp);
+
+    copy_v3_v3(r_plane_co, itmp[3]);
+    copy_v3_v3(r_plane_no, itmp[axis]);
+  }
+  else {
+    copy_v3_v3(r_plane_co, r_mtx[3]);
+    /* Need to negate here, since that axis is inverted (for mirror transform). */
+    negate_v3_v3(r_plane_no, r_mtx[axis]);
+  }
+}
+
 Mesh *BKE_mesh_mirror_apply_mirror_on_axis(MirrorModifierData *mmd,
                                            const ModifierEvalContext *UNUSED(ctx),
                                            Object *ob,
@@ -122,38 +164,7 @@ Mesh *BKE_mesh_mirror_apply_mirror_on_axis(MirrorModifierData *mmd,
   int a, totshape;
   int *vtargetmap = NULL, *vtmap_a = NULL, *vtmap_b = NULL;
 
-  /* mtx is the mirror transformation */
-  unit_m4(mtx);
-  mtx[axis][axis] = -1.0f;
-
-  Object *mirror_ob = mmd->mirror_ob;
-  if (mirror_ob != NULL) {
-    float tmp[4][4];
-    float itmp[4][4];
-
-    /* tmp is a transform from coords relative to the object's own origin,
-     * to coords relative to the mirror object origin */
-    invert_m4_m4(tmp, mirror_ob->obmat);
-    mul_m4_m4m4(tmp, tmp, ob->obmat);
-
-    /* itmp is the reverse transform back to origin-relative coordinates */
-    invert_m4_m4(itmp, tmp);
-
-    /* combine matrices to get a single matrix that translates coordinates into
-     * mirror-object-relative space, does the mirror, and translates back to
-     * origin-relative space */
-    mul_m4_series(mtx, itmp, mtx, tmp);
-
-    if (do_bisect) {
-      copy_v3_v3(plane_co, itmp[3]);
-      copy_v3_v3(plane_no, itmp[axis]);
-    }
-  }
-  else if (do_bisect) {
-    copy_v3_v3(plane_co, mtx[3]);
-    /* Need to negate here, since that axis is inverted (for mirror transform). */
-    negate_v3_v3(plane_no, mtx[axis]);
-  }
+  mesh_mirror_transform_calc(mmd, ob, axis, mtx, plane_co, plane_no);
 
   Mesh *mesh_bisect = NULL;
   if (do_bisect) {
@@ -431,3 +442,316 @@ Mesh *BKE_mesh_mirror_apply_mirror_on_axis(MirrorModifierData *mmd,
 
   return result;
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Mirror Cache
+ *
+ * The topology of the mirrored mesh only depends on the topology of the input mesh, the modifier
+ * settings and which vertices got merged with their mirrored copy. When only vertex positions of
+ * the input changed since the previous evaluation, the previous result is copied and the vertex
+ * positions are remapped, instead of copying and reversing all custom data and merging vertices
+ * again.
+ *
+ * The positions are calculated the same way #BKE_mesh_mirror_apply_mirror_on_axis does for every
+ * mirrored axis, so the result matches a rebuilt mesh exactly.
+ * \{ */
+
+typedef struct MeshMirrorCacheAxis {
+  int axis;
+  /** Number of vertices of the mesh this axis is mirrored from. */
+  int verts_num;
+  /** Vertices merged with their mirrored copy, NULL when merging is disabled. */
+  BLI_bitmap *merged;
+} MeshMirrorCacheAxis;
+
+struct MeshMirrorCache {
+  uint32_t topology_hash;
+  uint32_t settings_hash;
+
+  MeshMirrorCacheAxis axes[3];
+  int axes_num;
+
+  /** Result of the previous evaluation, copied for the next one. */
+  Mesh *mesh;
+};
+
+void BKE_mesh_mirror_cache_free(MeshMirrorCache *mirror_cache)
+{
+  if (mirror_cache == NULL) {
+    return;
+  }
+  for (int i = 0; i < mirror_cache->axes_num; i++) {
+    MEM_SAFE_FREE(mirror_cache->axes[i].merged);
+  }
+  if (mirror_cache->mesh != NULL) {
+    BKE_id_free(NULL, mirror_cache->mesh);
+  }
+  MEM_freeN(mirror_cache);
+}
+
+/* Data which affects the result but is not stored in its vertex positions is not supported,
+ * bisecting also makes the topology depend on vertex positions. */
+static bool mesh_mirror_cache_supported(const MirrorModifierData *mmd, const Mesh *mesh)
+{
+  if (mmd->flag & (MOD_MIR_BISECT_AXIS_X | MOD_MIR_BISECT_AXIS_Y | MOD_MIR_BISECT_AXIS_Z)) {
+    return false;
+  }
+  if (CustomData_has_layer(&mesh->vdata, CD_SHAPEKEY) ||
+      CustomData_has_layer(&mesh->ldata, CD_CUSTOMLOOPNORMAL)) {
+    return false;
+  }
+  return (mmd->flag & (MOD_MIR_AXIS_X | MOD_MIR_AXIS_Y | MOD_MIR_AXIS_Z)) != 0;
+}
+
+/* Layers are copied to the result as they are on a cache hit, their layout must match. */
+static void mesh_mirror_cache_customdata_hash(BLI_HashMurmur2A *mm2, const CustomData *data)
+{
+  BLI_hash_mm2a_add_int(mm2, data->totlayer);
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    BLI_hash_mm2a_add_int(mm2, layer->type);
+    /* Whether the layer is shared with the original mesh doesn't change its content. */
+    BLI_hash_mm2a_add_int(mm2, layer->flag & ~CD_FLAG_NOFREE);
+    BLI_hash_mm2a_add(mm2, (const uchar *)layer->name, strlen(layer->name));
+  }
+}
+
+static uint32_t mesh_mirror_cache_topology_hash(const Mesh *mesh)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+
+  BLI_hash_mm2a_add_int(&mm2, mesh->totvert);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totedge);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totloop);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totpoly);
+
+  const MEdge *med = mesh->medge;
+  for (int i = 0; i < mesh->totedge; i++, med++) {
+    BLI_hash_mm2a_add_int(&mm2, (int)med->v1);
+    BLI_hash_mm2a_add_int(&mm2, (int)med->v2);
+  }
+  const MLoop *ml = mesh->mloop;
+  for (int i = 0; i < mesh->totloop; i++, ml++) {
+    BLI_hash_mm2a_add_int(&mm2, (int)ml->v);
+    BLI_hash_mm2a_add_int(&mm2, (int)ml->e);
+  }
+  const MPoly *mp = mesh->mpoly;
+  for (int i = 0; i < mesh->totpoly; i++, mp++) {
+    BLI_hash_mm2a_add_int(&mm2, mp->loopstart);
+    BLI_hash_mm2a_add_int(&mm2, mp->totloop);
+  }
+
+  mesh_mirror_cache_customdata_hash(&mm2, &mesh->vdata);
+  mesh_mirror_cache_customdata_hash(&mm2, &mesh->edata);
+  mesh_mirror_cache_customdata_hash(&mm2, &mesh->ldata);
+  mesh_mirror_cache_customdata_hash(&mm2, &mesh->pdata);
+
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+static uint32_t mesh_mirror_cache_settings_hash(const MirrorModifierData *mmd,
+                                                const Object *ob,
+                                                const Mesh *mesh)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+
+  BLI_hash_mm2a_add_int(&mm2, mmd->flag);
+  BLI_hash_mm2a_add(&mm2, (const uchar *)&mmd->tolerance, sizeof(mmd->tolerance));
+  BLI_hash_mm2a_add(&mm2, (const uchar *)mmd->uv_offset, sizeof(mmd->uv_offset));
+  BLI_hash_mm2a_add(&mm2, (const uchar *)mmd->uv_offset_copy, sizeof(mmd->uv_offset_copy));
+
+  /* Vertex groups are flipped by name. */
+  if ((mmd->flag & MOD_MIR_VGROUP) && CustomData_has_layer(&mesh->vdata, CD_MDEFORMVERT)) {
+    int flip_map_len = 0;
+    int *flip_map = BKE_object_defgroup_flip_map(ob, &flip_map_len, false);
+    BLI_hash_mm2a_add_int(&mm2, flip_map_len);
+    if (flip_map) {
+      BLI_hash_mm2a_add(&mm2, (const uchar *)flip_map, sizeof(*flip_map) * (size_t)flip_map_len);
+      MEM_freeN(flip_map);
+    }
+  }
+
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+/**
+ * Calculate the vertex positions of the mirrored mesh from \a vert_coords, one axis after the
+ * other. With \a do_init the merged vertices of every axis are stored in the cache, otherwise
+ * they are compared with the cached ones.
+ *
+ * \return the mirrored vertex positions, or NULL when different vertices got merged.
+ */
+static float (*mesh_mirror_cache_vert_coords_calc(MeshMirrorCache *mirror_cache,
+                                                  const MirrorModifierData *mmd,
+                                                  const Object *ob,
+                                                  float (*vert_coords)[3],
+                                                  const int verts_num,
+                                                  const bool do_init,
+                                                  int *r_verts_num))[3]
+{
+  const float tolerance_sq = mmd->tolerance * mmd->tolerance;
+  const bool do_vtargetmap = (mmd->flag & MOD_MIR_NO_MERGE) == 0;
+
+  float(*cos)[3] = vert_coords;
+  int cos_num = verts_num;
+
+  for (int a = 0; a < mirror_cache->axes_num; a++) {
+    MeshMirrorCacheAxis *cache_axis = &mirror_cache->axes[a];
+    float mtx[4][4];
+    float plane_co[3], plane_no[3];
+    mesh_mirror_transform_calc(mmd, ob, cache_axis->axis, mtx, plane_co, plane_no);
+
+    if (do_init) {
+      cache_axis->verts_num = cos_num;
+      cache_axis->merged = do_vtargetmap ? BLI_BITMAP_NEW(cos_num, __func__) : NULL;
+    }
+    else if (cache_axis->verts_num != cos_num) {
+      if (cos != vert_coords) {
+        MEM_freeN(cos);
+      }
+      return NULL;
+    }
+
+    /* The mirrored copies are written after the first half, of which the merged vertices are
+     * removed, see #BKE_mesh_merge_verts. */
+    float(*cos_next)[3] = MEM_malloc_arrayN((size_t)cos_num * 2, sizeof(*cos_next), __func__);
+    float(*cos_mirror)[3] = cos_next + cos_num;
+    int cos_next_num = 0;
+    bool is_valid = true;
+
+    for (int i = 0; i < cos_num; i++) {
+      mul_v3_m4v3(cos_mirror[i], mtx, cos[i]);
+
+      if (do_vtargetmap) {
+        const bool is_merged = len_squared_v3v3(cos[i], cos_mirror[i]) < tolerance_sq;
+        if (do_init) {
+          BLI_BITMAP_SET(cache_axis->merged, i, is_merged);
+        }
+        else if (is_merged != BLI_BITMAP_TEST_BOOL(cache_axis->merged, i)) {
+          is_valid = false;
+          break;
+        }
+        if (is_merged) {
+          /* average location */
+          mid_v3_v3v3(cos_mirror[i], cos[i], cos_mirror[i]);
+          continue;
+        }
+      }
+      copy_v3_v3(cos_next[cos_next_num++], cos[i]);
+    }
+
+    if (is_valid && cos_next_num != cos_num) {
+      memmove(cos_next + cos_next_num, cos_mirror, sizeof(*cos_mirror) * (size_t)cos_num);
+    }
+    cos_next_num += cos_num;
+
+    if (cos != vert_coords) {
+      MEM_freeN(cos);
+    }
+    if (!is_valid) {
+      MEM_freeN(cos_next);
+      return NULL;
+    }
+    cos = cos_next;
+    cos_num = cos_next_num;
+  }
+
+  *r_verts_num = cos_num;
+  return cos;
+}
+
+/**
+ * Mirror \a mesh using the result stored in \a mirror_cache by #BKE_mesh_mirror_cache_store.
+ * Only valid when nothing but vertex positions of the input changed since then,
+ * see #MOD_APPLY_TOPOLOGY_CACHE.
+ *
+ * \return the mirrored mesh or NULL when the cache can't be used.
+ */
+Mesh *BKE_mesh_mirror_cache_apply(MeshMirrorCache *mirror_cache,
+                                  const MirrorModifierData *mmd,
+                                  const Object *ob,
+                                  const Mesh *mesh)
+{
+  if (mirror_cache == NULL || mirror_cache->mesh == NULL ||
+      !mesh_mirror_cache_supported(mmd, mesh)) {
+    return NULL;
+  }
+  if ((mirror_cache->settings_hash != mesh_mirror_cache_settings_hash(mmd, ob, mesh)) ||
+      (mirror_cache->topology_hash != mesh_mirror_cache_topology_hash(mesh))) {
+    return NULL;
+  }
+
+  int verts_num;
+  float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, &verts_num);
+  float(*vert_coords_mirror)[3] = mesh_mirror_cache_vert_coords_calc(
+      mirror_cache, mmd, ob, vert_coords, verts_num, false, &verts_num);
+  MEM_freeN(vert_coords);
+
+  if (vert_coords_mirror == NULL) {
+    return NULL;
+  }
+  if (verts_num != mirror_cache->mesh->totvert) {
+    MEM_freeN(vert_coords_mirror);
+    return NULL;
+  }
+
+  Mesh *result = BKE_mesh_copy_for_eval(mirror_cache->mesh, false);
+  BKE_mesh_vert_coords_apply(result, (const float(*)[3])vert_coords_mirror);
+  MEM_freeN(vert_coords_mirror);
+
+  return result;
+}
+
+/**
+ * Store \a result, the mirrored \a mesh, in \a mirror_cache_p for #BKE_mesh_mirror_cache_apply.
+ * Frees the cache when \a mesh can't be cached.
+ */
+void BKE_mesh_mirror_cache_store(MeshMirrorCache **mirror_cache_p,
+                                 const MirrorModifierData *mmd,
+                                 const Object *ob,
+                                 const Mesh *mesh,
+                                 Mesh *result)
+{
+  BKE_mesh_mirror_cache_free(*mirror_cache_p);
+  *mirror_cache_p = NULL;
+
+  if (result == mesh || !mesh_mirror_cache_supported(mmd, mesh)) {
+    return;
+  }
+
+  MeshMirrorCache *mirror_cache = MEM_callocN(sizeof(*mirror_cache), __func__);
+  for (int axis = 0; axis < 3; axis++) {
+    if (mmd->flag & (MOD_MIR_AXIS_X << axis)) {
+      mirror_cache->axes[mirror_cache->axes_num++].axis = axis;
+    }
+  }
+
+  /* Only cache when the positions match exactly, so a mismatch with the regular mirroring can't
+   * show up on the next evaluation. */
+  int verts_num;
+  float(*vert_coords)[3] = BKE_mesh_vert_coords_alloc(mesh, &verts_num);
+  float(*vert_coords_mirror)[3] = mesh_mirror_cache_vert_coords_calc(
+      mirror_cache, mmd, ob, vert_coords, verts_num, true, &verts_num);
+  MEM_freeN(vert_coords);
+
+  bool is_valid = (verts_num == result->totvert);
+  for (int i = 0; is_valid && i < verts_num; i++) {
+    is_valid = equals_v3v3(vert_coords_mirror[i], result->mvert[i].co);
+  }
+  MEM_freeN(vert_coords_mirror);
+
+  if (!is_valid) {
+    BKE_mesh_mirror_cache_free(mirror_cache);
+    return;
+  }
+
+  mirror_cache->topology_hash = mesh_mirror_cache_topology_hash(mesh);
+  mirror_cache->settings_hash = mesh_mirror_cache_settings_hash(mmd, ob, mesh);
+  mirror_cache->mesh = BKE_mesh_copy_for_eval(result, false);
+
+  *mirror_cache_p = mirror_cache;
+}
+
+/** \} */
@@ -0,0 +1,252 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_math.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_mirror.h"
+
+namespace blender::bke::tests {
+
+/* Quads in the XY plane, the vertices of the first column and row are on the X and Y mirror
+ * planes. */
+#define GRID_SIZE 4
+
+/* Compares the result of a cache hit with mirroring the moved vertices from scratch. */
+class MeshMirrorCacheTest : public testing::Test {
+ protected:
+  MirrorModifierData mmd;
+  Object ob;
+  Mesh ob_mesh;
+  Object mirror_ob;
+  Mesh *mesh = nullptr;
+  MeshMirrorCache *mirror_cache = nullptr;
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+  }
+
+  void SetUp() override
+  {
+    memset(&mmd, 0, sizeof(mmd));
+    memset(&ob, 0, sizeof(ob));
+    memset(&ob_mesh, 0, sizeof(ob_mesh));
+    memset(&mirror_ob, 0, sizeof(mirror_ob));
+
+    mmd.flag = MOD_MIR_AXIS_X | MOD_MIR_VGROUP;
+    mmd.tolerance = 0.001f;
+
+    ob.type = OB_MESH;
+    ob.data = &ob_mesh;
+    unit_m4(ob.obmat);
+
+    /* Rotated around the X axis, the X mirror plane stays in place. */
+    const float loc[3] = {0.0f, 0.5f, 2.0f};
+    const float eul[3] = {0.4f, 0.0f, 0.0f};
+    const float size[3] = {1.0f, 1.0f, 1.0f};
+    loc_eul_size_to_mat4(mirror_ob.obmat, loc, eul, size);
+
+    mesh = grid_mesh_create();
+  }
+
+  void TearDown() override
+  {
+    BKE_mesh_mirror_cache_free(mirror_cache);
+    BKE_id_free(nullptr, mesh);
+  }
+
+  static Mesh *grid_mesh_create()
+  {
+    const int verts_per_side = GRID_SIZE + 1;
+    const int totedge_x = verts_per_side * GRID_SIZE;
+    Mesh *mesh = BKE_mesh_new_nomain(verts_per_side * verts_per_side,
+                                     totedge_x * 2,
+                                     0,
+                                     GRID_SIZE * GRID_SIZE * 4,
+                                     GRID_SIZE * GRID_SIZE);
+
+    for (int y = 0; y < verts_per_side; y++) {
+      for (int x = 0; x < verts_per_side; x++) {
+        const float co[3] = {(float)x * 0.5f, (float)y * 0.5f, 0.0f};
+        copy_v3_v3(mesh->mvert[y * verts_per_side + x].co, co);
+      }
+    }
+    /* Edges along X first, then edges along Y. */
+    for (int y = 0; y < verts_per_side; y++) {
+      for (int x = 0; x < GRID_SIZE; x++) {
+        MEdge *me = &mesh->medge[y * GRID_SIZE + x];
+        me->v1 = (unsigned int)(y * verts_per_side + x);
+        me->v2 = me->v1 + 1;
+      }
+    }
+    for (int y = 0; y < GRID_SIZE; y++) {
+      for (int x = 0; x < verts_per_side; x++) {
+        MEdge *me = &mesh->medge[totedge_x + y * verts_per_side + x];
+        me->v1 = (unsigned int)(y * verts_per_side + x);
+        me->v2 = me->v1 + (unsigned int)verts_per_side;
+      }
+    }
+    for (int y = 0; y < GRID_SIZE; y++) {
+      for (int x = 0; x < GRID_SIZE; x++) {
+        const int poly_index = y * GRID_SIZE + x;
+        MPoly *mp = &mesh->mpoly[poly_index];
+        mp->loopstart = poly_index * 4;
+        mp->totloop = 4;
+        MLoop *ml = &mesh->mloop[mp->loopstart];
+        ml[0].v = (unsigned int)(y * verts_per_side + x);
+        ml[1].v = (unsigned int)(y * verts_per_side + x + 1);
+        ml[2].v = (unsigned int)((y + 1) * verts_per_side + x + 1);
+        ml[3].v = (unsigned int)((y + 1) * verts_per_side + x);
+        ml[0].e = (unsigned int)(y * GRID_SIZE + x);
+        ml[1].e = (unsigned int)(totedge_x + y * verts_per_side + x + 1);
+        ml[2].e = (unsigned int)((y + 1) * GRID_SIZE + x);
+        ml[3].e = (unsigned int)(totedge_x + y * verts_per_side + x);
+      }
+    }
+    return mesh;
+  }
+
+  /* Same as the mirror modifier. */
+  Mesh *mirror_mesh()
+  {
+    Mesh *result = mesh;
+    for (int axis = 0; axis < 3; axis++) {
+      if (mmd.flag & (MOD_MIR_AXIS_X << axis)) {
+        Mesh *tmp = result;
+        result = BKE_mesh_mirror_apply_mirror_on_axis(&mmd, nullptr, &ob, result, axis);
+        if (tmp != mesh) {
+          BKE_id_free(nullptr, tmp);
+        }
+      }
+    }
+    return result;
+  }
+
+  /* Move all vertices, keeping the ones on the mirror planes on them. */
+  void move_verts()
+  {
+    for (int i = 0; i < mesh->totvert; i++) {
+      float *co = mesh->mvert[i].co;
+      if (co[0] != 0.0f) {
+        co[0] += 0.05f * (float)(i % 3);
+      }
+      if (co[1] != 0.0f) {
+        co[1] -= 0.03f * (float)(i % 4);
+      }
+      co[2] += 0.1f * (float)(i % 5) - 0.2f;
+    }
+  }
+
+  void cache_store()
+  {
+    Mesh *result = mirror_mesh();
+    BKE_mesh_mirror_cache_store(&mirror_cache, &mmd, &ob, mesh, result);
+    ASSERT_NE(mirror_cache, nullptr);
+    BKE_id_free(nullptr, result);
+  }
+
+  void expect_cache_matches_mirror()
+  {
+    cache_store();
+    move_verts();
+
+    Mesh *result_cache = BKE_mesh_mirror_cache_apply(mirror_cache, &mmd, &ob, mesh);
+    ASSERT_NE(result_cache, nullptr);
+    Mesh *result = mirror_mesh();
+
+    ASSERT_EQ(result_cache->totvert, result->totvert);
+    ASSERT_EQ(result_cache->totedge, result->totedge);
+    ASSERT_EQ(result_cache->totloop, result->totloop);
+    ASSERT_EQ(result_cache->totpoly, result->totpoly);
+    for (int i = 0; i < result->totvert; i++) {
+      EXPECT_V3_NEAR(result_cache->mvert[i].co, result->mvert[i].co, 0.0f);
+    }
+    for (int i = 0; i < result->totedge; i++) {
+      EXPECT_EQ(result_cache->medge[i].v1, result->medge[i].v1);
+      EXPECT_EQ(result_cache->medge[i].v2, result->medge[i].v2);
+    }
+    for (int i = 0; i < result->totloop; i++) {
+      EXPECT_EQ(result_cache->mloop[i].v, result->mloop[i].v);
+      EXPECT_EQ(result_cache->mloop[i].e, result->mloop[i].e);
+    }
+    for (int i = 0; i < result->totpoly; i++) {
+      EXPECT_EQ(result_cache->mpoly[i].loopstart, result->mpoly[i].loopstart);
+      EXPECT_EQ(result_cache->mpoly[i].totloop, result->mpoly[i].totloop);
+    }
+
+    BKE_id_free(nullptr, result_cache);
+    BKE_id_free(nullptr, result);
+  }
+};
+
+TEST_F(MeshMirrorCacheTest, Merge)
+{
+  expect_cache_matches_mirror();
+}
+
+TEST_F(MeshMirrorCacheTest, MergeAxesXY)
+{
+  mmd.flag |= MOD_MIR_AXIS_Y;
+  expect_cache_matches_mirror();
+}
+
+TEST_F(MeshMirrorCacheTest, NoMerge)
+{
+  mmd.flag |= MOD_MIR_NO_MERGE;
+  expect_cache_matches_mirror();
+}
+
+TEST_F(MeshMirrorCacheTest, NoMergeAxesXY)
+{
+  mmd.flag |= MOD_MIR_AXIS_Y | MOD_MIR_NO_MERGE;
+  expect_cache_matches_mirror();
+}
+
+TEST_F(MeshMirrorCacheTest, MirrorObject)
+{
+  mmd.mirror_ob = &mirror_ob;
+  expect_cache_matches_mirror();
+}
+
+TEST_F(MeshMirrorCacheTest, MirrorObjectNoMerge)
+{
+  mmd.mirror_ob = &mirror_ob;
+  mmd.flag |= MOD_MIR_NO_MERGE;
+  expect_cache_matches_mirror();
+}
+
+/* Vertices leaving the mirror plane are not merged anymore, which changes the topology. */
+TEST_F(MeshMirrorCacheTest, MergeChanged)
+{
+  cache_store();
+  mesh->mvert[0].co[0] = 0.1f;
+  EXPECT_EQ(BKE_mesh_mirror_cache_apply(mirror_cache, &mmd, &ob, mesh), nullptr);
+}
+
+}  // namespace blender::bke::tests
@@ -0,0 +1,431 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "BKE_mesh.h"
+
+#include "PIL_time.h"
+
+namespace blender::bke::tests {
+
+#define SPLIT_ANGLE DEG2RADF(30.0f)
+
+static void mesh_verts_init(MVert *mverts, const float (*cos)[3], const int num_verts)
+{
+  for (int i = 0; i < num_verts; i++) {
+    copy_v3_v3(mverts[i].co, cos[i]);
+    mverts[i].no[0] = 0;
+    mverts[i].no[1] = 0;
+    mverts[i].no[2] = SHRT_MAX;
+    mverts[i].flag = 0;
+    mverts[i].bweight = 0;
+  }
+}
+
+static void mesh_edge_init(MEdge *medge, const int v1, const int v2)
+{
+  memset(medge, 0, sizeof(*medge));
+  medge->v1 = (unsigned int)v1;
+  medge->v2 = (unsigned int)v2;
+}
+
+TEST(mesh_normals, LoopSplitLooseEdgesNoFaces)
+{
+  const float cos[3][3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}};
+  MVert mverts[3];
+  MEdge medges[2];
+  mesh_verts_init(mverts, cos, 3);
+  mesh_edge_init(&medges[0], 0, 1);
+  mesh_edge_init(&medges[1], 1, 2);
+
+  MLoopFanCache *fan_cache = nullptr;
+  /* The second call validates the cache built by the first one. */
+  for (int i = 0; i < 2; i++) {
+    BKE_mesh_normals_loop_split_ex(mverts,
+                                   3,
+                                   medges,
+                                   2,
+                                   nullptr,
+                                   nullptr,
+                                   0,
+                                   nullptr,
+                                   nullptr,
+                                   0,
+                                   true,
+                                   SPLIT_ANGLE,
+                                   nullptr,
+                                   nullptr,
+                                   nullptr,
+                                   &fan_cache);
+    EXPECT_NE(fan_cache, nullptr);
+  }
+
+  BKE_mesh_loop_fan_cache_free(fan_cache);
+}
+
+TEST(mesh_normals, LoopSplitFanCacheLooseEdge)
+{
+  /* Two quads folded along their shared edge, plus a loose edge. */
+  const float cos[8][3] = {
+      {0.0f, 0.0f, 0.0f},
+      {1.0f, 0.0f, 0.0f},
+      {1.0f, 1.0f, 0.0f},
+      {0.0f, 1.0f, 0.0f},
+      {2.0f, 0.0f, 0.2f},
+      {2.0f, 1.0f, 0.2f},
+      {3.0f, 0.0f, 0.0f},
+      {3.0f, 1.0f, 0.0f},
+  };
+  const int edge_verts[8][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {1, 4}, {4, 5}, {5, 2}, {6, 7}};
+  const int loop_verts[8] = {0, 1, 2, 3, 1, 4, 5, 2};
+  const int loop_edges[8] = {0, 1, 2, 3, 4, 5, 6, 1};
+
+  MVert mverts[8];
+  MEdge medges[8];
+  MLoop mloops[8];
+  MPoly mpolys[2];
+  mesh_verts_init(mverts, cos, 8);
+  for (int i = 0; i < 8; i++) {
+    mesh_edge_init(&medges[i], edge_verts[i][0], edge_verts[i][1]);
+    mloops[i].v = (unsigned int)loop_verts[i];
+    mloops[i].e = (unsigned int)loop_edges[i];
+  }
+  memset(mpolys, 0, sizeof(mpolys));
+  for (int i = 0; i < 2; i++) {
+    mpolys[i].loopstart = i * 4;
+    mpolys[i].totloop = 4;
+    mpolys[i].flag = ME_SMOOTH;
+  }
+
+  float polynors[2][3];
+  BKE_mesh_calc_normals_poly(mverts, nullptr, 8, mloops, mpolys, 8, 2, polynors, false);
+
+  float loopnors_expected[8][3];
+  BKE_mesh_normals_loop_split(mverts,
+                              8,
+                              medges,
+                              8,
+                              mloops,
+                              loopnors_expected,
+                              8,
+                              mpolys,
+                              (const float(*)[3])polynors,
+                              2,
+                              true,
+                              SPLIT_ANGLE,
+                              nullptr,
+                              nullptr,
+                              nullptr);
+
+  MLoopFanCache *fan_cache = nullptr;
+  /* The second call uses the smooth fans stored by the first one. */
+  for (int i = 0; i < 2; i++) {
+    float loopnors[8][3];
+    BKE_mesh_normals_loop_split_ex(mverts,
+                                   8,
+                                   medges,
+                                   8,
+                                   mloops,
+                                   loopnors,
+                                   8,
+                                   mpolys,
+                                   (const float(*)[3])polynors,
+                                   2,
+                                   true,
+                                   SPLIT_ANGLE,
+                                   nullptr,
+                                   nullptr,
+                                   nullptr,
+                                   &fan_cache);
+    for (int j = 0; j < 8; j++) {
+      EXPECT_V3_NEAR(loopnors[j], loopnors_expected[j], 1e-6f);
+    }
+  }
+
+  BKE_mesh_loop_fan_cache_free(fan_cache);
+}
+
+/* Grid of quads, bumped so the normals of neighboring faces differ. */
+class MeshNormalsGridTest : public testing::Test {
+ protected:
+  MVert *mverts = nullptr;
+  MEdge *medges = nullptr;
+  MLoop *mloops = nullptr;
+  MPoly *mpolys = nullptr;
+  int totvert = 0, totedge = 0, totloop = 0, totpoly = 0;
+
+  void SetUp() override
+  {
+    BLI_threadapi_init();
+  }
+
+  void TearDown() override
+  {
+    MEM_SAFE_FREE(mverts);
+    MEM_SAFE_FREE(medges);
+    MEM_SAFE_FREE(mloops);
+    MEM_SAFE_FREE(mpolys);
+
+    BLI_threadapi_exit();
+  }
+
+  void grid_create(const int grid_size)
+  {
+    const int verts_per_side = grid_size + 1;
+    /* Edges along X first, then edges along Y. */
+    const int totedge_x = verts_per_side * grid_size;
+    totvert = verts_per_side * verts_per_side;
+    totedge = totedge_x * 2;
+    totpoly = grid_size * grid_size;
+    totloop = totpoly * 4;
+    mverts = (MVert *)MEM_calloc_arrayN(totvert, sizeof(MVert), __func__);
+    medges = (MEdge *)MEM_calloc_arrayN(totedge, sizeof(MEdge), __func__);
+    mloops = (MLoop *)MEM_calloc_arrayN(totloop, sizeof(MLoop), __func__);
+    mpolys = (MPoly *)MEM_calloc_arrayN(totpoly, sizeof(MPoly), __func__);
+
+    for (int y = 0; y < verts_per_side; y++) {
+      for (int x = 0; x < verts_per_side; x++) {
+        MVert *mv = &mverts[y * verts_per_side + x];
+        mv->co[0] = (float)x;
+        mv->co[1] = (float)y;
+        mv->co[2] = sinf((float)x * 0.3f) * cosf((float)y * 0.17f);
+      }
+    }
+    for (int y = 0; y < verts_per_side; y++) {
+      for (int x = 0; x < grid_size; x++) {
+        const int v = y * verts_per_side + x;
+        mesh_edge_init(&medges[y * grid_size + x], v, v + 1);
+      }
+    }
+    for (int y = 0; y < grid_size; y++) {
+      for (int x = 0; x < verts_per_side; x++) {
+        const int v = y * verts_per_side + x;
+        mesh_edge_init(&medges[totedge_x + v], v, v + verts_per_side);
+      }
+    }
+    for (int y = 0; y < grid_size; y++) {
+      for (int x = 0; x < grid_size; x++) {
+        const int poly_index = y * grid_size + x;
+        MPoly *mp = &mpolys[poly_index];
+        mp->loopstart = poly_index * 4;
+        mp->totloop = 4;
+        MLoop *ml = &mloops[mp->loopstart];
+        ml[0].v = (unsigned int)(y * verts_per_side + x);
+        ml[1].v = (unsigned int)(y * verts_per_side + x + 1);
+        ml[2].v = (unsigned int)((y + 1) * verts_per_side + x + 1);
+        ml[3].v = (unsigned int)((y + 1) * verts_per_side + x);
+        ml[0].e = (unsigned int)(y * grid_size + x);
+        ml[1].e = (unsigned int)(totedge_x + y * verts_per_side + x + 1);
+        ml[2].e = (unsigned int)((y + 1) * grid_size + x);
+        ml[3].e = (unsigned int)(totedge_x + y * verts_per_side + x);
+      }
+    }
+  }
+
+  float (*calc_vert_normals())[3]
+  {
+    float(*vnors)[3] = (float(*)[3])MEM_malloc_arrayN(totvert, sizeof(*vnors), __func__);
+    float(*pnors)[3] = (float(*)[3])MEM_malloc_arrayN(totpoly, sizeof(*pnors), __func__);
+    BKE_mesh_calc_normals_poly(
+        mverts, vnors, totvert, mloops, mpolys, totloop, totpoly, pnors, false);
+    MEM_freeN(pnors);
+    return vnors;
+  }
+
+  void expect_vert_normals_near_serial_accumulation(const float (*vnors)[3])
+  {
+    float(*vnors_expected)[3] = (float(*)[3])MEM_calloc_arrayN(
+        totvert, sizeof(*vnors_expected), __func__);
+    for (int i = 0; i < totpoly; i++) {
+      const MPoly *mp = &mpolys[i];
+      const MLoop *ml = &mloops[mp->loopstart];
+      float *vertnos[4];
+      const float *vertcos[4];
+      float vdiffs[4][3];
+      float pnor[3];
+      for (int j = 0; j < 4; j++) {
+        vertnos[j] = vnors_expected[ml[j].v];
+        vertcos[j] = mverts[ml[j].v].co;
+      }
+      BKE_mesh_calc_poly_normal(mp, ml, mverts, pnor);
+      accumulate_vertex_normals_poly_v3(vertnos, pnor, vertcos, vdiffs, 4);
+    }
+    for (int i = 0; i < totvert; i++) {
+      normalize_v3(vnors_expected[i]);
+      EXPECT_V3_NEAR(vnors[i], vnors_expected[i], 1e-5f);
+    }
+    MEM_freeN(vnors_expected);
+  }
+
+  /* The scheduler reads the thread count override when it is initialized. */
+  static void task_scheduler_reinit(const int num_threads)
+  {
+    BLI_task_scheduler_exit();
+    BLI_system_num_threads_override_set(num_threads);
+    BLI_task_scheduler_init();
+  }
+
+  void benchmark_vert_normals(const int grid_size)
+  {
+    grid_create(grid_size);
+    const int num_runs = 5;
+    const double start_time = PIL_check_seconds_timer();
+    for (int i = 0; i < num_runs; i++) {
+      MEM_freeN(calc_vert_normals());
+    }
+    printf("Vertex normals of %d vertices: %fs average over %d runs\n",
+           totvert,
+           (PIL_check_seconds_timer() - start_time) / num_runs,
+           num_runs);
+  }
+};
+
+/* Custom normals which differ within a fan are replaced by their average, with and without
+ * the fan cache. */
+TEST_F(MeshNormalsGridTest, LoopSplitFanCacheCustomNormals)
+{
+  grid_create(8);
+  /* Sharp edges split some fans and leave some loops with two sharp edges. */
+  for (int i = 0; i < totedge; i += 3) {
+    medges[i].flag |= ME_SHARP;
+  }
+  for (int i = 0; i < totpoly; i++) {
+    mpolys[i].flag = (i % 5) ? ME_SMOOTH : 0;
+  }
+  float(*polynors)[3] = (float(*)[3])MEM_malloc_arrayN(totpoly, sizeof(*polynors), __func__);
+  BKE_mesh_calc_normals_poly(
+      mverts, nullptr, totvert, mloops, mpolys, totloop, totpoly, polynors, false);
+
+  short(*clnors_init)[2] = (short(*)[2])MEM_malloc_arrayN(totloop, sizeof(*clnors_init), __func__);
+  for (int i = 0; i < totloop; i++) {
+    clnors_init[i][0] = (short)((i * 37) % 200 - 100);
+    clnors_init[i][1] = (short)((i * 11) % 150 - 75);
+  }
+  short(*clnors_expected)[2] = (short(*)[2])MEM_dupallocN(clnors_init);
+  short(*clnors)[2] = (short(*)[2])MEM_malloc_arrayN(totloop, sizeof(*clnors), __func__);
+  float(*loopnors_expected)[3] = (float(*)[3])MEM_malloc_arrayN(
+      totloop, sizeof(*loopnors_expected), __func__);
+  float(*loopnors)[3] = (float(*)[3])MEM_malloc_arrayN(totloop, sizeof(*loopnors), __func__);
+
+  BKE_mesh_normals_loop_split(mverts,
+                              totvert,
+                              medges,
+                              totedge,
+                              mloops,
+                              loopnors_expected,
+                              totloop,
+                              mpolys,
+                              (const float(*)[3])polynors,
+                              totpoly,
+                              true,
+                              SPLIT_ANGLE,
+                              nullptr,
+                              clnors_expected,
+                              nullptr);
+  EXPECT_NE(memcmp(clnors_expected, clnors_init, sizeof(*clnors_init) * totloop), 0);
+
+  MLoopFanCache *fan_cache = nullptr;
+  /* The second call uses the smooth fans stored by the first one. */
+  for (int i = 0; i < 2; i++) {
+    memcpy(clnors, clnors_init, sizeof(*clnors_init) * totloop);
+    BKE_mesh_normals_loop_split_ex(mverts,
+                                   totvert,
+                                   medges,
+                                   totedge,
+                                   mloops,
+                                   loopnors,
+                                   totloop,
+                                   mpolys,
+                                   (const float(*)[3])polynors,
+                                   totpoly,
+                                   true,
+                                   SPLIT_ANGLE,
+                                   nullptr,
+                                   clnors,
+                                   nullptr,
+                                   &fan_cache);
+    EXPECT_EQ(memcmp(clnors, clnors_expected, sizeof(*clnors) * totloop), 0);
+    for (int j = 0; j < totloop; j++) {
+      EXPECT_V3_NEAR(loopnors[j], loopnors_expected[j], 1e-6f);
+    }
+  }
+
+  BKE_mesh_loop_fan_cache_free(fan_cache);
+  MEM_freeN(polynors);
+  MEM_freeN(clnors_init);
+  MEM_freeN(clnors_expected);
+  MEM_freeN(clnors);
+  MEM_freeN(loopnors_expected);
+  MEM_freeN(loopnors);
+}
+
+/* Only small meshes accumulate vertex normals serially. */
+TEST_F(MeshNormalsGridTest, CalcNormalsPolySmall)
+{
+  grid_create(16);
+  float(*vnors)[3] = calc_vert_normals();
+  expect_vert_normals_near_serial_accumulation(vnors);
+  MEM_freeN(vnors);
+}
+
+TEST_F(MeshNormalsGridTest, CalcNormalsPolyVertLoopMap)
+{
+  grid_create(300);
+  float(*vnors)[3] = calc_vert_normals();
+  expect_vert_normals_near_serial_accumulation(vnors);
+  MEM_freeN(vnors);
+}
+
+/* Vertices sum their loops in the same order whatever the threading. */
+TEST_F(MeshNormalsGridTest, CalcNormalsPolyThreadingDeterministic)
+{
+  grid_create(300);
+
+  task_scheduler_reinit(1);
+  float(*vnors_single)[3] = calc_vert_normals();
+  task_scheduler_reinit(0);
+  float(*vnors_threaded)[3] = calc_vert_normals();
+
+  EXPECT_EQ(memcmp(vnors_single, vnors_threaded, sizeof(*vnors_single) * totvert), 0);
+
+  MEM_freeN(vnors_single);
+  MEM_freeN(vnors_threaded);
+}
+
+TEST_F(MeshNormalsGridTest, CalcNormalsPolyPerformance1M)
+{
+  benchmark_vert_normals(1000);
+}
+
+/* Needs close to two gigabytes of memory, run with `--gtest_also_run_disabled_tests`. */
+TEST_F(MeshNormalsGridTest, DISABLED_CalcNormalsPolyPerformance10M)
+{
+  benchmark_vert_normals(3162);
+}
+
+}  // namespace blender::bke::tests
@@ -69,6 +69,7 @@ void BKE_mesh_runtime_reset_on_copy(Mesh *mesh, const int UNUSED(flag))
   runtime->subdiv_ccg = NULL;
   memset(&runtime->looptris, 0, sizeof(runtime->looptris));
   runtime->bvh_cache = NULL;
+  runtime->loop_fan_cache = NULL;
   runtime->shrinkwrap_data = NULL;
 
   mesh->runtime.eval_mutex = MEM_mallocN(sizeof(ThreadMutex), "mesh runtime eval_mutex");
@@ -237,6 +238,10 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
     bvhcache_free(mesh->runtime.bvh_cache);
     mesh->runtime.bvh_cache = NULL;
   }
+  if (mesh->runtime.loop_fan_cache) {
+    BKE_mesh_loop_fan_cache_free(mesh->runtime.loop_fan_cache);
+    mesh->runtime.loop_fan_cache = NULL;
+  }
   MEM_SAFE_FREE(mesh->runtime.looptris.array);
   /* TODO(sergey): Does this really belong here? */
   if (mesh->runtime.subdiv_ccg != NULL) {
@@ -51,6 +51,11 @@
 
 #define LEAF_LIMIT 10000
 
+/* Sub-trees with fewer primitives are built by the task which partitioned their parent. */
+#define BUILD_TASK_MIN_PRIMS (LEAF_LIMIT * 4)
+/* Ranges with fewer primitives have their bounds calculated on a single thread. */
+#define BUILD_BOUNDS_THREADED_MIN_PRIMS 100000
+
 //#define PERFCNTRS
 
 #define STACK_FIXED_DEPTH 100
@@ -254,17 +259,33 @@ void pbvh_grow_nodes(PBVH *pbvh, int totnode)
 }
 
 /* Add a vertex to the map, with a positive value for unique vertices and
- * a negative value for additional vertices */
-static int map_insert_vert(
-    PBVH *pbvh, GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex)
+ * a negative value for additional vertices.
+ *
+ * A vertex is unique in the first leaf using it: with the threaded build this was found
+ * beforehand (see #pbvh_build_leafs_threaded), otherwise leafs are built in order. */
+static int map_insert_vert(PBVH *pbvh,
+                           GHash *map,
+                           unsigned int *face_verts,
+                           unsigned int *uniq_verts,
+                           int vertex,
+                           int leaf_index)
 {
   void *key, **value_p;
 
   key = POINTER_FROM_INT(vertex);
   if (!BLI_ghash_ensure_p(map, key, &value_p)) {
     int value_i;
-    if (BLI_BITMAP_TEST(pbvh->vert_bitmap, vertex) == 0) {
-      BLI_BITMAP_ENABLE(pbvh->vert_bitmap, vertex);
+    bool is_unique;
+    if (pbvh->vert_leaf_owner) {
+      is_unique = (pbvh->vert_leaf_owner[vertex] == leaf_index);
+    }
+    else {
+      is_unique = (BLI_BITMAP_TEST(pbvh->vert_bitmap, vertex) == 0);
+      if (is_unique) {
+        BLI_BITMAP_ENABLE(pbvh->vert_bitmap, vertex);
+      }
+    }
+    if (is_unique) {
       value_i = *uniq_verts;
       (*uniq_verts)++;
     }
@@ -281,7 +302,7 @@ static int map_insert_vert(
 }
 
 /* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
+static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node, int leaf_index)
 {
   bool has_visible = false;
 
@@ -302,8 +323,12 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
   for (int i = 0; i < totface; i++) {
     const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
     for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          pbvh, map, &node->face_verts, &node->uniq_verts, pbvh->mloop[lt->tri[j]].v);
+      face_vert_indices[i][j] = map_insert_vert(pbvh,
+                                                map,
+                                                &node->face_verts,
+                                                &node->uniq_verts,
+                                                pbvh->mloop[lt->tri[j]].v,
+                                                leaf_index);
     }
 
     if (has_visible == false) {
@@ -428,7 +453,7 @@ static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, in
   update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
 
   if (pbvh->looptri) {
-    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
+    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index, -1);
   }
   else {
     build_grid_leaf_node(pbvh, pbvh->nodes + node_index);
@@ -535,6 +560,307 @@ static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int off
             offset + count - end);
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Threaded Build
+ *
+ * Same result as #build_sub, in three steps:
+ * - Partition the primitives into a temporary tree, sub-trees are built in parallel tasks.
+ * - Lay out the nodes in the same depth first order as #build_sub (on a single thread,
+ *   there are only a few nodes per #LEAF_LIMIT primitives).
+ * - Build the leafs in parallel.
+ * \{ */
+
+typedef struct PBVHBuildNode {
+  BB vb;
+  int offset, count;
+  /** NULL for leafs. */
+  struct PBVHBuildNode *children;
+} PBVHBuildNode;
+
+typedef struct PBVHBuildBounds {
+  BB vb;
+  BB cb;
+} PBVHBuildBounds;
+
+typedef struct PBVHBuildBoundsData {
+  const PBVH *pbvh;
+  const BBC *prim_bbc;
+  bool use_centroids;
+} PBVHBuildBoundsData;
+
+static void pbvh_build_bounds_task_cb(void *__restrict userdata,
+                                      const int i,
+                                      const TaskParallelTLS *__restrict tls)
+{
+  const PBVHBuildBoundsData *data = userdata;
+  PBVHBuildBounds *bounds = tls->userdata_chunk;
+  const BBC *bbc = &data->prim_bbc[data->pbvh->prim_indices[i]];
+
+  BB_expand_with_bb(&bounds->vb, (BB *)bbc);
+  if (data->use_centroids) {
+    BB_expand(&bounds->cb, bbc->bcentroid);
+  }
+}
+
+static void pbvh_build_bounds_reduce(const void *__restrict UNUSED(userdata),
+                                     void *__restrict chunk_join,
+                                     void *__restrict chunk)
+{
+  PBVHBuildBounds *join = chunk_join;
+  PBVHBuildBounds *bounds = chunk;
+
+  BB_expand_with_bb(&join->vb, &bounds->vb);
+  BB_expand_with_bb(&join->cb, &bounds->cb);
+}
+
+/* Bounds of the primitives in the range, and of their centroids when \a r_cb is set. */
+static void pbvh_build_bounds(
+    const PBVH *pbvh, const BBC *prim_bbc, int offset, int count, BB *r_vb, BB *r_cb)
+{
+  PBVHBuildBoundsData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+      .use_centroids = (r_cb != NULL),
+  };
+  PBVHBuildBounds bounds;
+  BB_reset(&bounds.vb);
+  BB_reset(&bounds.cb);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (count >= BUILD_BOUNDS_THREADED_MIN_PRIMS);
+  settings.userdata_chunk = &bounds;
+  settings.userdata_chunk_size = sizeof(bounds);
+  settings.func_reduce = pbvh_build_bounds_reduce;
+  BLI_task_parallel_range(offset, offset + count, &data, pbvh_build_bounds_task_cb, &settings);
+
+  *r_vb = bounds.vb;
+  if (r_cb) {
+    *r_cb = bounds.cb;
+  }
+}
+
+typedef struct PBVHBuildTaskData {
+  PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHBuildTaskData;
+
+static void pbvh_build_node_task_cb(TaskPool *__restrict pool, void *taskdata);
+
+/* Same as #build_sub, without creating the nodes. */
+static void pbvh_build_node(TaskPool *__restrict pool, PBVHBuildNode *bnode, BB *cb)
+{
+  const PBVHBuildTaskData *data = BLI_task_pool_user_data(pool);
+  PBVH *pbvh = data->pbvh;
+  const int offset = bnode->offset;
+  const int count = bnode->count;
+  int end;
+  BB cb_backing;
+
+  /* Decide whether this is a leaf or not */
+  const bool below_leaf_limit = count <= pbvh->leaf_limit;
+  if (below_leaf_limit) {
+    if (!leaf_needs_material_split(pbvh, offset, count)) {
+      pbvh_build_bounds(pbvh, data->prim_bbc, offset, count, &bnode->vb, NULL);
+      return;
+    }
+  }
+
+  if (!below_leaf_limit) {
+    /* Find axis with widest range of primitive centroids */
+    if (!cb) {
+      cb = &cb_backing;
+      pbvh_build_bounds(pbvh, data->prim_bbc, offset, count, &bnode->vb, cb);
+    }
+    else {
+      pbvh_build_bounds(pbvh, data->prim_bbc, offset, count, &bnode->vb, NULL);
+    }
+    const int axis = BB_widest_axis(cb);
+
+    /* Partition primitives along that axis */
+    end = partition_indices(pbvh->prim_indices,
+                            offset,
+                            offset + count - 1,
+                            axis,
+                            (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
+                            data->prim_bbc);
+  }
+  else {
+    pbvh_build_bounds(pbvh, data->prim_bbc, offset, count, &bnode->vb, NULL);
+
+    /* Partition primitives by material */
+    end = partition_indices_material(pbvh, offset, offset + count - 1);
+  }
+
+  /* Build children */
+  bnode->children = MEM_callocN(sizeof(*bnode->children) * 2, __func__);
+  bnode->children[0].offset = offset;
+  bnode->children[0].count = end - offset;
+  bnode->children[1].offset = end;
+  bnode->children[1].count = offset + count - end;
+
+  for (int i = 0; i < 2; i++) {
+    PBVHBuildNode *child = &bnode->children[i];
+    if (child->count >= BUILD_TASK_MIN_PRIMS) {
+      BLI_task_pool_push(pool, pbvh_build_node_task_cb, child, false, NULL);
+    }
+    else {
+      pbvh_build_node(pool, child, NULL);
+    }
+  }
+}
+
+static void pbvh_build_node_task_cb(TaskPool *__restrict pool, void *taskdata)
+{
+  pbvh_build_node(pool, taskdata, NULL);
+}
+
+/* Create the nodes in the same order as #build_sub, and gather the leafs. */
+static void pbvh_build_layout(PBVH *pbvh,
+                              int node_index,
+                              const PBVHBuildNode *bnode,
+                              int *leaf_nodes,
+                              int *r_leaf_nodes_len)
+{
+  PBVHNode *node = &pbvh->nodes[node_index];
+  node->vb = bnode->vb;
+  node->orig_vb = bnode->vb;
+
+  if (bnode->children == NULL) {
+    node->flag |= PBVH_Leaf;
+    node->prim_indices = pbvh->prim_indices + bnode->offset;
+    node->totprim = bnode->count;
+    leaf_nodes[(*r_leaf_nodes_len)++] = node_index;
+    return;
+  }
+
+  /* Add two child nodes, the node pointer is invalid after growing. */
+  const int children_offset = pbvh->totnode;
+  node->children_offset = children_offset;
+  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
+
+  pbvh_build_layout(pbvh, children_offset, &bnode->children[0], leaf_nodes, r_leaf_nodes_len);
+  pbvh_build_layout(
+      pbvh, children_offset + 1, &bnode->children[1], leaf_nodes, r_leaf_nodes_len);
+}
+
+static void pbvh_build_node_free(PBVHBuildNode *bnode)
+{
+  if (bnode->children) {
+    pbvh_build_node_free(&bnode->children[0]);
+    pbvh_build_node_free(&bnode->children[1]);
+    MEM_freeN(bnode->children);
+  }
+}
+
+static int pbvh_build_leaf_count(const PBVHBuildNode *bnode)
+{
+  if (bnode->children) {
+    return pbvh_build_leaf_count(&bnode->children[0]) +
+           pbvh_build_leaf_count(&bnode->children[1]);
+  }
+  return 1;
+}
+
+typedef struct PBVHBuildLeafsData {
+  PBVH *pbvh;
+  const int *leaf_nodes;
+} PBVHBuildLeafsData;
+
+static void pbvh_build_leaf_owner_task_cb(void *__restrict userdata,
+                                          const int leaf_index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeafsData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  const PBVHNode *node = &pbvh->nodes[data->leaf_nodes[leaf_index]];
+  const int totface = node->totprim;
+
+  for (int i = 0; i < totface; i++) {
+    const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+    for (int j = 0; j < 3; j++) {
+      int *owner = &pbvh->vert_leaf_owner[pbvh->mloop[lt->tri[j]].v];
+      /* Atomic minimum, the first leaf in build order owns the vertex. */
+      int owner_prev = *owner;
+      while (leaf_index < owner_prev) {
+        const int owner_cas = atomic_cas_int32(owner, owner_prev, leaf_index);
+        if (owner_cas == owner_prev) {
+          break;
+        }
+        owner_prev = owner_cas;
+      }
+    }
+  }
+}
+
+static void pbvh_build_leaf_task_cb(void *__restrict userdata,
+                                    const int leaf_index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildLeafsData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  PBVHNode *node = &pbvh->nodes[data->leaf_nodes[leaf_index]];
+
+  if (pbvh->looptri) {
+    build_mesh_leaf_node(pbvh, node, leaf_index);
+  }
+  else {
+    build_grid_leaf_node(pbvh, node);
+  }
+}
+
+/* Vertices are unique in the same leafs as with #build_leaf called in order. */
+static void pbvh_build_leafs_threaded(PBVH *pbvh, const int *leaf_nodes, int leaf_nodes_len)
+{
+  PBVHBuildLeafsData data = {
+      .pbvh = pbvh,
+      .leaf_nodes = leaf_nodes,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  if (pbvh->looptri) {
+    pbvh->vert_leaf_owner = MEM_mallocN(sizeof(*pbvh->vert_leaf_owner) * pbvh->totvert,
+                                        __func__);
+    copy_vn_i(pbvh->vert_leaf_owner, pbvh->totvert, INT_MAX);
+    BLI_task_parallel_range(0, leaf_nodes_len, &data, pbvh_build_leaf_owner_task_cb, &settings);
+  }
+
+  BLI_task_parallel_range(0, leaf_nodes_len, &data, pbvh_build_leaf_task_cb, &settings);
+
+  MEM_SAFE_FREE(pbvh->vert_leaf_owner);
+}
+
+static void pbvh_build_threaded(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
+{
+  PBVHBuildTaskData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  PBVHBuildNode root = {
+      .offset = 0,
+      .count = totprim,
+  };
+
+  TaskPool *pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+  pbvh_build_node(pool, &root, cb);
+  BLI_task_pool_work_and_wait(pool);
+  BLI_task_pool_free(pool);
+
+  const int leaf_nodes_len_max = pbvh_build_leaf_count(&root);
+  int *leaf_nodes = MEM_mallocN(sizeof(*leaf_nodes) * leaf_nodes_len_max, __func__);
+  int leaf_nodes_len = 0;
+  pbvh_build_layout(pbvh, 0, &root, leaf_nodes, &leaf_nodes_len);
+  BLI_assert(leaf_nodes_len == leaf_nodes_len_max);
+  pbvh_build_node_free(&root);
+
+  pbvh_build_leafs_threaded(pbvh, leaf_nodes, leaf_nodes_len);
+  MEM_freeN(leaf_nodes);
+}
+
+/** \} */
+
 static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
 {
   if (totprim != pbvh->totprim) {
@@ -557,7 +883,69 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
   }
 
   pbvh->totnode = 1;
-  build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+
+  if (totprim > pbvh->leaf_limit) {
+    pbvh_build_threaded(pbvh, cb, prim_bbc, totprim);
+  }
+  else {
+    build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+  }
+}
+
+typedef struct PBVHBuildPrimBoundsData {
+  const PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHBuildPrimBoundsData;
+
+static void pbvh_build_mesh_prim_bounds_task_cb(void *__restrict userdata,
+                                                const int i,
+                                                const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildPrimBoundsData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const MLoopTri *lt = &pbvh->looptri[i];
+  const int sides = 3;
+  BBC *bbc = data->prim_bbc + i;
+  BB *cb = tls->userdata_chunk;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < sides; j++) {
+    BB_expand((BB *)bbc, pbvh->verts[pbvh->mloop[lt->tri[j]].v].co);
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(cb, bbc->bcentroid);
+}
+
+static void pbvh_build_grids_prim_bounds_task_cb(void *__restrict userdata,
+                                                 const int i,
+                                                 const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildPrimBoundsData *data = userdata;
+  const PBVH *pbvh = data->pbvh;
+  const CCGKey *key = &pbvh->gridkey;
+  CCGElem *grid = pbvh->grids[i];
+  BBC *bbc = data->prim_bbc + i;
+  BB *cb = tls->userdata_chunk;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < key->grid_area; j++) {
+    BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(cb, bbc->bcentroid);
+}
+
+static void pbvh_build_prim_bounds_reduce(const void *__restrict UNUSED(userdata),
+                                          void *__restrict chunk_join,
+                                          void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
 }
 
 /**
@@ -602,21 +990,17 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   /* For each face, store the AABB and the AABB centroid */
   prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
 
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[pbvh->mloop[lt->tri[j]].v].co);
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  PBVHBuildPrimBoundsData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (looptri_num >= BUILD_BOUNDS_THREADED_MIN_PRIMS);
+  settings.userdata_chunk = &cb;
+  settings.userdata_chunk_size = sizeof(cb);
+  settings.func_reduce = pbvh_build_prim_bounds_reduce;
+  BLI_task_parallel_range(0, looptri_num, &data, pbvh_build_mesh_prim_bounds_task_cb, &settings);
 
   if (looptri_num) {
     pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
@@ -652,20 +1036,19 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   /* For each grid, store the AABB and the AABB centroid */
   BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
 
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  PBVHBuildPrimBoundsData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  /* Grids have many more vertices than triangles. */
+  settings.use_threading = ((size_t)totgrid * gridsize * gridsize >=
+                           BUILD_BOUNDS_THREADED_MIN_PRIMS);
+  settings.userdata_chunk = &cb;
+  settings.userdata_chunk_size = sizeof(cb);
+  settings.func_reduce = pbvh_build_prim_bounds_reduce;
+  BLI_task_parallel_range(0, totgrid, &data, pbvh_build_grids_prim_bounds_task_cb, &settings);
 
   if (totgrid) {
     pbvh_build(pbvh, &cb, prim_bbc, totgrid);
@@ -154,6 +154,8 @@ struct PBVH {
   /* Only used during BVH build and update,
    * don't need to remain valid after */
   BLI_bitmap *vert_bitmap;
+  /** Index of the first leaf (in build order) using each vertex, for the threaded build. */
+  int *vert_leaf_owner;
 
 #ifdef PERFCNTRS
   int perf_modified;
@@ -0,0 +1,221 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_mesh.h"
+#include "BKE_pbvh.h"
+
+#include "PIL_time.h"
+
+#include "pbvh_intern.h"
+
+namespace blender::bke::tests {
+
+/* Large enough for sub-trees to be partitioned on multiple threads. */
+#define GRID_SIZE 512
+
+class PBVHBuildTest : public testing::Test {
+ protected:
+  Mesh mesh;
+  CustomData vdata, ldata, pdata;
+  MVert *mverts = nullptr;
+  MLoop *mloops = nullptr;
+  MPoly *mpolys = nullptr;
+  int totvert = 0, totloop = 0, totpoly = 0, looptri_num = 0;
+
+  void SetUp() override
+  {
+    BLI_threadapi_init();
+
+    memset(&mesh, 0, sizeof(mesh));
+    CustomData_reset(&vdata);
+    CustomData_reset(&ldata);
+    CustomData_reset(&pdata);
+
+    /* A grid of quads, slightly bumped so bounds are not all coplanar. */
+    const int verts_per_side = GRID_SIZE + 1;
+    totvert = verts_per_side * verts_per_side;
+    totpoly = GRID_SIZE * GRID_SIZE;
+    totloop = totpoly * 4;
+    looptri_num = poly_to_tri_count(totpoly, totloop);
+    mverts = (MVert *)MEM_calloc_arrayN(totvert, sizeof(MVert), __func__);
+    mloops = (MLoop *)MEM_calloc_arrayN(totloop, sizeof(MLoop), __func__);
+    mpolys = (MPoly *)MEM_calloc_arrayN(totpoly, sizeof(MPoly), __func__);
+
+    for (int y = 0; y < verts_per_side; y++) {
+      for (int x = 0; x < verts_per_side; x++) {
+        MVert *mv = &mverts[y * verts_per_side + x];
+        mv->co[0] = (float)x;
+        mv->co[1] = (float)y;
+        mv->co[2] = sinf((float)x * 0.1f) * cosf((float)y * 0.07f);
+      }
+    }
+    for (int y = 0; y < GRID_SIZE; y++) {
+      for (int x = 0; x < GRID_SIZE; x++) {
+        const int poly_index = y * GRID_SIZE + x;
+        MPoly *mp = &mpolys[poly_index];
+        mp->loopstart = poly_index * 4;
+        mp->totloop = 4;
+        MLoop *ml = &mloops[mp->loopstart];
+        ml[0].v = (unsigned int)(y * verts_per_side + x);
+        ml[1].v = (unsigned int)(y * verts_per_side + x + 1);
+        ml[2].v = (unsigned int)((y + 1) * verts_per_side + x + 1);
+        ml[3].v = (unsigned int)((y + 1) * verts_per_side + x);
+      }
+    }
+  }
+
+  void TearDown() override
+  {
+    MEM_freeN(mverts);
+    MEM_freeN(mloops);
+    MEM_freeN(mpolys);
+
+    BLI_threadapi_exit();
+  }
+
+  PBVH *build_pbvh(double *r_time)
+  {
+    /* Owned by the PBVH. */
+    MLoopTri *looptri = (MLoopTri *)MEM_malloc_arrayN(looptri_num, sizeof(MLoopTri), __func__);
+    BKE_mesh_recalc_looptri(mloops, mpolys, mverts, totloop, totpoly, looptri);
+
+    PBVH *pbvh = BKE_pbvh_new();
+    const double start_time = PIL_check_seconds_timer();
+    BKE_pbvh_build_mesh(pbvh,
+                        &mesh,
+                        mpolys,
+                        mloops,
+                        mverts,
+                        totvert,
+                        &vdata,
+                        &ldata,
+                        &pdata,
+                        looptri,
+                        looptri_num);
+    *r_time = PIL_check_seconds_timer() - start_time;
+    return pbvh;
+  }
+
+  /* The scheduler reads the thread count override when it is initialized. */
+  static void task_scheduler_reinit(const int num_threads)
+  {
+    BLI_task_scheduler_exit();
+    BLI_system_num_threads_override_set(num_threads);
+    BLI_task_scheduler_init();
+  }
+};
+
+static void expect_pbvh_nodes_match(const PBVH *pbvh, const PBVH *pbvh_expected)
+{
+  ASSERT_EQ(pbvh->totnode, pbvh_expected->totnode);
+  ASSERT_EQ(pbvh->totprim, pbvh_expected->totprim);
+  EXPECT_EQ(memcmp(pbvh->prim_indices,
+                   pbvh_expected->prim_indices,
+                   sizeof(*pbvh->prim_indices) * pbvh->totprim),
+            0);
+
+  for (int i = 0; i < pbvh->totnode; i++) {
+    const PBVHNode *node = &pbvh->nodes[i];
+    const PBVHNode *node_expected = &pbvh_expected->nodes[i];
+    EXPECT_EQ(node->flag & PBVH_Leaf, node_expected->flag & PBVH_Leaf);
+    EXPECT_V3_NEAR(node->vb.bmin, node_expected->vb.bmin, 0.0f);
+    EXPECT_V3_NEAR(node->vb.bmax, node_expected->vb.bmax, 0.0f);
+    if (!(node->flag & PBVH_Leaf)) {
+      EXPECT_EQ(node->children_offset, node_expected->children_offset);
+      continue;
+    }
+    ASSERT_EQ(node->totprim, node_expected->totprim);
+    EXPECT_EQ(node->prim_indices - pbvh->prim_indices,
+              node_expected->prim_indices - pbvh_expected->prim_indices);
+    ASSERT_EQ(node->uniq_verts, node_expected->uniq_verts);
+    ASSERT_EQ(node->face_verts, node_expected->face_verts);
+    EXPECT_EQ(memcmp(node->vert_indices,
+                     node_expected->vert_indices,
+                     sizeof(*node->vert_indices) * (node->uniq_verts + node->face_verts)),
+              0);
+    EXPECT_EQ(memcmp(node->face_vert_indices,
+                     node_expected->face_vert_indices,
+                     sizeof(*node->face_vert_indices) * node->totprim),
+              0);
+  }
+}
+
+/* Building on one thread runs the same code serially, so the trees have to be identical. The build
+ * times of both are printed for comparison. */
+TEST_F(PBVHBuildTest, MeshThreadedMatchesSingleThread)
+{
+  double time_single, time_threaded;
+
+  task_scheduler_reinit(1);
+  PBVH *pbvh_single = build_pbvh(&time_single);
+
+  task_scheduler_reinit(0);
+  PBVH *pbvh_threaded = build_pbvh(&time_threaded);
+
+  printf("PBVH build of %d triangles: single thread %fs, %d threads %fs\n",
+         looptri_num,
+         time_single,
+         BLI_task_scheduler_num_threads(),
+         time_threaded);
+
+  expect_pbvh_nodes_match(pbvh_threaded, pbvh_single);
+
+  BKE_pbvh_free(pbvh_single);
+  BKE_pbvh_free(pbvh_threaded);
+}
+
+TEST_F(PBVHBuildTest, MeshUniqueVertsAssignedOnce)
+{
+  double time;
+  PBVH *pbvh = build_pbvh(&time);
+
+  /* Every vertex used by the mesh is unique to exactly one leaf. */
+  int *owner_count = (int *)MEM_calloc_arrayN(totvert, sizeof(int), __func__);
+  for (int i = 0; i < pbvh->totnode; i++) {
+    const PBVHNode *node = &pbvh->nodes[i];
+    if (!(node->flag & PBVH_Leaf)) {
+      continue;
+    }
+    EXPECT_LE(node->totprim, (unsigned int)pbvh->leaf_limit);
+    for (unsigned int j = 0; j < node->uniq_verts; j++) {
+      owner_count[node->vert_indices[j]]++;
+    }
+  }
+  for (int i = 0; i < totvert; i++) {
+    EXPECT_EQ(owner_count[i], 1);
+  }
+
+  MEM_freeN(owner_count);
+  BKE_pbvh_free(pbvh);
+}
+
+}  // namespace blender::bke::tests
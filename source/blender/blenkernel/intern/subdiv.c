@@ -23,10 +23,13 @@
 
 #include "BKE_subdiv.h"
 
+#include "BKE_customdata.h"
+
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_modifier_types.h"
 
+#include "BLI_math_vector.h"
 #include "BLI_utildefines.h"
 
 #include "MEM_guardedalloc.h"
@@ -181,14 +184,162 @@ Subdiv *BKE_subdiv_update_from_converter(Subdiv *subdiv,
   return BKE_subdiv_new_from_converter(settings, converter);
 }
 
+/* Copy of everything the mesh converter passes to OpenSubdiv, except vertex positions.
+ * UV coordinates are included since they define the face-varying topology. */
+typedef struct SubdivMeshTopology {
+  int totvert, totedge, totloop, totpoly;
+  unsigned int (*edge_verts)[2];
+  /* NULL when creases are not used. */
+  char *edge_creases;
+  MLoop *loops;
+  /* Loop start and number of loops of every polygon. */
+  int (*poly_loops)[2];
+  int num_uv_layers;
+  /* UV coordinates of all layers, one layer after another. */
+  float (*uvs)[2];
+} SubdivMeshTopology;
+
+static SubdivMeshTopology *subdiv_mesh_topology_create(const SubdivSettings *settings,
+                                                       const Mesh *mesh)
+{
+  SubdivMeshTopology *topology = MEM_callocN(sizeof(SubdivMeshTopology), __func__);
+  topology->totvert = mesh->totvert;
+  topology->totedge = mesh->totedge;
+  topology->totloop = mesh->totloop;
+  topology->totpoly = mesh->totpoly;
+
+  topology->edge_verts = MEM_malloc_arrayN(
+      (size_t)mesh->totedge, sizeof(*topology->edge_verts), __func__);
+  if (settings->use_creases) {
+    topology->edge_creases = MEM_malloc_arrayN(
+        (size_t)mesh->totedge, sizeof(*topology->edge_creases), __func__);
+  }
+  for (int i = 0; i < mesh->totedge; i++) {
+    topology->edge_verts[i][0] = mesh->medge[i].v1;
+    topology->edge_verts[i][1] = mesh->medge[i].v2;
+    if (topology->edge_creases != NULL) {
+      topology->edge_creases[i] = mesh->medge[i].crease;
+    }
+  }
+
+  topology->loops = MEM_malloc_arrayN((size_t)mesh->totloop, sizeof(*topology->loops), __func__);
+  memcpy(topology->loops, mesh->mloop, sizeof(*topology->loops) * (size_t)mesh->totloop);
+
+  topology->poly_loops = MEM_malloc_arrayN(
+      (size_t)mesh->totpoly, sizeof(*topology->poly_loops), __func__);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    topology->poly_loops[i][0] = mesh->mpoly[i].loopstart;
+    topology->poly_loops[i][1] = mesh->mpoly[i].totloop;
+  }
+
+  topology->num_uv_layers = CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV);
+  if (topology->num_uv_layers != 0) {
+    topology->uvs = MEM_malloc_arrayN((size_t)topology->num_uv_layers * (size_t)mesh->totloop,
+                                      sizeof(*topology->uvs),
+                                      __func__);
+    float(*uv)[2] = topology->uvs;
+    for (int layer_index = 0; layer_index < topology->num_uv_layers; layer_index++) {
+      const MLoopUV *mloopuv = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+      for (int i = 0; i < mesh->totloop; i++, uv++) {
+        copy_v2_v2(*uv, mloopuv[i].uv);
+      }
+    }
+  }
+
+  return topology;
+}
+
+static void subdiv_mesh_topology_free(SubdivMeshTopology *topology)
+{
+  MEM_SAFE_FREE(topology->edge_verts);
+  MEM_SAFE_FREE(topology->edge_creases);
+  MEM_SAFE_FREE(topology->loops);
+  MEM_SAFE_FREE(topology->poly_loops);
+  MEM_SAFE_FREE(topology->uvs);
+  MEM_freeN(topology);
+}
+
+/* Exact comparison, returns as soon as a difference is found. UV coordinates are compared
+ * bitwise, a change which doesn't affect the face-varying topology still counts as a change. */
+static bool subdiv_mesh_topology_equal(const SubdivMeshTopology *topology,
+                                       const SubdivSettings *settings,
+                                       const Mesh *mesh)
+{
+  if (topology->totvert != mesh->totvert || topology->totedge != mesh->totedge ||
+      topology->totloop != mesh->totloop || topology->totpoly != mesh->totpoly ||
+      (topology->edge_creases != NULL) != settings->use_creases ||
+      topology->num_uv_layers != CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV)) {
+    return false;
+  }
+
+  for (int i = 0; i < mesh->totedge; i++) {
+    const MEdge *medge = &mesh->medge[i];
+    if (topology->edge_verts[i][0] != medge->v1 || topology->edge_verts[i][1] != medge->v2) {
+      return false;
+    }
+    if (topology->edge_creases != NULL && topology->edge_creases[i] != medge->crease) {
+      return false;
+    }
+  }
+  if (memcmp(topology->loops, mesh->mloop, sizeof(*topology->loops) * (size_t)mesh->totloop) !=
+      0) {
+    return false;
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    if (topology->poly_loops[i][0] != mesh->mpoly[i].loopstart ||
+        topology->poly_loops[i][1] != mesh->mpoly[i].totloop) {
+      return false;
+    }
+  }
+
+  const float(*uv)[2] = (const float(*)[2])topology->uvs;
+  for (int layer_index = 0; layer_index < topology->num_uv_layers; layer_index++) {
+    const MLoopUV *mloopuv = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+    for (int i = 0; i < mesh->totloop; i++, uv++) {
+      if (memcmp(*uv, mloopuv[i].uv, sizeof(*uv)) != 0) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
                                     const SubdivSettings *settings,
                                     const Mesh *mesh)
 {
+  /* Comparing the mesh with its stored copy is much cheaper than creating a converter and
+   * comparing it against the topology refiner, which is what happens on every evaluation of an
+   * animated mesh. */
+  SubdivStats stats;
+  BKE_subdiv_stats_init(&stats);
+  bool mesh_topology_equal = false;
+  if (subdiv != NULL && subdiv->topology_refiner != NULL && subdiv->mesh_topology != NULL &&
+      BKE_subdiv_settings_equal(&subdiv->settings, settings)) {
+    BKE_subdiv_stats_begin(&stats, SUBDIV_STATS_MESH_TOPOLOGY_COMPARE);
+    mesh_topology_equal = subdiv_mesh_topology_equal(subdiv->mesh_topology, settings, mesh);
+    BKE_subdiv_stats_end(&stats, SUBDIV_STATS_MESH_TOPOLOGY_COMPARE);
+  }
+  if (mesh_topology_equal) {
+    BKE_subdiv_stats_reset(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_REFINER_CREATION_TIME);
+    BKE_subdiv_stats_reset(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_COMPARE);
+    subdiv->stats.mesh_topology_compare_time = stats.mesh_topology_compare_time;
+    return subdiv;
+  }
+
   OpenSubdiv_Converter converter;
   BKE_subdiv_converter_init_for_mesh(&converter, settings, mesh);
   subdiv = BKE_subdiv_update_from_converter(subdiv, settings, &converter);
   BKE_subdiv_converter_free(&converter);
+  if (subdiv != NULL) {
+    /* The refiner might have been re-used for a mesh which differs from the stored one. */
+    if (subdiv->mesh_topology != NULL) {
+      subdiv_mesh_topology_free(subdiv->mesh_topology);
+    }
+    subdiv->mesh_topology = subdiv_mesh_topology_create(settings, mesh);
+    subdiv->stats.mesh_topology_compare_time = stats.mesh_topology_compare_time;
+  }
   return subdiv;
 }
 
@@ -203,6 +354,9 @@ void BKE_subdiv_free(Subdiv *subdiv)
     openSubdiv_deleteTopologyRefiner(subdiv->topology_refiner);
   }
   BKE_subdiv_displacement_detach(subdiv);
+  if (subdiv->mesh_topology != NULL) {
+    subdiv_mesh_topology_free(subdiv->mesh_topology);
+  }
   if (subdiv->cache_.face_ptex_offset != NULL) {
     MEM_freeN(subdiv->cache_.face_ptex_offset);
   }
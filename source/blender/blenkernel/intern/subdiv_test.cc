@@ -0,0 +1,307 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation
+ * All rights reserved.
+ */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_subdiv.h"
+
+#include "PIL_time.h"
+
+#include "opensubdiv_converter_capi.h"
+#include "opensubdiv_topology_refiner_capi.h"
+
+#include "subdiv_converter.h"
+
+/* Without OpenSubdiv no topology refiner is ever created. */
+#ifdef WITH_OPENSUBDIV
+
+namespace blender::bke::tests {
+
+/* Compares a subdiv updated from a mesh with one created from scratch for the same mesh. */
+class SubdivUpdateFromMeshTest : public testing::Test {
+ protected:
+  SubdivSettings settings;
+  Mesh *mesh = nullptr;
+  Subdiv *subdiv = nullptr;
+
+  static void SetUpTestCase()
+  {
+    BKE_idtype_init();
+    BKE_subdiv_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_subdiv_exit();
+  }
+
+  void SetUp() override
+  {
+    memset(&settings, 0, sizeof(settings));
+    settings.level = 1;
+    settings.use_creases = true;
+    settings.vtx_boundary_interpolation = SUBDIV_VTX_BOUNDARY_EDGE_ONLY;
+    settings.fvar_linear_interpolation = SUBDIV_FVAR_LINEAR_INTERPOLATION_BOUNDARIES;
+  }
+
+  void TearDown() override
+  {
+    if (subdiv != nullptr) {
+      BKE_subdiv_free(subdiv);
+    }
+    BKE_id_free(nullptr, mesh);
+  }
+
+  /* Quads in the XY plane, with UV coordinates matching the vertex positions. */
+  static Mesh *grid_mesh_create(const int grid_size)
+  {
+    const int verts_per_side = grid_size + 1;
+    const int totedge_x = verts_per_side * grid_size;
+    Mesh *mesh = BKE_mesh_new_nomain(verts_per_side * verts_per_side,
+                                     totedge_x * 2,
+                                     0,
+                                     grid_size * grid_size * 4,
+                                     grid_size * grid_size);
+    MLoopUV *mloopuv = (MLoopUV *)CustomData_add_layer(
+        &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop);
+
+    for (int y = 0; y < verts_per_side; y++) {
+      for (int x = 0; x < verts_per_side; x++) {
+        const float co[3] = {(float)x / grid_size, (float)y / grid_size, 0.0f};
+        copy_v3_v3(mesh->mvert[y * verts_per_side + x].co, co);
+      }
+    }
+    /* Edges along X first, then edges along Y. */
+    for (int y = 0; y < verts_per_side; y++) {
+      for (int x = 0; x < grid_size; x++) {
+        MEdge *me = &mesh->medge[y * grid_size + x];
+        me->v1 = (unsigned int)(y * verts_per_side + x);
+        me->v2 = me->v1 + 1;
+      }
+    }
+    for (int y = 0; y < grid_size; y++) {
+      for (int x = 0; x < verts_per_side; x++) {
+        MEdge *me = &mesh->medge[totedge_x + y * verts_per_side + x];
+        me->v1 = (unsigned int)(y * verts_per_side + x);
+        me->v2 = me->v1 + (unsigned int)verts_per_side;
+      }
+    }
+    for (int y = 0; y < grid_size; y++) {
+      for (int x = 0; x < grid_size; x++) {
+        const int poly_index = y * grid_size + x;
+        MPoly *mp = &mesh->mpoly[poly_index];
+        mp->loopstart = poly_index * 4;
+        mp->totloop = 4;
+        MLoop *ml = &mesh->mloop[mp->loopstart];
+        ml[0].v = (unsigned int)(y * verts_per_side + x);
+        ml[1].v = (unsigned int)(y * verts_per_side + x + 1);
+        ml[2].v = (unsigned int)((y + 1) * verts_per_side + x + 1);
+        ml[3].v = (unsigned int)((y + 1) * verts_per_side + x);
+        ml[0].e = (unsigned int)(y * grid_size + x);
+        ml[1].e = (unsigned int)(totedge_x + y * verts_per_side + x + 1);
+        ml[2].e = (unsigned int)((y + 1) * grid_size + x);
+        ml[3].e = (unsigned int)(totedge_x + y * verts_per_side + x);
+        for (int corner = 0; corner < 4; corner++) {
+          copy_v2_v2(mloopuv[mp->loopstart + corner].uv, mesh->mvert[ml[corner].v].co);
+        }
+      }
+    }
+    return mesh;
+  }
+
+  MLoopUV *mloopuv_get()
+  {
+    return (MLoopUV *)CustomData_get_layer(&mesh->ldata, CD_MLOOPUV);
+  }
+
+  void move_verts()
+  {
+    for (int i = 0; i < mesh->totvert; i++) {
+      mesh->mvert[i].co[2] += 0.1f * (float)(i % 5);
+    }
+  }
+
+  void expect_refiner_matches_mesh()
+  {
+    /* Includes edge sharpness, which is not accessible otherwise. */
+    OpenSubdiv_Converter converter;
+    BKE_subdiv_converter_init_for_mesh(&converter, &settings, mesh);
+    EXPECT_TRUE(
+        openSubdiv_topologyRefinerCompareWithConverter(subdiv->topology_refiner, &converter));
+    BKE_subdiv_converter_free(&converter);
+
+    Subdiv *subdiv_expected = BKE_subdiv_new_from_mesh(&settings, mesh);
+    ASSERT_NE(subdiv_expected, nullptr);
+    const OpenSubdiv_TopologyRefiner *refiner = subdiv->topology_refiner;
+    const OpenSubdiv_TopologyRefiner *refiner_expected = subdiv_expected->topology_refiner;
+
+    ASSERT_EQ(refiner->getNumVertices(refiner),
+              refiner_expected->getNumVertices(refiner_expected));
+    ASSERT_EQ(refiner->getNumFaces(refiner), refiner_expected->getNumFaces(refiner_expected));
+    ASSERT_EQ(refiner->getNumFVarChannels(refiner),
+              refiner_expected->getNumFVarChannels(refiner_expected));
+    const bool has_uvs = refiner->getNumFVarChannels(refiner) != 0;
+    if (has_uvs) {
+      EXPECT_EQ(refiner->getNumFVarValues(refiner, 0),
+                refiner_expected->getNumFVarValues(refiner_expected, 0));
+    }
+    for (int face_index = 0; face_index < refiner->getNumFaces(refiner); face_index++) {
+      const int num_face_verts = refiner->getNumFaceVertices(refiner, face_index);
+      ASSERT_EQ(num_face_verts,
+                refiner_expected->getNumFaceVertices(refiner_expected, face_index));
+      int face_verts[4], face_verts_expected[4];
+      refiner->getFaceVertices(refiner, face_index, face_verts);
+      refiner_expected->getFaceVertices(refiner_expected, face_index, face_verts_expected);
+      for (int i = 0; i < num_face_verts; i++) {
+        EXPECT_EQ(face_verts[i], face_verts_expected[i]);
+      }
+      if (has_uvs) {
+        const int *uv_indices = refiner->getFaceFVarValueIndices(refiner, face_index, 0);
+        const int *uv_indices_expected = refiner_expected->getFaceFVarValueIndices(
+            refiner_expected, face_index, 0);
+        for (int i = 0; i < num_face_verts; i++) {
+          EXPECT_EQ(uv_indices[i], uv_indices_expected[i]);
+        }
+      }
+    }
+
+    BKE_subdiv_free(subdiv_expected);
+  }
+};
+
+/* Only the positions changed, the subdiv is returned as is. */
+TEST_F(SubdivUpdateFromMeshTest, UnchangedTopology)
+{
+  mesh = grid_mesh_create(4);
+  subdiv = BKE_subdiv_update_from_mesh(nullptr, &settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  const Subdiv *subdiv_prev = subdiv;
+  const OpenSubdiv_TopologyRefiner *refiner_prev = subdiv->topology_refiner;
+
+  move_verts();
+  subdiv = BKE_subdiv_update_from_mesh(subdiv, &settings, mesh);
+  EXPECT_EQ(subdiv, subdiv_prev);
+  EXPECT_EQ(subdiv->topology_refiner, refiner_prev);
+  /* The refiner was not compared with the mesh converter. */
+  EXPECT_EQ(subdiv->stats.topology_compare_time, 0.0);
+  expect_refiner_matches_mesh();
+}
+
+/* Same element counts, but one quad starts at another corner. */
+TEST_F(SubdivUpdateFromMeshTest, RotatedFace)
+{
+  mesh = grid_mesh_create(4);
+  subdiv = BKE_subdiv_update_from_mesh(nullptr, &settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+
+  MLoop *ml = &mesh->mloop[mesh->mpoly[5].loopstart];
+  MLoopUV *mloopuv = &mloopuv_get()[mesh->mpoly[5].loopstart];
+  const MLoop ml_first = ml[0];
+  MLoopUV mloopuv_first = mloopuv[0];
+  for (int corner = 0; corner < 3; corner++) {
+    ml[corner] = ml[corner + 1];
+    mloopuv[corner] = mloopuv[corner + 1];
+  }
+  ml[3] = ml_first;
+  mloopuv[3] = mloopuv_first;
+
+  subdiv = BKE_subdiv_update_from_mesh(subdiv, &settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  expect_refiner_matches_mesh();
+  /* The changed mesh is stored, so the next update is a match again. */
+  const Subdiv *subdiv_prev = subdiv;
+  subdiv = BKE_subdiv_update_from_mesh(subdiv, &settings, mesh);
+  EXPECT_EQ(subdiv, subdiv_prev);
+  EXPECT_EQ(subdiv->stats.topology_compare_time, 0.0);
+}
+
+/* Moving the UV of one corner of an inner vertex adds a UV seam. */
+TEST_F(SubdivUpdateFromMeshTest, UVSeam)
+{
+  mesh = grid_mesh_create(4);
+  subdiv = BKE_subdiv_update_from_mesh(nullptr, &settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  const int num_uvs_prev = subdiv->topology_refiner->getNumFVarValues(subdiv->topology_refiner,
+                                                                      0);
+
+  MLoopUV *mloopuv = &mloopuv_get()[mesh->mpoly[5].loopstart];
+  mloopuv[0].uv[0] += 0.5f;
+
+  subdiv = BKE_subdiv_update_from_mesh(subdiv, &settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  EXPECT_GT(subdiv->topology_refiner->getNumFVarValues(subdiv->topology_refiner, 0),
+            num_uvs_prev);
+  expect_refiner_matches_mesh();
+}
+
+TEST_F(SubdivUpdateFromMeshTest, ChangedCreases)
+{
+  mesh = grid_mesh_create(4);
+  subdiv = BKE_subdiv_update_from_mesh(nullptr, &settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+
+  mesh->medge[7].crease = 255;
+  subdiv = BKE_subdiv_update_from_mesh(subdiv, &settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  expect_refiner_matches_mesh();
+}
+
+/* Prints the time of an update with unchanged topology, compared with the topology comparison of
+ * the mesh converter it replaces. */
+TEST_F(SubdivUpdateFromMeshTest, UnchangedTopologyPerformance)
+{
+  mesh = grid_mesh_create(512);
+  subdiv = BKE_subdiv_update_from_mesh(nullptr, &settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  const Subdiv *subdiv_prev = subdiv;
+  move_verts();
+
+  double start_time = PIL_check_seconds_timer();
+  subdiv = BKE_subdiv_update_from_mesh(subdiv, &settings, mesh);
+  const double time_mesh = PIL_check_seconds_timer() - start_time;
+  EXPECT_EQ(subdiv, subdiv_prev);
+
+  start_time = PIL_check_seconds_timer();
+  OpenSubdiv_Converter converter;
+  BKE_subdiv_converter_init_for_mesh(&converter, &settings, mesh);
+  subdiv = BKE_subdiv_update_from_converter(subdiv, &settings, &converter);
+  BKE_subdiv_converter_free(&converter);
+  const double time_converter = PIL_check_seconds_timer() - start_time;
+  EXPECT_EQ(subdiv, subdiv_prev);
+
+  printf("Subdiv update of %d faces: mesh comparison %fs, converter comparison %fs\n",
+         mesh->totpoly,
+         time_mesh,
+         time_converter);
+}
+
+}  // namespace blender::bke::tests
+
+#endif
@@ -46,6 +46,9 @@ void BLI_array_store_state_remove(BArrayStore *bs, BArrayState *state);
 size_t BLI_array_store_state_size_get(BArrayState *state);
 void BLI_array_store_state_data_get(BArrayState *state, void *data);
 void *BLI_array_store_state_data_get_alloc(BArrayState *state, size_t *r_data_len);
+bool BLI_array_store_state_is_identical(const BArrayState *state_a, const BArrayState *state_b);
+size_t BLI_array_store_state_size_added_get(const BArrayState *state,
+                                            const BArrayState *state_reference);
 
 /* only for tests */
 bool BLI_array_store_is_valid(BArrayStore *bs);
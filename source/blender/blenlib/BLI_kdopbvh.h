@@ -102,6 +102,11 @@ enum {
   /* calculate IsectRayPrecalc data */
   BVH_RAYCAST_WATERTIGHT = (1 << 0),
 };
+enum {
+  /* Split using the surface area heuristic instead of the median of the largest axis,
+   * slower to build but faster to ray-cast (only supported for trees including the AABB axes). */
+  BVH_BALANCE_SAH = (1 << 0),
+};
 #define BVH_RAYCAST_DEFAULT (BVH_RAYCAST_WATERTIGHT)
 #define BVH_RAYCAST_DIST_MAX (FLT_MAX / 2.0f)
 
@@ -149,6 +154,7 @@ void BLI_bvhtree_free(BVHTree *tree);
 /* construct: first insert points, then call balance */
 void BLI_bvhtree_insert(BVHTree *tree, int index, const float co[3], int numpoints);
 void BLI_bvhtree_balance(BVHTree *tree);
+void BLI_bvhtree_balance_ex(BVHTree *tree, const int flag);
 
 /* update: first update points/nodes, then call update_tree to refit the bounding volumes */
 bool BLI_bvhtree_update_node(
@@ -195,6 +201,16 @@ int BLI_bvhtree_find_nearest(BVHTree *tree,
                              BVHTree_NearestPointCallback callback,
                              void *userdata);
 
+/* Find the nearest node for many coordinates at once, see #BLI_bvhtree_find_nearest_ex.
+ * Each entry of \a nearest must be initialized by the caller. */
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    const int co_num,
+                                    BVHTreeNearest *nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    int flag);
+
 int BLI_bvhtree_find_nearest_first(BVHTree *tree,
                                    const float co[3],
                                    const float dist_sq,
@@ -217,6 +233,19 @@ int BLI_bvhtree_ray_cast(BVHTree *tree,
                          BVHTree_RayCastCallback callback,
                          void *userdata);
 
+/* Cast many rays at once, rays are traversed in packets sharing the same direction signs.
+ * Each hit in \a hits is used and updated like the \a hit argument of
+ * #BLI_bvhtree_ray_cast_ex (so it must be initialized by the caller). */
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*co)[3],
+                                const float (*dir)[3],
+                                const int rays_num,
+                                float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag);
+
 void BLI_bvhtree_ray_cast_all_ex(BVHTree *tree,
                                  const float co[3],
                                  const float dir[3],
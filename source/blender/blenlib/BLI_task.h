@@ -164,6 +164,9 @@ typedef struct TaskParallelSettings {
    *   thread which will be doing 16 iterators each.
    * This is a preferred way to tell scheduler when to start threading than
    * having a global use_threading switch based on just range size.
+   *
+   * When zero, BLI_task_parallel_range() measures the cost of the first
+   * iterations and chooses the chunk size from it.
    */
   int min_iter_per_thread;
 } TaskParallelSettings;
@@ -229,7 +232,7 @@ BLI_INLINE void BLI_parallel_range_settings_defaults(TaskParallelSettings *setti
 {
   memset(settings, 0, sizeof(*settings));
   settings->use_threading = true;
-  /* Use default heuristic to define actual chunk size. */
+  /* Use default heuristic to define actual chunk size (measured cost of iterations). */
   settings->min_iter_per_thread = 0;
 }
 
@@ -30,8 +30,10 @@
  *
  * - Ray-cast:
  *   #BLI_bvhtree_ray_cast, #BVHRayCastData
+ *   #BLI_bvhtree_ray_cast_batch, #BVHRayPacket
  * - Nearest point on surface:
  *   #BLI_bvhtree_find_nearest, #BVHNearestData
+ *   #BLI_bvhtree_find_nearest_batch, #BVHNearestPacket
  * - Overlapping 2 trees:
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
  * - Range Query:
@@ -40,6 +42,10 @@
 
 #include <assert.h>
 
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "BLI_alloca.h"
@@ -865,6 +871,376 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Surface Area Heuristic Balance
+ *
+ * Alternative to #non_recursive_bvh_div_nodes used with #BVH_BALANCE_SAH.
+ *
+ * A binary tree is built first, splitting each node where the binned surface area heuristic
+ * is minimal. It's then collapsed into branches of up to `tree_type` children,
+ * by repeatedly opening the child with the largest surface area.
+ *
+ * Unlike the implicit tree the number of branches isn't known beforehand,
+ * the node arrays are grown when they're too small.
+ * \{ */
+
+#define BVH_SAH_BINS 16
+
+/* Node of the intermediate binary tree. */
+typedef struct BVHSahNode {
+  /* Range in the leaf order array. */
+  int begin, end;
+  /* Binary children, -1 for nodes with a single leaf. */
+  int children[2];
+  /* Index in the branches of the collapsed tree. */
+  int branch;
+  float bounds[2][3];
+  axis_t split_axis;
+} BVHSahNode;
+
+typedef struct BVHSahBin {
+  float bounds[2][3];
+  int count;
+} BVHSahBin;
+
+static void sah_bounds_expand(float bounds[2][3], const float other[2][3])
+{
+  for (int i = 0; i < 3; i++) {
+    bounds[0][i] = min_ff(bounds[0][i], other[0][i]);
+    bounds[1][i] = max_ff(bounds[1][i], other[1][i]);
+  }
+}
+
+static void sah_bounds_expand_bv(float r_min[3], float r_max[3], const float *bv)
+{
+  for (int i = 0; i < 3; i++) {
+    r_min[i] = min_ff(r_min[i], bv[2 * i]);
+    r_max[i] = max_ff(r_max[i], bv[2 * i + 1]);
+  }
+}
+
+static float sah_bounds_area(const float bounds[2][3])
+{
+  float size[3];
+  sub_v3_v3v3(size, bounds[1], bounds[0]);
+  return size[0] * size[1] + size[1] * size[2] + size[2] * size[0];
+}
+
+static int sah_bin_index(const float co, const float co_min, const float scale)
+{
+  /* Clamp before casting, the scale of tiny extents may overflow. */
+  const float bin = (co - co_min) * scale;
+  return (bin < (float)(BVH_SAH_BINS - 1)) ? max_ii(0, (int)bin) : BVH_SAH_BINS - 1;
+}
+
+/**
+ * Find the axis and bin to split the leafs of \a node at, with the lowest SAH cost.
+ * \return false when all centroids are at the same position.
+ */
+static bool sah_find_split(const BVHTree *tree,
+                           const int *leaf_order,
+                           const float (*centroids)[3],
+                           const BVHSahNode *node,
+                           const float centroid_bounds[2][3],
+                           int *r_axis,
+                           int *r_bin)
+{
+  float best_cost = FLT_MAX;
+  *r_axis = -1;
+
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = centroid_bounds[1][axis] - centroid_bounds[0][axis];
+    if (extent <= 0.0f) {
+      continue;
+    }
+    const float scale = (float)BVH_SAH_BINS / extent;
+
+    BVHSahBin bins[BVH_SAH_BINS];
+    for (int b = 0; b < BVH_SAH_BINS; b++) {
+      INIT_MINMAX(bins[b].bounds[0], bins[b].bounds[1]);
+      bins[b].count = 0;
+    }
+
+    for (int i = node->begin; i < node->end; i++) {
+      const int leaf = leaf_order[i];
+      const int b = sah_bin_index(centroids[leaf][axis], centroid_bounds[0][axis], scale);
+      BVHSahBin *bin = &bins[b];
+      sah_bounds_expand_bv(bin->bounds[0], bin->bounds[1], tree->nodearray[leaf].bv);
+      bin->count++;
+    }
+
+    /* Sweep from the right to accumulate the cost of the right side of each split. */
+    float right_area[BVH_SAH_BINS];
+    int right_count[BVH_SAH_BINS];
+    float bounds[2][3];
+    int count = 0;
+    INIT_MINMAX(bounds[0], bounds[1]);
+    for (int b = BVH_SAH_BINS - 1; b > 0; b--) {
+      sah_bounds_expand(bounds, bins[b].bounds);
+      count += bins[b].count;
+      right_area[b] = (count != 0) ? sah_bounds_area(bounds) : 0.0f;
+      right_count[b] = count;
+    }
+
+    count = 0;
+    INIT_MINMAX(bounds[0], bounds[1]);
+    for (int b = 1; b < BVH_SAH_BINS; b++) {
+      sah_bounds_expand(bounds, bins[b - 1].bounds);
+      count += bins[b - 1].count;
+      if (count == 0 || right_count[b] == 0) {
+        continue;
+      }
+      const float cost = sah_bounds_area(bounds) * (float)count +
+                         right_area[b] * (float)right_count[b];
+      if (cost < best_cost) {
+        best_cost = cost;
+        *r_axis = axis;
+        *r_bin = b;
+      }
+    }
+  }
+
+  return (*r_axis != -1);
+}
+
+/**
+ * Build the binary tree in \a r_nodes, reordering \a leaf_order.
+ * \return the number of nodes used.
+ */
+static int sah_build_binary(const BVHTree *tree,
+                            int *leaf_order,
+                            const float (*centroids)[3],
+                            BVHSahNode *r_nodes)
+{
+  /* Pending nodes have disjoint leaf ranges, so there are never more than `totleaf`. */
+  int *stack = MEM_mallocN(sizeof(*stack) * (size_t)tree->totleaf, __func__);
+  int stack_len = 0;
+  int nodes_len = 1;
+
+  r_nodes[0].begin = 0;
+  r_nodes[0].end = tree->totleaf;
+  stack[stack_len++] = 0;
+
+  while (stack_len != 0) {
+    BVHSahNode *node = &r_nodes[stack[--stack_len]];
+    float centroid_bounds[2][3];
+
+    INIT_MINMAX(node->bounds[0], node->bounds[1]);
+    INIT_MINMAX(centroid_bounds[0], centroid_bounds[1]);
+    for (int i = node->begin; i < node->end; i++) {
+      const int leaf = leaf_order[i];
+      sah_bounds_expand_bv(node->bounds[0], node->bounds[1], tree->nodearray[leaf].bv);
+      minmax_v3v3_v3(centroid_bounds[0], centroid_bounds[1], centroids[leaf]);
+    }
+
+    if (node->end - node->begin == 1) {
+      node->children[0] = node->children[1] = -1;
+      node->split_axis = 0;
+      continue;
+    }
+
+    int axis, bin, mid;
+    if (sah_find_split(tree, leaf_order, centroids, node, centroid_bounds, &axis, &bin)) {
+      const float scale = (float)BVH_SAH_BINS /
+                          (centroid_bounds[1][axis] - centroid_bounds[0][axis]);
+      int i = node->begin, j = node->end - 1;
+      while (i <= j) {
+        if (sah_bin_index(centroids[leaf_order[i]][axis], centroid_bounds[0][axis], scale) <
+            bin) {
+          i++;
+        }
+        else {
+          SWAP(int, leaf_order[i], leaf_order[j]);
+          j--;
+        }
+      }
+      mid = i;
+    }
+    else {
+      /* All centroids are the same, any split is as good as another. */
+      float size[3];
+      sub_v3_v3v3(size, node->bounds[1], node->bounds[0]);
+      axis = axis_dominant_v3_single(size);
+      mid = (node->begin + node->end) / 2;
+    }
+    BLI_assert(mid > node->begin && mid < node->end);
+
+    node->split_axis = (axis_t)axis;
+    node->children[0] = nodes_len;
+    node->children[1] = nodes_len + 1;
+    r_nodes[nodes_len].begin = node->begin;
+    r_nodes[nodes_len].end = mid;
+    r_nodes[nodes_len + 1].begin = mid;
+    r_nodes[nodes_len + 1].end = node->end;
+
+    stack[stack_len++] = nodes_len;
+    stack[stack_len++] = nodes_len + 1;
+    nodes_len += 2;
+  }
+
+  MEM_freeN(stack);
+  return nodes_len;
+}
+
+/**
+ * Grow the node arrays so they can hold \a totbranch branches after the leafs.
+ * Only valid before the tree is balanced, when no node references another.
+ */
+static void bvhtree_ensure_branches_len(BVHTree *tree, const int totbranch)
+{
+  const int numnodes_prev = (int)(MEM_allocN_len(tree->nodearray) / sizeof(*tree->nodearray));
+  const int numnodes = tree->totleaf + totbranch + tree->tree_type;
+
+  if (numnodes <= numnodes_prev) {
+    return;
+  }
+
+  tree->nodes = MEM_recallocN(tree->nodes, sizeof(*tree->nodes) * (size_t)numnodes);
+  tree->nodebv = MEM_recallocN(tree->nodebv, sizeof(float) * (size_t)(tree->axis * numnodes));
+  tree->nodechild = MEM_recallocN(tree->nodechild,
+                                  sizeof(BVHNode *) * (size_t)(tree->tree_type * numnodes));
+  tree->nodearray = MEM_recallocN(tree->nodearray, sizeof(BVHNode) * (size_t)numnodes);
+
+  /* Re-link the dynamic bv and child links. */
+  for (int i = 0; i < numnodes; i++) {
+    tree->nodearray[i].bv = &tree->nodebv[i * tree->axis];
+    tree->nodearray[i].children = &tree->nodechild[i * tree->tree_type];
+  }
+  for (int i = 0; i < tree->totleaf; i++) {
+    tree->nodes[i] = &tree->nodearray[i];
+  }
+}
+
+static void bvhtree_balance_sah(BVHTree *tree)
+{
+  const int totleaf = tree->totleaf;
+  const int tree_type = tree->tree_type;
+
+  BLI_assert(tree->start_axis == 0 && totleaf > 1);
+
+  float(*centroids)[3] = MEM_mallocN(sizeof(*centroids) * (size_t)totleaf, __func__);
+  int *leaf_order = MEM_mallocN(sizeof(*leaf_order) * (size_t)totleaf, __func__);
+  for (int i = 0; i < totleaf; i++) {
+    const float *bv = tree->nodearray[i].bv;
+    centroids[i][0] = (bv[0] + bv[1]) * 0.5f;
+    centroids[i][1] = (bv[2] + bv[3]) * 0.5f;
+    centroids[i][2] = (bv[4] + bv[5]) * 0.5f;
+    leaf_order[i] = i;
+  }
+
+  BVHSahNode *nodes = MEM_mallocN(sizeof(*nodes) * (size_t)(2 * totleaf - 1), __func__);
+  sah_build_binary(tree, leaf_order, (const float(*)[3])centroids, nodes);
+  MEM_freeN(centroids);
+
+  /* Collapse the binary tree, branches are added in breadth first order
+   * so children always have a greater index than their parent (see #BLI_bvhtree_update_tree).
+   * A binary tree with N leafs has N - 1 branches, collapsing can only reduce that. */
+  const int branches_max = totleaf - 1;
+  int *branch_node = MEM_mallocN(sizeof(*branch_node) * (size_t)branches_max, __func__);
+  int *branch_children = MEM_mallocN(sizeof(*branch_children) * (size_t)(branches_max * tree_type),
+                                     __func__);
+  char *branch_totnode = MEM_mallocN(sizeof(*branch_totnode) * (size_t)branches_max, __func__);
+  int totbranch = 1;
+
+  branch_node[0] = 0;
+  nodes[0].branch = 0;
+
+  for (int b = 0; b < totbranch; b++) {
+    const BVHSahNode *node = &nodes[branch_node[b]];
+    int *children = &branch_children[b * tree_type];
+    int children_len = 2;
+
+    children[0] = node->children[0];
+    children[1] = node->children[1];
+
+    while (children_len < tree_type) {
+      int best = -1;
+      float best_area = -1.0f;
+      for (int k = 0; k < children_len; k++) {
+        const BVHSahNode *child = &nodes[children[k]];
+        if (child->children[0] != -1) {
+          const float area = sah_bounds_area(child->bounds);
+          if (area > best_area) {
+            best_area = area;
+            best = k;
+          }
+        }
+      }
+      if (best == -1) {
+        break;
+      }
+
+      /* Replace the child with its own children, keeping their order. */
+      const BVHSahNode *child = &nodes[children[best]];
+      memmove(&children[best + 2],
+              &children[best + 1],
+              sizeof(*children) * (size_t)(children_len - best - 1));
+      children[best] = child->children[0];
+      children[best + 1] = child->children[1];
+      children_len++;
+    }
+
+    branch_totnode[b] = (char)children_len;
+    for (int k = 0; k < children_len; k++) {
+      BVHSahNode *child = &nodes[children[k]];
+      if (child->children[0] != -1) {
+        child->branch = totbranch;
+        branch_node[totbranch++] = children[k];
+      }
+    }
+  }
+
+  bvhtree_ensure_branches_len(tree, totbranch);
+
+  for (int b = 0; b < totbranch; b++) {
+    const BVHSahNode *node = &nodes[branch_node[b]];
+    const int *children = &branch_children[b * tree_type];
+    BVHNode *branch = &tree->nodearray[totleaf + b];
+    int k;
+
+    tree->nodes[totleaf + b] = branch;
+    branch->totnode = branch_totnode[b];
+    branch->main_axis = (char)node->split_axis;
+
+    /* Keep children sorted along the main axis, ray-casts use this to pick the loop order. */
+    float centers[MAX_TREETYPE];
+    for (k = 0; k < branch->totnode; k++) {
+      const BVHSahNode *child = &nodes[children[k]];
+      BVHNode *child_node = (child->children[0] == -1) ?
+                                &tree->nodearray[leaf_order[child->begin]] :
+                                &tree->nodearray[totleaf + child->branch];
+      const float center = child->bounds[0][node->split_axis] +
+                           child->bounds[1][node->split_axis];
+      int l;
+      for (l = k; l > 0 && center < centers[l - 1]; l--) {
+        centers[l] = centers[l - 1];
+        branch->children[l] = branch->children[l - 1];
+      }
+      centers[l] = center;
+      branch->children[l] = child_node;
+      child_node->parent = branch;
+    }
+    for (; k < tree_type; k++) {
+      branch->children[k] = NULL;
+    }
+  }
+  tree->nodes[totleaf]->parent = NULL;
+  tree->totbranch = totbranch;
+
+  /* Calculate the bounding volumes for all the axes, bottom to top. */
+  for (int b = totbranch - 1; b >= 0; b--) {
+    node_join(tree, tree->nodes[totleaf + b]);
+  }
+
+  MEM_freeN(nodes);
+  MEM_freeN(leaf_order);
+  MEM_freeN(branch_node);
+  MEM_freeN(branch_children);
+  MEM_freeN(branch_totnode);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -955,7 +1331,7 @@ void BLI_bvhtree_free(BVHTree *tree)
   }
 }
 
-void BLI_bvhtree_balance(BVHTree *tree)
+void BLI_bvhtree_balance_ex(BVHTree *tree, const int flag)
 {
   BVHNode **leafs_array = tree->nodes;
 
@@ -963,15 +1339,21 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->totbranch == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
+  /* The SAH build uses the AABB part of the bounding volumes, not available on 18-DOP's. */
+  if ((flag & BVH_BALANCE_SAH) && (tree->start_axis == 0) && (tree->totleaf > 1)) {
+    bvhtree_balance_sah(tree);
+  }
+  else {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->totleaf - 1), leafs_array, tree->totleaf);
 
-  /* current code expects the branches to be linked to the nodes array
-   * we perform that linkage here */
-  tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
-  for (int i = 0; i < tree->totbranch; i++) {
-    tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
+    /* current code expects the branches to be linked to the nodes array
+     * we perform that linkage here */
+    tree->totbranch = implicit_needed_branches(tree->tree_type, tree->totleaf);
+    for (int i = 0; i < tree->totbranch; i++) {
+      tree->nodes[tree->totleaf + i] = &tree->nodearray[tree->totleaf + i];
+    }
   }
 
 #ifdef USE_SKIP_LINKS
@@ -987,6 +1369,11 @@ void BLI_bvhtree_balance(BVHTree *tree)
 #endif
 }
 
+void BLI_bvhtree_balance(BVHTree *tree)
+{
+  BLI_bvhtree_balance_ex(tree, 0);
+}
+
 void BLI_bvhtree_insert(BVHTree *tree, int index, const float co[3], int numpoints)
 {
   axis_t axis_iter;
@@ -1643,6 +2030,162 @@ int BLI_bvhtree_find_nearest(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_find_nearest_batch
+ *
+ * Packets of coordinates are traversed together, testing the nodes for all of them at once.
+ * Each coordinate sees the same nodes in the same order as #dfs_find_nearest_dfs,
+ * so results (and callback calls) match #BLI_bvhtree_find_nearest_ex.
+ * \{ */
+
+#define BVH_PACKET_SIZE 4
+
+typedef struct BVHNearestPacket {
+  BVHNearestData lanes[BVH_PACKET_SIZE];
+  /* Lane values in SoA layout for the node tests. */
+  float proj[3][BVH_PACKET_SIZE];
+  float dist_sq[BVH_PACKET_SIZE];
+} BVHNearestPacket;
+
+/**
+ * Same as #calc_nearest_point_squared for all lanes in \a mask.
+ * \return the lanes which are closer to \a node than their current nearest.
+ */
+static int nearest_packet_node_test(const BVHNearestPacket *packet,
+                                    BVHNode *node,
+                                    const int mask)
+{
+  const float *bv = node->bv;
+#ifdef __SSE2__
+  __m128 dist_sq = _mm_setzero_ps();
+  for (int i = 0; i != 3; i++) {
+    const __m128 proj = _mm_loadu_ps(packet->proj[i]);
+    __m128 nearest = _mm_max_ps(_mm_set1_ps(bv[2 * i]), proj);
+    nearest = _mm_min_ps(_mm_set1_ps(bv[2 * i + 1]), nearest);
+    const __m128 delta = _mm_sub_ps(nearest, proj);
+    dist_sq = _mm_add_ps(dist_sq, _mm_mul_ps(delta, delta));
+  }
+  return mask & _mm_movemask_ps(_mm_cmplt_ps(dist_sq, _mm_loadu_ps(packet->dist_sq)));
+#else
+  float nearest[3];
+  int result = 0;
+  for (int lane = 0; lane < BVH_PACKET_SIZE; lane++) {
+    if ((mask & (1 << lane)) &&
+        calc_nearest_point_squared(packet->lanes[lane].proj, node, nearest) <
+            packet->dist_sq[lane]) {
+      result |= (1 << lane);
+    }
+  }
+  UNUSED_VARS(bv);
+  return result;
+#endif
+}
+
+static void dfs_find_nearest_packet(BVHNearestPacket *packet, BVHNode *node, const int mask)
+{
+  if (node->totnode == 0) {
+    for (int lane = 0; lane < BVH_PACKET_SIZE; lane++) {
+      if (mask & (1 << lane)) {
+        BVHNearestData *data = &packet->lanes[lane];
+        if (data->callback) {
+          data->callback(data->userdata, node->index, data->co, &data->nearest);
+        }
+        else {
+          data->nearest.index = node->index;
+          data->nearest.dist_sq = calc_nearest_point_squared(
+              data->proj, node, data->nearest.co);
+        }
+        packet->dist_sq[lane] = data->nearest.dist_sq;
+      }
+    }
+    return;
+  }
+
+  /* Lanes may disagree on the best order to dive into the children,
+   * traverse the children twice in that case. */
+  const float split = node->children[0]->bv[node->main_axis * 2 + 1];
+  int mask_forward = 0;
+  for (int lane = 0; lane < BVH_PACKET_SIZE; lane++) {
+    if ((mask & (1 << lane)) && packet->lanes[lane].proj[node->main_axis] <= split) {
+      mask_forward |= (1 << lane);
+    }
+  }
+  const int mask_backward = mask & ~mask_forward;
+
+  if (mask_forward) {
+    for (int i = 0; i != node->totnode; i++) {
+      const int mask_child = nearest_packet_node_test(packet, node->children[i], mask_forward);
+      if (mask_child) {
+        dfs_find_nearest_packet(packet, node->children[i], mask_child);
+      }
+    }
+  }
+  if (mask_backward) {
+    for (int i = node->totnode - 1; i >= 0; i--) {
+      const int mask_child = nearest_packet_node_test(packet, node->children[i], mask_backward);
+      if (mask_child) {
+        dfs_find_nearest_packet(packet, node->children[i], mask_child);
+      }
+    }
+  }
+}
+
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    const int co_num,
+                                    BVHTreeNearest *nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    int flag)
+{
+  BVHNode *root = tree->nodes[tree->totleaf];
+
+  /* The priority queue can't be shared between coordinates. */
+  if ((flag & BVH_NEAREST_OPTIMAL_ORDER) || (root == NULL)) {
+    for (int i = 0; i < co_num; i++) {
+      BLI_bvhtree_find_nearest_ex(tree, co[i], &nearest[i], callback, userdata, flag);
+    }
+    return;
+  }
+
+  BVHNearestPacket packet;
+
+  for (int start = 0; start < co_num; start += BVH_PACKET_SIZE) {
+    const int lanes_num = min_ii(BVH_PACKET_SIZE, co_num - start);
+
+    for (int lane = 0; lane < BVH_PACKET_SIZE; lane++) {
+      /* Unused lanes repeat the last coordinate, they're masked out. */
+      const int i = start + min_ii(lane, lanes_num - 1);
+      BVHNearestData *data = &packet.lanes[lane];
+
+      data->tree = tree;
+      data->co = co[i];
+      data->callback = callback;
+      data->userdata = userdata;
+      for (axis_t axis_iter = tree->start_axis; axis_iter != tree->stop_axis; axis_iter++) {
+        data->proj[axis_iter] = dot_v3v3(data->co, bvhtree_kdop_axes[axis_iter]);
+      }
+      memcpy(&data->nearest, &nearest[i], sizeof(data->nearest));
+
+      for (int j = 0; j != 3; j++) {
+        packet.proj[j][lane] = data->proj[j];
+      }
+      packet.dist_sq[lane] = data->nearest.dist_sq;
+    }
+
+    const int mask = nearest_packet_node_test(&packet, root, (1 << lanes_num) - 1);
+    if (mask) {
+      dfs_find_nearest_packet(&packet, root, mask);
+    }
+
+    for (int lane = 0; lane < lanes_num; lane++) {
+      memcpy(&nearest[start + lane], &packet.lanes[lane].nearest, sizeof(*nearest));
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_find_nearest_first
  * \{ */
@@ -2062,6 +2605,268 @@ void BLI_bvhtree_ray_cast_all(BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLI_bvhtree_ray_cast_batch
+ *
+ * Rays are grouped by the sign of their direction on each axis, so all rays of a packet
+ * share the slab planes and child order used by #dfs_raycast.
+ * Each ray sees the same nodes in the same order as #dfs_raycast,
+ * so results (and callback calls) match #BLI_bvhtree_ray_cast_ex.
+ * \{ */
+
+typedef struct BVHRayPacket {
+  BVHRayCastData lanes[BVH_PACKET_SIZE];
+  bool use_radius;
+  /* Lane values in SoA layout for the node tests. */
+  float origin[3][BVH_PACKET_SIZE];
+  float ray_dot_axis[3][BVH_PACKET_SIZE];
+  float idot_axis[3][BVH_PACKET_SIZE];
+  float radius[BVH_PACKET_SIZE];
+  float hit_dist[BVH_PACKET_SIZE];
+} BVHRayPacket;
+
+/* Number of direction sign combinations: negative, zero or positive on each axis. */
+#define BVH_RAY_SIGN_GROUPS 27
+
+static int ray_sign_group(const float dir[3])
+{
+  int group = 0;
+  for (int i = 2; i >= 0; i--) {
+    /* Same rounding to zero as #bvhtree_ray_cast_data_precalc. */
+    const float ray_dot_axis = dot_v3v3(dir, bvhtree_kdop_axes[i]);
+    group = group * 3 + ((fabsf(ray_dot_axis) < FLT_EPSILON) ? 1 : (ray_dot_axis < 0.0f ? 0 : 2));
+  }
+  return group;
+}
+
+/**
+ * Same as #fast_ray_nearest_hit and #ray_nearest_hit for all lanes in \a mask.
+ * \return the lanes which hit \a node before their current hit.
+ */
+static int ray_packet_node_test(const BVHRayPacket *packet, BVHNode *node, const int mask)
+{
+#ifdef __SSE2__
+  const float *bv = node->bv;
+  const __m128 hit_dist = _mm_loadu_ps(packet->hit_dist);
+  __m128 miss;
+
+  if (!packet->use_radius) {
+    /* All lanes share the same slab planes. */
+    const int *index = packet->lanes[0].index;
+    __m128 t1[3], t2[3];
+    for (int i = 0; i != 3; i++) {
+      const __m128 origin = _mm_loadu_ps(packet->origin[i]);
+      const __m128 idot_axis = _mm_loadu_ps(packet->idot_axis[i]);
+      t1[i] = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[index[2 * i]]), origin), idot_axis);
+      t2[i] = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(bv[index[2 * i + 1]]), origin), idot_axis);
+    }
+
+    miss = _mm_or_ps(_mm_cmpgt_ps(t1[0], t2[1]), _mm_cmplt_ps(t2[0], t1[1]));
+    miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(t1[0], t2[2]), _mm_cmplt_ps(t2[0], t1[2])));
+    miss = _mm_or_ps(miss, _mm_or_ps(_mm_cmpgt_ps(t1[1], t2[2]), _mm_cmplt_ps(t2[1], t1[2])));
+    for (int i = 0; i != 3; i++) {
+      miss = _mm_or_ps(miss, _mm_cmplt_ps(t2[i], _mm_setzero_ps()));
+      miss = _mm_or_ps(miss, _mm_cmpgt_ps(t1[i], hit_dist));
+    }
+
+    const __m128 dist = _mm_max_ps(_mm_max_ps(t1[0], t1[1]), t1[2]);
+    miss = _mm_or_ps(miss, _mm_cmpge_ps(dist, hit_dist));
+  }
+  else {
+    const __m128 radius = _mm_loadu_ps(packet->radius);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 low = zero, upper = hit_dist;
+    miss = zero;
+
+    for (int i = 0; i != 3; i++) {
+      const __m128 origin = _mm_loadu_ps(packet->origin[i]);
+      const __m128 ray_dot_axis = _mm_loadu_ps(packet->ray_dot_axis[i]);
+      const __m128 bv_min = _mm_sub_ps(_mm_set1_ps(bv[2 * i]), radius);
+      const __m128 bv_max = _mm_add_ps(_mm_set1_ps(bv[2 * i + 1]), radius);
+
+      /* Axis aligned rays. */
+      const __m128 aligned = _mm_cmpeq_ps(ray_dot_axis, zero);
+      const __m128 outside = _mm_or_ps(_mm_cmplt_ps(origin, bv_min), _mm_cmpgt_ps(origin, bv_max));
+      miss = _mm_or_ps(miss, _mm_and_ps(aligned, outside));
+
+      /* Other rays, avoid dividing by zero on aligned lanes. */
+      const __m128 divisor = _mm_or_ps(_mm_andnot_ps(aligned, ray_dot_axis),
+                                       _mm_and_ps(aligned, _mm_set1_ps(1.0f)));
+      const __m128 ll = _mm_div_ps(_mm_sub_ps(bv_min, origin), divisor);
+      const __m128 lu = _mm_div_ps(_mm_sub_ps(bv_max, origin), divisor);
+      const __m128 positive = _mm_cmpgt_ps(ray_dot_axis, zero);
+      const __m128 t_near = _mm_or_ps(_mm_and_ps(positive, ll), _mm_andnot_ps(positive, lu));
+      const __m128 t_far = _mm_or_ps(_mm_and_ps(positive, lu), _mm_andnot_ps(positive, ll));
+      low = _mm_or_ps(_mm_and_ps(aligned, low), _mm_andnot_ps(aligned, _mm_max_ps(t_near, low)));
+      upper = _mm_or_ps(_mm_and_ps(aligned, upper),
+                        _mm_andnot_ps(aligned, _mm_min_ps(t_far, upper)));
+      miss = _mm_or_ps(miss, _mm_cmpgt_ps(low, upper));
+    }
+
+    miss = _mm_or_ps(miss, _mm_cmpge_ps(low, hit_dist));
+  }
+
+  return mask & ~_mm_movemask_ps(miss);
+#else
+  int result = 0;
+  for (int lane = 0; lane < BVH_PACKET_SIZE; lane++) {
+    if (mask & (1 << lane)) {
+      const BVHRayCastData *data = &packet->lanes[lane];
+      const float dist = packet->use_radius ? ray_nearest_hit(data, node->bv) :
+                                              fast_ray_nearest_hit(data, node);
+      if (dist < data->hit.dist) {
+        result |= (1 << lane);
+      }
+    }
+  }
+  return result;
+#endif
+}
+
+static void dfs_raycast_packet(BVHRayPacket *packet, BVHNode *node, const int mask)
+{
+  if (node->totnode == 0) {
+    for (int lane = 0; lane < BVH_PACKET_SIZE; lane++) {
+      if (mask & (1 << lane)) {
+        BVHRayCastData *data = &packet->lanes[lane];
+        if (data->callback) {
+          data->callback(data->userdata, node->index, &data->ray, &data->hit);
+        }
+        else {
+          const float dist = packet->use_radius ? ray_nearest_hit(data, node->bv) :
+                                                  fast_ray_nearest_hit(data, node);
+          data->hit.index = node->index;
+          data->hit.dist = dist;
+          madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist);
+        }
+        packet->hit_dist[lane] = data->hit.dist;
+      }
+    }
+    return;
+  }
+
+  /* pick loop direction to dive into the tree (based on ray direction and split axis) */
+  if (packet->lanes[0].ray_dot_axis[node->main_axis] > 0.0f) {
+    for (int i = 0; i != node->totnode; i++) {
+      const int mask_child = ray_packet_node_test(packet, node->children[i], mask);
+      if (mask_child) {
+        dfs_raycast_packet(packet, node->children[i], mask_child);
+      }
+    }
+  }
+  else {
+    for (int i = node->totnode - 1; i >= 0; i--) {
+      const int mask_child = ray_packet_node_test(packet, node->children[i], mask);
+      if (mask_child) {
+        dfs_raycast_packet(packet, node->children[i], mask_child);
+      }
+    }
+  }
+}
+
+static void raycast_packet_lane_init(BVHRayPacket *packet,
+                                     const int lane,
+                                     BVHTree *tree,
+                                     const float co[3],
+                                     const float dir[3],
+                                     float radius,
+                                     const BVHTreeRayHit *hit,
+                                     BVHTree_RayCastCallback callback,
+                                     void *userdata,
+                                     int flag)
+{
+  BVHRayCastData *data = &packet->lanes[lane];
+
+  BLI_ASSERT_UNIT_V3(dir);
+
+  data->tree = tree;
+  data->callback = callback;
+  data->userdata = userdata;
+
+  copy_v3_v3(data->ray.origin, co);
+  copy_v3_v3(data->ray.direction, dir);
+  data->ray.radius = radius;
+
+  bvhtree_ray_cast_data_precalc(data, flag);
+  memcpy(&data->hit, hit, sizeof(*hit));
+
+  for (int i = 0; i != 3; i++) {
+    packet->origin[i][lane] = data->ray.origin[i];
+    packet->ray_dot_axis[i][lane] = data->ray_dot_axis[i];
+    packet->idot_axis[i][lane] = data->idot_axis[i];
+  }
+  packet->radius[lane] = radius;
+  packet->hit_dist[lane] = data->hit.dist;
+}
+
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*co)[3],
+                                const float (*dir)[3],
+                                const int rays_num,
+                                float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag)
+{
+  BVHNode *root = tree->nodes[tree->totleaf];
+
+  if (root == NULL || rays_num == 0) {
+    return;
+  }
+
+  /* Sort rays by sign group (counting sort). */
+  int group_offset[BVH_RAY_SIGN_GROUPS + 1] = {0};
+  int *groups = MEM_mallocN(sizeof(*groups) * (size_t)rays_num, __func__);
+  int *order = MEM_mallocN(sizeof(*order) * (size_t)rays_num, __func__);
+
+  for (int i = 0; i < rays_num; i++) {
+    groups[i] = ray_sign_group(dir[i]);
+    group_offset[groups[i] + 1]++;
+  }
+  for (int g = 0; g < BVH_RAY_SIGN_GROUPS; g++) {
+    group_offset[g + 1] += group_offset[g];
+  }
+  for (int i = 0; i < rays_num; i++) {
+    order[group_offset[groups[i]]++] = i;
+  }
+  /* Offsets now point to the group ends. */
+
+  BVHRayPacket packet;
+  packet.use_radius = (radius != 0.0f);
+
+  int start = 0;
+  for (int g = 0; g < BVH_RAY_SIGN_GROUPS; g++) {
+    const int group_end = group_offset[g];
+
+    for (; start < group_end; start += BVH_PACKET_SIZE) {
+      const int lanes_num = min_ii(BVH_PACKET_SIZE, group_end - start);
+
+      for (int lane = 0; lane < BVH_PACKET_SIZE; lane++) {
+        /* Unused lanes repeat the last ray, they're masked out. */
+        const int i = order[start + min_ii(lane, lanes_num - 1)];
+        raycast_packet_lane_init(
+            &packet, lane, tree, co[i], dir[i], radius, &hits[i], callback, userdata, flag);
+      }
+
+      const int mask = ray_packet_node_test(&packet, root, (1 << lanes_num) - 1);
+      if (mask) {
+        dfs_raycast_packet(&packet, root, mask);
+      }
+
+      for (int lane = 0; lane < lanes_num; lane++) {
+        memcpy(&hits[order[start + lane]], &packet.lanes[lane].hit, sizeof(*hits));
+      }
+    }
+    start = group_end;
+  }
+
+  MEM_freeN(groups);
+  MEM_freeN(order);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree_range_query
  *
@@ -0,0 +1,235 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_mmap.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#ifdef WIN32
+#  include "mmap_win.h"
+#  include <io.h>
+#else
+#  include <signal.h>
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+
+struct BLI_mmap_file {
+  /* The address to which the file was mapped. */
+  char *memory;
+
+  /* The length of the file (and therefore the mapped region). */
+  size_t length;
+
+  /* Set to true when an I/O error occurs while reading the mapped memory. */
+  bool io_error;
+};
+
+#ifndef WIN32
+/* When a file is mapped and accessing it fails (e.g. because the file was truncated or was on a
+ * network drive that went away) a SIGBUS is raised. Keep track of all open mappings so the
+ * handler can replace the failing one with zeroes and flag the error on the mapping. */
+static struct {
+  ListBase open_mmaps;
+  ThreadMutex lock;
+  bool configured;
+  struct sigaction next_handler;
+} error_handler = {{NULL, NULL}, BLI_MUTEX_INITIALIZER, false};
+
+static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
+{
+  /* We only handle SIGBUS here for now. */
+  BLI_assert(sig == SIGBUS);
+
+  char *error_addr = (char *)siginfo->si_addr;
+  /* Find the file that this error belongs to. */
+  LISTBASE_FOREACH (LinkData *, link, &error_handler.open_mmaps) {
+    BLI_mmap_file *file = link->data;
+
+    /* Is the address where the error occurred in this file's mapped range? */
+    if (error_addr >= file->memory && error_addr < file->memory + file->length) {
+      file->io_error = true;
+
+      /* Replace the mapped memory with zeroes so the read can continue. */
+      const void *mapped_memory = mmap(file->memory,
+                                       file->length,
+                                       PROT_READ,
+                                       MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS,
+                                       -1,
+                                       0);
+      if (mapped_memory == MAP_FAILED) {
+        fprintf(stderr, "SIGBUS handler: Error replacing mapped file with zeros\n");
+      }
+      return;
+    }
+  }
+
+  /* Fall back to other handler if there was one. */
+  if (error_handler.next_handler.sa_flags & SA_SIGINFO) {
+    if (error_handler.next_handler.sa_sigaction) {
+      error_handler.next_handler.sa_sigaction(sig, siginfo, ptr);
+      return;
+    }
+  }
+  else if (!ELEM(error_handler.next_handler.sa_handler, SIG_DFL, SIG_IGN)) {
+    error_handler.next_handler.sa_handler(sig);
+    return;
+  }
+
+  fprintf(stderr, "Unhandled SIGBUS caught\n");
+  abort();
+}
+
+/* Ensures that the error handler is set up and ready. */
+static bool sigbus_handler_setup(void)
+{
+  if (!error_handler.configured) {
+    struct sigaction newact, oldact;
+    memset(&newact, 0, sizeof(newact));
+    memset(&oldact, 0, sizeof(oldact));
+
+    newact.sa_sigaction = sigbus_handler;
+    newact.sa_flags = SA_SIGINFO;
+
+    if (sigaction(SIGBUS, &newact, &oldact)) {
+      return false;
+    }
+
+    /* Remember the previously configured handler to fall back to it if the error
+     * does not belong to any of the mapped files. */
+    error_handler.next_handler = oldact;
+    error_handler.configured = true;
+  }
+
+  return true;
+}
+
+/* Adds a file to the tracked list. Caller holds the lock. */
+static void sigbus_handler_add(BLI_mmap_file *file)
+{
+  BLI_addtail(&error_handler.open_mmaps, BLI_genericNodeN(file));
+}
+
+/* Removes a file from the tracked list. Caller holds the lock. */
+static void sigbus_handler_remove(BLI_mmap_file *file)
+{
+  LinkData *link = BLI_findptr(&error_handler.open_mmaps, file, offsetof(LinkData, data));
+  BLI_freelinkN(&error_handler.open_mmaps, link);
+}
+#endif
+
+BLI_mmap_file *BLI_mmap_open(int fd)
+{
+  void *memory;
+  const int64_t length = BLI_lseek(fd, 0, SEEK_END);
+
+  /* Mapping an empty file is an error, nothing to read from anyway. */
+  if (length <= 0) {
+    return NULL;
+  }
+
+#ifndef WIN32
+  BLI_mutex_lock(&error_handler.lock);
+
+  /* Ensure that the SIGBUS handler is configured. */
+  if (!sigbus_handler_setup()) {
+    BLI_mutex_unlock(&error_handler.lock);
+    return NULL;
+  }
+#endif
+
+  /* Map the given file to memory. */
+  memory = mmap(NULL, (size_t)length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (memory == MAP_FAILED) {
+#ifndef WIN32
+    BLI_mutex_unlock(&error_handler.lock);
+#endif
+    return NULL;
+  }
+
+  /* Now that the mapping was successful, allocate memory and set up the BLI_mmap_file. */
+  BLI_mmap_file *file = MEM_callocN(sizeof(BLI_mmap_file), __func__);
+  file->memory = memory;
+  file->length = (size_t)length;
+
+#ifndef WIN32
+  /* Register the file with the error handler. */
+  sigbus_handler_add(file);
+  BLI_mutex_unlock(&error_handler.lock);
+#endif
+
+  return file;
+}
+
+bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length)
+{
+  /* If a previous read has already failed or we try to read past the end,
+   * don't even attempt to read any further. */
+  if (file->io_error || (offset + length > file->length) || (offset + length < offset)) {
+    return false;
+  }
+
+  memcpy(dest, file->memory + offset, length);
+
+  /* If an error occurred in this call, the handler replaced the mapping with zeroes
+   * and set the error flag, so this reports the failure. */
+  return !file->io_error;
+}
+
+const void *BLI_mmap_get_pointer(BLI_mmap_file *file)
+{
+  return file->memory;
+}
+
+size_t BLI_mmap_get_length(const BLI_mmap_file *file)
+{
+  return file->length;
+}
+
+bool BLI_mmap_has_io_error(const BLI_mmap_file *file)
+{
+  return file->io_error;
+}
+
+void BLI_mmap_free(BLI_mmap_file *file)
+{
+#ifndef WIN32
+  BLI_mutex_lock(&error_handler.lock);
+  sigbus_handler_remove(file);
+#endif
+
+  munmap((void *)file->memory, file->length);
+
+#ifndef WIN32
+  BLI_mutex_unlock(&error_handler.lock);
+#endif
+
+  MEM_freeN(file);
+}
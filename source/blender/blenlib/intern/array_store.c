@@ -109,7 +109,7 @@
 
 #include "BLI_array_store.h" /* own include */
 
-/* only for BLI_array_store_is_valid */
+/* for BLI_array_store_is_valid & BLI_array_store_state_size_added_get */
 #include "BLI_ghash.h"
 
 /** \name Defines
@@ -1657,6 +1657,53 @@ void *BLI_array_store_state_data_get_alloc(BArrayState *state, size_t *r_data_le
   return data;
 }
 
+/**
+ * Check if two states share all their data,
+ * this is the case when a state was added with identical data to its reference state.
+ *
+ * \note This doesn't compare the data itself, states with matching contents that don't share
+ * their chunks (e.g. when neither is the reference of the other) are not considered identical.
+ */
+bool BLI_array_store_state_is_identical(const BArrayState *state_a, const BArrayState *state_b)
+{
+  return state_a->chunk_list == state_b->chunk_list;
+}
+
+/**
+ * Return the size of the chunks of \a state which are not used by \a state_reference.
+ *
+ * When \a state was added with \a state_reference as its reference, this is the memory it added
+ * to the store (the increase of #BLI_array_store_calc_size_compacted_get),
+ * without having to go over all chunks of the store.
+ *
+ * \param state_reference: May be NULL, in which case all chunks of \a state are counted.
+ */
+size_t BLI_array_store_state_size_added_get(const BArrayState *state,
+                                            const BArrayState *state_reference)
+{
+  if (state_reference != NULL && state->chunk_list == state_reference->chunk_list) {
+    return 0;
+  }
+
+  GSet *chunks = BLI_gset_ptr_new(__func__);
+  if (state_reference != NULL) {
+    LISTBASE_FOREACH (const BChunkRef *, cref, &state_reference->chunk_list->chunk_refs) {
+      BLI_gset_add(chunks, cref->link);
+    }
+  }
+
+  size_t size_added = 0;
+  LISTBASE_FOREACH (const BChunkRef *, cref, &state->chunk_list->chunk_refs) {
+    /* Chunks used more than once in \a state are only counted once. */
+    if (BLI_gset_add(chunks, cref->link)) {
+      size_added += cref->link->data_len;
+    }
+  }
+
+  BLI_gset_free(chunks, NULL);
+  return size_added;
+}
+
 /** \} */
 
 /** \name Debugging API (for testing).
@@ -20,6 +20,8 @@
  * Task parallel range functions.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <stdlib.h>
 
 #include "MEM_guardedalloc.h"
@@ -104,6 +106,60 @@ struct RangeTask {
   }
 };
 
+/* Automatic grain size, used when the caller does not set min_iter_per_thread.
+ *
+ * Cost of an iteration is measured by running the first iterations of the range on the calling
+ * thread, doubling their number until the measured time is reliable. The rest of the range is then
+ * split into chunks which take about #ADAPTIVE_CHUNK_DURATION seconds: long enough to hide the
+ * scheduling overhead and short enough to balance the load between threads. When the whole rest
+ * of the range is cheaper than a single chunk it is not split at all.
+ *
+ * Ranges with few iterations per thread are not probed. Their iterations tend to be heavy, like
+ * PBVH nodes, and running even one of them before the threads start is a large share of the total
+ * time. They use a grain size of one, same as the static default. */
+static const double ADAPTIVE_CHUNK_DURATION = 50e-6;
+static const double ADAPTIVE_PROBE_DURATION = 5e-6;
+static const int ADAPTIVE_PROBE_MIN_ITER_PER_THREAD = 8;
+
+/* Run the first iterations of the range, returns index of the first iteration which is still to be
+ * done and the grain size to use for the rest of the range. */
+static int parallel_range_probe(const RangeTask &task,
+                                const int start,
+                                const int stop,
+                                size_t *r_grainsize)
+{
+  using Clock = std::chrono::steady_clock;
+  const int num_threads = BLI_task_scheduler_num_threads();
+  if (stop - start < num_threads * ADAPTIVE_PROBE_MIN_ITER_PER_THREAD) {
+    *r_grainsize = 1;
+    return start;
+  }
+  /* Leave most of the range to the threads, even if the measurement is not reliable yet. */
+  const int max_probe_iter = (stop - start) / (num_threads * ADAPTIVE_PROBE_MIN_ITER_PER_THREAD);
+  int num_iter = 0;
+  int step = 1;
+  double duration = 0.0;
+  while (num_iter < max_probe_iter && duration < ADAPTIVE_PROBE_DURATION) {
+    const int step_stop = start + std::min(num_iter + step, max_probe_iter);
+    const Clock::time_point step_begin = Clock::now();
+    task(tbb::blocked_range<int>(start + num_iter, step_stop));
+    duration += std::chrono::duration<double>(Clock::now() - step_begin).count();
+    num_iter = step_stop - start;
+    step *= 2;
+  }
+
+  const int num_remaining = stop - start - num_iter;
+  const double iter_duration = duration / num_iter;
+  size_t grainsize = (size_t)num_remaining;
+  if (iter_duration * num_remaining > ADAPTIVE_CHUNK_DURATION) {
+    /* Make sure all threads get some work. */
+    grainsize = (size_t)std::min(ADAPTIVE_CHUNK_DURATION / iter_duration,
+                                 (double)num_remaining / num_threads);
+  }
+  *r_grainsize = std::max(grainsize, (size_t)1);
+  return start + num_iter;
+}
+
 #endif
 
 void BLI_task_parallel_range(const int start,
@@ -116,8 +172,13 @@ void BLI_task_parallel_range(const int start,
   /* Multithreading. */
   if (settings->use_threading && BLI_task_scheduler_num_threads() > 1) {
     RangeTask task(func, userdata, settings);
-    const size_t grainsize = MAX2(settings->min_iter_per_thread, 1);
-    const tbb::blocked_range<int> range(start, stop, grainsize);
+    int parallel_start = start;
+    size_t grainsize = (size_t)settings->min_iter_per_thread;
+    if (grainsize == 0 && start < stop) {
+      /* Iterations done here are accumulated into the chunk of the root task. */
+      parallel_start = parallel_range_probe(task, start, stop, &grainsize);
+    }
+    const tbb::blocked_range<int> range(parallel_start, stop, MAX2(grainsize, 1));
 
     if (settings->func_reduce) {
       parallel_reduce(range, task);
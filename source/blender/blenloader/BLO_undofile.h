@@ -25,15 +25,26 @@
  * \ingroup blenloader
  */
 
-struct Scene;
+struct BArrayState;
 struct GHash;
+struct Scene;
+
+/** Size of data passed to #BLO_memfile_chunk_add_array must be a multiple of this. */
+#define BLO_MEMFILE_ARRAY_STRIDE 4
 
 typedef struct {
   void *next, *prev;
+  /** The chunk data, NULL when stored in #MemFileChunk.state. */
   const char *buf;
+  /**
+   * Data of large blocks, de-duplicated with the data of previous undo steps
+   * (only the parts of an array that changed use extra memory), see #BLO_memfile_chunk_read.
+   */
+  struct BArrayState *state;
   /** Size in bytes. */
   unsigned int size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk doesn't own the memory (`buf` or `state`),
+   * it's shared with a previous #MemFileChunk */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -74,6 +85,8 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
 void BLO_memfile_write_finalize(MemFileWriteData *mem_data);
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, unsigned int size);
+void BLO_memfile_chunk_add_array(MemFileWriteData *mem_data, const char *buf, unsigned int size);
+void BLO_memfile_chunk_read(const MemFileChunk *chunk, size_t offset, size_t size, void *r_data);
 
 /* exports */
 extern void BLO_memfile_free(MemFile *memfile);
@@ -84,6 +97,11 @@ extern void BLO_memfile_clear_future(MemFile *memfile);
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                          struct Main *bmain,
                                          struct Scene **r_scene);
+extern void BLO_memfile_snapshot(const MemFile *memfile, MemFile *r_snapshot);
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+extern bool BLO_memfile_write_file_ex(struct MemFile *memfile,
+                                      const char *filename,
+                                      const short *stop,
+                                      float *progress);
 
 #endif /* __BLO_UNDOFILE_H__ */
@@ -100,6 +100,7 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.h"
 #include "BLI_blenlib.h"
 #include "BLI_endian_switch.h"
 #include "BLI_ghash.h"
@@ -107,6 +108,8 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -233,7 +236,7 @@
  * Delay reading blocks we might not use (especially applies to library linking).
  * which keeps large arrays in memory from data-blocks we may not even use.
  *
- * \note This is disabled when using compression,
+ * \note This is disabled for compressed files without a frame table (see #BLO_GZIP_FRAME_SIZE),
  * while zlib supports seek it's unusably slow, see: T61880.
  */
 #define USE_BHEAD_READ_ON_DEMAND
@@ -244,6 +247,13 @@
 /* Use GHash for restoring pointers by name */
 #define USE_GHASH_RESTORE_POINTER
 
+/**
+ * Read and reconstruct the DATA blocks of data-blocks with many of them in parallel,
+ * see #read_data_into_datamap_parallel.
+ */
+#define USE_PARALLEL_DATA_READ
+#define PARALLEL_DATA_READ_MIN_BLOCKS 64
+
 /* Define this to have verbose debug prints. */
 //#define USE_DEBUG_PRINT
 
@@ -997,6 +1007,11 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->mmap_file != NULL) {
+    /* Copy straight out of the mapping, no need to move the read position. */
+    return BLI_mmap_read(
+        fd->mmap_file, buf, (size_t)new_bhead->file_offset, (size_t)new_bhead->bhead.len);
+  }
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -1027,6 +1042,25 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
   }
   return &new_bhead_data->bhead;
 }
+
+/**
+ * Zero-copy access to the data of a block that was not read yet,
+ * only possible when the file is memory-mapped.
+ *
+ * \return NULL when the data needs to be read into a buffer instead.
+ */
+static const void *blo_bhead_data_from_mmap(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  if ((fd->mmap_file == NULL) || new_bhead->has_data) {
+    return NULL;
+  }
+  if (UNLIKELY((size_t)(new_bhead->file_offset + new_bhead->bhead.len) >
+               BLI_mmap_get_length(fd->mmap_file))) {
+    return NULL;
+  }
+  return POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), new_bhead->file_offset);
+}
 #endif /* USE_BHEAD_READ_ON_DEMAND */
 
 /* Warning! Caller's responsibility to ensure given bhead **is** and ID one! */
@@ -1196,6 +1230,53 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+/* Memory-mapped file reading.
+ * The data is copied straight out of the page cache, delayed data-blocks
+ * can even be used in-place (see #blo_bhead_data_from_mmap). */
+
+static int fd_read_from_mmap(FileData *filedata,
+                             void *buffer,
+                             uint size,
+                             bool *UNUSED(r_is_memchunck_identical))
+{
+  /* don't read more bytes then there are available in the file */
+  const size_t length = BLI_mmap_get_length(filedata->mmap_file);
+  const size_t readsize = MIN2((size_t)size, length - (size_t)filedata->file_offset);
+
+  if (!BLI_mmap_read(filedata->mmap_file, buffer, (size_t)filedata->file_offset, readsize)) {
+    return 0;
+  }
+  filedata->file_offset += readsize;
+
+  return (int)readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  const off64_t length = (off64_t)BLI_mmap_get_length(filedata->mmap_file);
+  off64_t new_pos;
+
+  if (whence == SEEK_CUR) {
+    new_pos = filedata->file_offset + offset;
+  }
+  else if (whence == SEEK_SET) {
+    new_pos = offset;
+  }
+  else if (whence == SEEK_END) {
+    new_pos = length + offset;
+  }
+  else {
+    return -1;
+  }
+
+  if (new_pos < 0 || new_pos > length) {
+    return -1;
+  }
+
+  filedata->file_offset = new_pos;
+  return new_pos;
+}
+
 /* GZip file reading. */
 
 static int fd_read_gzip_from_file(FileData *filedata,
@@ -1215,6 +1296,268 @@ static int fd_read_gzip_from_file(FileData *filedata,
   return (readsize);
 }
 
+/* Seekable GZip file reading (see #BLO_GZIP_FRAME_SIZE). */
+
+/* Number of decompressed frames kept around, reading delayed data-blocks
+ * jumps back a little from the current position in the file. */
+#define GZIP_FRAMES_CACHE_LEN 4
+
+typedef struct FileDataGzipFrames {
+  int frames_len;
+  /** Start of every frame in the file and in the uncompressed data (`frames_len + 1` items). */
+  off64_t *compressed_offsets;
+  off64_t *uncompressed_offsets;
+
+  /** Compressed data of the frame being decompressed. */
+  char *compressed_buf;
+  size_t compressed_buf_len;
+
+  /** Decompressed frames, #GZIP_FRAMES_CACHE_LEN items of #BLO_GZIP_FRAME_SIZE. */
+  char *cache_buf[GZIP_FRAMES_CACHE_LEN];
+  int cache_frame[GZIP_FRAMES_CACHE_LEN];
+  /** Cache slot to replace next. */
+  int cache_next;
+} FileDataGzipFrames;
+
+static uint gzip_frames_decode_uint16(const uchar *buf)
+{
+  return (uint)buf[0] | ((uint)buf[1] << 8);
+}
+
+static uint gzip_frames_decode_uint32(const uchar *buf)
+{
+  return (uint)buf[0] | ((uint)buf[1] << 8) | ((uint)buf[2] << 16) | ((uint)buf[3] << 24);
+}
+
+static bool gzip_frames_read_at(int file, off64_t offset, void *buf, size_t buf_len)
+{
+  if (BLI_lseek(file, offset, SEEK_SET) != offset) {
+    return false;
+  }
+  while (buf_len > 0) {
+    const int readsize = read(file, buf, (uint)MIN2(buf_len, (size_t)INT_MAX));
+    if (readsize <= 0) {
+      return false;
+    }
+    buf = POINTER_OFFSET(buf, readsize);
+    buf_len -= (size_t)readsize;
+  }
+  return true;
+}
+
+static void gzip_frames_free(FileDataGzipFrames *frames)
+{
+  MEM_SAFE_FREE(frames->compressed_offsets);
+  MEM_SAFE_FREE(frames->uncompressed_offsets);
+  MEM_SAFE_FREE(frames->compressed_buf);
+  for (int i = 0; i < GZIP_FRAMES_CACHE_LEN; i++) {
+    MEM_SAFE_FREE(frames->cache_buf[i]);
+  }
+  MEM_freeN(frames);
+}
+
+/**
+ * Read the frame table from the end of a gzip file.
+ *
+ * \return NULL when the file isn't a seekable gzip file (it can still be read as a regular one).
+ */
+static FileDataGzipFrames *gzip_frames_open(int file)
+{
+  uchar tail[8 + BLO_GZIP_FRAMES_TRAILER_SIZE];
+  const off64_t file_len = BLI_lseek(file, 0, SEEK_END);
+
+  if ((file_len < (off64_t)sizeof(tail)) ||
+      !gzip_frames_read_at(file, file_len - (off64_t)sizeof(tail), tail, sizeof(tail)) ||
+      (memcmp(tail + 4, BLO_GZIP_FRAMES_MAGIC, 4) != 0)) {
+    return NULL;
+  }
+
+  const uint frames_len = gzip_frames_decode_uint32(tail);
+  if (frames_len == 0 || frames_len > BLO_GZIP_FRAMES_MAX) {
+    return NULL;
+  }
+
+  /* Read the whole member holding the frame table, and validate its header. */
+  const uint payload_len = frames_len * 8 + 8;
+  const uint member_len = 10 + 2 + 4 + payload_len + BLO_GZIP_FRAMES_TRAILER_SIZE;
+  if (file_len < (off64_t)member_len) {
+    return NULL;
+  }
+  uchar *member = MEM_mallocN(member_len, __func__);
+  const off64_t member_offset = file_len - (off64_t)member_len;
+  if (!gzip_frames_read_at(file, member_offset, member, member_len) ||
+      (member[0] != 0x1f || member[1] != 0x8b || member[3] != 4) ||
+      (gzip_frames_decode_uint16(member + 10) != 4 + payload_len) ||
+      (member[12] != BLO_GZIP_FRAMES_SI1 || member[13] != BLO_GZIP_FRAMES_SI2) ||
+      (gzip_frames_decode_uint16(member + 14) != payload_len)) {
+    MEM_freeN(member);
+    return NULL;
+  }
+
+  FileDataGzipFrames *frames = MEM_callocN(sizeof(*frames), __func__);
+  frames->frames_len = (int)frames_len;
+  frames->compressed_offsets = MEM_mallocN(sizeof(off64_t) * (frames_len + 1), __func__);
+  frames->uncompressed_offsets = MEM_mallocN(sizeof(off64_t) * (frames_len + 1), __func__);
+
+  bool ok = true;
+  const uchar *table = member + 16;
+  off64_t compressed_offset = 0, uncompressed_offset = 0;
+  for (uint i = 0; i < frames_len; i++) {
+    const uint compressed_len = gzip_frames_decode_uint32(table + i * 8);
+    const uint uncompressed_len = gzip_frames_decode_uint32(table + i * 8 + 4);
+    if (uncompressed_len > BLO_GZIP_FRAME_SIZE) {
+      ok = false;
+      break;
+    }
+    frames->compressed_offsets[i] = compressed_offset;
+    frames->uncompressed_offsets[i] = uncompressed_offset;
+    frames->compressed_buf_len = MAX2(frames->compressed_buf_len, compressed_len);
+    compressed_offset += compressed_len;
+    uncompressed_offset += uncompressed_len;
+  }
+  frames->compressed_offsets[frames_len] = compressed_offset;
+  frames->uncompressed_offsets[frames_len] = uncompressed_offset;
+  MEM_freeN(member);
+
+  /* The frames have to exactly fill the file up to the table. */
+  if (!ok || compressed_offset != member_offset) {
+    gzip_frames_free(frames);
+    return NULL;
+  }
+
+  frames->compressed_buf = MEM_mallocN(frames->compressed_buf_len, __func__);
+  for (int i = 0; i < GZIP_FRAMES_CACHE_LEN; i++) {
+    frames->cache_frame[i] = -1;
+  }
+
+  return frames;
+}
+
+/**
+ * \return The decompressed frame containing \a offset, or NULL on error or end of file.
+ */
+static const char *gzip_frames_ensure(FileData *filedata, off64_t offset, int *r_frame)
+{
+  FileDataGzipFrames *frames = filedata->gzip_frames;
+  const off64_t *uncompressed_offsets = frames->uncompressed_offsets;
+
+  if (offset < 0 || offset >= uncompressed_offsets[frames->frames_len]) {
+    return NULL;
+  }
+
+  /* Binary search for the frame containing the offset. */
+  int low = 0, high = frames->frames_len - 1;
+  while (low < high) {
+    const int mid = (low + high + 1) / 2;
+    if (uncompressed_offsets[mid] <= offset) {
+      low = mid;
+    }
+    else {
+      high = mid - 1;
+    }
+  }
+  const int frame = low;
+  *r_frame = frame;
+
+  for (int i = 0; i < GZIP_FRAMES_CACHE_LEN; i++) {
+    if (frames->cache_frame[i] == frame) {
+      return frames->cache_buf[i];
+    }
+  }
+
+  const int slot = frames->cache_next;
+  frames->cache_next = (frames->cache_next + 1) % GZIP_FRAMES_CACHE_LEN;
+  frames->cache_frame[slot] = -1;
+  if (frames->cache_buf[slot] == NULL) {
+    frames->cache_buf[slot] = MEM_mallocN(BLO_GZIP_FRAME_SIZE, __func__);
+  }
+
+  const size_t compressed_len = (size_t)(frames->compressed_offsets[frame + 1] -
+                                         frames->compressed_offsets[frame]);
+  const size_t uncompressed_len = (size_t)(uncompressed_offsets[frame + 1] -
+                                           uncompressed_offsets[frame]);
+  if (!gzip_frames_read_at(filedata->filedes,
+                           frames->compressed_offsets[frame],
+                           frames->compressed_buf,
+                           compressed_len)) {
+    return NULL;
+  }
+
+  z_stream strm = {NULL};
+  if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK) {
+    return NULL;
+  }
+  strm.next_in = (Bytef *)frames->compressed_buf;
+  strm.avail_in = (uInt)compressed_len;
+  strm.next_out = (Bytef *)frames->cache_buf[slot];
+  strm.avail_out = BLO_GZIP_FRAME_SIZE;
+  const int err = inflate(&strm, Z_FINISH);
+  const bool ok = (err == Z_STREAM_END) && (strm.total_out == uncompressed_len);
+  inflateEnd(&strm);
+
+  if (!ok) {
+    printf("%s: zlib error decompressing frame %d\n", __func__, frame);
+    return NULL;
+  }
+
+  frames->cache_frame[slot] = frame;
+  return frames->cache_buf[slot];
+}
+
+static int fd_read_gzip_frames_from_file(FileData *filedata,
+                                         void *buffer,
+                                         uint size,
+                                         bool *UNUSED(r_is_memchunck_identical))
+{
+  FileDataGzipFrames *frames = filedata->gzip_frames;
+  uint totread = 0;
+
+  while (totread < size) {
+    int frame;
+    const char *frame_buf = gzip_frames_ensure(filedata, filedata->file_offset, &frame);
+    if (frame_buf == NULL) {
+      break;
+    }
+    const off64_t frame_offset = filedata->file_offset - frames->uncompressed_offsets[frame];
+    const uint readsize = (uint)MIN2((off64_t)(size - totread),
+                                     frames->uncompressed_offsets[frame + 1] -
+                                         filedata->file_offset);
+    memcpy(POINTER_OFFSET(buffer, totread), frame_buf + frame_offset, readsize);
+    totread += readsize;
+    filedata->file_offset += readsize;
+  }
+
+  return (int)totread;
+}
+
+static off64_t fd_seek_gzip_frames_from_file(FileData *filedata, off64_t offset, int whence)
+{
+  const FileDataGzipFrames *frames = filedata->gzip_frames;
+  const off64_t length = frames->uncompressed_offsets[frames->frames_len];
+  off64_t new_pos;
+
+  if (whence == SEEK_CUR) {
+    new_pos = filedata->file_offset + offset;
+  }
+  else if (whence == SEEK_SET) {
+    new_pos = offset;
+  }
+  else if (whence == SEEK_END) {
+    new_pos = length + offset;
+  }
+  else {
+    return -1;
+  }
+
+  /* Only moves the read position, frames are decompressed when they are read from. */
+  if (new_pos < 0 || new_pos > length) {
+    return -1;
+  }
+
+  filedata->file_offset = new_pos;
+  return new_pos;
+}
+
 /* Memory reading. */
 
 static int fd_read_from_memory(FileData *filedata,
@@ -1292,7 +1635,7 @@ static int fd_read_from_memfile(FileData *filedata,
         readsize = chunk->size - chunkoffset;
       }
 
-      memcpy(POINTER_OFFSET(buffer, totread), chunk->buf + chunkoffset, readsize);
+      BLO_memfile_chunk_read(chunk, chunkoffset, readsize, POINTER_OFFSET(buffer, totread));
       totread += readsize;
       filedata->file_offset += readsize;
       seek += readsize;
@@ -1360,6 +1703,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  BLI_mmap_file *mmap_file = NULL;
+  FileDataGzipFrames *gzip_frames = NULL;
 
   char header[7];
 
@@ -1379,8 +1724,30 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   /* Regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    read_fn = fd_read_data_from_file;
-    seek_fn = fd_seek_data_from_file;
+    /* Uncompressed files are memory-mapped when possible,
+     * this avoids copying all data through intermediate buffers. */
+    mmap_file = BLI_mmap_open(file);
+    if (mmap_file != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_from_mmap;
+    }
+    else {
+      /* Fall back to regular IO, opening the mapping may have moved the file position. */
+      BLI_lseek(file, 0, SEEK_SET);
+      read_fn = fd_read_data_from_file;
+      seek_fn = fd_seek_data_from_file;
+    }
+  }
+
+  /* Seekable gzip file, only the frames that are read get decompressed. */
+  if ((read_fn == NULL) &&
+      /* Check header magic. */
+      (header[0] == 0x1f && header[1] == 0x8b)) {
+    gzip_frames = gzip_frames_open(file);
+    if (gzip_frames != NULL) {
+      read_fn = fd_read_gzip_frames_from_file;
+      seek_fn = fd_seek_gzip_frames_from_file;
+    }
   }
 
   /* Gzip file. */
@@ -1414,6 +1781,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->mmap_file = mmap_file;
+  fd->gzip_frames = gzip_frames;
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1576,6 +1945,14 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->mmap_file != NULL) {
+      BLI_mmap_free(fd->mmap_file);
+    }
+
+    if (fd->gzip_frames != NULL) {
+      gzip_frames_free(fd->gzip_frames);
+    }
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -2164,7 +2541,11 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+/**
+ * Same as #read_struct, without changing \a fd, so it can be called from multiple threads.
+ * Read errors are reported in \a r_file_error instead of clearing #FD_FLAGS_FILE_OK.
+ */
+static void *read_struct_ex(FileData *fd, BHead *bh, const char *blockname, bool *r_file_error)
 {
   void *temp = NULL;
 
@@ -2179,7 +2560,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
         bh = blo_bhead_read_full(fd, bh);
         if (UNLIKELY(bh == NULL)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
+          *r_file_error = true;
           return NULL;
         }
       }
@@ -2189,17 +2570,31 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
-        if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
+        /* Reconstruct directly from the mapped file when possible, avoids an extra copy. */
+        const void *data_mmap = blo_bhead_data_from_mmap(fd, bh);
+        if (data_mmap != NULL) {
+          data = data_mmap;
+        }
+        else if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
           bh = blo_bhead_read_full(fd, bh);
           if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_file_error = true;
             return NULL;
           }
+          data = (bh + 1);
         }
 #endif
         temp = DNA_struct_reconstruct(
-            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh + 1));
+            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, data);
+#ifdef USE_BHEAD_READ_ON_DEMAND
+        if (UNLIKELY(data_mmap != NULL && BLI_mmap_has_io_error(fd->mmap_file))) {
+          *r_file_error = true;
+          MEM_freeN(temp);
+          temp = NULL;
+        }
+#endif
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -2212,7 +2607,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
           if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_file_error = true;
             MEM_freeN(temp);
             temp = NULL;
           }
@@ -2233,6 +2628,16 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+  bool file_error = false;
+  void *temp = read_struct_ex(fd, bh, blockname, &file_error);
+  if (UNLIKELY(file_error)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+  return temp;
+}
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -8977,10 +9382,113 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
 }
 
 /* Read all data associated with a datablock into datamap. */
+#ifdef USE_PARALLEL_DATA_READ
+typedef struct ReadDataParallelData {
+  FileData *fd;
+  BHead **bheads;
+  void **data;
+  const char *allocname;
+} ReadDataParallelData;
+
+static void read_data_parallel_cb(void *__restrict userdata,
+                                  const int i,
+                                  const TaskParallelTLS *__restrict tls)
+{
+  ReadDataParallelData *data = userdata;
+  bool *file_error = tls->userdata_chunk;
+  data->data[i] = read_struct_ex(data->fd, data->bheads[i], data->allocname, file_error);
+}
+
+static void read_data_parallel_reduce(const void *__restrict UNUSED(userdata),
+                                      void *__restrict chunk_join,
+                                      void *__restrict chunk)
+{
+  bool *file_error_join = chunk_join;
+  const bool *file_error = chunk;
+  *file_error_join |= *file_error;
+}
+
+/**
+ * Reading the headers is sequential, but once all DATA blocks of an ID are known,
+ * they can be read and reconstructed in parallel.
+ * This is only possible when reading them doesn't move the shared file position,
+ * so when their data is already in memory or the file is memory-mapped.
+ *
+ * \return The first block after the DATA blocks of the ID, or NULL when reading in parallel
+ * is not possible (in which case nothing was read).
+ */
+static BHead *read_data_into_datamap_parallel(FileData *fd,
+                                              BHead *bhead,
+                                              const char *allocname,
+                                              bool *r_done)
+{
+  BHead **bheads = NULL;
+  BLI_array_staticdeclare(bheads, PARALLEL_DATA_READ_MIN_BLOCKS);
+  bool use_threading = true;
+
+  *r_done = false;
+
+  while (bhead && bhead->code == DATA) {
+    if ((fd->mmap_file == NULL) && (BHEADN_FROM_BHEAD(bhead)->has_data == false)) {
+      use_threading = false;
+    }
+    BLI_array_append(bheads, bhead);
+    bhead = blo_bhead_next(fd, bhead);
+  }
+
+  const int bheads_len = BLI_array_len(bheads);
+  if (use_threading && bheads_len >= PARALLEL_DATA_READ_MIN_BLOCKS) {
+    ReadDataParallelData data = {
+        .fd = fd,
+        .bheads = bheads,
+        .data = MEM_malloc_arrayN(bheads_len, sizeof(void *), __func__),
+        .allocname = allocname,
+    };
+
+    /* Read errors are gathered per thread, #FileData is only changed after. */
+    bool file_error = false;
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 8;
+    settings.userdata_chunk = &file_error;
+    settings.userdata_chunk_size = sizeof(file_error);
+    settings.func_reduce = read_data_parallel_reduce;
+    BLI_task_parallel_range(0, bheads_len, &data, read_data_parallel_cb, &settings);
+
+    if (UNLIKELY(file_error)) {
+      fd->flags &= ~FD_FLAGS_FILE_OK;
+    }
+
+    /* Keep insertion order, so the datamap is identical to reading sequentially. */
+    for (int i = 0; i < bheads_len; i++) {
+      if (data.data[i]) {
+        oldnewmap_insert(fd->datamap, bheads[i]->old, data.data[i], 0);
+      }
+    }
+
+    MEM_freeN(data.data);
+    *r_done = true;
+  }
+
+  BLI_array_free(bheads);
+  return bhead;
+}
+#endif /* USE_PARALLEL_DATA_READ */
+
 static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
 {
   bhead = blo_bhead_next(fd, bhead);
 
+#ifdef USE_PARALLEL_DATA_READ
+  {
+    bool done;
+    BHead *bhead_next = read_data_into_datamap_parallel(fd, bhead, allocname, &done);
+    if (done) {
+      return bhead_next;
+    }
+  }
+#endif
+
   while (bhead && bhead->code == DATA) {
     void *data;
 #if 0
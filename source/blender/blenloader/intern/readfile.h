@@ -30,7 +30,9 @@
 #include "DNA_windowmanager_types.h" /* for ReportType */
 #include "zlib.h"
 
+struct BLI_mmap_file;
 struct BLOCacheStorage;
+struct FileDataGzipFrames;
 struct GSet;
 struct IDNameLib_Map;
 struct Key;
@@ -53,6 +55,26 @@ enum eFileDataFlag {
   FD_FLAGS_NOT_MY_LIBMAP = 1 << 5,
 };
 
+/* Seekable gzip compressed files.
+ *
+ * Compressed files are written as a sequence of independent gzip members ("frames") of
+ * #BLO_GZIP_FRAME_SIZE uncompressed bytes each, so they can be compressed in parallel.
+ * The last member is empty, its header's extra field stores the compressed and uncompressed
+ * size of every frame, followed by the number of frames and #BLO_GZIP_FRAMES_MAGIC.
+ *
+ * Any gzip reader handles such files transparently (concatenated members are decompressed as one
+ * stream), while the frame table allows Blender to only decompress the frames it actually
+ * reads. */
+#define BLO_GZIP_FRAME_SIZE (1 << 21)
+/** Maximum number of frames that fit in the extra field, larger files have no frame table. */
+#define BLO_GZIP_FRAMES_MAX 8190
+#define BLO_GZIP_FRAMES_MAGIC "BFRM"
+/** Extra field sub-field identifier for the frame table. */
+#define BLO_GZIP_FRAMES_SI1 'B'
+#define BLO_GZIP_FRAMES_SI2 'F'
+/** Size of the empty deflate stream and gzip trailer ending the frame table member. */
+#define BLO_GZIP_FRAMES_TRAILER_SIZE 10
+
 /* Disallow since it's 32bit on ms-windows. */
 #ifdef __GNUC__
 #  pragma GCC poison off_t
@@ -92,8 +114,12 @@ typedef struct FileData {
 
   /** Variables needed for reading from file. */
   gzFile gzfiledes;
+  /** Memory-mapped (uncompressed) file, used instead of `filedes` for reading when set. */
+  struct BLI_mmap_file *mmap_file;
   /** Gzip stream for memory decompression. */
   z_stream strm;
+  /** Seekable gzip file (see #BLO_GZIP_FRAME_SIZE), read through `filedes`. */
+  struct FileDataGzipFrames *gzip_frames;
 
   /** Now only in use for library appending. */
   char relabase[FILE_MAX];
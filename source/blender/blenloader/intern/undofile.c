@@ -40,6 +40,7 @@
 
 #include "DNA_listBase.h"
 
+#include "BLI_array_store.h"
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
 
@@ -52,6 +53,77 @@
 /* keep last */
 #include "BLI_strict_flags.h"
 
+/* -------------------------------------------------------------------- */
+/** \name Array Storage
+ *
+ * Large blocks of data (mesh & custom-data layers, typically) are stored in a #BArrayStore
+ * shared by all undo steps. Its chunks are found using rolling hashes, so an array that was
+ * re-allocated or had elements inserted or removed only uses memory for what actually changed,
+ * where comparing the chunks of the previous step would store a full copy.
+ * \{ */
+
+/** Number of #BLO_MEMFILE_ARRAY_STRIDE elements in a chunk (16kb). */
+#define MEMFILE_ARRAY_CHUNK_COUNT 4096
+
+static struct {
+  BArrayStore *bs;
+  /** Number of states in `bs`, the store is freed when no undo step uses it anymore. */
+  int users;
+} memfile_arraystore = {NULL};
+
+static BArrayState *memfile_arraystore_state_add(const char *buf,
+                                                 uint size,
+                                                 const BArrayState *state_reference)
+{
+  if (memfile_arraystore.bs == NULL) {
+    BLI_assert(memfile_arraystore.users == 0);
+    memfile_arraystore.bs = BLI_array_store_create(BLO_MEMFILE_ARRAY_STRIDE,
+                                                   MEMFILE_ARRAY_CHUNK_COUNT);
+  }
+  memfile_arraystore.users += 1;
+  return BLI_array_store_state_add(memfile_arraystore.bs, buf, size, state_reference);
+}
+
+static void memfile_arraystore_state_remove(BArrayState *state)
+{
+  BLI_assert(memfile_arraystore.users > 0);
+  BLI_array_store_state_remove(memfile_arraystore.bs, state);
+  memfile_arraystore.users -= 1;
+  if (memfile_arraystore.users == 0) {
+    BLI_array_store_destroy(memfile_arraystore.bs);
+    memfile_arraystore.bs = NULL;
+  }
+}
+
+/** Memory owned by the chunk, used to transfer ownership between undo steps. */
+static const void *memfile_chunk_data_key(const MemFileChunk *chunk)
+{
+  return chunk->state ? (const void *)chunk->state : (const void *)chunk->buf;
+}
+
+/**
+ * Read \a size bytes of the chunk data starting at \a offset.
+ */
+void BLO_memfile_chunk_read(const MemFileChunk *chunk, size_t offset, size_t size, void *r_data)
+{
+  BLI_assert(offset + size <= chunk->size);
+
+  if (chunk->state == NULL) {
+    memcpy(r_data, chunk->buf + offset, size);
+  }
+  else if (offset == 0 && size == chunk->size) {
+    BLI_array_store_state_data_get(chunk->state, r_data);
+  }
+  else {
+    size_t data_len;
+    char *data = BLI_array_store_state_data_get_alloc(chunk->state, &data_len);
+    memcpy(r_data, data + offset, size);
+    MEM_freeN(data);
+  }
+}
+
+/** \} */
+
 /* **************** support for memory-write, for undo buffers *************** */
 
 /* not memfile itself */
@@ -61,7 +133,12 @@ void BLO_memfile_free(MemFile *memfile)
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
     if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
+      if (chunk->state) {
+        memfile_arraystore_state_remove(chunk->state);
+      }
+      else {
+        MEM_freeN((void *)chunk->buf);
+      }
     }
     MEM_freeN(chunk);
   }
@@ -80,7 +157,7 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   /* First, detect all memchunks in second memfile that are not owned by it. */
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
     if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+      BLI_ghash_insert(buffer_to_second_memchunk, (void *)memfile_chunk_data_key(sc), sc);
     }
   }
 
@@ -88,7 +165,8 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
     if (!fc->is_identical) {
-      MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
+      MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk,
+                                          memfile_chunk_data_key(fc));
       if (sc != NULL) {
         BLI_assert(sc->is_identical);
         sc->is_identical = false;
@@ -154,26 +232,32 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   }
 }
 
-void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint size)
+static MemFileChunk *memfile_chunk_new(MemFileWriteData *mem_data, uint size)
 {
-  MemFile *memfile = mem_data->written_memfile;
-  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
-
   MemFileChunk *curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
   curchunk->size = size;
   curchunk->buf = NULL;
+  curchunk->state = NULL;
   curchunk->is_identical = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
-  BLI_addtail(&memfile->chunks, curchunk);
+  BLI_addtail(&mem_data->written_memfile->chunks, curchunk);
+  return curchunk;
+}
+
+void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint size)
+{
+  MemFile *memfile = mem_data->written_memfile;
+  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
+  MemFileChunk *curchunk = memfile_chunk_new(mem_data, size);
 
   /* we compare compchunk with buf */
   if (*compchunk_step != NULL) {
     MemFileChunk *compchunk = *compchunk_step;
-    if (compchunk->size == curchunk->size) {
+    if (compchunk->state == NULL && compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
@@ -192,6 +276,40 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint siz
   }
 }
 
+/**
+ * Add a large block of data, stored de-duplicated with the data of the reference chunk,
+ * see #MemFileChunk.state.
+ */
+void BLO_memfile_chunk_add_array(MemFileWriteData *mem_data, const char *buf, uint size)
+{
+  BLI_assert((size % BLO_MEMFILE_ARRAY_STRIDE) == 0);
+
+  MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
+  MemFileChunk *curchunk = memfile_chunk_new(mem_data, size);
+  MemFileChunk *compchunk = NULL;
+
+  if (*compchunk_step != NULL) {
+    compchunk = (*compchunk_step)->state ? *compchunk_step : NULL;
+    *compchunk_step = (*compchunk_step)->next;
+  }
+
+  BArrayState *state_reference = compchunk ? compchunk->state : NULL;
+  BArrayState *state = memfile_arraystore_state_add(buf, size, state_reference);
+
+  if (compchunk != NULL && BLI_array_store_state_is_identical(state, compchunk->state)) {
+    memfile_arraystore_state_remove(state);
+    curchunk->state = compchunk->state;
+    curchunk->is_identical = true;
+    compchunk->is_identical_future = true;
+  }
+  else {
+    curchunk->state = state;
+    /* Only account for the array chunks which are not shared with the previous step. */
+    const size_t size_added = BLI_array_store_state_size_added_get(state, state_reference);
+    mem_data->written_memfile->size += size_added;
+  }
+}
+
 struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                   struct Main *oldmain,
                                   struct Scene **r_scene)
@@ -215,15 +333,73 @@ struct Main *BLO_memfile_main_get(struct MemFile *memfile,
   return bmain_undo;
 }
 
+/* Size of the chunks of #BLO_memfile_snapshot, large enough to avoid many small allocations. */
+#define MEMFILE_SNAPSHOT_CHUNK_SIZE (1 << 26) /* 64mb */
+
+/**
+ * Copy \a memfile into \a r_snapshot, which owns all of its memory.
+ * Chunks of undo steps share memory with previous steps, the copy can be used (e.g. written to
+ * disk from another thread) while the undo stack keeps changing.
+ */
+void BLO_memfile_snapshot(const MemFile *memfile, MemFile *r_snapshot)
+{
+  BLI_listbase_clear(&r_snapshot->chunks);
+  r_snapshot->size = 0;
+
+  /* Group small chunks into larger ones. */
+  const MemFileChunk *chunk = memfile->chunks.first;
+  while (chunk) {
+    uint size = 0;
+    const MemFileChunk *chunk_end = chunk;
+    do {
+      size += chunk_end->size;
+      chunk_end = chunk_end->next;
+    } while (chunk_end && (size + chunk_end->size <= MEMFILE_SNAPSHOT_CHUNK_SIZE));
+
+    char *buf = MEM_mallocN(size, "Chunk buffer");
+    uint offset = 0;
+    for (; chunk != chunk_end; chunk = chunk->next) {
+      BLO_memfile_chunk_read(chunk, 0, chunk->size, buf + offset);
+      offset += chunk->size;
+    }
+
+    MemFileChunk *snapshot_chunk = MEM_callocN(sizeof(MemFileChunk), "MemFileChunk");
+    snapshot_chunk->buf = buf;
+    snapshot_chunk->size = size;
+    snapshot_chunk->id_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
+    BLI_addtail(&r_snapshot->chunks, snapshot_chunk);
+    r_snapshot->size += size;
+  }
+}
+
 /**
  * Saves .blend using undo buffer.
  *
  * \return success.
  */
 bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
+{
+  return BLO_memfile_write_file_ex(memfile, filename, NULL, NULL);
+}
+
+/**
+ * Same as #BLO_memfile_write_file, with progress reporting and cancellation
+ * for writing from a job.
+ *
+ * \param stop: Optional, cancel writing when set (the file is left incomplete).
+ * \param progress: Optional, updated with the part of the file written so far.
+ */
+bool BLO_memfile_write_file_ex(struct MemFile *memfile,
+                               const char *filename,
+                               const short *stop,
+                               float *progress)
 {
   MemFileChunk *chunk;
   int file, oflags;
+  size_t size_total = 0, size_written = 0;
+  /* Expanded data of array chunks. */
+  char *array_buf = NULL;
+  size_t array_buf_len = 0;
 
   /* note: This is currently used for autosave and 'quit.blend',
    * where _not_ following symlinks is OK,
@@ -251,14 +427,43 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
     return false;
   }
 
+  if (progress) {
+    LISTBASE_FOREACH (MemFileChunk *, chunk_iter, &memfile->chunks) {
+      size_total += chunk_iter->size;
+    }
+  }
+
   for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
-    if ((size_t)write(file, chunk->buf, chunk->size) != chunk->size) {
+    if (stop && *stop) {
       break;
     }
+    const char *buf = chunk->buf;
+    if (chunk->state) {
+      if (array_buf_len < chunk->size) {
+        MEM_SAFE_FREE(array_buf);
+        array_buf = MEM_mallocN(chunk->size, __func__);
+        array_buf_len = chunk->size;
+      }
+      BLO_memfile_chunk_read(chunk, 0, chunk->size, array_buf);
+      buf = array_buf;
+    }
+    if ((size_t)write(file, buf, chunk->size) != chunk->size) {
+      break;
+    }
+    if (progress) {
+      size_written += chunk->size;
+      *progress = (float)((double)size_written / (double)size_total);
+    }
   }
 
   close(file);
 
+  MEM_SAFE_FREE(array_buf);
+
+  if (chunk && stop && *stop) {
+    return false;
+  }
+
   if (chunk) {
     fprintf(stderr,
             "Unable to save '%s': %s\n",
@@ -149,6 +149,8 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h"  // MEM_freeN
 
 #include "BKE_action.h"
@@ -223,7 +225,7 @@ struct WriteWrap {
   /* internal */
   union {
     int file_handle;
-    gzFile gz_handle;
+    struct ZlibFramesWriter *zlib_frames;
   } _user_data;
 };
 
@@ -254,17 +256,204 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+/* zlib (seekable frames, see #BLO_GZIP_FRAME_SIZE) */
+#define ZLIB_FRAMES(ww) (ww)->_user_data.zlib_frames
+
+/* Matches the "wb1" mode previously used with gzopen, favor speed over size. */
+#define ZLIB_FRAME_LEVEL 1
+
+typedef struct ZlibFrame {
+  /** Uncompressed data (#BLO_GZIP_FRAME_SIZE allocated). */
+  char *data;
+  size_t data_len;
+  /** Compressed data, a complete gzip member. */
+  char *compressed;
+  size_t compressed_len;
+  size_t compressed_alloc_len;
+  bool error;
+} ZlibFrame;
+
+typedef struct ZlibFramesWriter {
+  int file_handle;
+  /** Frames compressed in parallel, written out in order once all are filled. */
+  ZlibFrame *frames;
+  int frames_len;
+  /** The frame being filled, frames before it are waiting to be compressed. */
+  int frame_active;
+  /** Compressed and uncompressed size of all written frames, for the frame table. */
+  uint (*frame_sizes)[2];
+  int frame_sizes_len;
+  int frame_sizes_alloc_len;
+  TaskPool *task_pool;
+  bool error;
+} ZlibFramesWriter;
+
+static void ww_zlib_frame_compress_fn(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  ZlibFrame *frame = taskdata;
+  z_stream strm = {NULL};
+
+  frame->compressed_len = 0;
+  frame->error = false;
+
+  /* Window bits of 16 + MAX_WBITS to write a gzip header & trailer. */
+  if (deflateInit2(&strm, ZLIB_FRAME_LEVEL, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) !=
+      Z_OK) {
+    frame->error = true;
+    return;
+  }
+
+  const size_t compressed_bound = deflateBound(&strm, (uLong)frame->data_len);
+  if (frame->compressed_alloc_len < compressed_bound) {
+    MEM_SAFE_FREE(frame->compressed);
+    frame->compressed = MEM_mallocN(compressed_bound, __func__);
+    frame->compressed_alloc_len = compressed_bound;
+  }
+
+  strm.next_in = (Bytef *)frame->data;
+  strm.avail_in = (uInt)frame->data_len;
+  strm.next_out = (Bytef *)frame->compressed;
+  strm.avail_out = (uInt)frame->compressed_alloc_len;
+
+  if (deflate(&strm, Z_FINISH) == Z_STREAM_END) {
+    frame->compressed_len = strm.total_out;
+  }
+  else {
+    frame->error = true;
+  }
+
+  deflateEnd(&strm);
+}
+
+static bool ww_zlib_write_all(int file, const void *buf, size_t buf_len)
+{
+  while (buf_len > 0) {
+    const ssize_t written = write(file, buf, buf_len);
+    if (written <= 0) {
+      return false;
+    }
+    buf = POINTER_OFFSET(buf, written);
+    buf_len -= (size_t)written;
+  }
+  return true;
+}
+
+/**
+ * Compress all filled frames in parallel, then write them to the file in order.
+ */
+static void ww_zlib_frames_flush(ZlibFramesWriter *zw)
+{
+  const int frames_filled = zw->frame_active + (zw->frames[zw->frame_active].data_len != 0);
+  if (frames_filled == 0) {
+    return;
+  }
+
+  for (int i = 0; i < frames_filled; i++) {
+    BLI_task_pool_push(zw->task_pool, ww_zlib_frame_compress_fn, &zw->frames[i], false, NULL);
+  }
+  BLI_task_pool_work_and_wait(zw->task_pool);
+
+  for (int i = 0; i < frames_filled; i++) {
+    ZlibFrame *frame = &zw->frames[i];
+    if (zw->error == false) {
+      if (frame->error ||
+          !ww_zlib_write_all(zw->file_handle, frame->compressed, frame->compressed_len)) {
+        zw->error = true;
+      }
+    }
+
+    if (zw->frame_sizes_len == zw->frame_sizes_alloc_len) {
+      zw->frame_sizes_alloc_len = MAX2(64, zw->frame_sizes_alloc_len * 2);
+      zw->frame_sizes = MEM_reallocN(zw->frame_sizes,
+                                     sizeof(*zw->frame_sizes) * zw->frame_sizes_alloc_len);
+    }
+    zw->frame_sizes[zw->frame_sizes_len][0] = (uint)frame->compressed_len;
+    zw->frame_sizes[zw->frame_sizes_len][1] = (uint)frame->data_len;
+    zw->frame_sizes_len++;
+
+    frame->data_len = 0;
+  }
+  zw->frame_active = 0;
+}
+
+static void ww_zlib_encode_uint16(uchar *buf, uint value)
+{
+  buf[0] = value & 0xff;
+  buf[1] = (value >> 8) & 0xff;
+}
+
+static void ww_zlib_encode_uint32(uchar *buf, uint value)
+{
+  buf[0] = value & 0xff;
+  buf[1] = (value >> 8) & 0xff;
+  buf[2] = (value >> 16) & 0xff;
+  buf[3] = (value >> 24) & 0xff;
+}
+
+/**
+ * Write the frame table as an empty gzip member, see #BLO_GZIP_FRAME_SIZE.
+ */
+static bool ww_zlib_frames_write_table(ZlibFramesWriter *zw)
+{
+  if (zw->frame_sizes_len > BLO_GZIP_FRAMES_MAX) {
+    /* The file is still a valid gzip file, just not seekable. */
+    return true;
+  }
+
+  const uint payload_len = (uint)zw->frame_sizes_len * 8 + 8;
+  const uint member_len = 10 + 2 + 4 + payload_len + BLO_GZIP_FRAMES_TRAILER_SIZE;
+  uchar *member = MEM_callocN(member_len, __func__);
+  uchar *p = member;
+
+  /* Header: magic, deflate, FEXTRA flag, no time-stamp, no extra flags, unknown OS. */
+  const uchar header[10] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff};
+  memcpy(p, header, sizeof(header));
+  p += sizeof(header);
+
+  ww_zlib_encode_uint16(p, 4 + payload_len);
+  p += 2;
+  p[0] = BLO_GZIP_FRAMES_SI1;
+  p[1] = BLO_GZIP_FRAMES_SI2;
+  ww_zlib_encode_uint16(p + 2, payload_len);
+  p += 4;
+
+  for (int i = 0; i < zw->frame_sizes_len; i++) {
+    ww_zlib_encode_uint32(p, zw->frame_sizes[i][0]);
+    ww_zlib_encode_uint32(p + 4, zw->frame_sizes[i][1]);
+    p += 8;
+  }
+  ww_zlib_encode_uint32(p, (uint)zw->frame_sizes_len);
+  memcpy(p + 4, BLO_GZIP_FRAMES_MAGIC, 4);
+  p += 8;
+
+  /* Empty final deflate block using fixed codes, the CRC and size of no data are all zero. */
+  p[0] = 0x03;
+  p[1] = 0x00;
+  p += BLO_GZIP_FRAMES_TRAILER_SIZE;
+
+  BLI_assert(p == member + member_len);
+  const bool ok = ww_zlib_write_all(zw->file_handle, member, member_len);
+  MEM_freeN(member);
+  return ok;
+}
 
 static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 {
-  gzFile file;
+  int file;
 
-  file = BLI_gzopen(filepath, "wb1");
+  file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
+  if (file != -1) {
+    ZlibFramesWriter *zw = MEM_callocN(sizeof(*zw), __func__);
+    zw->file_handle = file;
+    /* Enough frames to keep all threads busy. */
+    zw->frames_len = MAX2(2, BLI_system_thread_count());
+    zw->frames = MEM_callocN(sizeof(*zw->frames) * zw->frames_len, __func__);
+    for (int i = 0; i < zw->frames_len; i++) {
+      zw->frames[i].data = MEM_mallocN(BLO_GZIP_FRAME_SIZE, __func__);
+    }
+    zw->task_pool = BLI_task_pool_create(zw, TASK_PRIORITY_HIGH);
+    ZLIB_FRAMES(ww) = zw;
     return true;
   }
   else {
@@ -273,13 +462,55 @@ static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  ZlibFramesWriter *zw = ZLIB_FRAMES(ww);
+
+  ww_zlib_frames_flush(zw);
+  if (zw->error == false) {
+    zw->error = !ww_zlib_frames_write_table(zw);
+  }
+
+  bool ok = (zw->error == false);
+  if (close(zw->file_handle) == -1) {
+    ok = false;
+  }
+
+  BLI_task_pool_free(zw->task_pool);
+  for (int i = 0; i < zw->frames_len; i++) {
+    MEM_freeN(zw->frames[i].data);
+    MEM_SAFE_FREE(zw->frames[i].compressed);
+  }
+  MEM_freeN(zw->frames);
+  MEM_SAFE_FREE(zw->frame_sizes);
+  MEM_freeN(zw);
+  ZLIB_FRAMES(ww) = NULL;
+
+  return ok;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  ZlibFramesWriter *zw = ZLIB_FRAMES(ww);
+  size_t written = 0;
+
+  while (written < buf_len) {
+    ZlibFrame *frame = &zw->frames[zw->frame_active];
+    const size_t len = MIN2(buf_len - written, BLO_GZIP_FRAME_SIZE - frame->data_len);
+    memcpy(frame->data + frame->data_len, buf + written, len);
+    frame->data_len += len;
+    written += len;
+
+    if (frame->data_len == BLO_GZIP_FRAME_SIZE) {
+      if (zw->frame_active + 1 == zw->frames_len) {
+        ww_zlib_frames_flush(zw);
+      }
+      else {
+        zw->frame_active++;
+      }
+    }
+  }
+
+  return zw->error ? 0 : written;
 }
-#undef FILE_HANDLE
+#undef ZLIB_FRAMES
 
 /* --- end compression types --- */
 
@@ -438,6 +669,13 @@ static void mywrite(WriteData *wd, const void *adr, int len)
         wd->buf_used_len = 0;
       }
 
+      /* Undo stores big chunks as a whole, so their unchanged parts are shared
+       * with previous steps even when data was inserted or removed. */
+      if (wd->use_memfile && (len % BLO_MEMFILE_ARRAY_STRIDE) == 0) {
+        BLO_memfile_chunk_add_array(&wd->mem, adr, (uint)len);
+        return;
+      }
+
       do {
         int writelen = MIN2(len, MYWRITE_MAX_CHUNK);
         writedata_do_write(wd, adr, writelen);
@@ -4445,9 +4683,12 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
+  bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
 
-  ww.close(&ww);
+  /* Compressed files may still have data to write out when closing. */
+  if (ww.close(&ww) == false) {
+    err = true;
+  }
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
@@ -85,6 +85,11 @@ void DEG_graph_build_from_ids(struct Depsgraph *graph,
 /* Tag relations from the given graph for update. */
 void DEG_graph_tag_relations_update(struct Depsgraph *graph);
 
+/* Tag relations of the given ID for update in the given graph.
+ * Only nodes and relations of this ID are re-built on the next relations update, unless the
+ * change can not be handled locally, in which case the whole graph is re-built. */
+void DEG_graph_id_tag_relations_update(struct Depsgraph *graph, struct ID *id);
+
 /* Create or update relations in the specified graph. */
 void DEG_graph_relations_update(struct Depsgraph *graph,
                                 struct Main *bmain,
@@ -94,6 +99,9 @@ void DEG_graph_relations_update(struct Depsgraph *graph,
 /* Tag all relations in the database for update.*/
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of the given ID for update in all dependency graphs. */
+void DEG_id_tag_relations_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /* Handle for components to define their dependencies from callbacks.
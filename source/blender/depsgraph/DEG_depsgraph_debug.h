@@ -63,6 +63,14 @@ void DEG_debug_stats_gnuplot(const struct Depsgraph *graph,
                              const char *label,
                              const char *output_filename);
 
+/* ************************************************ */
+/* Evaluation Trace */
+
+/* Write timing of every evaluated operation of all dependency graphs to the given file,
+ * in the Chrome trace event format. Returns false if the file could not be opened. */
+bool DEG_debug_trace_begin(const char *filepath);
+void DEG_debug_trace_end(void);
+
 /* ************************************************ */
 
 /* Compare two dependency graphs. */
@@ -43,6 +43,7 @@
 #include "intern/depsgraph_tag.h"
 #include "intern/depsgraph_type.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
+#include "intern/eval/deg_eval_priority.h"
 #include "intern/node/deg_node.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
@@ -74,7 +75,7 @@ bool deg_check_base_in_depsgraph(const Depsgraph *graph, Base *base)
  */
 
 DepsgraphBuilder::DepsgraphBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache)
-    : bmain_(bmain), graph_(graph), cache_(cache)
+    : bmain_(bmain), graph_(graph), cache_(cache), owner_id_(nullptr)
 {
 }
 
@@ -209,6 +210,7 @@ void deg_graph_build_finalize(Main *bmain, Depsgraph *graph)
   /* Make sure dependencies of visible ID datablocks are visible. */
   deg_graph_build_flush_visibility(graph);
   deg_graph_remove_unused_noops(graph);
+  deg_eval_priorities_calculate(graph);
 
   /* Re-tag IDs for update if it was tagged before the relations
    * update tag. */
@@ -49,10 +49,35 @@ class DepsgraphBuilder {
   /* NOTE: The builder does NOT take ownership over any of those resources. */
   DepsgraphBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache);
 
+  /* Operations and relations are owned by the ID whose build function created them: this is what
+   * allows to rebuild them for individual IDs, see deg_builder_incremental.h.
+   *
+   * The scope is to be opened by every build function of an ID right after the ID is tagged as
+   * built. */
+  class BuildOwnerScope {
+   public:
+    BuildOwnerScope(DepsgraphBuilder *builder, ID *id)
+        : builder_(builder), previous_owner_id_(builder->owner_id_)
+    {
+      builder_->owner_id_ = id;
+    }
+    ~BuildOwnerScope()
+    {
+      builder_->owner_id_ = previous_owner_id_;
+    }
+
+   private:
+    DepsgraphBuilder *builder_;
+    ID *previous_owner_id_;
+  };
+
   /* State which never changes, same for the whole builder time. */
   Main *bmain_;
   Depsgraph *graph_;
   DepsgraphBuilderCache *cache_;
+
+  /* ID on behalf of which nodes and relations are currently being built. */
+  ID *owner_id_;
 };
 
 bool deg_check_id_in_depsgraph(const Depsgraph *graph, ID *id_orig);
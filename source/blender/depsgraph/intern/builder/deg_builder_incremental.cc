@@ -0,0 +1,614 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Operations and relations know the ID on behalf of which the builders created them, see
+ * DepsgraphBuilder::BuildOwnerScope. This allows to remove everything an ID contributed to the
+ * graph and to run the builders for this ID again, with all other IDs considered built.
+ */
+
+#include "intern/builder/deg_builder_incremental.h"
+
+#include "BLI_listbase.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_object_force_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_collision.h"
+#include "BKE_effect.h"
+
+#include "DEG_depsgraph_physics.h"
+
+#include "intern/builder/deg_builder_cache.h"
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/depsgraph_type.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender {
+namespace deg {
+
+namespace {
+
+class DepsgraphIncrementalNodeBuilder : public DepsgraphNodeBuilder {
+ public:
+  DepsgraphIncrementalNodeBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache)
+      : DepsgraphNodeBuilder(bmain, graph, cache)
+  {
+  }
+
+  /* Remember entry tag of an operation which is about to be removed, so that end_build() restores
+   * it on the re-created operation. */
+  void save_entry_tag(OperationNode *op_node)
+  {
+    ComponentNode *comp_node = op_node->owner;
+    SavedEntryTag entry_tag;
+    entry_tag.id_orig = comp_node->owner->id_orig;
+    entry_tag.component_type = comp_node->type;
+    entry_tag.opcode = op_node->opcode;
+    entry_tag.name = op_node->name;
+    entry_tag.name_tag = op_node->name_tag;
+    saved_entry_tags_.append(entry_tag);
+  }
+
+  /* Build nodes of the given objects, all the other IDs of the graph are considered built. */
+  void build_objects(const Set<ID *> &ids)
+  {
+    for (IDNode *id_node : graph_->id_nodes) {
+      if (!ids.contains(id_node->id_orig)) {
+        built_map_.tagBuild(id_node->id_orig);
+      }
+    }
+    scene_ = graph_->scene;
+    view_layer_ = graph_->view_layer;
+    view_layer_index_ = 0;
+    for (ID *id : ids) {
+      Object *object = (Object *)id;
+      const IDNode *id_node = graph_->find_id_node(id);
+      /* The object keeps its users, which are not rebuilt. */
+      BuildOwnerScope owner_scope(this, id);
+      build_object(
+          find_base_index(object), object, id_node->linked_state, id_node->is_directly_visible);
+    }
+  }
+
+ protected:
+  /* Base index as assigned by build_view_layer(), or -1 if the object has no base. */
+  int find_base_index(const Object *object)
+  {
+    int base_index = 0;
+    LISTBASE_FOREACH (Base *, base, &view_layer_->object_bases) {
+      if (need_pull_base_into_graph(base)) {
+        if (base->object == object) {
+          return base_index;
+        }
+        base_index++;
+      }
+    }
+    return -1;
+  }
+};
+
+class DepsgraphIncrementalRelationBuilder : public DepsgraphRelationBuilder {
+ public:
+  DepsgraphIncrementalRelationBuilder(Main *bmain,
+                                      Depsgraph *graph,
+                                      DepsgraphBuilderCache *cache)
+      : DepsgraphRelationBuilder(bmain, graph, cache)
+  {
+  }
+
+  /* Build relations of the given IDs, all the other IDs of the graph are considered built. */
+  void build_ids(const Set<ID *> &ids)
+  {
+    for (IDNode *id_node : graph_->id_nodes) {
+      if (!ids.contains(id_node->id_orig)) {
+        built_map_.tagBuild(id_node->id_orig);
+      }
+    }
+    scene_ = graph_->scene;
+    for (ID *id : ids) {
+      if (id == &graph_->scene->id) {
+        build_view_layer(graph_->scene, graph_->view_layer, DEG_ID_LINKED_DIRECTLY);
+      }
+      else {
+        build_id(id);
+      }
+    }
+    for (ID *id : ids) {
+      IDNode *id_node = graph_->find_id_node(id);
+      build_copy_on_write_relations(id_node);
+      build_driver_relations(id_node);
+    }
+  }
+};
+
+/* Identifies an operation across its removal and re-creation. */
+struct OperationIdentifier {
+  ID *id_orig;
+  NodeType component_type;
+  string component_name;
+  OperationCode opcode;
+  string name;
+  int name_tag;
+};
+
+OperationIdentifier operation_identifier(const OperationNode *op_node)
+{
+  const ComponentNode *comp_node = op_node->owner;
+  return {comp_node->owner->id_orig,
+          comp_node->type,
+          comp_node->name,
+          op_node->opcode,
+          op_node->name,
+          op_node->name_tag};
+}
+
+OperationNode *find_operation(const Depsgraph *graph, const OperationIdentifier &identifier)
+{
+  const IDNode *id_node = graph->find_id_node(identifier.id_orig);
+  if (id_node == nullptr) {
+    return nullptr;
+  }
+  const ComponentNode *comp_node = id_node->find_component(identifier.component_type,
+                                                           identifier.component_name.c_str());
+  if (comp_node == nullptr) {
+    return nullptr;
+  }
+  return comp_node->find_operation(
+      identifier.opcode, identifier.name.c_str(), identifier.name_tag);
+}
+
+/* Physics relations are cached per collection and used by objects other than the ones whose
+ * builders requested them, so changes to objects which take part in physics are not local. */
+bool object_uses_physics(const Depsgraph *graph, const Object *object)
+{
+  if (object->pd != nullptr && (object->pd->forcefield != PFIELD_NULL || object->pd->deflect)) {
+    return true;
+  }
+  if (object->soft != nullptr || object->rigidbody_object != nullptr ||
+      object->rigidbody_constraint != nullptr) {
+    return true;
+  }
+  if (!BLI_listbase_is_empty(&object->particlesystem)) {
+    return true;
+  }
+  LISTBASE_FOREACH (ModifierData *, md, &object->modifiers) {
+    if (ELEM(md->type,
+             eModifierType_Cloth,
+             eModifierType_Collision,
+             eModifierType_DynamicPaint,
+             eModifierType_Fluid,
+             eModifierType_ParticleSystem,
+             eModifierType_Softbody,
+             eModifierType_Surface)) {
+      return true;
+    }
+  }
+  /* Object might have stopped taking part in physics, but it is still in the caches. */
+  for (int i = 0; i < DEG_PHYSICS_RELATIONS_NUM; i++) {
+    const Map<const ID *, ListBase *> *hash = graph->physics_relations[i];
+    if (hash == nullptr) {
+      continue;
+    }
+    for (const ListBase *relations : hash->values()) {
+      if (i == DEG_PHYSICS_EFFECTOR) {
+        LISTBASE_FOREACH (const EffectorRelation *, relation, relations) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+      else {
+        LISTBASE_FOREACH (const CollisionRelation *, relation, relations) {
+          if (relation->ob == object) {
+            return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool id_can_be_rebuilt(const Depsgraph *graph, const IDNode *id_node)
+{
+  if (id_node->linked_state == DEG_ID_LINKED_VIA_SET) {
+    return false;
+  }
+  const ID *id = id_node->id_orig;
+  if (GS(id->name) == ID_SCE) {
+    /* Scene relations are built by the view layer builder, which does not support scene sets. */
+    const Scene *scene = (const Scene *)id;
+    return scene == graph->scene && scene->set == nullptr;
+  }
+  if (GS(id->name) != ID_OB) {
+    return true;
+  }
+  const Object *object = (const Object *)id;
+  if (object->proxy != nullptr || object->proxy_from != nullptr) {
+    return false;
+  }
+  if (id_node->find_component(NodeType::PARTICLE_SYSTEM) != nullptr) {
+    return false;
+  }
+  return !object_uses_physics(graph, object);
+}
+
+/* Add ID which created the relation to the set, returns false if relations of a single ID can not
+ * be rebuilt. */
+bool add_relation_build_owner(const Depsgraph *graph, const Relation *rel, Set<ID *> &ids)
+{
+  if (rel->build_owner == nullptr || (rel->flag & RELATION_FLAG_SHARED)) {
+    return false;
+  }
+  if (!ids.add(rel->build_owner)) {
+    return true;
+  }
+  const IDNode *id_node = graph->find_id_node(rel->build_owner);
+  return id_node != nullptr && id_can_be_rebuilt(graph, id_node);
+}
+
+/* Find IDs which are not used by the scene anymore, either directly or via other IDs. This is the
+ * case for IDs which were only used by the previous state of the rebuilt IDs. */
+Set<ID *> find_unused_ids(const Depsgraph *graph)
+{
+  Map<ID *, Vector<IDNode *>> used_id_nodes;
+  for (IDNode *id_node : graph->id_nodes) {
+    for (ID *user : id_node->build_users) {
+      used_id_nodes.lookup_or_add_default(user).append(id_node);
+    }
+  }
+  Set<const IDNode *> used_set;
+  Vector<IDNode *> stack;
+  IDNode *scene_node = graph->find_id_node(&graph->scene->id);
+  if (scene_node != nullptr) {
+    stack.append(scene_node);
+  }
+  if (const Vector<IDNode *> *root_id_nodes = used_id_nodes.lookup_ptr(nullptr)) {
+    stack.extend(*root_id_nodes);
+  }
+  while (!stack.is_empty()) {
+    IDNode *id_node = stack.pop_last();
+    if (!used_set.add(id_node)) {
+      continue;
+    }
+    if (const Vector<IDNode *> *id_nodes = used_id_nodes.lookup_ptr(id_node->id_orig)) {
+      stack.extend(*id_nodes);
+    }
+  }
+  Set<ID *> unused_ids;
+  for (IDNode *id_node : graph->id_nodes) {
+    if (!used_set.contains(id_node)) {
+      unused_ids.add_new(id_node->id_orig);
+    }
+  }
+  return unused_ids;
+}
+
+bool node_belongs_to_ids(const Node *node, const Set<ID *> &ids)
+{
+  if (node->type == NodeType::TIMESOURCE) {
+    return true;
+  }
+  if (node->type != NodeType::OPERATION) {
+    return false;
+  }
+  return ids.contains(((const OperationNode *)node)->owner->owner->id_orig);
+}
+
+/* Remove nodes of the given IDs from the graph, returns false if they are connected to nodes of
+ * other IDs. */
+bool remove_id_nodes(Depsgraph *graph, const Set<ID *> &ids)
+{
+  Set<Relation *> removed_relations;
+  for (OperationNode *op_node : graph->operations) {
+    if (!ids.contains(op_node->owner->owner->id_orig)) {
+      continue;
+    }
+    for (Relation *rel : op_node->inlinks) {
+      if (!node_belongs_to_ids(rel->from, ids)) {
+        return false;
+      }
+      removed_relations.add(rel);
+    }
+    for (Relation *rel : op_node->outlinks) {
+      if (!node_belongs_to_ids(rel->to, ids)) {
+        return false;
+      }
+      removed_relations.add(rel);
+    }
+  }
+  for (Relation *rel : removed_relations) {
+    rel->unlink();
+    delete rel;
+  }
+
+  Depsgraph::OperationNodes remaining_operations;
+  for (OperationNode *op_node : graph->operations) {
+    if (ids.contains(op_node->owner->owner->id_orig)) {
+      graph->entry_tags.remove(op_node);
+    }
+    else {
+      remaining_operations.append(op_node);
+    }
+  }
+  graph->operations = std::move(remaining_operations);
+
+  Depsgraph::IDDepsNodes remaining_id_nodes;
+  for (IDNode *id_node : graph->id_nodes) {
+    if (ids.contains(id_node->id_orig)) {
+      graph->id_hash.remove(id_node->id_orig);
+      delete id_node;
+    }
+    else {
+      remaining_id_nodes.append(id_node);
+    }
+  }
+  graph->id_nodes = std::move(remaining_id_nodes);
+  return true;
+}
+
+/* Withdraw evaluation flags and customdata masks requested by the given IDs. */
+void withdraw_eval_requests(IDNode *id_node, const Set<ID *> &ids)
+{
+  bool is_changed = false;
+  for (ID *id : ids) {
+    is_changed |= id_node->eval_requests.remove(id);
+  }
+  if (!is_changed) {
+    return;
+  }
+  id_node->eval_flags = 0;
+  id_node->customdata_masks = DEGCustomDataMeshMasks();
+  for (const IDNode::EvalRequest &request : id_node->eval_requests.values()) {
+    id_node->eval_flags |= request.eval_flags;
+    id_node->customdata_masks |= request.customdata_masks;
+  }
+}
+
+}  // namespace
+
+bool deg_graph_build_incremental(Main *bmain, Depsgraph *graph)
+{
+  if (graph->has_reduced_relations) {
+    return false;
+  }
+
+  /* IDs whose nodes are to be rebuilt. */
+  Set<ID *> node_ids;
+  for (ID *id : graph->relations_update_ids) {
+    const IDNode *id_node = graph->find_id_node(id);
+    if (id_node == nullptr) {
+      /* Relations of an ID which is not in this graph do not affect it. */
+      continue;
+    }
+    if (GS(id->name) != ID_OB || !id_can_be_rebuilt(graph, id_node)) {
+      return false;
+    }
+    node_ids.add_new(id);
+  }
+  if (node_ids.is_empty()) {
+    return true;
+  }
+
+  /* Operations to be removed and created again by the node builder. */
+  Set<OperationNode *> removed_operations;
+  for (OperationNode *op_node : graph->operations) {
+    if (op_node->owner->type == NodeType::COPY_ON_WRITE ||
+        !node_ids.contains(op_node->build_owner)) {
+      continue;
+    }
+    if (op_node->flag & DEPSOP_FLAG_SHARED) {
+      return false;
+    }
+    removed_operations.add_new(op_node);
+  }
+
+  /* IDs whose relations are to be rebuilt: all relations of the removed operations are to be
+   * re-created, so are the rest of the relations created by the same IDs. */
+  Set<ID *> relation_ids = node_ids;
+  for (OperationNode *op_node : removed_operations) {
+    for (Relation *rel : op_node->inlinks) {
+      if (!add_relation_build_owner(graph, rel, relation_ids)) {
+        return false;
+      }
+    }
+    for (Relation *rel : op_node->outlinks) {
+      if (!add_relation_build_owner(graph, rel, relation_ids)) {
+        return false;
+      }
+    }
+  }
+  Vector<Relation *> removed_relations;
+  /* IDs with operations which lose copy-on-write relations. */
+  Set<ID *> copy_on_write_ids;
+  for (OperationNode *op_node : graph->operations) {
+    for (Relation *rel : op_node->inlinks) {
+      if (!relation_ids.contains(rel->build_owner)) {
+        continue;
+      }
+      if (rel->flag & RELATION_FLAG_SHARED) {
+        return false;
+      }
+      removed_relations.append(rel);
+      copy_on_write_ids.add(op_node->owner->owner->id_orig);
+      if (rel->from->type == NodeType::OPERATION) {
+        copy_on_write_ids.add(((OperationNode *)rel->from)->owner->owner->id_orig);
+      }
+    }
+  }
+
+  /* Unused no-op operations had their incoming relations removed by the previous build, which
+   * can not be undone once they are used again. */
+  Vector<OperationNode *> unlinked_noops;
+  Vector<OperationIdentifier> removed_unlinked_noops;
+  for (OperationNode *op_node : graph->operations) {
+    if (!op_node->is_noop() || !op_node->inlinks.is_empty() || !op_node->outlinks.is_empty()) {
+      continue;
+    }
+    if (removed_operations.contains(op_node)) {
+      removed_unlinked_noops.append(operation_identifier(op_node));
+    }
+    else {
+      unlinked_noops.append(op_node);
+    }
+  }
+
+  /* From here on the graph is modified. If the update fails, the graph stays suitable for a full
+   * rebuild. */
+  DepsgraphBuilderCache builder_cache;
+  DepsgraphIncrementalNodeBuilder node_builder(bmain, graph, &builder_cache);
+
+  for (IDNode *id_node : graph->id_nodes) {
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      comp_node->restore_operations_map();
+    }
+  }
+
+  for (Relation *rel : removed_relations) {
+    rel->unlink();
+    delete rel;
+  }
+
+  /* The node builder records IDs used by the rebuilt IDs again. */
+  for (IDNode *id_node : graph->id_nodes) {
+    for (ID *id : node_ids) {
+      id_node->build_users.remove(id);
+    }
+  }
+
+  Depsgraph::OperationNodes remaining_operations;
+  remaining_operations.reserve(graph->operations.size() - removed_operations.size());
+  for (OperationNode *op_node : graph->operations) {
+    if (!removed_operations.contains(op_node)) {
+      remaining_operations.append(op_node);
+    }
+  }
+  graph->operations = std::move(remaining_operations);
+  for (OperationNode *op_node : removed_operations) {
+    if (graph->entry_tags.remove(op_node)) {
+      node_builder.save_entry_tag(op_node);
+    }
+    ComponentNode *comp_node = op_node->owner;
+    comp_node->operations_map->remove(ComponentNode::OperationIDKey(
+        op_node->opcode, op_node->name.c_str(), op_node->name_tag));
+    if (comp_node->entry_operation == op_node) {
+      comp_node->entry_operation = nullptr;
+    }
+    if (comp_node->exit_operation == op_node) {
+      comp_node->exit_operation = nullptr;
+    }
+    delete op_node;
+  }
+
+  /* Build nodes. */
+  const uint num_id_nodes = graph->id_nodes.size();
+  const uint num_operations = graph->operations.size();
+  node_builder.build_objects(node_ids);
+  node_builder.end_build();
+  for (uint i = num_id_nodes; i < graph->id_nodes.size(); i++) {
+    relation_ids.add(graph->id_nodes[i]->id_orig);
+  }
+  for (uint i = num_operations; i < graph->operations.size(); i++) {
+    copy_on_write_ids.add(graph->operations[i]->owner->owner->id_orig);
+  }
+
+  /* Remove IDs which were pulled into the graph only by the previous state of the rebuilt IDs, the
+   * same as a full rebuild would not have them. */
+  const Set<ID *> removed_ids = find_unused_ids(graph);
+  if (!removed_ids.is_empty()) {
+    Vector<OperationNode *> remaining_unlinked_noops;
+    for (OperationNode *op_node : unlinked_noops) {
+      if (!removed_ids.contains(op_node->owner->owner->id_orig)) {
+        remaining_unlinked_noops.append(op_node);
+      }
+    }
+    unlinked_noops = std::move(remaining_unlinked_noops);
+    if (!remove_id_nodes(graph, removed_ids)) {
+      return false;
+    }
+    for (ID *id : removed_ids) {
+      relation_ids.remove(id);
+      copy_on_write_ids.remove(id);
+    }
+  }
+
+  /* The relations builder requests evaluation flags and customdata masks of the rebuilt IDs
+   * again, the removed IDs do not request anything anymore. */
+  Set<ID *> withdrawn_request_ids = relation_ids;
+  for (ID *id : removed_ids) {
+    withdrawn_request_ids.add(id);
+  }
+  for (IDNode *id_node : graph->id_nodes) {
+    withdraw_eval_requests(id_node, withdrawn_request_ids);
+  }
+
+  /* Build relations. */
+  DepsgraphIncrementalRelationBuilder relation_builder(bmain, graph, &builder_cache);
+  relation_builder.begin_build();
+  relation_builder.build_ids(relation_ids);
+  for (ID *id : copy_on_write_ids) {
+    if (!relation_ids.contains(id)) {
+      relation_builder.build_copy_on_write_relations(graph->find_id_node(id),
+                                                     RELATION_CHECK_BEFORE_ADD);
+    }
+  }
+
+  for (const OperationNode *op_node : unlinked_noops) {
+    if (!op_node->outlinks.is_empty()) {
+      return false;
+    }
+  }
+  for (const OperationIdentifier &identifier : removed_unlinked_noops) {
+    const OperationNode *op_node = find_operation(graph, identifier);
+    if (op_node != nullptr && !op_node->outlinks.is_empty()) {
+      return false;
+    }
+  }
+
+  /* Reset state which the finalization accumulates. */
+  for (IDNode *id_node : graph->id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      comp_node->affects_directly_visible = false;
+    }
+  }
+  for (OperationNode *op_node : graph->operations) {
+    for (Relation *rel : op_node->inlinks) {
+      rel->flag &= ~RELATION_FLAG_CYCLIC;
+    }
+  }
+  return true;
+}
+
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,48 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Incremental update of the dependency graph, which rebuilds nodes and relations of individual
+ * IDs instead of the whole graph.
+ */
+
+#pragma once
+
+struct Main;
+
+namespace blender {
+namespace deg {
+
+struct Depsgraph;
+
+/* Rebuild nodes and relations of IDs from Depsgraph::relations_update_ids, keeping the rest of
+ * the graph as-is.
+ *
+ * Returns false if the change can not be handled locally, for example when the tagged ID takes
+ * part in physics simulation, its nodes are shared with other IDs or the transitive reduction
+ * removed relations of the graph. The graph is then to be rebuilt from scratch, which the graph is
+ * left suitable for.
+ *
+ * On success the graph is to be finalized the same way as after a full build. */
+bool deg_graph_build_incremental(Main *bmain, Depsgraph *graph);
+
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,230 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+#include "blenloader/blendfile_loading_base_test.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "BLI_listbase.h"
+
+#include "DNA_modifier_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BKE_collection.h"
+#include "BKE_main.h"
+#include "BKE_modifier.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg::tests {
+
+class IncrementalBuildTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = static_cast<ViewLayer *>(scene->view_layers.first);
+  }
+
+  void TearDown() override
+  {
+    depsgraph_free();
+    BKE_main_free(bmain);
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /* Object which is not in the view layer unless it is added to the scene collection. */
+  Object *add_object(const int type, const char *name)
+  {
+    Object *object = BKE_object_add_only_object(bmain, type, name);
+    object->data = BKE_object_obdata_add_from_type(bmain, type, name);
+    return object;
+  }
+
+  Object *add_scene_object(const int type, const char *name)
+  {
+    Object *object = add_object(type, name);
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+    return object;
+  }
+
+  ModifierData *add_modifier(Object *object, const ModifierType type)
+  {
+    ModifierData *md = BKE_modifier_new(type);
+    BLI_addtail(&object->modifiers, md);
+    return md;
+  }
+
+  void remove_modifier(Object *object, ModifierData *md)
+  {
+    BLI_remlink(&object->modifiers, md);
+    BKE_modifier_free(md);
+  }
+
+  void build_depsgraph()
+  {
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph, bmain, scene, view_layer);
+  }
+
+  Depsgraph *deg_graph()
+  {
+    return reinterpret_cast<Depsgraph *>(depsgraph);
+  }
+
+  /* Update relations after the object changed, expecting the update to happen incrementally. */
+  void update_object_relations(Object *object)
+  {
+    const IDNode *scene_node = deg_graph()->find_id_node(&scene->id);
+    DEG_graph_id_tag_relations_update(depsgraph, &object->id);
+    DEG_graph_relations_update(depsgraph, bmain, scene, view_layer);
+    /* A full rebuild re-creates all ID nodes. */
+    EXPECT_EQ(deg_graph()->find_id_node(&scene->id), scene_node);
+  }
+
+  /* Everything which a full rebuild and an incremental one are to agree on, sorted so that the
+   * order of building does not matter. */
+  static std::vector<std::string> describe_graph(const Depsgraph *graph)
+  {
+    std::vector<std::string> lines;
+    for (const IDNode *id_node : graph->id_nodes) {
+      const DEGCustomDataMeshMasks &masks = id_node->customdata_masks;
+      lines.push_back(id_node->name + " eval_flags " + std::to_string(id_node->eval_flags) +
+                      " customdata_masks " + std::to_string(masks.vert_mask) + " " +
+                      std::to_string(masks.edge_mask) + " " + std::to_string(masks.face_mask) +
+                      " " + std::to_string(masks.loop_mask) + " " +
+                      std::to_string(masks.poly_mask));
+    }
+    for (const OperationNode *op_node : graph->operations) {
+      lines.push_back(op_node->full_identifier());
+      for (const Relation *rel : op_node->inlinks) {
+        const std::string from = (rel->from->type == NodeType::OPERATION) ?
+                                     ((const OperationNode *)rel->from)->full_identifier() :
+                                     rel->from->identifier();
+        lines.push_back(from + " -> " + op_node->full_identifier() + " (" + rel->name + ")");
+      }
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+  }
+
+  /* Compare the incrementally updated graph with a graph built from scratch. */
+  void expect_same_as_full_build()
+  {
+    ::Depsgraph *depsgraph_full = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph_full, bmain, scene, view_layer);
+    EXPECT_EQ(describe_graph(deg_graph()),
+              describe_graph(reinterpret_cast<Depsgraph *>(depsgraph_full)));
+    DEG_graph_free(depsgraph_full);
+  }
+};
+
+TEST_F(IncrementalBuildTest, RemoveModifierTarget)
+{
+  Object *object = add_scene_object(OB_MESH, "Mesh");
+  Object *curve = add_object(OB_CURVE, "Curve");
+  CurveModifierData *cmd = (CurveModifierData *)add_modifier(object, eModifierType_Curve);
+  cmd->object = curve;
+  build_depsgraph();
+  EXPECT_NE(deg_graph()->find_id_node(&curve->id), nullptr);
+
+  remove_modifier(object, &cmd->modifier);
+  update_object_relations(object);
+  /* The curve was only in the graph because of the modifier. */
+  EXPECT_EQ(deg_graph()->find_id_node(&curve->id), nullptr);
+  EXPECT_EQ(deg_graph()->find_id_node((ID *)curve->data), nullptr);
+  expect_same_as_full_build();
+}
+
+TEST_F(IncrementalBuildTest, ChangeModifierTarget)
+{
+  Object *object = add_scene_object(OB_MESH, "Mesh");
+  Object *curve_a = add_object(OB_CURVE, "CurveA");
+  Object *curve_b = add_object(OB_CURVE, "CurveB");
+  CurveModifierData *cmd = (CurveModifierData *)add_modifier(object, eModifierType_Curve);
+  cmd->object = curve_a;
+  build_depsgraph();
+
+  cmd->object = curve_b;
+  update_object_relations(object);
+  EXPECT_EQ(deg_graph()->find_id_node(&curve_a->id), nullptr);
+  EXPECT_NE(deg_graph()->find_id_node(&curve_b->id), nullptr);
+  expect_same_as_full_build();
+}
+
+TEST_F(IncrementalBuildTest, KeepSharedModifierTarget)
+{
+  Object *object_a = add_scene_object(OB_MESH, "MeshA");
+  Object *object_b = add_scene_object(OB_MESH, "MeshB");
+  Object *curve = add_object(OB_CURVE, "Curve");
+  CurveModifierData *cmd_a = (CurveModifierData *)add_modifier(object_a, eModifierType_Curve);
+  CurveModifierData *cmd_b = (CurveModifierData *)add_modifier(object_b, eModifierType_Curve);
+  cmd_a->object = curve;
+  cmd_b->object = curve;
+  build_depsgraph();
+
+  remove_modifier(object_a, &cmd_a->modifier);
+  update_object_relations(object_a);
+  /* Still used by the other object. */
+  const IDNode *curve_node = deg_graph()->find_id_node(&curve->id);
+  ASSERT_NE(curve_node, nullptr);
+  EXPECT_EQ(curve_node->eval_flags, (uint32_t)DAG_EVAL_NEED_CURVE_PATH);
+  expect_same_as_full_build();
+}
+
+TEST_F(IncrementalBuildTest, WithdrawEvalRequests)
+{
+  Object *object = add_scene_object(OB_MESH, "Mesh");
+  Object *target = add_scene_object(OB_MESH, "Target");
+  ShrinkwrapModifierData *smd = (ShrinkwrapModifierData *)add_modifier(object,
+                                                                        eModifierType_Shrinkwrap);
+  smd->target = target;
+  smd->shrinkType = MOD_SHRINKWRAP_TARGET_PROJECT;
+  build_depsgraph();
+  const IDNode *target_node = deg_graph()->find_id_node(&target->id);
+  ASSERT_NE(target_node, nullptr);
+  EXPECT_EQ(target_node->eval_flags, (uint32_t)DAG_EVAL_NEED_SHRINKWRAP_BOUNDARY);
+  EXPECT_NE(target_node->customdata_masks, DEGCustomDataMeshMasks());
+
+  remove_modifier(object, &smd->modifier);
+  update_object_relations(object);
+  target_node = deg_graph()->find_id_node(&target->id);
+  ASSERT_NE(target_node, nullptr);
+  EXPECT_EQ(target_node->eval_flags, (uint32_t)0);
+  EXPECT_EQ(target_node->customdata_masks, DEGCustomDataMeshMasks());
+  expect_same_as_full_build();
+}
+
+}  // namespace blender::deg::tests
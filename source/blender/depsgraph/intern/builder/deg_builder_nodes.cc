@@ -150,26 +150,36 @@ DepsgraphNodeBuilder::~DepsgraphNodeBuilder()
   }
 }
 
+void DepsgraphNodeBuilder::add_build_user(ID *id)
+{
+  if (owner_id_ != id) {
+    build_users_.append({id, owner_id_});
+  }
+}
+
+bool DepsgraphNodeBuilder::check_is_built_and_tag(ID *id, int tag)
+{
+  add_build_user(id);
+  return built_map_.checkIsBuiltAndTag(id, tag);
+}
+
 IDNode *DepsgraphNodeBuilder::add_id_node(ID *id)
 {
+  add_build_user(id);
   IDNode *id_node = nullptr;
   ID *id_cow = nullptr;
-  IDComponentsMask previously_visible_components_mask = 0;
-  uint32_t previous_eval_flags = 0;
-  DEGCustomDataMeshMasks previous_customdata_masks;
   IDInfo *id_info = id_info_hash_.lookup_default(id, nullptr);
   if (id_info != nullptr) {
     id_cow = id_info->id_cow;
-    previously_visible_components_mask = id_info->previously_visible_components_mask;
-    previous_eval_flags = id_info->previous_eval_flags;
-    previous_customdata_masks = id_info->previous_customdata_masks;
+  }
+  id_node = graph_->add_id_node(id, id_cow);
+  if (id_info != nullptr) {
+    id_node->previously_visible_components_mask = id_info->previously_visible_components_mask;
+    id_node->previous_eval_flags = id_info->previous_eval_flags;
+    id_node->previous_customdata_masks = id_info->previous_customdata_masks;
     /* Tag ID info to not free the CoW ID pointer. */
     id_info->id_cow = nullptr;
   }
-  id_node = graph_->add_id_node(id, id_cow);
-  id_node->previously_visible_components_mask = previously_visible_components_mask;
-  id_node->previous_eval_flags = previous_eval_flags;
-  id_node->previous_customdata_masks = previous_customdata_masks;
   /* Currently all ID nodes are supposed to have copy-on-write logic.
    *
    * NOTE: Zero number of components indicates that ID node was just created. */
@@ -180,6 +190,9 @@ IDNode *DepsgraphNodeBuilder::add_id_node(ID *id)
         OperationCode::COPY_ON_WRITE,
         "",
         -1);
+    /* Copy-on-write operation belongs to the ID itself, regardless of which builder happened to
+     * pull the ID into the graph. */
+    op_cow->build_owner = id;
     graph_->operations.append(op_cow);
   }
   return id_node;
@@ -214,6 +227,7 @@ OperationNode *DepsgraphNodeBuilder::add_operation_node(ComponentNode *comp_node
   OperationNode *op_node = comp_node->find_operation(opcode, name, name_tag);
   if (op_node == nullptr) {
     op_node = comp_node->add_operation(op, opcode, name, name_tag);
+    op_node->build_owner = owner_id_;
     graph_->operations.append(op_node);
   }
   else {
@@ -258,6 +272,9 @@ OperationNode *DepsgraphNodeBuilder::ensure_operation_node(ID *id,
 {
   OperationNode *operation = find_operation_node(id, comp_type, opcode, name, name_tag);
   if (operation != nullptr) {
+    if (operation->build_owner != owner_id_) {
+      operation->flag |= OperationFlag::DEPSOP_FLAG_SHARED;
+    }
     return operation;
   }
   return add_operation_node(id, comp_type, opcode, op, name, name_tag);
@@ -377,6 +394,12 @@ void DepsgraphNodeBuilder::end_build()
      * that originally node was explicitly tagged for user update. */
     op_node->tag_update(graph_, DEG_UPDATE_SOURCE_USER_EDIT);
   }
+  for (const BuildUser &build_user : build_users_) {
+    IDNode *id_node = find_id_node(build_user.id);
+    if (id_node != nullptr) {
+      id_node->build_users.add(build_user.user);
+    }
+  }
 }
 
 void DepsgraphNodeBuilder::build_id(ID *id)
@@ -501,7 +524,7 @@ void DepsgraphNodeBuilder::build_collection(LayerCollection *from_layer_collecti
   const bool is_collection_restricted = (collection->flag & restrict_flag);
   const bool is_collection_visible = !is_collection_restricted && is_parent_collection_visible_;
   IDNode *id_node;
-  if (built_map_.checkIsBuiltAndTag(collection)) {
+  if (check_is_built_and_tag(collection)) {
     id_node = find_id_node(&collection->id);
     if (is_collection_visible && id_node->is_directly_visible == false &&
         id_node->is_collection_fully_expanded == true) {
@@ -524,6 +547,7 @@ void DepsgraphNodeBuilder::build_collection(LayerCollection *from_layer_collecti
 
     build_idproperties(collection->id.properties);
   }
+  BuildOwnerScope owner_scope(this, &collection->id);
   if (from_layer_collection != nullptr) {
     /* If we came from layer collection we don't go deeper, view layer
      * builder takes care of going deeper. */
@@ -557,7 +581,8 @@ void DepsgraphNodeBuilder::build_object(int base_index,
   if (object->proxy != nullptr) {
     object->proxy->proxy_from = object;
   }
-  const bool has_object = built_map_.checkIsBuiltAndTag(object);
+  const bool has_object = check_is_built_and_tag(object);
+  BuildOwnerScope owner_scope(this, &object->id);
 
   /* When there is already object in the dependency graph accumulate visibility an linked state
    * flags. Only do it on the object itself (apart from very special cases) and leave dealing with
@@ -769,7 +794,9 @@ void DepsgraphNodeBuilder::build_object_data(Object *object, bool is_object_visi
       break;
     default: {
       ID *obdata = (ID *)object->data;
+      add_build_user(obdata);
       if (!built_map_.checkIsBuilt(obdata)) {
+        BuildOwnerScope owner_scope(this, obdata);
         build_animdata(obdata);
       }
       break;
@@ -962,9 +989,10 @@ void DepsgraphNodeBuilder::build_animation_images(ID *id)
 
 void DepsgraphNodeBuilder::build_action(bAction *action)
 {
-  if (built_map_.checkIsBuiltAndTag(action)) {
+  if (check_is_built_and_tag(action)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &action->id);
   build_idproperties(action->id.properties);
   add_operation_node(&action->id, NodeType::ANIMATION, OperationCode::ANIMATION_EVAL);
 }
@@ -1060,9 +1088,10 @@ void DepsgraphNodeBuilder::build_dimensions(Object *object)
 /* Recursively build graph for world */
 void DepsgraphNodeBuilder::build_world(World *world)
 {
-  if (built_map_.checkIsBuiltAndTag(world)) {
+  if (check_is_built_and_tag(world)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &world->id);
   /* World itself. */
   add_id_node(&world->id);
   World *world_cow = get_cow_datablock(world);
@@ -1217,9 +1246,10 @@ void DepsgraphNodeBuilder::build_particle_systems(Object *object, bool is_object
 
 void DepsgraphNodeBuilder::build_particle_settings(ParticleSettings *particle_settings)
 {
-  if (built_map_.checkIsBuiltAndTag(particle_settings)) {
+  if (check_is_built_and_tag(particle_settings)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &particle_settings->id);
   /* Make sure we've got proper copied ID pointer. */
   add_id_node(&particle_settings->id);
   ParticleSettings *particle_settings_cow = get_cow_datablock(particle_settings);
@@ -1251,9 +1281,10 @@ void DepsgraphNodeBuilder::build_particle_settings(ParticleSettings *particle_se
 /* Shapekeys */
 void DepsgraphNodeBuilder::build_shapekeys(Key *key)
 {
-  if (built_map_.checkIsBuiltAndTag(key)) {
+  if (check_is_built_and_tag(key)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &key->id);
   build_idproperties(key->id.properties);
   build_animdata(&key->id);
   build_parameters(&key->id);
@@ -1302,9 +1333,10 @@ void DepsgraphNodeBuilder::build_object_data_geometry(Object *object, bool is_ob
 
 void DepsgraphNodeBuilder::build_object_data_geometry_datablock(ID *obdata, bool is_object_visible)
 {
-  if (built_map_.checkIsBuiltAndTag(obdata)) {
+  if (check_is_built_and_tag(obdata)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, obdata);
   OperationNode *op_node;
   /* Make sure we've got an ID node before requesting CoW pointer. */
   (void)add_id_node((ID *)obdata);
@@ -1412,9 +1444,10 @@ void DepsgraphNodeBuilder::build_object_data_geometry_datablock(ID *obdata, bool
 
 void DepsgraphNodeBuilder::build_armature(bArmature *armature)
 {
-  if (built_map_.checkIsBuiltAndTag(armature)) {
+  if (check_is_built_and_tag(armature)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &armature->id);
   build_idproperties(armature->id.properties);
   build_animdata(&armature->id);
   build_parameters(&armature->id);
@@ -1437,9 +1470,10 @@ void DepsgraphNodeBuilder::build_armature_bones(ListBase *bones)
 
 void DepsgraphNodeBuilder::build_camera(Camera *camera)
 {
-  if (built_map_.checkIsBuiltAndTag(camera)) {
+  if (check_is_built_and_tag(camera)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &camera->id);
   build_idproperties(camera->id.properties);
   build_animdata(&camera->id);
   build_parameters(&camera->id);
@@ -1450,9 +1484,10 @@ void DepsgraphNodeBuilder::build_camera(Camera *camera)
 
 void DepsgraphNodeBuilder::build_light(Light *lamp)
 {
-  if (built_map_.checkIsBuiltAndTag(lamp)) {
+  if (check_is_built_and_tag(lamp)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &lamp->id);
   build_idproperties(lamp->id.properties);
   build_animdata(&lamp->id);
   build_parameters(&lamp->id);
@@ -1471,9 +1506,10 @@ void DepsgraphNodeBuilder::build_nodetree(bNodeTree *ntree)
   if (ntree == nullptr) {
     return;
   }
-  if (built_map_.checkIsBuiltAndTag(ntree)) {
+  if (check_is_built_and_tag(ntree)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &ntree->id);
   /* nodetree itself */
   add_id_node(&ntree->id);
   bNodeTree *ntree_cow = get_cow_datablock(ntree);
@@ -1561,9 +1597,10 @@ void DepsgraphNodeBuilder::build_nodetree(bNodeTree *ntree)
 /* Recursively build graph for material */
 void DepsgraphNodeBuilder::build_material(Material *material)
 {
-  if (built_map_.checkIsBuiltAndTag(material)) {
+  if (check_is_built_and_tag(material)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &material->id);
   /* Material itself. */
   add_id_node(&material->id);
   Material *material_cow = get_cow_datablock(material);
@@ -1593,9 +1630,10 @@ void DepsgraphNodeBuilder::build_materials(Material **materials, int num_materia
 /* Recursively build graph for texture */
 void DepsgraphNodeBuilder::build_texture(Tex *texture)
 {
-  if (built_map_.checkIsBuiltAndTag(texture)) {
+  if (check_is_built_and_tag(texture)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &texture->id);
   /* Texture itself. */
   add_id_node(&texture->id);
   build_idproperties(texture->id.properties);
@@ -1615,9 +1653,10 @@ void DepsgraphNodeBuilder::build_texture(Tex *texture)
 
 void DepsgraphNodeBuilder::build_image(Image *image)
 {
-  if (built_map_.checkIsBuiltAndTag(image)) {
+  if (check_is_built_and_tag(image)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &image->id);
   build_parameters(&image->id);
   build_idproperties(image->id.properties);
   add_operation_node(
@@ -1626,9 +1665,10 @@ void DepsgraphNodeBuilder::build_image(Image *image)
 
 void DepsgraphNodeBuilder::build_gpencil(bGPdata *gpd)
 {
-  if (built_map_.checkIsBuiltAndTag(gpd)) {
+  if (check_is_built_and_tag(gpd)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &gpd->id);
   ID *gpd_id = &gpd->id;
 
   /* TODO(sergey): what about multiple users of same datablock? This should
@@ -1642,9 +1682,10 @@ void DepsgraphNodeBuilder::build_gpencil(bGPdata *gpd)
 
 void DepsgraphNodeBuilder::build_cachefile(CacheFile *cache_file)
 {
-  if (built_map_.checkIsBuiltAndTag(cache_file)) {
+  if (check_is_built_and_tag(cache_file)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &cache_file->id);
   ID *cache_file_id = &cache_file->id;
   add_id_node(cache_file_id);
   CacheFile *cache_file_cow = get_cow_datablock(cache_file);
@@ -1661,9 +1702,10 @@ void DepsgraphNodeBuilder::build_cachefile(CacheFile *cache_file)
 
 void DepsgraphNodeBuilder::build_mask(Mask *mask)
 {
-  if (built_map_.checkIsBuiltAndTag(mask)) {
+  if (check_is_built_and_tag(mask)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &mask->id);
   ID *mask_id = &mask->id;
   Mask *mask_cow = (Mask *)ensure_cow_id(mask_id);
   build_idproperties(mask->id.properties);
@@ -1697,9 +1739,10 @@ void DepsgraphNodeBuilder::build_mask(Mask *mask)
 
 void DepsgraphNodeBuilder::build_freestyle_linestyle(FreestyleLineStyle *linestyle)
 {
-  if (built_map_.checkIsBuiltAndTag(linestyle)) {
+  if (check_is_built_and_tag(linestyle)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &linestyle->id);
 
   ID *linestyle_id = &linestyle->id;
   build_parameters(linestyle_id);
@@ -1710,9 +1753,10 @@ void DepsgraphNodeBuilder::build_freestyle_linestyle(FreestyleLineStyle *linesty
 
 void DepsgraphNodeBuilder::build_movieclip(MovieClip *clip)
 {
-  if (built_map_.checkIsBuiltAndTag(clip)) {
+  if (check_is_built_and_tag(clip)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &clip->id);
   ID *clip_id = &clip->id;
   MovieClip *clip_cow = (MovieClip *)ensure_cow_id(clip_id);
   build_idproperties(clip_id->properties);
@@ -1733,9 +1777,10 @@ void DepsgraphNodeBuilder::build_movieclip(MovieClip *clip)
 
 void DepsgraphNodeBuilder::build_lightprobe(LightProbe *probe)
 {
-  if (built_map_.checkIsBuiltAndTag(probe)) {
+  if (check_is_built_and_tag(probe)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &probe->id);
   /* Placeholder so we can add relations and tag ID node for update. */
   add_operation_node(&probe->id, NodeType::PARAMETERS, OperationCode::LIGHT_PROBE_EVAL);
   build_idproperties(probe->id.properties);
@@ -1745,9 +1790,10 @@ void DepsgraphNodeBuilder::build_lightprobe(LightProbe *probe)
 
 void DepsgraphNodeBuilder::build_speaker(Speaker *speaker)
 {
-  if (built_map_.checkIsBuiltAndTag(speaker)) {
+  if (check_is_built_and_tag(speaker)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &speaker->id);
   /* Placeholder so we can add relations and tag ID node for update. */
   add_operation_node(&speaker->id, NodeType::AUDIO, OperationCode::SPEAKER_EVAL);
   build_idproperties(speaker->id.properties);
@@ -1760,9 +1806,10 @@ void DepsgraphNodeBuilder::build_speaker(Speaker *speaker)
 
 void DepsgraphNodeBuilder::build_sound(bSound *sound)
 {
-  if (built_map_.checkIsBuiltAndTag(sound)) {
+  if (check_is_built_and_tag(sound)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &sound->id);
   add_id_node(&sound->id);
   bSound *sound_cow = get_cow_datablock(sound);
   add_operation_node(&sound->id,
@@ -1776,9 +1823,10 @@ void DepsgraphNodeBuilder::build_sound(bSound *sound)
 
 void DepsgraphNodeBuilder::build_simulation(Simulation *simulation)
 {
-  if (built_map_.checkIsBuiltAndTag(simulation)) {
+  if (check_is_built_and_tag(simulation)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &simulation->id);
   add_id_node(&simulation->id);
   build_animdata(&simulation->id);
   build_parameters(&simulation->id);
@@ -1827,9 +1875,10 @@ void DepsgraphNodeBuilder::build_scene_sequencer(Scene *scene)
 
 void DepsgraphNodeBuilder::build_scene_audio(Scene *scene)
 {
-  if (built_map_.checkIsBuiltAndTag(scene, BuilderMap::TAG_SCENE_AUDIO)) {
+  if (check_is_built_and_tag(scene, BuilderMap::TAG_SCENE_AUDIO)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &scene->id);
 
   OperationNode *audio_entry_node = add_operation_node(
       &scene->id, NodeType::AUDIO, OperationCode::AUDIO_ENTRY);
@@ -257,6 +257,24 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   };
   Vector<SavedEntryTag> saved_entry_tags_;
 
+  /* Remember that the ID on behalf of which nodes are being built uses the given ID, the ID nodes
+   * get to know their users in end_build(), see IDNode::build_users. */
+  void add_build_user(ID *id);
+  /* Same as BuilderMap::checkIsBuiltAndTag(), but also remembers the ID as being used by the ID
+   * on behalf of which nodes are being built. */
+  bool check_is_built_and_tag(ID *id, int tag = BuilderMap::TAG_COMPLETE);
+  template<typename T>
+  bool check_is_built_and_tag(T *datablock, int tag = BuilderMap::TAG_COMPLETE)
+  {
+    return check_is_built_and_tag(&datablock->id, tag);
+  }
+
+  struct BuildUser {
+    ID *id;
+    ID *user;
+  };
+  Vector<BuildUser> build_users_;
+
   struct BuilderWalkUserData {
     DepsgraphNodeBuilder *builder;
     /* Denotes whether object the walk is invoked from is visible. */
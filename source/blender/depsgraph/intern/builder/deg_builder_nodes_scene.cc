@@ -30,6 +30,7 @@ namespace deg {
 
 void DepsgraphNodeBuilder::build_scene_render(Scene *scene, ViewLayer *view_layer)
 {
+  BuildOwnerScope owner_scope(this, &scene->id);
   scene_ = scene;
   view_layer_ = view_layer;
   const bool build_compositor = (scene->r.scemode & R_DOCOMP);
@@ -54,9 +55,10 @@ void DepsgraphNodeBuilder::build_scene_render(Scene *scene, ViewLayer *view_laye
 
 void DepsgraphNodeBuilder::build_scene_parameters(Scene *scene)
 {
-  if (built_map_.checkIsBuiltAndTag(scene, BuilderMap::TAG_PARAMETERS)) {
+  if (check_is_built_and_tag(scene, BuilderMap::TAG_PARAMETERS)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &scene->id);
   build_parameters(&scene->id);
   build_idproperties(scene->id.properties);
   add_operation_node(&scene->id, NodeType::PARAMETERS, OperationCode::SCENE_EVAL);
@@ -75,9 +77,10 @@ void DepsgraphNodeBuilder::build_scene_parameters(Scene *scene)
 
 void DepsgraphNodeBuilder::build_scene_compositor(Scene *scene)
 {
-  if (built_map_.checkIsBuiltAndTag(scene, BuilderMap::TAG_SCENE_COMPOSITOR)) {
+  if (check_is_built_and_tag(scene, BuilderMap::TAG_SCENE_COMPOSITOR)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &scene->id);
   if (scene->nodetree == nullptr) {
     return;
   }
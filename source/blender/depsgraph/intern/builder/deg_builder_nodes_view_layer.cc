@@ -88,6 +88,7 @@ void DepsgraphNodeBuilder::build_view_layer(Scene *scene,
                                             ViewLayer *view_layer,
                                             eDepsNode_LinkedState_Type linked_state)
 {
+  BuildOwnerScope owner_scope(this, &scene->id);
   /* NOTE: Pass view layer index of 0 since after scene CoW there is
    * only one view layer in there. */
   view_layer_index_ = 0;
@@ -171,6 +172,7 @@ void DepsgraphNodeBuilder::build_view_layer(Scene *scene,
   /* Build all set scenes. */
   if (scene->set != nullptr) {
     ViewLayer *set_view_layer = BKE_view_layer_default_render(scene->set);
+    add_build_user(&scene->set->id);
     build_view_layer(scene->set, set_view_layer, DEG_ID_LINKED_VIA_SET);
   }
 }
@@ -329,6 +329,7 @@ void DepsgraphRelationBuilder::add_customdata_mask(Object *object,
     }
     else {
       id_node->customdata_masks |= customdata_masks;
+      id_node->eval_requests.lookup_or_add_default(owner_id_).customdata_masks |= customdata_masks;
     }
   }
 }
@@ -341,6 +342,7 @@ void DepsgraphRelationBuilder::add_special_eval_flag(ID *id, uint32_t flag)
   }
   else {
     id_node->eval_flags |= flag;
+    id_node->eval_requests.lookup_or_add_default(owner_id_).eval_flags |= flag;
   }
 }
 
@@ -350,7 +352,7 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       int flags)
 {
   if (timesrc && node_to) {
-    return graph_->add_new_relation(timesrc, node_to, description, flags);
+    return add_new_relation(timesrc, node_to, description, flags);
   }
   else {
     DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -365,13 +367,30 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
   return nullptr;
 }
 
+Relation *DepsgraphRelationBuilder::add_new_relation(Node *node_from,
+                                                     Node *node_to,
+                                                     const char *description,
+                                                     int flags)
+{
+  const uint num_inlinks = node_to->inlinks.size();
+  Relation *rel = graph_->add_new_relation(node_from, node_to, description, flags);
+  if (node_to->inlinks.size() != num_inlinks) {
+    rel->build_owner = owner_id_;
+  }
+  else if (rel->build_owner != owner_id_) {
+    /* Existing relation is requested on behalf of another ID. */
+    rel->flag |= RELATION_FLAG_SHARED;
+  }
+  return rel;
+}
+
 Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_from,
                                                            OperationNode *node_to,
                                                            const char *description,
                                                            int flags)
 {
   if (node_from && node_to) {
-    return graph_->add_new_relation(node_from, node_to, description, flags);
+    return add_new_relation(node_from, node_to, description, flags);
   }
   else {
     DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -627,6 +646,7 @@ void DepsgraphRelationBuilder::build_object(Object *object)
   if (built_map_.checkIsBuiltAndTag(object)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &object->id);
   /* Object Transforms */
   OperationCode base_op = (object->parent) ? OperationCode::TRANSFORM_PARENT :
                                              OperationCode::TRANSFORM_LOCAL;
@@ -790,6 +810,7 @@ void DepsgraphRelationBuilder::build_object_data(Object *object)
   ID *obdata_id = (ID *)object->data;
   /* Object data animation. */
   if (!built_map_.checkIsBuilt(obdata_id)) {
+    BuildOwnerScope owner_scope(this, obdata_id);
     build_animdata(obdata_id);
   }
   /* type-specific data. */
@@ -1322,7 +1343,7 @@ void DepsgraphRelationBuilder::build_animdata_curves_targets(ID *id,
       add_relation(adt_key, pose_init_key, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
       continue;
     }
-    graph_->add_new_relation(
+    add_operation_relation(
         operation_from, operation_to, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
     /* It is possible that animation is writing to a nested ID data-block,
      * need to make sure animation is evaluated after target ID is copied. */
@@ -1398,6 +1419,7 @@ void DepsgraphRelationBuilder::build_action(bAction *action)
   if (built_map_.checkIsBuiltAndTag(action)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &action->id);
   build_idproperties(action->id.properties);
   if (!BLI_listbase_is_empty(&action->curves)) {
     TimeSourceKey time_src_key;
@@ -1647,6 +1669,7 @@ void DepsgraphRelationBuilder::build_world(World *world)
   if (built_map_.checkIsBuiltAndTag(world)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &world->id);
   build_idproperties(world->id.properties);
   /* animation */
   build_animdata(&world->id);
@@ -1868,6 +1891,7 @@ void DepsgraphRelationBuilder::build_particle_settings(ParticleSettings *part)
   if (built_map_.checkIsBuiltAndTag(part)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &part->id);
   /* Animation data relations. */
   build_animdata(&part->id);
   build_parameters(&part->id);
@@ -1927,6 +1951,7 @@ void DepsgraphRelationBuilder::build_shapekeys(Key *key)
   if (built_map_.checkIsBuiltAndTag(key)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &key->id);
   build_idproperties(key->id.properties);
   /* Attach animdata to geometry. */
   build_animdata(&key->id);
@@ -2107,6 +2132,7 @@ void DepsgraphRelationBuilder::build_object_data_geometry_datablock(ID *obdata)
   if (built_map_.checkIsBuiltAndTag(obdata)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, obdata);
   build_idproperties(obdata->properties);
   /* Animation. */
   build_animdata(obdata);
@@ -2220,6 +2246,7 @@ void DepsgraphRelationBuilder::build_armature(bArmature *armature)
   if (built_map_.checkIsBuiltAndTag(armature)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &armature->id);
   build_idproperties(armature->id.properties);
   build_animdata(&armature->id);
   build_parameters(&armature->id);
@@ -2239,6 +2266,7 @@ void DepsgraphRelationBuilder::build_camera(Camera *camera)
   if (built_map_.checkIsBuiltAndTag(camera)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &camera->id);
   build_idproperties(camera->id.properties);
   build_animdata(&camera->id);
   build_parameters(&camera->id);
@@ -2256,6 +2284,7 @@ void DepsgraphRelationBuilder::build_light(Light *lamp)
   if (built_map_.checkIsBuiltAndTag(lamp)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &lamp->id);
   build_idproperties(lamp->id.properties);
   build_animdata(&lamp->id);
   build_parameters(&lamp->id);
@@ -2283,6 +2312,7 @@ void DepsgraphRelationBuilder::build_nodetree(bNodeTree *ntree)
   if (built_map_.checkIsBuiltAndTag(ntree)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &ntree->id);
   build_idproperties(ntree->id.properties);
   build_animdata(&ntree->id);
   build_parameters(&ntree->id);
@@ -2387,6 +2417,7 @@ void DepsgraphRelationBuilder::build_material(Material *material)
   if (built_map_.checkIsBuiltAndTag(material)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &material->id);
   build_idproperties(material->id.properties);
   /* animation */
   build_animdata(&material->id);
@@ -2418,6 +2449,7 @@ void DepsgraphRelationBuilder::build_texture(Tex *texture)
   if (built_map_.checkIsBuiltAndTag(texture)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &texture->id);
   /* texture itself */
   ComponentKey texture_key(&texture->id, NodeType::GENERIC_DATABLOCK);
   build_idproperties(texture->id.properties);
@@ -2454,6 +2486,7 @@ void DepsgraphRelationBuilder::build_image(Image *image)
   if (built_map_.checkIsBuiltAndTag(image)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &image->id);
   build_idproperties(image->id.properties);
   build_parameters(&image->id);
 }
@@ -2463,6 +2496,7 @@ void DepsgraphRelationBuilder::build_gpencil(bGPdata *gpd)
   if (built_map_.checkIsBuiltAndTag(gpd)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &gpd->id);
   /* animation */
   build_animdata(&gpd->id);
   build_parameters(&gpd->id);
@@ -2475,6 +2509,7 @@ void DepsgraphRelationBuilder::build_cachefile(CacheFile *cache_file)
   if (built_map_.checkIsBuiltAndTag(cache_file)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &cache_file->id);
   build_idproperties(cache_file->id.properties);
   /* Animation. */
   build_animdata(&cache_file->id);
@@ -2504,6 +2539,7 @@ void DepsgraphRelationBuilder::build_mask(Mask *mask)
   if (built_map_.checkIsBuiltAndTag(mask)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &mask->id);
   ID *mask_id = &mask->id;
   build_idproperties(mask_id->properties);
   /* F-Curve animation. */
@@ -2541,6 +2577,7 @@ void DepsgraphRelationBuilder::build_freestyle_linestyle(FreestyleLineStyle *lin
   if (built_map_.checkIsBuiltAndTag(linestyle)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &linestyle->id);
 
   ID *linestyle_id = &linestyle->id;
   build_parameters(linestyle_id);
@@ -2554,6 +2591,7 @@ void DepsgraphRelationBuilder::build_movieclip(MovieClip *clip)
   if (built_map_.checkIsBuiltAndTag(clip)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &clip->id);
   /* Animation. */
   build_idproperties(clip->id.properties);
   build_animdata(&clip->id);
@@ -2565,6 +2603,7 @@ void DepsgraphRelationBuilder::build_lightprobe(LightProbe *probe)
   if (built_map_.checkIsBuiltAndTag(probe)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &probe->id);
   build_idproperties(probe->id.properties);
   build_animdata(&probe->id);
   build_parameters(&probe->id);
@@ -2575,6 +2614,7 @@ void DepsgraphRelationBuilder::build_speaker(Speaker *speaker)
   if (built_map_.checkIsBuiltAndTag(speaker)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &speaker->id);
   build_idproperties(speaker->id.properties);
   build_animdata(&speaker->id);
   build_parameters(&speaker->id);
@@ -2591,6 +2631,7 @@ void DepsgraphRelationBuilder::build_sound(bSound *sound)
   if (built_map_.checkIsBuiltAndTag(sound)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &sound->id);
   build_idproperties(sound->id.properties);
   build_animdata(&sound->id);
   build_parameters(&sound->id);
@@ -2601,6 +2642,7 @@ void DepsgraphRelationBuilder::build_simulation(Simulation *simulation)
   if (built_map_.checkIsBuiltAndTag(simulation)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &simulation->id);
   build_animdata(&simulation->id);
   build_parameters(&simulation->id);
 
@@ -2714,9 +2756,10 @@ void DepsgraphRelationBuilder::build_nested_shapekey(ID *owner, Key *key)
   build_nested_datablock(owner, &key->id);
 }
 
-void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
+void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node, int extra_flags)
 {
   ID *id_orig = id_node->id_orig;
+  BuildOwnerScope owner_scope(this, id_orig);
   const ID_Type id_type = GS(id_orig->name);
   TimeSourceKey time_source_key;
   OperationKey copy_on_write_key(id_orig, NodeType::COPY_ON_WRITE, OperationCode::COPY_ON_WRITE);
@@ -2736,7 +2779,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
       /* Component explicitly requests to not add relation. */
       continue;
     }
-    int rel_flag = (RELATION_FLAG_NO_FLUSH | RELATION_FLAG_GODMODE);
+    int rel_flag = (RELATION_FLAG_NO_FLUSH | RELATION_FLAG_GODMODE | extra_flags);
     if ((ELEM(id_type, ID_ME, ID_HA, ID_PT, ID_VO) && comp_node->type == NodeType::GEOMETRY) ||
         (id_type == ID_CF && comp_node->type == NodeType::CACHE)) {
       rel_flag &= ~RELATION_FLAG_NO_FLUSH;
@@ -2766,8 +2809,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
      * copy of ID. */
     OperationNode *op_entry = comp_node->get_entry_operation();
     if (op_entry != nullptr) {
-      Relation *rel = graph_->add_new_relation(op_cow, op_entry, "CoW Dependency");
-      rel->flag |= rel_flag;
+      add_operation_relation(op_cow, op_entry, "CoW Dependency", rel_flag);
     }
     /* All dangling operations should also be executed after copy-on-write. */
     for (OperationNode *op_node : comp_node->operations_map->values()) {
@@ -2775,8 +2817,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
         continue;
       }
       if (op_node->inlinks.is_empty()) {
-        Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
-        rel->flag |= rel_flag;
+        add_operation_relation(op_cow, op_node, "CoW Dependency", rel_flag);
       }
       else {
         bool has_same_comp_dependency = false;
@@ -2791,8 +2832,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
           }
         }
         if (!has_same_comp_dependency) {
-          Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
-          rel->flag |= rel_flag;
+          add_operation_relation(op_cow, op_node, "CoW Dependency", rel_flag);
         }
       }
     }
@@ -2813,8 +2853,10 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
       if (deg_copy_on_write_is_needed(object_data_id)) {
         OperationKey data_copy_on_write_key(
             object_data_id, NodeType::COPY_ON_WRITE, OperationCode::COPY_ON_WRITE);
-        add_relation(
-            data_copy_on_write_key, copy_on_write_key, "Eval Order", RELATION_FLAG_GODMODE);
+        add_relation(data_copy_on_write_key,
+                     copy_on_write_key,
+                     "Eval Order",
+                     RELATION_FLAG_GODMODE | extra_flags);
       }
     }
     else {
@@ -2898,6 +2940,7 @@ void DepsgraphRelationBuilder::build_driver_relations(IDNode *id_node)
   if (adt == nullptr) {
     return;
   }
+  BuildOwnerScope owner_scope(this, id_orig);
 
   // Mapping from RNA prefix -> set of driver evaluation nodes:
   Map<string, Vector<Node *>> driver_groups;
@@ -309,7 +309,8 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
                                          const char *name);
 
   virtual void build_copy_on_write_relations();
-  virtual void build_copy_on_write_relations(IDNode *id_node);
+  /* Extra flags are added to all the created relations. */
+  virtual void build_copy_on_write_relations(IDNode *id_node, int extra_flags = 0);
   virtual void build_driver_relations();
   virtual void build_driver_relations(IDNode *id_node);
 
@@ -326,6 +327,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   OperationNode *find_node(const OperationKey &key) const;
   bool has_node(const OperationKey &key) const;
 
+  /* Add relation to the graph on behalf of the ID which is currently being built. */
+  Relation *add_new_relation(Node *node_from,
+                             Node *node_to,
+                             const char *description,
+                             int flags = 0);
   Relation *add_time_relation(TimeSourceNode *timesrc,
                               Node *node_to,
                               const char *description,
@@ -365,10 +371,13 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   static void constraint_walk(bConstraint *con, ID **idpoin, bool is_reference, void *user_data);
 
+ protected:
   /* State which demotes currently built entities. */
   Scene *scene_;
 
   BuilderMap built_map_;
+
+ private:
   RNANodeQuery rna_node_query_;
 };
 
@@ -30,6 +30,7 @@ namespace deg {
 
 void DepsgraphRelationBuilder::build_scene_render(Scene *scene, ViewLayer *view_layer)
 {
+  BuildOwnerScope owner_scope(this, &scene->id);
   scene_ = scene;
   const bool build_compositor = (scene->r.scemode & R_DOCOMP);
   const bool build_sequencer = (scene->r.scemode & R_DOSEQ);
@@ -53,6 +54,7 @@ void DepsgraphRelationBuilder::build_scene_parameters(Scene *scene)
   if (built_map_.checkIsBuiltAndTag(scene, BuilderMap::TAG_PARAMETERS)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &scene->id);
   build_idproperties(scene->id.properties);
   build_parameters(&scene->id);
   OperationKey parameters_eval_key(
@@ -66,6 +68,7 @@ void DepsgraphRelationBuilder::build_scene_compositor(Scene *scene)
   if (built_map_.checkIsBuiltAndTag(scene, BuilderMap::TAG_SCENE_COMPOSITOR)) {
     return;
   }
+  BuildOwnerScope owner_scope(this, &scene->id);
   if (scene->nodetree == nullptr) {
     return;
   }
@@ -89,6 +89,7 @@ void DepsgraphRelationBuilder::build_view_layer(Scene *scene,
                                                 ViewLayer *view_layer,
                                                 eDepsNode_LinkedState_Type linked_state)
 {
+  BuildOwnerScope owner_scope(this, &scene->id);
   /* Setup currently building context. */
   scene_ = scene;
   /* Scene objects. */
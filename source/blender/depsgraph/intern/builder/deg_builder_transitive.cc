@@ -107,6 +107,9 @@ void deg_graph_transitive_reduction(Depsgraph *graph)
     num_removed_relations += relations_to_remove.size();
     relations_to_remove.clear();
   }
+  if (num_removed_relations != 0) {
+    graph->has_reduced_relations = true;
+  }
   DEG_DEBUG_PRINTF((::Depsgraph *)graph, BUILD, "Removed %d relations\n", num_removed_relations);
 }
 
@@ -0,0 +1,206 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Writes the evaluation of dependency graphs in the Chrome trace event format, which can be
+ * viewed with `chrome://tracing` or other compatible tools. Every evaluated operation is an
+ * event with its thread, start time and duration, the owning ID and component are stored as the
+ * arguments of the event.
+ *
+ * Events are appended to the file after every graph evaluation. The array format of traces allows
+ * the closing bracket to be missing, so the trace stays readable if Blender exits without ending
+ * it.
+ */
+
+#include "intern/debug/deg_debug_trace.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+#include "PIL_time.h"
+
+#include "BLI_fileops.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#include "DNA_ID.h"
+
+#include "DEG_depsgraph_debug.h"
+
+#include "intern/depsgraph.h"
+#include "intern/node/deg_node.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace deg = blender::deg;
+
+namespace blender {
+namespace deg {
+namespace {
+
+struct TraceState {
+  FILE *file = nullptr;
+  /* Time at which the trace was started, timestamps of events are relative to it. */
+  double start_time = 0.0;
+  /* Whether an event has been written already, to separate events with commas. */
+  bool has_events = false;
+  /* Graphs are evaluated from multiple threads (e.g. viewport and render). */
+  ThreadMutex mutex = BLI_MUTEX_INITIALIZER;
+};
+
+TraceState trace_state;
+
+std::atomic<int> num_trace_threads(0);
+
+string json_escape(const char *str)
+{
+  string result;
+  for (const char *c = str; *c != '\0'; c++) {
+    switch (*c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        /* Other control characters are not expected in names, skip them. */
+        if ((unsigned char)*c >= 0x20) {
+          result += *c;
+        }
+        break;
+    }
+  }
+  return result;
+}
+
+/* Timestamps are in microseconds. */
+double trace_timestamp(double time)
+{
+  return (time - trace_state.start_time) * 1e6;
+}
+
+void trace_event_begin()
+{
+  fputs(trace_state.has_events ? ",\n" : "\n", trace_state.file);
+  trace_state.has_events = true;
+}
+
+void trace_write_operation(const Depsgraph *graph, const OperationNode *op_node)
+{
+  const ComponentNode *comp_node = op_node->owner;
+  const IDNode *id_node = comp_node->owner;
+  trace_event_begin();
+  fprintf(trace_state.file,
+          "{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+          "\"pid\": 0, \"tid\": %d, \"args\": {\"id\": \"%s\", \"component\": \"%s\", "
+          "\"frame\": %f}}",
+          json_escape(op_node->identifier().c_str()).c_str(),
+          nodeTypeAsString(comp_node->type),
+          trace_timestamp(op_node->stats.current_start_time),
+          op_node->stats.current_time * 1e6,
+          op_node->stats.current_thread_id,
+          json_escape(id_node->id_orig->name).c_str(),
+          json_escape(comp_node->name.c_str()).c_str(),
+          graph->ctime);
+}
+
+}  // namespace
+
+bool deg_debug_trace_is_enabled()
+{
+  return trace_state.file != nullptr;
+}
+
+int deg_debug_trace_thread_id_get()
+{
+  static thread_local int thread_id = -1;
+  if (thread_id == -1) {
+    thread_id = num_trace_threads++;
+  }
+  return thread_id;
+}
+
+void deg_debug_trace_graph_evaluation(const Depsgraph *graph, double start_time, double end_time)
+{
+  BLI_mutex_lock(&trace_state.mutex);
+  if (trace_state.file == nullptr) {
+    BLI_mutex_unlock(&trace_state.mutex);
+    return;
+  }
+  /* Evaluation of the whole graph, operations are nested in it in the viewer. */
+  trace_event_begin();
+  fprintf(trace_state.file,
+          "{\"name\": \"Depsgraph evaluation\", \"cat\": \"depsgraph\", \"ph\": \"X\", "
+          "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 0, \"tid\": %d, \"args\": {\"depsgraph\": "
+          "\"%s\", \"frame\": %f}}",
+          trace_timestamp(start_time),
+          (end_time - start_time) * 1e6,
+          deg_debug_trace_thread_id_get(),
+          json_escape(graph->debug.name.c_str()).c_str(),
+          graph->ctime);
+  for (const OperationNode *op_node : graph->operations) {
+    if (op_node->scheduled && !op_node->is_noop()) {
+      trace_write_operation(graph, op_node);
+    }
+  }
+  fflush(trace_state.file);
+  BLI_mutex_unlock(&trace_state.mutex);
+}
+
+}  // namespace deg
+}  // namespace blender
+
+bool DEG_debug_trace_begin(const char *filepath)
+{
+  DEG_debug_trace_end();
+
+  FILE *file = BLI_fopen(filepath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+  BLI_mutex_lock(&deg::trace_state.mutex);
+  deg::trace_state.file = file;
+  deg::trace_state.start_time = PIL_check_seconds_timer();
+  deg::trace_state.has_events = false;
+  fputs("[", file);
+  BLI_mutex_unlock(&deg::trace_state.mutex);
+  return true;
+}
+
+void DEG_debug_trace_end(void)
+{
+  BLI_mutex_lock(&deg::trace_state.mutex);
+  if (deg::trace_state.file != nullptr) {
+    fputs("\n]\n", deg::trace_state.file);
+    fclose(deg::trace_state.file);
+    deg::trace_state.file = nullptr;
+  }
+  BLI_mutex_unlock(&deg::trace_state.mutex);
+}
@@ -0,0 +1,44 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Trace of dependency graph evaluation, see #DEG_debug_trace_begin.
+ */
+
+#pragma once
+
+namespace blender {
+namespace deg {
+
+struct Depsgraph;
+
+/* Is true when evaluation is being traced, the evaluation engine is to store thread and start
+ * time of every evaluated operation. */
+bool deg_debug_trace_is_enabled();
+
+/* Index of the current thread, stable for the lifetime of the thread. */
+int deg_debug_trace_thread_id_get();
+
+/* Write all operations evaluated during the last evaluation of the graph to the trace. */
+void deg_debug_trace_graph_evaluation(const Depsgraph *graph, double start_time, double end_time);
+
+}  // namespace deg
+}  // namespace blender
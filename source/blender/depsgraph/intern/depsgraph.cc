@@ -63,7 +63,9 @@ namespace deg {
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      has_reduced_relations(false),
       need_update_time(false),
+      need_update_priorities(true),
       bmain(bmain),
       scene(scene),
       view_layer(view_layer),
@@ -229,6 +231,7 @@ void Depsgraph::clear_all_nodes()
   clear_id_nodes();
   delete time_source;
   time_source = nullptr;
+  has_reduced_relations = false;
 }
 
 ID *Depsgraph::get_cow_id(const ID *id_orig) const
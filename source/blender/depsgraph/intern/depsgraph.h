@@ -110,6 +110,15 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* IDs tagged with DEG_graph_id_tag_relations_update(). When relations need update only because
+   * of those tags, only nodes and relations of those IDs are rebuilt. When the set is empty and
+   * need_update is set the whole graph is rebuilt. */
+  Set<ID *> relations_update_ids;
+
+  /* Transitive reduction removed relations without keeping track of the IDs which need them, so
+   * relations of individual IDs can not be rebuilt until the whole graph is rebuilt. */
+  bool has_reduced_relations;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
 
@@ -125,6 +134,10 @@ struct Depsgraph {
    * scene frame changes, so then when dependency graph becomes visible it is on a proper state. */
   bool need_update_time;
 
+  /* Indicates whether operation costs changed enough since priorities were calculated to
+   * affect the scheduling order, see #deg_eval_priorities_calculate. */
+  bool need_update_priorities;
+
   /* Convenience Data ................... */
 
   /* XXX: should be collected after building (if actually needed?) */
@@ -46,6 +46,7 @@
 #include "builder/deg_builder.h"
 #include "builder/deg_builder_cache.h"
 #include "builder/deg_builder_cycle.h"
+#include "builder/deg_builder_incremental.h"
 #include "builder/deg_builder_nodes.h"
 #include "builder/deg_builder_relations.h"
 #include "builder/deg_builder_transitive.h"
@@ -233,6 +234,7 @@ static void graph_build_finalize_common(deg::Depsgraph *deg_graph, Main *bmain)
 #endif
   /* Relations are up to date. */
   deg_graph->need_update = false;
+  deg_graph->relations_update_ids.clear();
 }
 
 /* Build depsgraph for the given scene layer, and dump results in given graph container. */
@@ -488,6 +490,8 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
   deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
   deg_graph->need_update = true;
+  /* Full rebuild supersedes any pending partial one. */
+  deg_graph->relations_update_ids.clear();
   /* NOTE: When relations are updated, it's quite possible that
    * we've got new bases in the scene. This means, we need to
    * re-create flat array of bases in view layer.
@@ -500,6 +504,25 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   }
 }
 
+/* Tag relations of a single ID for update. */
+void DEG_graph_id_tag_relations_update(Depsgraph *graph, ID *id)
+{
+  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  if (!deg_graph->need_update) {
+    deg_graph->need_update = true;
+    deg_graph->relations_update_ids.add(id);
+  }
+  else if (!deg_graph->relations_update_ids.is_empty()) {
+    deg_graph->relations_update_ids.add(id);
+  }
+  /* Otherwise the whole graph is already scheduled to be rebuilt. */
+  deg::IDNode *id_node = deg_graph->find_id_node(id);
+  if (id_node != nullptr) {
+    id_node->tag_update(deg_graph, deg::DEG_UPDATE_SOURCE_RELATIONS);
+  }
+}
+
 /* Create or update relations in the specified graph. */
 void DEG_graph_relations_update(Depsgraph *graph, Main *bmain, Scene *scene, ViewLayer *view_layer)
 {
@@ -508,6 +531,22 @@ void DEG_graph_relations_update(Depsgraph *graph, Main *bmain, Scene *scene, Vie
     /* Graph is up to date, nothing to do. */
     return;
   }
+  if (!deg_graph->relations_update_ids.is_empty() && !deg_graph->is_render_pipeline_depsgraph) {
+    BLI_assert(deg_graph->scene == scene);
+    BLI_assert(deg_graph->view_layer == view_layer);
+    double start_time = 0.0;
+    if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+      start_time = PIL_check_seconds_timer();
+    }
+    if (deg::deg_graph_build_incremental(bmain, deg_graph)) {
+      graph_build_finalize_common(deg_graph, bmain);
+      if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+        printf("Depsgraph updated incrementally in %f seconds.\n",
+               PIL_check_seconds_timer() - start_time);
+      }
+      return;
+    }
+  }
   DEG_graph_build_from_view_layer(graph, bmain, scene, view_layer);
 }
 
@@ -519,3 +558,12 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+/* Tag relations of a single ID for update in all graphs. */
+void DEG_id_tag_relations_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    DEG_graph_id_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph), id);
+  }
+}
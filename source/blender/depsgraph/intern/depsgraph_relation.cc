@@ -32,7 +32,7 @@ namespace blender {
 namespace deg {
 
 Relation::Relation(Node *from, Node *to, const char *description)
-    : from(from), to(to), name(description), flag(0)
+    : from(from), to(to), name(description), flag(0), build_owner(nullptr)
 {
   /* Hook it up to the nodes which use it.
    *
@@ -25,6 +25,8 @@
 
 #include "MEM_guardedalloc.h"
 
+struct ID;
+
 namespace blender {
 namespace deg {
 
@@ -45,6 +47,9 @@ enum RelationFlag {
   RELATION_FLAG_GODMODE = (1 << 4),
   /* Relation will check existence before being added. */
   RELATION_CHECK_BEFORE_ADD = (1 << 5),
+  /* Relation was requested by the builders of more than one ID, so it can not be rebuilt for any
+   * of them alone. */
+  RELATION_FLAG_SHARED = (1 << 6),
 };
 
 /* B depends on A (A -> B) */
@@ -62,6 +67,9 @@ struct Relation {
   const char *name; /* label for debugging */
   int flag;         /* Bitmask of RelationFlag) */
 
+  /* ID on behalf of which the relation builder created this relation. */
+  ID *build_owner;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("Relation");
 };
 
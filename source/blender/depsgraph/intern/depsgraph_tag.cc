@@ -274,6 +274,28 @@ void depsgraph_id_tag_copy_on_write(Depsgraph *graph, IDNode *id_node, eUpdateSo
   cow_comp->tag_update(graph, update_source);
 }
 
+/* Tag copy-on-write on behalf of the given component. As long as all the copy-on-write tags of
+ * the ID are coming from components, only data of those components is re-synced into the
+ * evaluated copy. */
+void depsgraph_id_tag_copy_on_write_for_component(Depsgraph *graph,
+                                                  IDNode *id_node,
+                                                  NodeType component_type,
+                                                  eUpdateSource update_source)
+{
+  ComponentNode *cow_comp = id_node->find_component(NodeType::COPY_ON_WRITE);
+  OperationNode *cow_op = cow_comp->get_entry_operation();
+  const bool was_cow_tagged = (cow_op->flag & DEPSOP_FLAG_NEEDS_UPDATE) != 0;
+  const IDComponentsMask cow_components_mask = id_node->cow_update_components_mask;
+  cow_comp->tag_update(graph, update_source);
+  if (was_cow_tagged && cow_components_mask == 0) {
+    /* Copy of the whole datablock is already requested. */
+    return;
+  }
+  const int component_type_as_int = static_cast<int>(component_type);
+  BLI_assert(component_type_as_int < 64);
+  id_node->cow_update_components_mask = cow_components_mask | (1ULL << component_type_as_int);
+}
+
 void depsgraph_tag_component(Depsgraph *graph,
                              IDNode *id_node,
                              NodeType component_type,
@@ -301,7 +323,7 @@ void depsgraph_tag_component(Depsgraph *graph,
   }
   /* If component depends on copy-on-write, tag it as well. */
   if (component_node->need_tag_cow_before_update()) {
-    depsgraph_id_tag_copy_on_write(graph, id_node, update_source);
+    depsgraph_id_tag_copy_on_write_for_component(graph, id_node, component_type, update_source);
   }
 }
 
@@ -29,7 +29,9 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
 #include "BKE_global.h"
@@ -44,9 +46,11 @@
 #include "atomic_ops.h"
 
 #include "intern/depsgraph.h"
+#include "intern/debug/deg_debug_trace.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/eval/deg_eval_flush.h"
+#include "intern/eval/deg_eval_priority.h"
 #include "intern/eval/deg_eval_stats.h"
 #include "intern/node/deg_node.h"
 #include "intern/node/deg_node_component.h"
@@ -69,10 +73,7 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, NULL);
-}
+void schedule_node_to_pool(OperationNode *node, const int thread_id, TaskPool *pool);
 
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
@@ -94,8 +95,14 @@ enum class EvaluationStage {
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
+  bool do_trace;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Operations which are ready to be evaluated, ordered by their priority.
+   * Tasks pushed to the pool evaluate the first operation from this queue, so the longest
+   * chains of operations start as early as possible. */
+  Heap *ready_operations;
+  SpinLock ready_operations_lock;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
@@ -104,24 +111,39 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
 
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
-  if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
-  }
-  else {
-    operation_node->evaluate(depsgraph);
+  /* Perform operation. Timing is always measured, it's used to estimate the cost of the
+   * operation for scheduling. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+  if (state->do_trace) {
+    operation_node->stats.current_start_time = start_time;
+    operation_node->stats.current_thread_id = deg_debug_trace_thread_id_get();
   }
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  /* Heap gives smallest value first. */
+  BLI_spin_lock(&state->ready_operations_lock);
+  BLI_heap_insert(state->ready_operations, -node->priority, node);
+  BLI_spin_unlock(&state->ready_operations_lock);
+  /* The task evaluates the operation with the highest priority once it runs, which is not
+   * necessarily this one. Every task pops exactly one operation from the queue. */
+  BLI_task_pool_push(pool, deg_task_run_func, NULL, false, NULL);
+}
+
+void deg_task_run_func(TaskPool *pool, void *UNUSED(taskdata))
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
+  BLI_spin_lock(&state->ready_operations_lock);
+  OperationNode *operation_node = (OperationNode *)BLI_heap_pop_min(state->ready_operations);
+  BLI_spin_unlock(&state->ready_operations_lock);
+
   /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
   evaluate_node(state, operation_node);
 
   /* Schedule children. */
@@ -178,15 +200,15 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
-void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
+void initialize_execution(DepsgraphEvalState * /*state*/, Depsgraph *graph)
 {
-  const bool do_stats = state->do_stats;
+  if (graph->need_update_priorities) {
+    deg_eval_priorities_calculate(graph);
+  }
   calculate_pending_parents(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
-    if (do_stats) {
-      node->stats.reset_current();
-    }
+    node->stats.reset_current();
   }
 }
 
@@ -373,6 +395,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   }
 
   graph->debug.begin_graph_evaluation();
+  const double start_time = PIL_check_seconds_timer();
 
   graph->is_evaluating = true;
   depsgraph_ensure_view_layer(graph);
@@ -380,7 +403,10 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   DepsgraphEvalState state;
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
+  state.do_trace = deg_debug_trace_is_enabled();
   state.need_single_thread_pass = false;
+  state.ready_operations = BLI_heap_new();
+  BLI_spin_init(&state.ready_operations_lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
@@ -404,12 +430,20 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
     evaluate_graph_single_threaded(&state);
   }
 
+  BLI_assert(BLI_heap_is_empty(state.ready_operations));
+  BLI_heap_free(state.ready_operations, NULL);
+  BLI_spin_end(&state.ready_operations_lock);
+
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
+  deg_eval_stats_update_costs(graph);
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
   }
+  if (state.do_trace) {
+    deg_debug_trace_graph_evaluation(graph, start_time, PIL_check_seconds_timer());
+  }
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
   graph->is_evaluating = false;
@@ -36,6 +36,9 @@
 #include <cstring>
 
 #include "BLI_listbase.h"
+#include "BLI_math_matrix.h"
+#include "BLI_math_rotation.h"
+#include "BLI_math_vector.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
@@ -58,6 +61,7 @@
 #include "DNA_armature_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_modifier_types.h"
+#include "DNA_object_force_types.h"
 #include "DNA_object_types.h"
 #include "DNA_particle_types.h"
 #include "DNA_rigidbody_types.h"
@@ -85,6 +89,7 @@
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
 #include "BKE_armature.h"
+#include "BKE_constraint.h"
 #include "BKE_editmesh.h"
 #include "BKE_lib_query.h"
 #include "BKE_modifier.h"
@@ -938,6 +943,175 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
   return deg_expand_copy_on_write_datablock(depsgraph, id_node, node_builder, create_placeholders);
 }
 
+namespace {
+
+/* Synchronize data which belongs to a component from the original datablock into its already
+ * expanded copy-on-write version, without re-allocating anything else.
+ * Returns false when the change can not be applied in-place, in which case the whole
+ * datablock is to be copied. */
+typedef bool (*ComponentSyncFunc)(const Depsgraph *depsgraph, const ID *id_orig, ID *id_cow);
+
+bool component_sync_nothing(const Depsgraph * /*depsgraph*/,
+                            const ID * /*id_orig*/,
+                            ID * /*id_cow*/)
+{
+  return true;
+}
+
+void constraint_remap_id_to_cow_cb(bConstraint * /*con*/,
+                                   ID **id_p,
+                                   bool /*is_reference*/,
+                                   void *user_data)
+{
+  if (*id_p == nullptr || !deg_copy_on_write_is_needed(*id_p)) {
+    return;
+  }
+  const Depsgraph *depsgraph = (const Depsgraph *)user_data;
+  *id_p = depsgraph->get_cow_id(*id_p);
+}
+
+/* Find the copy-on-write version of an ID referenced by the original datablock.
+ * Returns false when the ID has no copy-on-write version in the graph yet, in which case the
+ * pointer can not be remapped in-place. */
+bool id_pointer_get_cow(const Depsgraph *depsgraph, ID *id_orig, ID **r_id_cow)
+{
+  if (id_orig == nullptr || !deg_copy_on_write_is_needed(id_orig)) {
+    *r_id_cow = id_orig;
+    return true;
+  }
+  const IDNode *id_node = depsgraph->find_id_node(id_orig);
+  if (id_node == nullptr) {
+    return false;
+  }
+  *r_id_cow = id_node->id_cow;
+  return true;
+}
+
+/* Transform of an object is tagged for changes in transform channels, parenting settings,
+ * instancing settings, constraints and force field settings. */
+bool object_transform_sync(const Depsgraph *depsgraph, const ID *id_orig, ID *id_cow)
+{
+  const Object *object_orig = (const Object *)id_orig;
+  Object *object_cow = (Object *)id_cow;
+  /* Force field settings can only be synced when they were neither added nor removed. */
+  if ((object_orig->pd == nullptr) != (object_cow->pd == nullptr)) {
+    return false;
+  }
+  /* Parenting and instancing are tagged as transform changes as well. Resolve all ID pointers
+   * before changing anything, so nothing is left half synced when falling back to a copy. */
+  ID *parent_cow, *track_cow, *instance_collection_cow;
+  ID *pd_tex_cow = nullptr, *pd_f_source_cow = nullptr;
+  if (!id_pointer_get_cow(depsgraph, (ID *)object_orig->parent, &parent_cow) ||
+      !id_pointer_get_cow(depsgraph, (ID *)object_orig->track, &track_cow) ||
+      !id_pointer_get_cow(
+          depsgraph, (ID *)object_orig->instance_collection, &instance_collection_cow)) {
+    return false;
+  }
+  if (object_orig->pd != nullptr) {
+    if (!id_pointer_get_cow(depsgraph, (ID *)object_orig->pd->tex, &pd_tex_cow) ||
+        !id_pointer_get_cow(depsgraph, (ID *)object_orig->pd->f_source, &pd_f_source_cow)) {
+      return false;
+    }
+  }
+  object_cow->parent = (Object *)parent_cow;
+  object_cow->track = (Object *)track_cow;
+  object_cow->instance_collection = (struct Collection *)instance_collection_cow;
+  copy_v3_v3(object_cow->loc, object_orig->loc);
+  copy_v3_v3(object_cow->dloc, object_orig->dloc);
+  copy_v3_v3(object_cow->scale, object_orig->scale);
+  copy_v3_v3(object_cow->dscale, object_orig->dscale);
+  copy_v3_v3(object_cow->rot, object_orig->rot);
+  copy_v3_v3(object_cow->drot, object_orig->drot);
+  copy_qt_qt(object_cow->quat, object_orig->quat);
+  copy_qt_qt(object_cow->dquat, object_orig->dquat);
+  copy_v3_v3(object_cow->rotAxis, object_orig->rotAxis);
+  copy_v3_v3(object_cow->drotAxis, object_orig->drotAxis);
+  object_cow->rotAngle = object_orig->rotAngle;
+  object_cow->drotAngle = object_orig->drotAngle;
+  object_cow->rotmode = object_orig->rotmode;
+  object_cow->protectflag = object_orig->protectflag;
+  object_cow->trackflag = object_orig->trackflag;
+  object_cow->upflag = object_orig->upflag;
+  object_cow->partype = object_orig->partype;
+  object_cow->par1 = object_orig->par1;
+  object_cow->par2 = object_orig->par2;
+  object_cow->par3 = object_orig->par3;
+  STRNCPY(object_cow->parsubstr, object_orig->parsubstr);
+  copy_m4_m4(object_cow->parentinv, object_orig->parentinv);
+  object_cow->transflag = object_orig->transflag;
+  object_cow->dt = object_orig->dt;
+  object_cow->instance_faces_scale = object_orig->instance_faces_scale;
+  if (object_orig->pd != nullptr) {
+    /* Random number generator is a runtime state of the evaluated object. */
+    struct RNG *rng = object_cow->pd->rng;
+    *object_cow->pd = *object_orig->pd;
+    object_cow->pd->rng = rng;
+    object_cow->pd->tex = (struct Tex *)pd_tex_cow;
+    object_cow->pd->f_source = (Object *)pd_f_source_cow;
+  }
+  /* Constraints are copied as a whole, there are no runtime data which is to be preserved. */
+  BKE_constraints_free_ex(&object_cow->constraints, false);
+  BKE_constraints_copy_ex(
+      &object_cow->constraints, &object_orig->constraints, LIB_ID_COPY_LOCALIZE, false);
+  BKE_constraints_id_loop(
+      &object_cow->constraints, constraint_remap_id_to_cow_cb, (void *)depsgraph);
+  return true;
+}
+
+ComponentSyncFunc component_sync_func_get(const ID_Type id_type, const NodeType component_type)
+{
+  switch (component_type) {
+    case NodeType::POINT_CACHE:
+      /* Point cache is tagged to be reset, no settings are changing in the original. */
+      return component_sync_nothing;
+    case NodeType::TRANSFORM:
+      if (id_type == ID_OB) {
+        return object_transform_sync;
+      }
+      break;
+    default:
+      break;
+  }
+  return nullptr;
+}
+
+/* Re-sync data of all components which requested copy-on-write, without freeing the copy.
+ * Returns false if any of the components does not support this, and a full copy is needed. */
+bool deg_sync_copy_on_write_components(const Depsgraph *depsgraph, const IDNode *id_node)
+{
+  IDComponentsMask components_mask = id_node->cow_update_components_mask;
+  if (components_mask == 0 || !deg_copy_on_write_is_expanded(id_node->id_cow)) {
+    return false;
+  }
+  ComponentSyncFunc sync_funcs[64];
+  int num_sync_funcs = 0;
+  for (int component_type_as_int = 0; components_mask != 0; component_type_as_int++) {
+    const IDComponentsMask component_bit = (1ULL << component_type_as_int);
+    if ((components_mask & component_bit) == 0) {
+      continue;
+    }
+    components_mask &= ~component_bit;
+    ComponentSyncFunc sync_func = component_sync_func_get(
+        id_node->id_type, static_cast<NodeType>(component_type_as_int));
+    if (sync_func == nullptr) {
+      return false;
+    }
+    sync_funcs[num_sync_funcs++] = sync_func;
+  }
+  for (int i = 0; i < num_sync_funcs; i++) {
+    if (!sync_funcs[i](depsgraph, id_node->id_orig, id_node->id_cow)) {
+      return false;
+    }
+  }
+  DEG_COW_PRINT("Synced components of %s: id_orig=%p id_cow=%p\n",
+                id_node->id_orig->name,
+                id_node->id_orig,
+                id_node->id_cow);
+  return true;
+}
+
+}  // namespace
+
 ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode *id_node)
 {
   const ID *id_orig = id_node->id_orig;
@@ -946,6 +1120,11 @@ ID *deg_update_copy_on_write_datablock(const Depsgraph *depsgraph, const IDNode
   if (!deg_copy_on_write_is_needed(id_orig)) {
     return id_cow;
   }
+  /* When only some components requested the update there is no need to go through the runtime
+   * backup and re-allocation of the whole datablock. */
+  if (deg_sync_copy_on_write_components(depsgraph, id_node)) {
+    return id_cow;
+  }
   RuntimeBackup backup(depsgraph);
   backup.init_from_id(id_cow);
   deg_free_copy_on_write_datablock(id_cow);
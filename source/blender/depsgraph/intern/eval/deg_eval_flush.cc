@@ -192,6 +192,11 @@ inline OperationNode *flush_schedule_children(OperationNode *op_node, FlushQueue
     /* Always flush flushable flags, so children always know what happened
      * to their parents. */
     to_node->flag |= (op_node->flag & DEPSOP_FLAG_FLUSH);
+    /* Copy-on-write caused by changes in another datablock can not be limited to the components
+     * which were tagged directly. */
+    if (to_node->owner->type == NodeType::COPY_ON_WRITE) {
+      to_node->owner->owner->cow_update_components_mask = 0;
+    }
     /* Flush update over the relation, if it was not flushed yet. */
     if (to_node->scheduled) {
       continue;
@@ -411,6 +416,10 @@ void deg_graph_clear_tags(Depsgraph *graph)
   }
   /* Clear any entry tags which haven't been flushed. */
   graph->entry_tags.clear();
+  /* Clear copy-on-write requests of components. */
+  for (IDNode *id_node : graph->id_nodes) {
+    id_node->cow_update_components_mask = 0;
+  }
 }
 
 }  // namespace deg
@@ -0,0 +1,103 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/eval/deg_eval_priority.h"
+
+#include "BLI_math_base.h"
+#include "BLI_stack.h"
+#include "BLI_utildefines.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender {
+namespace deg {
+
+namespace {
+
+/* Cost of operations which were never evaluated yet. Treating all of them equally makes the
+ * longest chains of operations go first until actual timing is known. */
+const float DEG_OPERATION_DEFAULT_COST = 1e-5f;
+
+float operation_cost_get(const OperationNode *op_node)
+{
+  if (op_node->is_noop()) {
+    return 0.0f;
+  }
+  return (op_node->cost != 0.0f) ? op_node->cost : DEG_OPERATION_DEFAULT_COST;
+}
+
+}  // namespace
+
+/* The priority of an operation is the estimated time needed to evaluate the longest chain of
+ * operations starting with it. Operations are visited from the leaves of the graph towards its
+ * roots, so all children are handled before their parents. Cyclic relations are ignored, the
+ * graph is acyclic without them. */
+void deg_eval_priorities_calculate(Depsgraph *graph)
+{
+  enum {
+    DEG_NODE_VISITED = (1 << 0),
+  };
+
+  BLI_Stack *stack = BLI_stack_new(sizeof(OperationNode *), "DEG priorities stack");
+  for (OperationNode *op_node : graph->operations) {
+    op_node->custom_flags = 0;
+    op_node->num_links_pending = 0;
+    op_node->priority = operation_cost_get(op_node);
+    for (Relation *rel : op_node->outlinks) {
+      if ((rel->to->type == NodeType::OPERATION) && (rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        ++op_node->num_links_pending;
+      }
+    }
+    if (op_node->num_links_pending == 0) {
+      BLI_stack_push(stack, &op_node);
+      op_node->custom_flags |= DEG_NODE_VISITED;
+    }
+  }
+  while (!BLI_stack_is_empty(stack)) {
+    OperationNode *op_node;
+    BLI_stack_pop(stack, &op_node);
+    for (Relation *rel : op_node->inlinks) {
+      if ((rel->from->type != NodeType::OPERATION) || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *op_from = (OperationNode *)rel->from;
+      op_from->priority = max_ff(op_from->priority,
+                                 operation_cost_get(op_from) + op_node->priority);
+      BLI_assert(op_from->num_links_pending > 0);
+      --op_from->num_links_pending;
+      if ((op_from->num_links_pending == 0) && (op_from->custom_flags & DEG_NODE_VISITED) == 0) {
+        BLI_stack_push(stack, &op_from);
+        op_from->custom_flags |= DEG_NODE_VISITED;
+      }
+    }
+  }
+  BLI_stack_free(stack);
+
+  graph->need_update_priorities = false;
+}
+
+}  // namespace deg
+}  // namespace blender
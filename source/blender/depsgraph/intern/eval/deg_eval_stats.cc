@@ -23,6 +23,7 @@
 
 #include "intern/eval/deg_eval_stats.h"
 
+#include "BLI_math_base.h"
 #include "BLI_utildefines.h"
 
 #include "intern/depsgraph.h"
@@ -55,5 +56,30 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+void deg_eval_stats_update_costs(Depsgraph *graph)
+{
+  /* Weight of the last evaluation in the running average, smooths out timing noise. */
+  const float new_time_weight = 0.25f;
+  /* Cost changes below this many seconds don't matter for scheduling. */
+  const float cost_change_threshold = 1e-5f;
+  for (OperationNode *op_node : graph->operations) {
+    if (!op_node->scheduled || op_node->is_noop()) {
+      continue;
+    }
+    const float time = (float)op_node->stats.current_time;
+    const float cost_prev = op_node->cost;
+    if (cost_prev == 0.0f) {
+      op_node->cost = time;
+    }
+    else {
+      op_node->cost = interpf(time, cost_prev, new_time_weight);
+    }
+    /* Only re-calculate priorities when the change is significant. */
+    if (fabsf(op_node->cost - cost_prev) > max_ff(cost_prev * 0.2f, cost_change_threshold)) {
+      graph->need_update_priorities = true;
+    }
+  }
+}
+
 }  // namespace deg
 }  // namespace blender
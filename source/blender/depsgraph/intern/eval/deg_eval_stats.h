@@ -31,5 +31,8 @@ struct Depsgraph;
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Update estimated cost of evaluated operations from their timing. */
+void deg_eval_stats_update_costs(Depsgraph *graph);
+
 }  // namespace deg
 }  // namespace blender
@@ -163,6 +163,10 @@ struct Node {
     void reset_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Point in time when evaluation of this node started and the thread which evaluated it.
+     * Only stored for operations when evaluation is traced. */
+    double current_start_time;
+    int current_thread_id;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
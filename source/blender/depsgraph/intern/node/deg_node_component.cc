@@ -231,6 +231,11 @@ void ComponentNode::clear_operations()
 
 void ComponentNode::tag_update(Depsgraph *graph, eUpdateSource source)
 {
+  if (type == NodeType::COPY_ON_WRITE) {
+    /* Generic copy-on-write tag, the whole datablock is to be copied. Is to be done prior to
+     * the check below, so that it is not ignored when copy-on-write was tagged already. */
+    owner->cow_update_components_mask = 0;
+  }
   OperationNode *entry_op = get_entry_operation();
   if (entry_op != nullptr && entry_op->flag & DEPSOP_FLAG_NEEDS_UPDATE) {
     return;
@@ -298,6 +303,17 @@ void ComponentNode::finalize_build(Depsgraph * /*graph*/)
   operations_map = nullptr;
 }
 
+void ComponentNode::restore_operations_map()
+{
+  BLI_assert(operations_map == nullptr);
+  operations_map = new Map<ComponentNode::OperationIDKey, OperationNode *>();
+  for (OperationNode *op_node : operations) {
+    OperationIDKey key(op_node->opcode, op_node->name.c_str(), op_node->name_tag);
+    operations_map->add_new(key, op_node);
+  }
+  operations.clear();
+}
+
 /* Bone Component ========================================= */
 
 /* Initialize 'bone component' node - from pointer data given */
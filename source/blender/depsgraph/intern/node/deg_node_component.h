@@ -106,6 +106,9 @@ struct ComponentNode : public Node {
   virtual OperationNode *get_exit_operation() override;
 
   void finalize_build(Depsgraph *graph);
+  /* Move operations back to the hash map used during build, so that more of them can be added
+   * when the graph is updated incrementally. */
+  void restore_operations_map();
 
   IDNode *owner;
 
@@ -93,6 +93,7 @@ void IDNode::init(const ID *id, const char *UNUSED(subdata))
 
   visible_components_mask = 0;
   previously_visible_components_mask = 0;
+  cow_update_components_mask = 0;
 }
 
 void IDNode::init_copy_on_write(ID *id_cow_hint)
@@ -95,6 +95,19 @@ struct IDNode : public Node {
   DEGCustomDataMeshMasks customdata_masks;
   DEGCustomDataMeshMasks previous_customdata_masks;
 
+  /* Evaluation flags and customdata masks requested by relations builders of other IDs, by the
+   * ID on behalf of which they were requested. Allows to withdraw requests of IDs whose relations
+   * are rebuilt, see deg_builder_incremental.h. */
+  struct EvalRequest {
+    uint32_t eval_flags = 0;
+    DEGCustomDataMeshMasks customdata_masks;
+  };
+  Map<ID *, EvalRequest> eval_requests;
+
+  /* IDs whose build functions pulled this ID into the graph. nullptr stands for the caller of
+   * the nodes builder, for IDs which are built outside of build functions of other IDs. */
+  Set<ID *> build_users;
+
   eDepsNode_LinkedState_Type linked_state;
 
   /* Indicates the datablock is visible in the evaluated scene. */
@@ -113,6 +126,12 @@ struct IDNode : public Node {
   IDComponentsMask visible_components_mask;
   IDComponentsMask previously_visible_components_mask;
 
+  /* Components on behalf of which copy-on-write of this ID has been tagged since the last
+   * evaluation. Allows to only re-sync data of those components into the evaluated copy.
+   * Zero means the whole datablock is to be copied: this is the case when the tag came from
+   * a generic source (such as ID_RECALC_COPY_ON_WRITE) or was flushed from another ID. */
+  IDComponentsMask cow_update_components_mask;
+
   DEG_DEPSNODE_DECLARE;
 };
 
@@ -210,7 +210,8 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0)
+OperationNode::OperationNode()
+    : cost(0.0f), priority(0.0f), name_tag(-1), flag(0), build_owner(nullptr)
 {
 }
 
@@ -241,6 +242,10 @@ void OperationNode::tag_update(Depsgraph *graph, eUpdateSource source)
   }
   /* Tag for update, but also note that this was the source of an update. */
   flag |= (DEPSOP_FLAG_NEEDS_UPDATE | DEPSOP_FLAG_DIRECTLY_MODIFIED);
+  /* Direct tag of the copy-on-write operation requests copy of the whole datablock. */
+  if (owner->type == NodeType::COPY_ON_WRITE) {
+    owner->owner->cow_update_components_mask = 0;
+  }
   switch (source) {
     case DEG_UPDATE_SOURCE_TIME:
     case DEG_UPDATE_SOURCE_RELATIONS:
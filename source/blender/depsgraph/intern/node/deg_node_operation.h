@@ -223,6 +223,9 @@ enum OperationFlag {
    * outgoing relations. This is for NO-OP nodes that are purely used to indicate a
    * relation between components/IDs, and not for connecting to an operation. */
   DEPSOP_FLAG_PINNED = (1 << 3),
+  /* Node was created by the builder of one ID and used by the builder of another ID, so it can
+   * not be rebuilt for any of them alone. */
+  DEPSOP_FLAG_SHARED = (1 << 4),
 
   /* Set of flags which gets flushed along the relations. */
   DEPSOP_FLAG_FLUSH = (DEPSOP_FLAG_USER_MODIFIED),
@@ -266,6 +269,12 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated evaluation time in seconds, averaged from the measured evaluation times. */
+  float cost;
+  /* Estimated time to evaluate the longest chain of operations starting with this one.
+   * Operations with the highest priority are evaluated first. */
+  float priority;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
@@ -273,6 +282,9 @@ struct OperationNode : public Node {
   /* (OperationFlag) extra settings affecting evaluation. */
   int flag;
 
+  /* ID on behalf of which the node builder created this operation. */
+  ID *build_owner;
+
   DEG_DEPSNODE_DECLARE;
 };
 
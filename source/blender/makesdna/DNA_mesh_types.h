@@ -104,6 +104,9 @@ typedef struct Mesh_Runtime {
   /** `BVHCache` defined in 'BKE_bvhutil.c' */
   struct BVHCache *bvh_cache;
 
+  /** `MLoopFanCache` defined in 'mesh_evaluate.c', smooth fans used for split normals. */
+  struct MLoopFanCache *loop_fan_cache;
+
   /** Non-manifold boundary data for Shrinkwrap Target Project. */
   struct ShrinkwrapBoundaryData *shrinkwrap_data;
 
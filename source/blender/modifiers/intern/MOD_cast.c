@@ -582,7 +582,7 @@ ModifierTypeInfo modifierType_Cast = {
     /* structSize */ sizeof(CastModifierData),
     /* type */ eModifierTypeType_OnlyDeform,
     /* flags */ eModifierTypeFlag_AcceptsCVs | eModifierTypeFlag_AcceptsVertexCosOnly |
-        eModifierTypeFlag_SupportsEditmode,
+        eModifierTypeFlag_SupportsEditmode | eModifierTypeFlag_AcceptsSharedDeformMesh,
 
     /* copyData */ BKE_modifier_copydata_generic,
 
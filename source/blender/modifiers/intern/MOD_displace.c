@@ -505,7 +505,8 @@ ModifierTypeInfo modifierType_Displace = {
     /* structName */ "DisplaceModifierData",
     /* structSize */ sizeof(DisplaceModifierData),
     /* type */ eModifierTypeType_OnlyDeform,
-    /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_SupportsEditmode,
+    /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_SupportsEditmode |
+        eModifierTypeFlag_AcceptsSharedDeformMesh,
 
     /* copyData */ BKE_modifier_copydata_generic,
 
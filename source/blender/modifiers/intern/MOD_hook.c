@@ -499,7 +499,7 @@ ModifierTypeInfo modifierType_Hook = {
     /* structSize */ sizeof(HookModifierData),
     /* type */ eModifierTypeType_OnlyDeform,
     /* flags */ eModifierTypeFlag_AcceptsCVs | eModifierTypeFlag_AcceptsVertexCosOnly |
-        eModifierTypeFlag_SupportsEditmode,
+        eModifierTypeFlag_SupportsEditmode | eModifierTypeFlag_AcceptsSharedDeformMesh,
     /* copyData */ copyData,
 
     /* deformVerts */ deformVerts,
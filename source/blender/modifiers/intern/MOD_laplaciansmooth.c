@@ -624,7 +624,8 @@ ModifierTypeInfo modifierType_LaplacianSmooth = {
     /* structName */ "LaplacianSmoothModifierData",
     /* structSize */ sizeof(LaplacianSmoothModifierData),
     /* type */ eModifierTypeType_OnlyDeform,
-    /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_SupportsEditmode,
+    /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_SupportsEditmode |
+        eModifierTypeFlag_AcceptsSharedDeformMesh,
 
     /* copyData */ BKE_modifier_copydata_generic,
 
@@ -111,12 +111,44 @@ static Mesh *mirrorModifier__doMirror(MirrorModifierData *mmd,
   return result;
 }
 
+static void freeRuntimeData(void *runtime_data)
+{
+  BKE_mesh_mirror_cache_free(runtime_data);
+}
+
+/* Drop the cached result of previous evaluations. */
+static void mirror_cache_clear(ModifierData *md)
+{
+  freeRuntimeData(md->runtime);
+  md->runtime = NULL;
+}
+
+static void freeData(ModifierData *md)
+{
+  mirror_cache_clear(md);
+}
+
 static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *mesh)
 {
   Mesh *result;
   MirrorModifierData *mmd = (MirrorModifierData *)md;
 
-  result = mirrorModifier__doMirror(mmd, ctx, ctx->object, mesh);
+  if (ctx->flag & MOD_APPLY_TOPOLOGY_CACHE) {
+    result = BKE_mesh_mirror_cache_apply(md->runtime, mmd, ctx->object, mesh);
+    if (result == NULL) {
+      result = mirrorModifier__doMirror(mmd, ctx, ctx->object, mesh);
+      BKE_mesh_mirror_cache_store(
+          (MeshMirrorCache **)&md->runtime, mmd, ctx->object, mesh, result);
+    }
+  }
+  else {
+    /* Other data than positions may have changed, the cached result is outdated.
+     * Evaluating undeformed coordinates doesn't affect the regular result. */
+    if ((ctx->flag & MOD_APPLY_ORCO) == 0) {
+      mirror_cache_clear(md);
+    }
+    result = mirrorModifier__doMirror(mmd, ctx, ctx->object, mesh);
+  }
 
   if (result != mesh) {
     result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
@@ -238,7 +270,7 @@ ModifierTypeInfo modifierType_Mirror = {
 
     /* initData */ initData,
     /* requiredDataMask */ NULL,
-    /* freeData */ NULL,
+    /* freeData */ freeData,
     /* isDisabled */ NULL,
     /* updateDepsgraph */ updateDepsgraph,
     /* dependsOnTime */ NULL,
@@ -246,7 +278,7 @@ ModifierTypeInfo modifierType_Mirror = {
     /* foreachObjectLink */ foreachObjectLink,
     /* foreachIDLink */ NULL,
     /* foreachTexLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
@@ -546,7 +546,7 @@ ModifierTypeInfo modifierType_SimpleDeform = {
 
     /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_AcceptsCVs |
         eModifierTypeFlag_AcceptsVertexCosOnly | eModifierTypeFlag_SupportsEditmode |
-        eModifierTypeFlag_EnableInEditmode,
+        eModifierTypeFlag_EnableInEditmode | eModifierTypeFlag_AcceptsSharedDeformMesh,
 
     /* copyData */ BKE_modifier_copydata_generic,
 
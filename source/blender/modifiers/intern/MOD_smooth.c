@@ -275,7 +275,7 @@ ModifierTypeInfo modifierType_Smooth = {
     /* structSize */ sizeof(SmoothModifierData),
     /* type */ eModifierTypeType_OnlyDeform,
     /* flags */ eModifierTypeFlag_AcceptsMesh | eModifierTypeFlag_AcceptsCVs |
-        eModifierTypeFlag_SupportsEditmode,
+        eModifierTypeFlag_SupportsEditmode | eModifierTypeFlag_AcceptsSharedDeformMesh,
 
     /* copyData */ BKE_modifier_copydata_generic,
 
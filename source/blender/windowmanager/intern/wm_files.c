@@ -1598,12 +1598,120 @@ void WM_autosave_init(wmWindowManager *wm)
   }
 }
 
+/**
+ * Auto-save writes a snapshot of the file (an undo memfile) to disk in a job,
+ * so that saving large files doesn't block the interface.
+ */
+typedef struct AutosaveJob {
+  /** Owns all its memory, see #BLO_memfile_snapshot. */
+  MemFile memfile;
+  char filepath[FILE_MAX];
+  bool success;
+} AutosaveJob;
+
+static void wm_autosave_job_startjob(void *customdata,
+                                     /* Cannot be const, this function implements
+                                      * wm_jobs_start_callback.
+                                      * NOLINTNEXTLINE: readability-non-const-parameter. */
+                                     short *stop,
+                                     short *UNUSED(do_update),
+                                     float *progress)
+{
+  AutosaveJob *job = customdata;
+  char tempname[FILE_MAX + 1];
+
+  /* Write to a temporary file first, so a canceled or failed write keeps the previous
+   * auto-save. */
+  BLI_snprintf(tempname, sizeof(tempname), "%s@", job->filepath);
+
+  if (BLO_memfile_write_file_ex(&job->memfile, tempname, stop, progress) &&
+      (BLI_rename(tempname, job->filepath) == 0)) {
+    job->success = true;
+  }
+  else if (BLI_exists(tempname)) {
+    BLI_delete(tempname, false, false);
+  }
+}
+
+static void wm_autosave_job_endjob(void *customdata)
+{
+  AutosaveJob *job = customdata;
+
+  if (job->success == false) {
+    WM_reportf(RPT_WARNING, "Unable to auto-save '%s'", job->filepath);
+  }
+}
+
+static void wm_autosave_job_free(void *customdata)
+{
+  AutosaveJob *job = customdata;
+
+  BLO_memfile_free(&job->memfile);
+  MEM_freeN(job);
+}
+
+/**
+ * Start writing the auto-save file from a job.
+ *
+ * \return false when the job could not be started and the file needs to be written directly.
+ */
+static bool wm_autosave_write_job(Main *bmain, wmWindowManager *wm, const char *filepath)
+{
+  wmWindow *win = wm->winactive ? wm->winactive : wm->windows.first;
+  if (win == NULL) {
+    return false;
+  }
+  /* Use the scene as owner, so progress is displayed in the status bar. */
+  Scene *scene = WM_window_get_active_scene(win);
+
+  AutosaveJob *job = MEM_callocN(sizeof(*job), __func__);
+  BLI_strncpy(job->filepath, filepath, sizeof(job->filepath));
+
+  if (U.uiflag & USER_GLOBALUNDO) {
+    /* Cheap snapshot of the last undo-buffer, now with UI. */
+    struct MemFile *memfile = ED_undosys_stack_memfile_get_active(wm->undo_stack);
+    if (memfile == NULL) {
+      MEM_freeN(job);
+      return true;
+    }
+    BLO_memfile_snapshot(memfile, &job->memfile);
+  }
+  else {
+    /* Serialize in memory, which is much faster than compressing and writing to disk. */
+    const int fileflags = G.fileflags & ~G_FILE_COMPRESS;
+
+    ED_editors_flush_edits(bmain);
+
+    if (BLO_write_file_mem(bmain, NULL, &job->memfile, fileflags) == false) {
+      BLO_memfile_free(&job->memfile);
+      MEM_freeN(job);
+      return false;
+    }
+  }
+
+  wmJob *wm_job = WM_jobs_get(
+      wm, win, scene, "Auto-saving...", WM_JOB_PROGRESS, WM_JOB_TYPE_AUTOSAVE);
+  WM_jobs_customdata_set(wm_job, job, wm_autosave_job_free);
+  WM_jobs_timer(wm_job, 0.1, 0, 0);
+  WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, NULL, NULL, wm_autosave_job_endjob);
+
+  WM_jobs_start(wm, wm_job);
+
+  return true;
+}
+
 void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
 {
   char filepath[FILE_MAX];
 
   WM_event_remove_timer(wm, NULL, wm->autosavetimer);
 
+  /* Previous auto-save is still being written, skip this one. */
+  if (WM_jobs_customdata_from_type(wm, WM_JOB_TYPE_AUTOSAVE)) {
+    wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
+    return;
+  }
+
   /* If a modal operator is running, don't autosave because we might not be in
    * a valid state to save. But try again in 10ms. */
   LISTBASE_FOREACH (wmWindow *, win, &wm->windows) {
@@ -1620,7 +1728,10 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
 
   wm_autosave_location(filepath);
 
-  if (U.uiflag & USER_GLOBALUNDO) {
+  if (wm_autosave_write_job(bmain, wm, filepath)) {
+    /* pass */
+  }
+  else if (U.uiflag & USER_GLOBALUNDO) {
     /* fast save of last undobuffer, now with UI */
     struct MemFile *memfile = ED_undosys_stack_memfile_get_active(wm->undo_stack);
     if (memfile) {
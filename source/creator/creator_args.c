@@ -597,6 +597,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-no-threads");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-time");
   BLI_argsPrintArgDoc(ba, "--debug-depsgraph-pretty");
+  BLI_argsPrintArgDoc(ba, "--debug-depsgraph-trace");
   BLI_argsPrintArgDoc(ba, "--debug-gpu");
   BLI_argsPrintArgDoc(ba, "--debug-gpumem");
   BLI_argsPrintArgDoc(ba, "--debug-gpu-shaders");
@@ -990,6 +991,30 @@ static int arg_handle_debug_mode_generic_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_debug_depsgraph_trace_set_doc[] =
+    "<filename>\n"
+    "\tWrite timing of every operation evaluated by the dependency graph to a file,\n"
+    "\tin the Chrome trace event format (chrome://tracing).\n"
+    "\tEvents store the thread, start and end time, and owning ID and component of operations.";
+static int arg_handle_debug_depsgraph_trace_set(int argc,
+                                                const char **argv,
+                                                void *UNUSED(data))
+{
+  const char *arg_id = "--debug-depsgraph-trace";
+  if (argc > 1) {
+    errno = 0;
+    if (!DEG_debug_trace_begin(argv[1])) {
+      const char *err_msg = errno ? strerror(errno) : "unknown";
+      printf("\nError: %s '%s %s'.\n", err_msg, arg_id, argv[1]);
+    }
+    return 1;
+  }
+  else {
+    printf("\nError: '%s' no args given.\n", arg_id);
+    return 0;
+  }
+}
+
 static const char arg_handle_debug_mode_io_doc[] =
     "\n\t"
     "Enable debug messages for I/O (Collada, ...).";
@@ -2189,6 +2214,8 @@ void main_args_setup(bContext *C, bArgs *ba)
               "--debug-depsgraph-pretty",
               CB_EX(arg_handle_debug_mode_generic_set, depsgraph_pretty),
               (void *)G_DEBUG_DEPSGRAPH_PRETTY);
+  BLI_argsAdd(
+      ba, 1, NULL, "--debug-depsgraph-trace", CB(arg_handle_debug_depsgraph_trace_set), NULL);
   BLI_argsAdd(ba,
               1,
               NULL,
@@ -344,6 +344,7 @@ TEST(array_store, DoubleNop)
   BArrayState *state_a = BLI_array_store_state_add(bs, data_src, sizeof(data_src), NULL);
   BArrayState *state_b = BLI_array_store_state_add(bs, data_src, sizeof(data_src), state_a);
 
+  EXPECT_TRUE(BLI_array_store_state_is_identical(state_a, state_b));
   EXPECT_EQ(BLI_array_store_calc_size_compacted_get(bs), sizeof(data_src));
   EXPECT_EQ(BLI_array_store_calc_size_expanded_get(bs), sizeof(data_src) * 2);
 
@@ -372,6 +373,7 @@ TEST(array_store, DoubleDiff)
   BArrayState *state_b = BLI_array_store_state_add(bs, data_src_b, sizeof(data_src_b), state_a);
   size_t data_dst_len;
 
+  EXPECT_FALSE(BLI_array_store_state_is_identical(state_a, state_b));
   EXPECT_EQ(BLI_array_store_calc_size_compacted_get(bs), sizeof(data_src_a) * 2);
   EXPECT_EQ(BLI_array_store_calc_size_expanded_get(bs), sizeof(data_src_a) * 2);
 
@@ -386,6 +388,38 @@ TEST(array_store, DoubleDiff)
   BLI_array_store_destroy(bs);
 }
 
+TEST(array_store, SizeAdded)
+{
+  BArrayStore *bs = BLI_array_store_create(1, 32);
+  const size_t data_len = 4096;
+  char *data_a = (char *)MEM_mallocN(data_len, __func__);
+  char *data_b = (char *)MEM_mallocN(data_len, __func__);
+  for (size_t i = 0; i < data_len; i++) {
+    data_a[i] = (char)((i * 7) ^ (i >> 5));
+  }
+  /* Shift the second half, changing a few bytes in the middle. */
+  memcpy(data_b, data_a, data_len / 2);
+  memset(data_b + data_len / 2, '#', 16);
+  memcpy(data_b + data_len / 2 + 16, data_a + data_len / 2, data_len / 2 - 16);
+
+  BArrayState *state_a = BLI_array_store_state_add(bs, data_a, data_len, NULL);
+  EXPECT_EQ(BLI_array_store_state_size_added_get(state_a, NULL),
+            BLI_array_store_calc_size_compacted_get(bs));
+
+  const size_t size_a = BLI_array_store_calc_size_compacted_get(bs);
+  BArrayState *state_b = BLI_array_store_state_add(bs, data_b, data_len, state_a);
+  const size_t size_added = BLI_array_store_state_size_added_get(state_b, state_a);
+  EXPECT_EQ(size_added, BLI_array_store_calc_size_compacted_get(bs) - size_a);
+  EXPECT_LT(size_added, data_len);
+
+  BArrayState *state_c = BLI_array_store_state_add(bs, data_b, data_len, state_b);
+  EXPECT_EQ(BLI_array_store_state_size_added_get(state_c, state_b), (size_t)0);
+
+  MEM_freeN(data_a);
+  MEM_freeN(data_b);
+  BLI_array_store_destroy(bs);
+}
+
 TEST(array_store, TextMixed)
 {
   TESTBUFFER_STRINGS(1, 4, "", );
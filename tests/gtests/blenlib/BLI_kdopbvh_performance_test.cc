@@ -0,0 +1,136 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_kdopbvh.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#include "PIL_time.h"
+}
+
+#define POINTS_NUM 200000
+#define QUERIES_NUM 1000000
+
+/* Small boxes on the surface of a sphere, similar to the triangles of a dense mesh. */
+static BVHTree *sphere_tree_new(const float (*points)[3], int balance_flag)
+{
+  const double init_time = PIL_check_seconds_timer();
+  BVHTree *tree = BLI_bvhtree_new(POINTS_NUM, 0.005f, 4, 6);
+  for (int i = 0; i < POINTS_NUM; i++) {
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+  printf("\tBalance (%s): %fs\n",
+         (balance_flag & BVH_BALANCE_SAH) ? "SAH" : "median",
+         PIL_check_seconds_timer() - init_time);
+  return tree;
+}
+
+static void ray_cast_test(BVHTree *tree,
+                          const char *id,
+                          const float (*co)[3],
+                          const float (*dir)[3],
+                          BVHTreeRayHit *hits)
+{
+  int hits_num = 0;
+
+  double init_time = PIL_check_seconds_timer();
+  for (int i = 0; i < QUERIES_NUM; i++) {
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+    hits_num += (BLI_bvhtree_ray_cast(tree, co[i], dir[i], 0.0f, &hits[i], NULL, NULL) != -1);
+  }
+  printf("\t%s ray-cast: %fs (%d hits)\n", id, PIL_check_seconds_timer() - init_time, hits_num);
+
+  init_time = PIL_check_seconds_timer();
+  for (int i = 0; i < QUERIES_NUM; i++) {
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+  }
+  BLI_bvhtree_ray_cast_batch(
+      tree, co, dir, QUERIES_NUM, 0.0f, hits, NULL, NULL, BVH_RAYCAST_DEFAULT);
+  printf("\t%s ray-cast batch: %fs\n", id, PIL_check_seconds_timer() - init_time);
+}
+
+static void find_nearest_test(BVHTree *tree,
+                              const char *id,
+                              const float (*co)[3],
+                              BVHTreeNearest *nearest)
+{
+  double init_time = PIL_check_seconds_timer();
+  for (int i = 0; i < QUERIES_NUM; i++) {
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, co[i], &nearest[i], NULL, NULL);
+  }
+  printf("\t%s find-nearest: %fs\n", id, PIL_check_seconds_timer() - init_time);
+
+  init_time = PIL_check_seconds_timer();
+  for (int i = 0; i < QUERIES_NUM; i++) {
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+  BLI_bvhtree_find_nearest_batch(tree, co, QUERIES_NUM, nearest, NULL, NULL, 0);
+  printf("\t%s find-nearest batch: %fs\n", id, PIL_check_seconds_timer() - init_time);
+}
+
+TEST(kdopbvh, QueriesPerformance)
+{
+  printf("\n========== STARTING %s ==========\n", __func__);
+
+  struct RNG *rng = BLI_rng_new(0);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(*points) * POINTS_NUM, __func__);
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(*co) * QUERIES_NUM, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(*dir) * QUERIES_NUM, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * QUERIES_NUM, __func__);
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * QUERIES_NUM,
+                                                          __func__);
+
+  for (int i = 0; i < POINTS_NUM; i++) {
+    BLI_rng_get_float_unit_v3(rng, points[i]);
+  }
+
+  BVHTree *tree = sphere_tree_new(points, 0);
+  BVHTree *tree_sah = sphere_tree_new(points, BVH_BALANCE_SAH);
+
+  /* Coherent rays, from a camera looking at the sphere. */
+  const int res = (int)sqrtf((float)QUERIES_NUM);
+  for (int i = 0; i < QUERIES_NUM; i++) {
+    const float x = (float)(i % res) / (float)res * 2.0f - 1.0f;
+    const float y = (float)(i / res) / (float)res * 2.0f - 1.0f;
+    copy_v3_fl3(co[i], 0.0f, 0.0f, -3.0f);
+    copy_v3_fl3(dir[i], x * 0.4f, y * 0.4f, 1.0f);
+    normalize_v3(dir[i]);
+  }
+  ray_cast_test(tree, "Median, coherent", co, dir, hits);
+  ray_cast_test(tree_sah, "SAH, coherent", co, dir, hits);
+
+  /* Incoherent rays, from random points inside the sphere. */
+  for (int i = 0; i < QUERIES_NUM; i++) {
+    BLI_rng_get_float_unit_v3(rng, co[i]);
+    mul_v3_fl(co[i], BLI_rng_get_float(rng));
+    BLI_rng_get_float_unit_v3(rng, dir[i]);
+  }
+  ray_cast_test(tree, "Median, incoherent", co, dir, hits);
+  ray_cast_test(tree_sah, "SAH, incoherent", co, dir, hits);
+
+  find_nearest_test(tree, "Median", co, nearest);
+  find_nearest_test(tree_sah, "SAH", co, nearest);
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_sah);
+  MEM_freeN(points);
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(hits);
+  MEM_freeN(nearest);
+  BLI_rng_free(rng);
+
+  printf("========== ENDED %s ==========\n\n", __func__);
+}
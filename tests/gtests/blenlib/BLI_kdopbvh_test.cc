@@ -70,8 +70,12 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                     float scale,
+                                     int round,
+                                     int random_seed,
+                                     bool optimal = false,
+                                     int balance_flag = 0)
 {
   struct RNG *rng = BLI_rng_new(random_seed);
   BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
@@ -83,7 +87,7 @@ static void find_nearest_points_test(
     rng_v3_round(points[i], 3, rng, round, scale);
     BLI_bvhtree_insert(tree, i, points[i], 1);
   }
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 
   /* first find each point */
   BVHTree_NearestPointCallback callback = optimal ? optimal_check_callback : NULL;
@@ -136,3 +140,126 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, SAHFindNearest_2)
+{
+  find_nearest_points_test(2, 1.0, 1000, 123, false, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, SAHFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, SAHOptimalFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, true, BVH_BALANCE_SAH);
+}
+
+static BVHTree *points_tree_new(
+    const float (*points)[3], int points_len, float epsilon, int tree_type, int balance_flag)
+{
+  BVHTree *tree = BLI_bvhtree_new(points_len, epsilon, tree_type, 8);
+  for (int i = 0; i < points_len; i++) {
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+  return tree;
+}
+
+/**
+ * Compare batched queries with single queries,
+ * as well as queries on trees balanced with the SAH with the default balancing.
+ */
+static void batch_queries_test(int points_len, int queries_len, int tree_type, int random_seed)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  float(*co)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  float(*dir)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(*hits) * queries_len, __func__);
+  BVHTreeNearest *nearest = (BVHTreeNearest *)MEM_mallocN(sizeof(*nearest) * queries_len,
+                                                          __func__);
+
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+  }
+  for (int i = 0; i < queries_len; i++) {
+    rng_v3_round(co[i], 3, rng, 1000, 1.5f);
+    BLI_rng_get_float_unit_v3(rng, dir[i]);
+    /* Include some axis aligned rays. */
+    if (i % 7 == 0) {
+      dir[i][i % 3] = 0.0f;
+      normalize_v3(dir[i]);
+    }
+  }
+
+  BVHTree *tree = points_tree_new(points, points_len, 0.01f, tree_type, 0);
+  BVHTree *tree_sah = points_tree_new(points, points_len, 0.01f, tree_type, BVH_BALANCE_SAH);
+
+  const float radius_tests[2] = {0.0f, 0.02f};
+  for (int r = 0; r < 2; r++) {
+    const float radius = radius_tests[r];
+    for (int i = 0; i < queries_len; i++) {
+      hits[i].index = -1;
+      hits[i].dist = BVH_RAYCAST_DIST_MAX;
+    }
+    BLI_bvhtree_ray_cast_batch(
+        tree, co, dir, queries_len, radius, hits, NULL, NULL, BVH_RAYCAST_DEFAULT);
+
+    for (int i = 0; i < queries_len; i++) {
+      BVHTreeRayHit hit = {-1};
+      hit.dist = BVH_RAYCAST_DIST_MAX;
+      BLI_bvhtree_ray_cast(tree, co[i], dir[i], radius, &hit, NULL, NULL);
+      EXPECT_EQ(hit.index, hits[i].index);
+      EXPECT_EQ(hit.dist, hits[i].dist);
+
+      BVHTreeRayHit hit_sah = {-1};
+      hit_sah.dist = BVH_RAYCAST_DIST_MAX;
+      BLI_bvhtree_ray_cast(tree_sah, co[i], dir[i], radius, &hit_sah, NULL, NULL);
+      /* Different nodes may be hit at the same distance. */
+      EXPECT_EQ(hit.dist, hit_sah.dist);
+    }
+  }
+
+  for (int i = 0; i < queries_len; i++) {
+    nearest[i].index = -1;
+    nearest[i].dist_sq = FLT_MAX;
+  }
+  BLI_bvhtree_find_nearest_batch(tree_sah, co, queries_len, nearest, NULL, NULL, 0);
+
+  for (int i = 0; i < queries_len; i++) {
+    BVHTreeNearest nearest_single;
+    nearest_single.index = -1;
+    nearest_single.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree_sah, co[i], &nearest_single, NULL, NULL);
+    EXPECT_EQ(nearest_single.index, nearest[i].index);
+    EXPECT_EQ(nearest_single.dist_sq, nearest[i].dist_sq);
+
+    nearest_single.index = -1;
+    nearest_single.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, co[i], &nearest_single, NULL, NULL);
+    EXPECT_EQ(nearest_single.dist_sq, nearest[i].dist_sq);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_bvhtree_free(tree_sah);
+  MEM_freeN(points);
+  MEM_freeN(co);
+  MEM_freeN(dir);
+  MEM_freeN(hits);
+  MEM_freeN(nearest);
+  BLI_rng_free(rng);
+}
+
+TEST(kdopbvh, BatchQueries_Binary)
+{
+  batch_queries_test(1000, 1001, 2, 1234);
+}
+TEST(kdopbvh, BatchQueries_Quad)
+{
+  batch_queries_test(1000, 1001, 4, 123);
+}
+TEST(kdopbvh, BatchQueries_Oct)
+{
+  batch_queries_test(5000, 503, 8, 12);
+}
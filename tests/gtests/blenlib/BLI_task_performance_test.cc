@@ -13,6 +13,7 @@ extern "C" {
 #include "BLI_utildefines.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math.h"
 #include "BLI_mempool.h"
 #include "BLI_task.h"
 
@@ -210,3 +211,217 @@ TEST(task, ListBaseIter100k)
 {
   task_listbase_test("ListBase parallel iteration - Threaded - 100000 items", 100000, true);
 }
+
+/* *** Parallel range with typical mesh processing kernels. *** */
+
+/* Compares the static chunk sizes with the automatic one (min_iter_per_thread of zero). */
+
+#define RANGE_NUM_ITEMS (1 << 20)
+
+typedef struct RangeKernelData {
+  const float (*co)[3];
+  float (*r_co)[3];
+  const int *interp_indices;
+  float mat[4][4];
+} RangeKernelData;
+
+static void range_normals_func(void *__restrict userdata,
+                               const int index,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RangeKernelData *data = (RangeKernelData *)userdata;
+  /* Triangle strip, last triangles wrap around. */
+  const int index_next = (index + 1) % RANGE_NUM_ITEMS;
+  const int index_next_next = (index + 2) % RANGE_NUM_ITEMS;
+  normal_tri_v3(
+      data->r_co[index], data->co[index], data->co[index_next], data->co[index_next_next]);
+}
+
+static void range_deform_func(void *__restrict userdata,
+                              const int index,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RangeKernelData *data = (RangeKernelData *)userdata;
+  mul_v3_m4v3(data->r_co[index], data->mat, data->co[index]);
+}
+
+static void range_interp_func(void *__restrict userdata,
+                              const int index,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RangeKernelData *data = (RangeKernelData *)userdata;
+  const float weights[4] = {0.1f, 0.2f, 0.3f, 0.4f};
+  const int *indices = &data->interp_indices[index * 4];
+  zero_v3(data->r_co[index]);
+  for (int i = 0; i < 4; i++) {
+    madd_v3_v3fl(data->r_co[index], data->co[indices[i]], weights[i]);
+  }
+}
+
+static void task_range_test_do(const char *id, TaskParallelRangeFunc func)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+
+  float(*co)[3] = (float(*)[3])MEM_malloc_arrayN(RANGE_NUM_ITEMS, sizeof(*co), __func__);
+  float(*r_co)[3] = (float(*)[3])MEM_malloc_arrayN(RANGE_NUM_ITEMS, sizeof(*r_co), __func__);
+  float(*r_co_expected)[3] = (float(*)[3])MEM_malloc_arrayN(
+      RANGE_NUM_ITEMS, sizeof(*r_co_expected), __func__);
+  int *interp_indices = (int *)MEM_malloc_arrayN(
+      RANGE_NUM_ITEMS * 4, sizeof(*interp_indices), __func__);
+  for (int i = 0; i < RANGE_NUM_ITEMS; i++) {
+    const uint num = gen_pseudo_random_number((uint)i);
+    co[i][0] = (float)i;
+    co[i][1] = (float)num;
+    co[i][2] = (float)(i % 64);
+    for (int j = 0; j < 4; j++) {
+      interp_indices[i * 4 + j] = (int)((num * (j + 1) + (uint)i) % RANGE_NUM_ITEMS);
+    }
+  }
+
+  RangeKernelData data;
+  data.co = co;
+  data.interp_indices = interp_indices;
+  unit_m4(data.mat);
+  rotate_m4(data.mat, 'Z', 0.5f);
+  scale_m4_fl(data.mat, 2.0f);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+
+  data.r_co = r_co_expected;
+  settings.use_threading = false;
+  BLI_task_parallel_range(0, RANGE_NUM_ITEMS, &data, func, &settings);
+
+  data.r_co = r_co;
+  settings.use_threading = true;
+  const struct {
+    const char *name;
+    int min_iter_per_thread;
+  } modes[] = {
+      {"Static, 1 iteration per chunk", 1},
+      {"Static, 1024 iterations per chunk", 1024},
+      {"Automatic chunk size", 0},
+  };
+  for (int mode = 0; mode < ARRAY_SIZE(modes); mode++) {
+    settings.min_iter_per_thread = modes[mode].min_iter_per_thread;
+    double averaged_timing = 0.0;
+    for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+      memset(r_co, 0, sizeof(*r_co) * RANGE_NUM_ITEMS);
+      const double init_time = PIL_check_seconds_timer();
+      BLI_task_parallel_range(0, RANGE_NUM_ITEMS, &data, func, &settings);
+      averaged_timing += PIL_check_seconds_timer() - init_time;
+    }
+    EXPECT_EQ(memcmp(r_co, r_co_expected, sizeof(*r_co) * RANGE_NUM_ITEMS), 0);
+    printf("\t%s: done in %fs on average over %d runs\n",
+           modes[mode].name,
+           averaged_timing / NUM_RUN_AVERAGED,
+           NUM_RUN_AVERAGED);
+  }
+
+  MEM_freeN(co);
+  MEM_freeN(r_co);
+  MEM_freeN(r_co_expected);
+  MEM_freeN(interp_indices);
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(task, RangeNormals)
+{
+  task_range_test_do("Range parallel iteration - Triangle normals", range_normals_func);
+}
+
+TEST(task, RangeDeform)
+{
+  task_range_test_do("Range parallel iteration - Matrix deform", range_deform_func);
+}
+
+TEST(task, RangeCustomDataInterp)
+{
+  task_range_test_do("Range parallel iteration - CustomData interpolation", range_interp_func);
+}
+
+/* *** Parallel range with few heavy iterations, like PBVH nodes. *** */
+
+#define RANGE_HEAVY_NUM_ITEMS 32
+#define RANGE_HEAVY_NUM_VERTS (1 << 14)
+
+static void range_heavy_func(void *__restrict userdata,
+                             const int index,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  RangeKernelData *data = (RangeKernelData *)userdata;
+  /* Every item deforms its own block of vertices. */
+  const int offset = index * RANGE_HEAVY_NUM_VERTS;
+  for (int i = offset; i < offset + RANGE_HEAVY_NUM_VERTS; i++) {
+    mul_v3_m4v3(data->r_co[i], data->mat, data->co[i]);
+    normalize_v3(data->r_co[i]);
+  }
+}
+
+TEST(task, RangeHeavyShort)
+{
+  const char *id = "Range parallel iteration - Few heavy iterations";
+  printf("\n========== STARTING %s ==========\n", id);
+
+  BLI_threadapi_init();
+
+  const int num_verts = RANGE_HEAVY_NUM_ITEMS * RANGE_HEAVY_NUM_VERTS;
+  float(*co)[3] = (float(*)[3])MEM_malloc_arrayN(num_verts, sizeof(*co), __func__);
+  float(*r_co)[3] = (float(*)[3])MEM_malloc_arrayN(num_verts, sizeof(*r_co), __func__);
+  float(*r_co_expected)[3] = (float(*)[3])MEM_malloc_arrayN(
+      num_verts, sizeof(*r_co_expected), __func__);
+  for (int i = 0; i < num_verts; i++) {
+    co[i][0] = (float)i;
+    co[i][1] = (float)gen_pseudo_random_number((uint)i);
+    co[i][2] = (float)(i % 64);
+  }
+
+  RangeKernelData data;
+  data.co = co;
+  data.interp_indices = NULL;
+  unit_m4(data.mat);
+  rotate_m4(data.mat, 'Z', 0.5f);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+
+  data.r_co = r_co_expected;
+  settings.use_threading = false;
+  BLI_task_parallel_range(0, RANGE_HEAVY_NUM_ITEMS, &data, range_heavy_func, &settings);
+
+  data.r_co = r_co;
+  settings.use_threading = true;
+  const struct {
+    const char *name;
+    int min_iter_per_thread;
+  } modes[] = {
+      {"Static, 1 iteration per chunk", 1},
+      {"Automatic chunk size", 0},
+  };
+  for (int mode = 0; mode < ARRAY_SIZE(modes); mode++) {
+    settings.min_iter_per_thread = modes[mode].min_iter_per_thread;
+    double averaged_timing = 0.0;
+    for (int i = 0; i < NUM_RUN_AVERAGED; i++) {
+      memset(r_co, 0, sizeof(*r_co) * num_verts);
+      const double init_time = PIL_check_seconds_timer();
+      BLI_task_parallel_range(0, RANGE_HEAVY_NUM_ITEMS, &data, range_heavy_func, &settings);
+      averaged_timing += PIL_check_seconds_timer() - init_time;
+    }
+    EXPECT_EQ(memcmp(r_co, r_co_expected, sizeof(*r_co) * num_verts), 0);
+    printf("\t%s: done in %fs on average over %d runs\n",
+           modes[mode].name,
+           averaged_timing / NUM_RUN_AVERAGED,
+           NUM_RUN_AVERAGED);
+  }
+
+  MEM_freeN(co);
+  MEM_freeN(r_co);
+  MEM_freeN(r_co_expected);
+  BLI_threadapi_exit();
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
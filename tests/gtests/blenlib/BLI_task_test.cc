@@ -67,6 +67,35 @@ TEST(task, RangeIter)
   BLI_threadapi_exit();
 }
 
+TEST(task, RangeIterShort)
+{
+  /* Few iterations per thread, which run in parallel right away with the automatic grain size. */
+  const int num_items = 16;
+  int data[num_items] = {0};
+  int sum = 0;
+
+  BLI_threadapi_init();
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 0;
+
+  settings.userdata_chunk = &sum;
+  settings.userdata_chunk_size = sizeof(sum);
+  settings.func_reduce = task_range_iter_reduce_func;
+
+  BLI_task_parallel_range(0, num_items, data, task_range_iter_func, &settings);
+
+  int expected_sum = 0;
+  for (int i = 0; i < num_items; i++) {
+    EXPECT_EQ(data[i], i);
+    expected_sum += i;
+  }
+  EXPECT_EQ(sum, expected_sum);
+
+  BLI_threadapi_exit();
+}
+
 /* *** Parallel iterations over mempool items. *** */
 
 static void task_mempool_iter_func(void *userdata, MempoolIterData *item)